@@ -40,6 +40,7 @@
 #include <sys/queue.h>
 #include <stdlib.h>
 #include <getopt.h>
+#include <unistd.h>
 
 #include <rte_eal.h>
 #include <rte_common.h>
@@ -57,6 +58,8 @@
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_string_fns.h>
+#include <rte_metrics.h>
+#include <rte_lcore_poll.h>
 
 /* Maximum long option length for option parsing. */
 #define MAX_LONG_OPT_SZ 64
@@ -74,6 +77,10 @@ static uint32_t reset_stats;
 static uint32_t reset_xstats;
 /**< Enable memory info. */
 static uint32_t mem_info;
+/**< Enable metrics. */
+static uint32_t enable_metrics;
+/**< Enable lcore poll statistics. */
+static uint32_t enable_lcore_stats;
 
 /**< display usage */
 static void
@@ -86,7 +93,10 @@ proc_info_usage(const char *prgname)
 		"  --xstats: to display extended port statistics, disabled by "
 			"default\n"
 		"  --stats-reset: to reset port statistics\n"
-		"  --xstats-reset: to reset port extended statistics\n",
+		"  --xstats-reset: to reset port extended statistics\n"
+		"  --metrics: to display global and port metrics\n"
+		"  --lcore-stats: to display the busy and idle polling of the "
+			"lcores\n",
 		prgname);
 }
 
@@ -128,6 +138,8 @@ proc_info_parse_args(int argc, char **argv)
 		{"stats-reset", 0, NULL, 0},
 		{"xstats", 0, NULL, 0},
 		{"xstats-reset", 0, NULL, 0},
+		{"metrics", 0, NULL, 0},
+		{"lcore-stats", 0, NULL, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -167,6 +179,14 @@ proc_info_parse_args(int argc, char **argv)
 			else if (!strncmp(long_option[option_index].name, "xstats-reset",
 					MAX_LONG_OPT_SZ))
 				reset_xstats = 1;
+			/* Print metrics */
+			else if (!strncmp(long_option[option_index].name, "metrics",
+					MAX_LONG_OPT_SZ))
+				enable_metrics = 1;
+			/* Print lcore poll statistics */
+			else if (!strncmp(long_option[option_index].name,
+					"lcore-stats", MAX_LONG_OPT_SZ))
+				enable_lcore_stats = 1;
 			break;
 
 		default:
@@ -285,6 +305,105 @@ nic_xstats_clear(uint8_t port_id)
 	printf("\n  NIC extended statistics for port %d cleared\n", port_id);
 }
 
+static void
+metrics_display(int port_id)
+{
+	struct rte_metric_value *values;
+	struct rte_metric_name *names;
+	int len, ret, i;
+	static const char *nic_stats_border = "########################";
+
+	len = rte_metrics_get_names(NULL, 0);
+	if (len < 0) {
+		printf("Cannot get metrics count\n");
+		return;
+	}
+	names = malloc(sizeof(names[0]) * len);
+	values = malloc(sizeof(values[0]) * len);
+	if (names == NULL || values == NULL) {
+		printf("Cannot allocate memory for metrics\n");
+		free(names);
+		free(values);
+		return;
+	}
+
+	if (rte_metrics_get_names(names, len) != len) {
+		printf("Cannot get metrics names\n");
+		goto out;
+	}
+	ret = rte_metrics_get_values(port_id, values, len);
+	if (ret < 0 || ret > len) {
+		printf("Cannot get metrics values\n");
+		goto out;
+	}
+
+	if (port_id == RTE_METRICS_GLOBAL)
+		printf("###### Global metrics #########\n");
+	else
+		printf("###### Metrics for port %-2d #########\n", port_id);
+	printf("%s############################\n", nic_stats_border);
+	for (i = 0; i < ret; i++) {
+		/* registered after the names were read */
+		if (values[i].key >= len)
+			continue;
+		printf("%s: %"PRIu64"\n", names[values[i].key].name,
+			values[i].value);
+	}
+	printf("%s############################\n", nic_stats_border);
+
+out:
+	free(names);
+	free(values);
+}
+
+static double
+busy_percent(uint64_t busy_cycles, uint64_t idle_cycles)
+{
+	if (busy_cycles + idle_cycles == 0)
+		return 0;
+	return 100.0 * busy_cycles / (busy_cycles + idle_cycles);
+}
+
+static void
+lcore_stats_display(void)
+{
+	static struct rte_lcore_poll_stats first[RTE_MAX_LCORE];
+	struct rte_lcore_poll_stats last;
+	static const char *lcore_stats_border = "########################";
+	unsigned int lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (rte_lcore_poll_stats_get(lcore_id, &first[lcore_id]) < 0) {
+			printf("Lcore poll statistics not available\n");
+			return;
+		}
+	}
+	/* sample the current load over one second */
+	sleep(1);
+
+	printf("###### Lcore poll statistics #########\n");
+	printf("%s############################\n", lcore_stats_border);
+	printf("%5s %14s %14s %8s %8s %12s\n", "lcore", "busy iters",
+		"idle iters", "busy%", "busy% 1s", "cycles/busy");
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		rte_lcore_poll_stats_get(lcore_id, &last);
+		/* lcore never ran an instrumented loop */
+		if (last.busy_iters + last.idle_iters == 0)
+			continue;
+
+		printf("%5u %14"PRIu64" %14"PRIu64" %7.1f%% %7.1f%% %12"PRIu64
+			"%s\n", lcore_id, last.busy_iters, last.idle_iters,
+			busy_percent(last.busy_cycles, last.idle_cycles),
+			busy_percent(last.busy_cycles -
+					first[lcore_id].busy_cycles,
+				last.idle_cycles - first[lcore_id].idle_cycles),
+			last.busy_iters == 0 ? 0 :
+				last.busy_cycles / last.busy_iters,
+			last.last_tsc == 0 ? " (stopped)" : "");
+	}
+	printf("%s############################\n", lcore_stats_border);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -323,9 +442,21 @@ main(int argc, char **argv)
 		return 0;
 	}
 
+	if (enable_metrics) {
+		if (rte_metrics_init(SOCKET_ID_ANY) < 0)
+			rte_exit(EXIT_FAILURE, "No metrics in primary process\n");
+		metrics_display(RTE_METRICS_GLOBAL);
+	}
+
+	if (enable_lcore_stats)
+		lcore_stats_display();
+
 	nb_ports = rte_eth_dev_count();
-	if (nb_ports == 0)
+	if (nb_ports == 0) {
+		if (enable_metrics || enable_lcore_stats)
+			return 0;
 		rte_exit(EXIT_FAILURE, "No Ethernet ports - bye\n");
+	}
 
 
 	if (nb_ports > RTE_MAX_ETHPORTS)
@@ -345,6 +476,8 @@ main(int argc, char **argv)
 				nic_stats_clear(i);
 			else if (reset_xstats)
 				nic_xstats_clear(i);
+			if (enable_metrics)
+				metrics_display(i);
 		}
 	}
 
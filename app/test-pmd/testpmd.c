@@ -72,6 +72,7 @@
 #include <rte_ethdev.h>
 #include <rte_dev.h>
 #include <rte_string_fns.h>
+#include <rte_lcore_poll.h>
 #ifdef RTE_LIBRTE_PMD_XENVIRT
 #include <rte_eth_xenvirt.h>
 #endif
@@ -877,12 +878,19 @@ run_pkt_fwd_on_lcore(struct fwd_lcore *fc, packet_fwd_t pkt_fwd)
 	struct fwd_stream **fsm;
 	streamid_t nb_fs;
 	streamid_t sm_id;
+	unsigned int nb_pkts;
 
 	fsm = &fwd_streams[fc->stream_idx];
 	nb_fs = fc->stream_nb;
 	do {
-		for (sm_id = 0; sm_id < nb_fs; sm_id++)
+		/* packets received or sent by the streams in this iteration */
+		nb_pkts = 0;
+		for (sm_id = 0; sm_id < nb_fs; sm_id++) {
+			nb_pkts -= fsm[sm_id]->rx_packets + fsm[sm_id]->tx_packets;
 			(*pkt_fwd)(fsm[sm_id]);
+			nb_pkts += fsm[sm_id]->rx_packets + fsm[sm_id]->tx_packets;
+		}
+		rte_lcore_poll_update(nb_pkts);
 	} while (! fc->stopped);
 }
 
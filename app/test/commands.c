@@ -439,7 +439,8 @@ int commands_init(void)
 		commands_len += strlen(t->command) + 1;
 	}
 
-	commands = malloc(commands_len);
+	/* room for the terminating '\0' written by the last sprintf() */
+	commands = malloc(commands_len + 1);
 	if (!commands)
 		return -1;
 
@@ -87,6 +87,7 @@ do_recursive_call(void)
 			{ "test_invalid_b_flag", no_action },
 			{ "test_invalid_vdev_flag", no_action },
 			{ "test_invalid_r_flag", no_action },
+			{ "test_invalid_s_flag", no_action },
 #ifdef RTE_LIBRTE_XEN_DOM0
 			{ "test_dom0_misc_flags", no_action },
 #else
@@ -95,6 +96,7 @@ do_recursive_call(void)
 			{ "test_memory_flags", no_action },
 			{ "test_file_prefix", no_action },
 			{ "test_no_huge_flag", no_action },
+			{ "test_malloc_heap_grow", test_malloc_heap_grow },
 #ifdef RTE_LIBRTE_IVSHMEM
 			{ "test_ivshmem", test_ivshmem },
 #endif
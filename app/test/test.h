@@ -173,6 +173,8 @@ int test_pci_run;
 
 int test_mp_secondary(void);
 
+int test_malloc_heap_grow(void);
+
 int test_ivshmem(void);
 int test_set_rxtx_conf(cmdline_fixed_string_t mode);
 int test_set_rxtx_anchor(cmdline_fixed_string_t type);
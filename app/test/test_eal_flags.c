@@ -491,6 +491,51 @@ test_invalid_r_flag(void)
 	return 0;
 }
 
+/*
+ * Test that the app doesn't run with invalid -s option.
+ */
+static int
+test_invalid_s_flag(void)
+{
+#ifdef RTE_EXEC_ENV_BSDAPP
+	/* BSD target doesn't support prefixes at this point */
+	const char * prefix = "";
+#else
+	char prefix[PATH_MAX], tmp[PATH_MAX];
+	if (get_current_prefix(tmp, sizeof(tmp)) == NULL) {
+		printf("Error - unable to get current prefix!\n");
+		return -1;
+	}
+	snprintf(prefix, sizeof(prefix), "--file-prefix=%s", tmp);
+#endif
+
+	const char *sinval[][9] = {
+			{prgname, prefix, mp_flag, "-n", "1", "--lcores=0,1@0", "-s", "error"},
+			{prgname, prefix, mp_flag, "-n", "1", "--lcores=0,1@0", "-s", "0"},
+			/* master lcore */
+			{prgname, prefix, mp_flag, "-n", "1", "--lcores=0,1@0", "-s", "1"},
+			/* lcore not enabled */
+			{prgname, prefix, mp_flag, "-n", "1", "--lcores=0,1@0", "-s", "4"},
+	};
+	/* Test with valid service coremask */
+	const char *sval[] = {prgname, prefix, mp_flag, "-n", "1", "--lcores=0,1@0", "-s", "2"};
+
+	int i;
+
+	for (i = 0; i != sizeof (sinval) / sizeof (sinval[0]); i++) {
+		if (launch_proc(sinval[i]) == 0) {
+			printf("Error - process did run ok with invalid "
+			    "-s (service coremask) parameter\n");
+			return -1;
+		}
+	}
+	if (launch_proc(sval) != 0) {
+		printf("Error - process did not run ok with valid -s (service coremask) value\n");
+		return -1;
+	}
+	return 0;
+}
+
 /*
  * Test that the app doesn't run without the coremask/corelist flags. In all cases
  * should give an error and fail to run
@@ -784,6 +829,9 @@ test_no_huge_flag(void)
 	/* With --no-huge, -m and --socket-mem */
 	const char *argv4[] = {prgname, prefix, no_huge, "-c", "1", "-n", "2",
 			"-m", DEFAULT_MEM_SIZE, "--socket-mem=" DEFAULT_MEM_SIZE};
+	/* With --no-huge and --fast-start */
+	const char *argv5[] = {prgname, prefix, no_huge, "-c", "1", "-n", "2",
+			"--fast-start"};
 	if (launch_proc(argv1) != 0) {
 		printf("Error - process did not run ok with --no-huge flag\n");
 		return -1;
@@ -807,6 +855,11 @@ test_no_huge_flag(void)
 				"--socket-mem flags\n");
 		return -1;
 	}
+	if (launch_proc(argv5) == 0) {
+		printf("Error - process run ok with --no-huge and --fast-start "
+				"flags\n");
+		return -1;
+	}
 	return 0;
 }
 
@@ -988,6 +1041,16 @@ test_misc_flags(void)
 	const char *argv15[] = {prgname, "--file-prefix=intr",
 			"-c", "1", "-n", "2", "--vfio-intr=invalid"};
 
+	/* try running with --huge-init-threads flag */
+	const char *argv16[] = {prgname, "--file-prefix=hugethreads",
+			"-c", "1", "-n", "2", "-m", DEFAULT_MEM_SIZE,
+			"--huge-init-threads=2"};
+
+	/* try running with invalid (zero) --huge-init-threads flag */
+	const char *argv17[] = {prgname, "--file-prefix=hugethreads",
+			"-c", "1", "-n", "2", "-m", DEFAULT_MEM_SIZE,
+			"--huge-init-threads=0"};
+
 
 	if (launch_proc(argv0) == 0) {
 		printf("Error - process ran ok with invalid flag\n");
@@ -1060,6 +1123,16 @@ test_misc_flags(void)
 				"--vfio-intr invalid parameter\n");
 		return -1;
 	}
+	if (launch_proc(argv16) != 0) {
+		printf("Error - process did not run ok with "
+				"--huge-init-threads parameter\n");
+		return -1;
+	}
+	if (launch_proc(argv17) == 0) {
+		printf("Error - process run ok with "
+				"invalid (zero) --huge-init-threads parameter\n");
+		return -1;
+	}
 	return 0;
 }
 #endif
@@ -1286,6 +1359,15 @@ test_memory_flags(void)
 	const char *argv10[] = {prgname, "-c", "10", "-n", "2",
 			"--file-prefix=" memtest, valid_socket_mem};
 
+	/* invalid --socket-limit flag (lower than --socket-mem) */
+	const char *argv11[] = {prgname, "-c", "10", "-n", "2",
+			"--file-prefix=" memtest, "--socket-mem=" DEFAULT_MEM_SIZE,
+			"--socket-limit=2"};
+
+	/* invalid (mixed with invalid data) --socket-limit flag */
+	const char *argv12[] = {prgname, "-c", "10", "-n", "2",
+			"--file-prefix=" memtest, "--socket-limit=2,Fred"};
+
 	if (launch_proc(argv0) != 0) {
 		printf("Error - secondary process failed with valid -m flag !\n");
 		return -1;
@@ -1353,6 +1435,18 @@ test_memory_flags(void)
 		return -1;
 	}
 
+	if (launch_proc(argv11) == 0) {
+		printf("Error - process run ok with --socket-limit lower "
+				"than --socket-mem!\n");
+		return -1;
+	}
+
+	if (launch_proc(argv12) == 0) {
+		printf("Error - process run ok with invalid "
+				"(mixed with invalid input) --socket-limit!\n");
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -1416,6 +1510,12 @@ test_eal_flags(void)
 		return ret;
 	}
 
+	ret = test_invalid_s_flag();
+	if (ret < 0) {
+		printf("Error in test_invalid_s_flag()\n");
+		return ret;
+	}
+
 	ret = test_memory_flags();
 	if (ret < 0) {
 		printf("Error in test_memory_flags()\n");
@@ -0,0 +1,264 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_latencystats.h>
+
+#include "test.h"
+
+#define RING_NAME "LATENCY_RING"
+#define POOL_NAME "LATENCY_POOL"
+#define RING_SIZE 1024
+#define NB_MBUFS 1023
+#define BURST 32
+#define SAMPLE_RATE 4
+#define DELAY_US 10
+#define PERF_ITER_SHIFT 20
+#define PERF_SAMPLE_RATE 1000
+
+static struct rte_ring *ring;
+static struct rte_mempool *pool;
+static uint8_t port;
+
+/* put a burst in the ring, without going through the ethdev callbacks */
+static int
+fill_ring(struct rte_mbuf **pkts)
+{
+	unsigned i;
+
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = rte_pktmbuf_alloc(pool);
+		if (pkts[i] == NULL)
+			return -1;
+	}
+	return rte_ring_enqueue_bulk(ring, (void **)pkts, BURST);
+}
+
+static void
+free_burst(struct rte_mbuf **pkts, unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+static int
+test_latency_init(void)
+{
+	TEST_ASSERT_EQUAL(rte_latencystats_init(0, SOCKET_ID_ANY), -EINVAL,
+		"Sample rate 0 accepted");
+	TEST_ASSERT_SUCCESS(rte_latencystats_init(SAMPLE_RATE, SOCKET_ID_ANY),
+		"Cannot start latency measures");
+	TEST_ASSERT_EQUAL(rte_latencystats_init(SAMPLE_RATE, SOCKET_ID_ANY),
+		-EEXIST, "Latency measures started twice");
+	TEST_ASSERT_SUCCESS(rte_latencystats_reset(), "Cannot reset stats");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_latency_measure(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	struct rte_latencystats stats;
+	uint64_t hist_sum = 0;
+	unsigned i, n, flagged = 0;
+
+	TEST_ASSERT_SUCCESS(fill_ring(pkts), "Cannot fill ring");
+	n = rte_eth_rx_burst(port, 0, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST, "Cannot receive burst");
+	for (i = 0; i < n; i++)
+		if (pkts[i]->ol_flags & PKT_RX_TIMESTAMP)
+			flagged++;
+	TEST_ASSERT_EQUAL(flagged, BURST / SAMPLE_RATE,
+		"Wrong number of timestamped packets: %u", flagged);
+
+	rte_delay_us(DELAY_US);
+	n = rte_eth_tx_burst(port, 0, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST, "Cannot send burst");
+	n = rte_eth_rx_burst(port, 0, pkts, BURST);
+	free_burst(pkts, n);
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_get(port, 0, &stats),
+		"Cannot get stats");
+	TEST_ASSERT_EQUAL(stats.samples, BURST / SAMPLE_RATE,
+		"Wrong number of samples: %"PRIu64, stats.samples);
+	TEST_ASSERT(stats.min_ns >= DELAY_US * 1000 &&
+		stats.min_ns <= stats.avg_ns && stats.avg_ns <= stats.max_ns,
+		"Wrong latencies: min %"PRIu64" avg %"PRIu64" max %"PRIu64,
+		stats.min_ns, stats.avg_ns, stats.max_ns);
+	for (i = 0; i < RTE_LATENCYSTATS_HIST_BUCKETS; i++) {
+		/* 2^13 ns < 10 us */
+		TEST_ASSERT(i >= 13 || stats.hist[i] == 0,
+			"Latency in wrong histogram bucket %u", i);
+		hist_sum += stats.hist[i];
+	}
+	TEST_ASSERT_EQUAL(hist_sum, stats.samples, "Wrong histogram");
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_reset(), "Cannot reset stats");
+	rte_latencystats_get(port, 0, &stats);
+	TEST_ASSERT_EQUAL(stats.samples, 0, "Stats not reset");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_latency_uninit(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	unsigned i, n;
+
+	TEST_ASSERT_SUCCESS(rte_latencystats_uninit(),
+		"Cannot stop latency measures");
+	TEST_ASSERT_EQUAL(rte_latencystats_uninit(), -EINVAL,
+		"Latency measures stopped twice");
+
+	TEST_ASSERT_SUCCESS(fill_ring(pkts), "Cannot fill ring");
+	n = rte_eth_rx_burst(port, 0, pkts, BURST);
+	for (i = 0; i < n; i++)
+		TEST_ASSERT(!(pkts[i]->ol_flags & PKT_RX_TIMESTAMP),
+			"Packet timestamped after stop");
+	free_burst(pkts, n);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_setup(void)
+{
+	/* the port is kept for the following tests */
+	if (ring != NULL)
+		return 0;
+
+	ring = rte_ring_create(RING_NAME, RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (ring == NULL)
+		ring = rte_ring_lookup(RING_NAME);
+	pool = rte_pktmbuf_pool_create(POOL_NAME, NB_MBUFS, BURST, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (pool == NULL)
+		pool = rte_mempool_lookup(POOL_NAME);
+	if (ring == NULL || pool == NULL) {
+		printf("Cannot create ring or mempool\n");
+		return -1;
+	}
+
+	port = rte_eth_from_ring(ring);
+	return 0;
+}
+
+static struct unit_test_suite latencystats_test_suite  = {
+	.setup = test_setup,
+	.suite_name = "Latency Statistics Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_latency_init),
+		TEST_CASE(test_latency_measure),
+		TEST_CASE(test_latency_uninit),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_latencystats(void)
+{
+	return unit_test_suite_runner(&latencystats_test_suite);
+}
+
+/* cycles per packet of an Rx/Tx loop on the ring port */
+static double
+forward_cycles(void)
+{
+	const unsigned iterations = 1 << PERF_ITER_SHIFT;
+	struct rte_mbuf *pkts[BURST];
+	uint64_t start, end;
+	unsigned i, n;
+
+	if (fill_ring(pkts) < 0)
+		return 0;
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < iterations; i++) {
+		n = rte_eth_rx_burst(port, 0, pkts, BURST);
+		rte_eth_tx_burst(port, 0, pkts, n);
+	}
+	end = rte_rdtsc_precise();
+
+	n = rte_eth_rx_burst(port, 0, pkts, BURST);
+	free_burst(pkts, n);
+	return (double)(end - start) / (iterations * BURST);
+}
+
+static int
+test_latencystats_perf(void)
+{
+	double base, sampled;
+
+	if (test_setup() < 0)
+		return -1;
+
+	base = forward_cycles();
+	if (rte_latencystats_init(PERF_SAMPLE_RATE, SOCKET_ID_ANY) < 0)
+		return -1;
+	sampled = forward_cycles();
+	rte_latencystats_uninit();
+
+	printf("Rx/Tx cycles per packet without latency stats: %.2F\n", base);
+	printf("Rx/Tx cycles per packet with 1/%u packets sampled: %.2F\n",
+		PERF_SAMPLE_RATE, sampled);
+	printf("Overhead: %.2F cycles per packet, %.2F%% of a 10 Mpps budget\n",
+		sampled - base,
+		(sampled - base) * 100 * 10E6 / rte_get_tsc_hz());
+	return 0;
+}
+
+static struct test_command latencystats_cmd = {
+	.command = "latencystats_autotest",
+	.callback = test_latencystats,
+};
+REGISTER_TEST_COMMAND(latencystats_cmd);
+
+static struct test_command latencystats_perf_cmd = {
+	.command = "latencystats_perf_autotest",
+	.callback = test_latencystats_perf,
+};
+REGISTER_TEST_COMMAND(latencystats_perf_cmd);
@@ -0,0 +1,128 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_lcore_poll.h>
+
+#include "test.h"
+
+#define NB_ITERS 1000
+
+/* first call marks the start of the loop, the next ones alternate */
+static int
+poll_loop(void *arg)
+{
+	unsigned int i;
+
+	RTE_SET_USED(arg);
+	for (i = 0; i < NB_ITERS; i++)
+		rte_lcore_poll_update(i & 1);
+	return 0;
+}
+
+static int
+test_lcore_poll_params(void)
+{
+	struct rte_lcore_poll_stats stats;
+
+	TEST_ASSERT_EQUAL(rte_lcore_poll_stats_get(RTE_MAX_LCORE, &stats),
+		-EINVAL, "Invalid lcore accepted");
+	TEST_ASSERT_EQUAL(rte_lcore_poll_stats_get(rte_lcore_id(), NULL),
+		-EINVAL, "NULL stats accepted");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_lcore_poll_launch(void)
+{
+	static struct rte_lcore_poll_stats before[RTE_MAX_LCORE];
+	struct rte_lcore_poll_stats after;
+	unsigned int lcore_id;
+
+	RTE_LCORE_FOREACH(lcore_id)
+		TEST_ASSERT_SUCCESS(rte_lcore_poll_stats_get(lcore_id,
+				&before[lcore_id]),
+			"Cannot get statistics of lcore %u", lcore_id);
+
+	rte_eal_mp_remote_launch(poll_loop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		rte_lcore_poll_stats_get(lcore_id, &after);
+		TEST_ASSERT_EQUAL(after.busy_iters - before[lcore_id].busy_iters,
+			NB_ITERS / 2, "Wrong busy iterations on lcore %u",
+			lcore_id);
+		TEST_ASSERT_EQUAL(after.idle_iters - before[lcore_id].idle_iters,
+			NB_ITERS / 2 - 1, "Wrong idle iterations on lcore %u",
+			lcore_id);
+		TEST_ASSERT(after.busy_cycles > before[lcore_id].busy_cycles &&
+			after.idle_cycles > before[lcore_id].idle_cycles,
+			"No cycles accounted on lcore %u", lcore_id);
+		TEST_ASSERT_EQUAL(after.last_tsc, 0,
+			"Loop of lcore %u still running", lcore_id);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite lcore_poll_test_suite  = {
+	.suite_name = "Lcore Poll Statistics Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_lcore_poll_params),
+		TEST_CASE(test_lcore_poll_launch),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_lcore_poll(void)
+{
+#ifndef RTE_LCORE_POLL_STATS
+	printf("Lcore poll statistics not compiled in, skipping\n");
+	return 0;
+#endif
+	return unit_test_suite_runner(&lcore_poll_test_suite);
+}
+
+static struct test_command lcore_poll_cmd = {
+	.command = "lcore_poll_autotest",
+	.callback = test_lcore_poll,
+};
+REGISTER_TEST_COMMAND(lcore_poll_cmd);
@@ -0,0 +1,183 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_per_lcore.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_ticketlock.h>
+#include <rte_mcslock.h>
+
+#include "test.h"
+
+/*
+ * Lock performance test
+ * =====================
+ *
+ * Compare the spinlock, the ticket lock and the MCS lock when 1, 2, 4...
+ * and all lcores take the same lock in a loop for a fixed time. The
+ * critical section updates a few cache lines of shared data.
+ *
+ * For each lock and number of lcores, the test displays the total number
+ * of critical sections per second (throughput) and the ratio between the
+ * most and the least served lcores (fairness, 1.0 being perfectly fair).
+ */
+
+#define TIME_MS 500
+#define SHARED_LINES 4
+
+static rte_spinlock_t sl = RTE_SPINLOCK_INITIALIZER;
+static rte_ticketlock_t tl = RTE_TICKETLOCK_INITIALIZER;
+static rte_mcslock_t *ml = RTE_MCSLOCK_INITIALIZER;
+static RTE_DEFINE_PER_LCORE(rte_mcslock_t, ml_me);
+
+static struct {
+	uint64_t data[RTE_CACHE_LINE_SIZE / sizeof(uint64_t)];
+} __rte_cache_aligned shared[SHARED_LINES];
+
+static uint64_t lock_count[RTE_MAX_LCORE] __rte_cache_aligned;
+static rte_atomic32_t synchro;
+static uint64_t time_end;
+
+static inline void
+critical_section(void)
+{
+	unsigned i;
+
+	for (i = 0; i < SHARED_LINES; i++)
+		shared[i].data[0]++;
+}
+
+#define LOCK_LOOP(name, lock, unlock)					\
+static int								\
+name(__attribute__((unused)) void *arg)					\
+{									\
+	uint64_t lcount = 0;						\
+									\
+	while (rte_atomic32_read(&synchro) == 0)			\
+		;							\
+	while (rte_get_timer_cycles() < time_end) {			\
+		lock;							\
+		critical_section();					\
+		unlock;							\
+		lcount++;						\
+	}								\
+	lock_count[rte_lcore_id()] = lcount;				\
+	return 0;							\
+}
+
+LOCK_LOOP(spinlock_loop, rte_spinlock_lock(&sl), rte_spinlock_unlock(&sl))
+LOCK_LOOP(ticketlock_loop, rte_ticketlock_lock(&tl),
+	rte_ticketlock_unlock(&tl))
+LOCK_LOOP(mcslock_loop, rte_mcslock_lock(&ml, &RTE_PER_LCORE(ml_me)),
+	rte_mcslock_unlock(&ml, &RTE_PER_LCORE(ml_me)))
+
+static const struct {
+	const char *name;
+	lcore_function_t *loop;
+} locks[] = {
+	{ "spinlock", spinlock_loop },
+	{ "ticketlock", ticketlock_loop },
+	{ "mcslock", mcslock_loop },
+};
+
+/* run a lock loop on the master lcore and the first nb_lcores - 1 slaves */
+static void
+run_loop(lcore_function_t *loop, unsigned nb_lcores)
+{
+	uint64_t total = 0, min = UINT64_MAX, max = 0;
+	unsigned lcore, n = 1;
+
+	memset(lock_count, 0, sizeof(lock_count));
+	rte_atomic32_set(&synchro, 0);
+	time_end = UINT64_MAX;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore) {
+		if (n++ == nb_lcores)
+			break;
+		rte_eal_remote_launch(loop, NULL, lcore);
+	}
+
+	time_end = rte_get_timer_cycles() + rte_get_timer_hz() * TIME_MS / 1000;
+	rte_atomic32_set(&synchro, 1);
+	loop(NULL);
+	rte_eal_mp_wait_lcore();
+
+	n = 0;
+	RTE_LCORE_FOREACH(lcore) {
+		if (n++ == nb_lcores)
+			break;
+		total += lock_count[lcore];
+		if (lock_count[lcore] < min)
+			min = lock_count[lcore];
+		if (lock_count[lcore] > max)
+			max = lock_count[lcore];
+	}
+
+	printf("%-10s %7u %14"PRIu64" %10.2f\n", "", nb_lcores,
+	       total * 1000 / TIME_MS,
+	       min != 0 ? (double)max / min : 0.0);
+}
+
+static int
+test_lock_perf(void)
+{
+	unsigned i, n, nb_lcores = rte_lcore_count();
+
+	printf("%-10s %7s %14s %10s\n", "lock", "lcores", "locks/s",
+	       "max/min");
+	for (i = 0; i < RTE_DIM(locks); i++) {
+		printf("%s\n", locks[i].name);
+		for (n = 1; n < nb_lcores; n *= 2)
+			run_loop(locks[i].loop, n);
+		run_loop(locks[i].loop, nb_lcores);
+	}
+
+	return 0;
+}
+
+static struct test_command lock_perf_cmd = {
+	.command = "lock_perf_autotest",
+	.callback = test_lock_perf,
+};
+REGISTER_TEST_COMMAND(lock_perf_cmd);
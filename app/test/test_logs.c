@@ -33,7 +33,10 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include <stdarg.h>
+#include <string.h>
 #include <sys/queue.h>
 
 #include <rte_log.h>
@@ -58,6 +61,90 @@
  * - Send logs with different types and levels, some should not be displayed.
  */
 
+#define ASYNC_NB_MSGS 64
+#define ASYNC_NB_FLOOD (RTE_LOG_ASYNC_RING_SIZE * 4)
+
+/*
+ * Asynchronous logs
+ * =================
+ *
+ * - Send less logs than a ring can hold, all of them should be written
+ *   by the writer thread once asynchronous logs are disabled.
+ * - Send more logs than a ring can hold, each of them is either written
+ *   or counted as dropped.
+ */
+static int
+test_logs_async(void)
+{
+	struct rte_log_async_stats pre, post;
+	FILE *f, *prev = rte_logs.file;
+	char line[128];
+	unsigned i, n = 0;
+	int ret = -1;
+
+	f = tmpfile();
+	if (f == NULL) {
+		printf("Cannot create temporary file\n");
+		return -1;
+	}
+	rte_openlog_stream(f);
+
+	if (rte_log_async_enable() < 0) {
+		printf("Cannot enable asynchronous logs\n");
+		goto end;
+	}
+	rte_log_async_get_stats(rte_lcore_id(), &pre);
+	for (i = 0; i < ASYNC_NB_MSGS; i++)
+		RTE_LOG(INFO, TESTAPP1, "async message %u\n", i);
+	rte_log_async_disable();
+
+	rte_log_async_get_stats(rte_lcore_id(), &post);
+	if (post.written - pre.written != ASYNC_NB_MSGS ||
+			post.dropped != pre.dropped) {
+		printf("Wrong asynchronous log statistics\n");
+		goto end;
+	}
+	rewind(f);
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (strstr(line, "async message") == NULL)
+			continue;
+		if (strtoul(strrchr(line, ' ') + 1, NULL, 10) != n) {
+			printf("Asynchronous log out of order\n");
+			goto end;
+		}
+		n++;
+	}
+	if (n != ASYNC_NB_MSGS) {
+		printf("Only %u asynchronous logs written\n", n);
+		goto end;
+	}
+
+	if (rte_log_async_enable() < 0) {
+		printf("Cannot enable asynchronous logs\n");
+		goto end;
+	}
+	pre = post;
+	for (i = 0; i < ASYNC_NB_FLOOD; i++)
+		RTE_LOG(INFO, TESTAPP1, "async flood message %u\n", i);
+	rte_log_async_disable();
+
+	rte_log_async_get_stats(rte_lcore_id(), &post);
+	if (post.written - pre.written + post.dropped - pre.dropped !=
+			ASYNC_NB_FLOOD) {
+		printf("Asynchronous logs lost\n");
+		goto end;
+	}
+	printf("Flood: %"PRIu64" written, %"PRIu64" dropped\n",
+		post.written - pre.written, post.dropped - pre.dropped);
+	ret = 0;
+
+end:
+	rte_log_async_disable();
+	rte_openlog_stream(prev);
+	fclose(f);
+	return ret;
+}
+
 static int
 test_logs(void)
 {
@@ -87,7 +174,7 @@ test_logs(void)
 
 	rte_log_dump_history(stdout);
 
-	return 0;
+	return test_logs_async();
 }
 
 static struct test_command logs_cmd = {
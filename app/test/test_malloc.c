@@ -33,11 +33,14 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdarg.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <sys/queue.h>
+#include <sys/wait.h>
 
 #include <rte_common.h>
 #include <rte_memory.h>
@@ -53,6 +56,10 @@
 #include <rte_string_fns.h>
 
 #include "test.h"
+#include "process.h"
+
+#define launch_proc(ARGV) process_dup(ARGV, \
+		sizeof(ARGV)/(sizeof(ARGV[0])), __func__)
 
 #define N 10000
 
@@ -618,6 +625,97 @@ test_random_alloc_free(void *_ __attribute__((unused)))
 	goto err_return; \
 } while (0)
 
+#define CACHE_TEST_NB_OBJS 100
+#define CACHE_TEST_SIZE 200
+
+/*
+ * Check the cache of small allocations of the calling lcore serves
+ * allocations, and that its elements are accounted as free in the heap.
+ */
+static int
+test_lcore_cache(void)
+{
+	struct rte_malloc_lcore_cache_stats pre_cache, post_cache;
+	struct rte_malloc_socket_stats pre_stats, post_stats;
+	void *objs[CACHE_TEST_NB_OBJS];
+	int socket = rte_socket_id();
+	unsigned i;
+
+	if (rte_malloc_cache_enable() < 0) {
+		printf("lcore cache not available, skipping\n");
+		return 0;
+	}
+
+	rte_malloc_get_socket_stats(socket, &pre_stats);
+	rte_malloc_get_lcore_cache_stats(rte_lcore_id(), &pre_cache);
+
+	for (i = 0; i < CACHE_TEST_NB_OBJS; i++) {
+		objs[i] = rte_malloc_socket("cache", CACHE_TEST_SIZE, 0,
+				socket);
+		if (objs[i] == NULL) {
+			printf("NULL pointer returned from rte_malloc\n");
+			goto err;
+		}
+		memset(objs[i], i, CACHE_TEST_SIZE);
+	}
+	for (i = 0; i < CACHE_TEST_NB_OBJS; i++) {
+		if (*(uint8_t *)objs[i] != (uint8_t)i ||
+				rte_malloc_validate(objs[i], NULL) < 0) {
+			printf("Cached object %u is corrupted\n", i);
+			goto err;
+		}
+	}
+	for (i = 0; i < CACHE_TEST_NB_OBJS; i++)
+		rte_free(objs[i]);
+
+	rte_malloc_get_lcore_cache_stats(rte_lcore_id(), &post_cache);
+	if (post_cache.alloc_hits + post_cache.alloc_misses !=
+			pre_cache.alloc_hits + pre_cache.alloc_misses +
+			CACHE_TEST_NB_OBJS ||
+			post_cache.alloc_hits == pre_cache.alloc_hits ||
+			post_cache.free_hits != pre_cache.free_hits +
+			CACHE_TEST_NB_OBJS) {
+		printf("Incorrect lcore cache statistics\n");
+		goto err;
+	}
+
+	/* cached elements are free from the user point of view */
+	rte_malloc_get_socket_stats(socket, &post_stats);
+	if (post_stats.alloc_count != pre_stats.alloc_count ||
+			post_stats.heap_allocsz_bytes !=
+			pre_stats.heap_allocsz_bytes) {
+		printf("Incorrect heap statistics with lcore cache\n");
+		goto err;
+	}
+
+	rte_malloc_cache_disable();
+	rte_malloc_get_lcore_cache_stats(rte_lcore_id(), &post_cache);
+	rte_malloc_get_socket_stats(socket, &post_stats);
+	if (post_cache.cached_count != 0 ||
+			post_stats.heap_freesz_bytes !=
+			pre_stats.heap_freesz_bytes) {
+		printf("Lcore cache not flushed\n");
+		return -1;
+	}
+	return 0;
+
+err:
+	rte_malloc_cache_disable();
+	return -1;
+}
+
+static int
+test_lcore_cache_per_lcore(void *arg)
+{
+	int ret;
+
+	if (rte_malloc_cache_enable() < 0)
+		return 0;
+	ret = test_random_alloc_free(arg);
+	rte_malloc_cache_disable();
+	return ret;
+}
+
 static int
 test_rte_malloc_validate(void)
 {
@@ -849,6 +947,75 @@ test_alloc_socket(void)
 	return 0;
 }
 
+/*
+ * Check that a heap allowed to grow with --socket-limit takes hugepages
+ * from the system when it runs out of memory, and gives them back once
+ * they are free, except for one segment kept as a spare. Run in a child
+ * process, as the heaps of the test application can't grow.
+ */
+#define GROW_SEGS 3
+#define GROW_MAX_OBJS 64
+
+int
+test_malloc_heap_grow(void)
+{
+	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	void *objs[GROW_MAX_OBJS];
+	uint64_t init_size, size;
+	size_t pg_sz;
+	unsigned i, n;
+
+	if (getenv(RECURSIVE_ENV_VAR) == NULL) {
+#ifdef RTE_EXEC_ENV_LINUXAPP
+		const char *argv[] = {prgname, "-c", "1", "-n", "1",
+				"--no-pci", "--file-prefix=malloc_grow",
+				"--socket-mem=16", "--socket-limit=64"};
+
+		return launch_proc(argv) == 0 ? 0 : -1;
+#else
+		printf("Heaps cannot grow on this platform, skipping\n");
+		return 0;
+#endif
+	}
+
+	init_size = rte_eal_get_physmem_size();
+	pg_sz = ms[0].hugepage_sz;
+
+	/* half a page per object, each growth adds one page at least */
+	for (n = 0; n < GROW_MAX_OBJS; n++) {
+		if (rte_eal_get_physmem_size() >= init_size + GROW_SEGS * pg_sz)
+			break;
+		objs[n] = rte_malloc_socket(NULL, pg_sz / 2, 0,
+				rte_socket_id());
+		if (objs[n] == NULL) {
+			printf("Cannot allocate from a growing heap\n");
+			goto fail;
+		}
+	}
+	if (rte_eal_get_physmem_size() < init_size + GROW_SEGS * pg_sz) {
+		printf("Heap did not grow by %u segments\n", GROW_SEGS);
+		goto fail;
+	}
+
+	for (i = 0; i < n; i++)
+		rte_free(objs[i]);
+	n = 0;
+
+	size = rte_eal_get_physmem_size();
+	if (size != init_size + pg_sz) {
+		printf("Heap holds %"PRIu64" MB once free, expected %"PRIu64
+			" MB\n", size >> 20, (init_size + pg_sz) >> 20);
+		return -1;
+	}
+
+	return 0;
+
+fail:
+	for (i = 0; i < n; i++)
+		rte_free(objs[i]);
+	return -1;
+}
+
 static int
 test_malloc(void)
 {
@@ -956,6 +1123,39 @@ test_malloc(void)
 	else
 		printf("test_multi_alloc_statistics() passed\n");
 
+	ret = test_lcore_cache();
+	if (ret < 0) {
+		printf("test_lcore_cache() failed\n");
+		return ret;
+	}
+	else
+		printf("test_lcore_cache() passed\n");
+
+	/*----------------------------*/
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		rte_eal_remote_launch(test_lcore_cache_per_lcore, NULL,
+				lcore_id);
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	}
+	if (ret < 0) {
+		printf("test_lcore_cache_per_lcore() failed\n");
+		return ret;
+	}
+	else
+		printf("test_lcore_cache_per_lcore() passed\n");
+
+	ret = test_malloc_heap_grow();
+	if (ret < 0) {
+		printf("test_malloc_heap_grow() failed\n");
+		return ret;
+	}
+	else
+		printf("test_malloc_heap_grow() passed\n");
+
 	return 0;
 }
 
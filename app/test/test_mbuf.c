@@ -56,8 +56,15 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
+#include <rte_errno.h>
+#ifdef RTE_LIBRTE_IP_FRAG
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+#endif
 
 #include "test.h"
 
@@ -80,6 +87,10 @@
 
 #define MAGIC_DATA              0x42424242
 
+#define EXT_BUF_LEN             4096
+#define EXT_BUF_FRAG_PAYLOAD    3000
+#define EXT_BUF_FRAG_MTU        1500
+
 #define MAKE_STRING(x)          # x
 
 static struct rte_mempool *pktmbuf_pool = NULL;
@@ -128,6 +139,38 @@ static unsigned refcnt_lcore[RTE_MAX_LCORE];
  *    - Repeat the test to check that allocation operations
  *      reinitialize the mbuf correctly.
  *
+ * #. Test bulk allocation and free of pktmbufs.
+ *
+ *    - Allocate NB_MBUF mbufs in one call, dirty and free them.
+ *    - Allocate them again and check that they are all reset.
+ *    - Check that the allocation fails when the pool is empty.
+ *    - Free an array containing NULL entries, chained segments from
+ *      two pools and an indirect mbuf, and check that all the mbufs
+ *      are back in their pools.
+ *
+ * #. Test external buffers.
+ *
+ *    - Attach an external buffer to a mbuf, clone it and check that the
+ *      buffer is freed with the last mbuf referencing it.
+ *    - Check that detaching the buffer restores the embedded one.
+ *    - Fragment an IPv4 packet stored in an external buffer and check
+ *      that the buffer is freed with the last fragment.
+ *
+ * #. Test dynamic fields and flags.
+ *
+ *    - Register fields and flags, check that they are placed in the
+ *      reserved space and that registering them again is idempotent.
+ *    - Check that conflicting or too large registrations fail.
+ *    - Write the fields of a mbuf and check the static fields around.
+ *
+ * #. Test linearization and coalescing of multi-segment packets.
+ *
+ *    - Linearize a packet in the tailroom of its first segment.
+ *    - Linearize a clone, which is copied in a new mbuf, and check that
+ *      a packet too large for a mbuf is left unchanged.
+ *    - Coalesce the small segments of a packet in the previous ones.
+ *    - Check the data and that no mbuf is leaked.
+ *
  * #. Test packet cloning
  *    - Clone a mbuf and verify the data
  *    - Clone the cloned mbuf and verify the data
@@ -346,6 +389,8 @@ testclone_testupdate_testdetach(void)
 	rte_pktmbuf_append(m, sizeof(uint32_t));
 	data = rte_pktmbuf_mtod(m, unaligned_uint32_t *);
 	*data = MAGIC_DATA;
+	m->timestamp = MAGIC_DATA;
+	m->ol_flags |= PKT_RX_TIMESTAMP;
 
 	/* clone the allocated mbuf */
 	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
@@ -356,6 +401,10 @@ testclone_testupdate_testdetach(void)
 	if (*data != MAGIC_DATA)
 		GOTO_FAIL("invalid data in clone\n");
 
+	if (!(clone->ol_flags & PKT_RX_TIMESTAMP) ||
+			clone->timestamp != MAGIC_DATA)
+		GOTO_FAIL("invalid timestamp in clone\n");
+
 	if (rte_mbuf_refcnt_read(m) != 2)
 		GOTO_FAIL("invalid refcnt in m\n");
 
@@ -532,6 +581,528 @@ fail:
 		rte_pktmbuf_free(clone2);
 	return -1;
 }
+
+/*
+ * test bulk allocation and free of packet mbufs
+ */
+static int
+test_pktmbuf_alloc_free_bulk(void)
+{
+	struct rte_mbuf *m[NB_MBUF];
+	struct rte_mbuf *clone = NULL;
+	struct rte_mempool_cache *cache;
+	unsigned i;
+
+	memset(m, 0, sizeof(m));
+
+	/*
+	 * Bulks larger than the cache are taken from the common pool, so
+	 * make sure the mbufs left in the cache by the previous tests are
+	 * back there.
+	 */
+	cache = rte_mempool_default_cache(pktmbuf_pool, rte_lcore_id());
+	rte_mempool_cache_flush(cache, pktmbuf_pool);
+
+	/* dirty some mbufs, so the bulk allocation has to reset them */
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, m, NB_MBUF) != 0)
+		GOTO_FAIL("cannot allocate %u mbufs", NB_MBUF);
+	for (i = 0; i < NB_MBUF; i++) {
+		m[i]->data_off = 0;
+		m[i]->port = 1;
+		m[i]->ol_flags = PKT_RX_VLAN_PKT;
+		m[i]->packet_type = RTE_PTYPE_L2_ETHER;
+		m[i]->pkt_len = MBUF_TEST_DATA_LEN;
+		m[i]->data_len = MBUF_TEST_DATA_LEN;
+		m[i]->vlan_tci = 1;
+		m[i]->vlan_tci_outer = 1;
+		m[i]->tx_offload = 1;
+	}
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+	if (rte_mempool_count(pktmbuf_pool) != NB_MBUF)
+		GOTO_FAIL("all mbufs were not freed");
+	memset(m, 0, sizeof(m));
+	rte_mempool_cache_flush(cache, pktmbuf_pool);
+
+	/* allocate the whole pool in one call, then check it is empty */
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, m, NB_MBUF) != 0)
+		GOTO_FAIL("cannot allocate %u mbufs", NB_MBUF);
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, &clone, 1) != -ENOENT)
+		GOTO_FAIL("allocation should fail on empty pool");
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, &clone, 0) != 0)
+		GOTO_FAIL("allocation of 0 mbuf should succeed");
+
+	for (i = 0; i < NB_MBUF; i++) {
+		if (m[i]->data_off != RTE_PKTMBUF_HEADROOM ||
+				rte_mbuf_refcnt_read(m[i]) != 1 ||
+				m[i]->nb_segs != 1 || m[i]->port != 0xff ||
+				m[i]->ol_flags != 0 || m[i]->packet_type != 0 ||
+				m[i]->pkt_len != 0 || m[i]->data_len != 0 ||
+				m[i]->vlan_tci != 0 || m[i]->vlan_tci_outer != 0 ||
+				m[i]->tx_offload != 0 || m[i]->next != NULL)
+			GOTO_FAIL("mbuf %u is not reset", i);
+	}
+
+	/* mbufs from a pool without data room have no headroom */
+	if (rte_pktmbuf_alloc_bulk(pktmbuf_pool2, &clone, 1) != 0)
+		GOTO_FAIL("cannot allocate mbuf from pool2");
+	if (clone->data_off != 0)
+		GOTO_FAIL("invalid data_off in mbuf from pool2");
+
+	/*
+	 * Free an array mixing chained segments from both pools, NULL
+	 * entries and an indirect mbuf.
+	 */
+	m[0]->next = clone;
+	m[0]->nb_segs = 2;
+	rte_pktmbuf_free_bulk(&m[1], 2);
+	m[1] = NULL;
+	m[2] = NULL;
+	clone = rte_pktmbuf_clone(m[3], pktmbuf_pool2);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf");
+	rte_pktmbuf_free_bulk(&clone, 1);
+	if (rte_mbuf_refcnt_read(m[3]) != 1)
+		GOTO_FAIL("invalid refcnt after freeing the clone");
+	clone = rte_pktmbuf_clone(m[4], pktmbuf_pool2);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf");
+	m[1] = clone;
+
+	rte_pktmbuf_free_bulk(m, NB_MBUF);
+	if (rte_mempool_count(pktmbuf_pool) != NB_MBUF)
+		GOTO_FAIL("all mbufs were not freed in pool");
+	if (rte_mempool_count(pktmbuf_pool2) != NB_MBUF)
+		GOTO_FAIL("all mbufs were not freed in pool2");
+
+	return 0;
+
+fail:
+	return -1;
+}
+
+/* free callback of the external buffers, counting its invocations */
+static void
+ext_buf_free_cb(__rte_unused void *addr, void *opaque)
+{
+	unsigned *freed = opaque;
+
+	(*freed)++;
+}
+
+/*
+ * test attachment of external buffers to mbufs
+ */
+static int
+test_pktmbuf_ext_buf(void)
+{
+	struct rte_mbuf *m = NULL, *clone = NULL;
+	struct rte_mbuf_ext_shared_info *shinfo;
+	phys_addr_t buf_physaddr;
+	uint16_t buf_len;
+	unsigned freed = 0;
+	char *buf, *data;
+#ifdef RTE_LIBRTE_IP_FRAG
+	struct rte_mbuf *frags[4];
+	struct ipv4_hdr *hdr;
+	int32_t nb_frags = 0;
+#endif
+
+	buf = rte_malloc("test_ext_buf", EXT_BUF_LEN, 0);
+	if (buf == NULL)
+		GOTO_FAIL("cannot allocate external buffer");
+	buf_physaddr = rte_malloc_virt2phy(buf);
+
+	/* the shared data is stored at the end of the buffer */
+	buf_len = EXT_BUF_LEN;
+	shinfo = rte_pktmbuf_ext_shinfo_init_helper(buf, &buf_len,
+		ext_buf_free_cb, &freed);
+	if (shinfo == NULL)
+		GOTO_FAIL("cannot initialize shared data");
+	if ((char *)shinfo != buf + buf_len ||
+			(char *)(shinfo + 1) > buf + EXT_BUF_LEN)
+		GOTO_FAIL("bad shared data location");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("invalid refcnt in shared data");
+
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	rte_pktmbuf_attach_extbuf(m, buf, buf_physaddr, buf_len, shinfo);
+	if (!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_DIRECT(m) ||
+			RTE_MBUF_INDIRECT(m))
+		GOTO_FAIL("mbuf has no external buffer");
+	if (rte_pktmbuf_mtod(m, char *) != buf + RTE_PKTMBUF_HEADROOM)
+		GOTO_FAIL("bad data pointer in mbuf");
+	data = rte_pktmbuf_append(m, MBUF_TEST_DATA_LEN);
+	if (data == NULL)
+		GOTO_FAIL("cannot append data");
+	memset(data, 0xcc, MBUF_TEST_DATA_LEN);
+
+	/* a clone references the external buffer, not the mbuf */
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool2);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf");
+	if (!RTE_MBUF_HAS_EXTBUF(clone) || RTE_MBUF_INDIRECT(clone))
+		GOTO_FAIL("clone has no external buffer");
+	if (rte_pktmbuf_mtod(clone, char *) != data)
+		GOTO_FAIL("clone was not attached properly");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 2 ||
+			rte_mbuf_refcnt_read(m) != 1)
+		GOTO_FAIL("invalid refcnt after clone");
+
+	/* the buffer is freed with the last mbuf referencing it */
+	rte_pktmbuf_free(m);
+	m = NULL;
+	if (freed != 0 || rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("external buffer freed too early");
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	if (freed != 1)
+		GOTO_FAIL("external buffer not freed");
+
+	/* detaching restores the buffer embedded in the mbuf */
+	buf_len = EXT_BUF_LEN;
+	shinfo = rte_pktmbuf_ext_shinfo_init_helper(buf, &buf_len,
+		ext_buf_free_cb, &freed);
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	data = rte_pktmbuf_mtod(m, char *);
+	rte_pktmbuf_attach_extbuf(m, buf, buf_physaddr, buf_len, shinfo);
+	rte_pktmbuf_detach_extbuf(m);
+	if (freed != 2)
+		GOTO_FAIL("external buffer not freed on detach");
+	if (RTE_MBUF_HAS_EXTBUF(m) || rte_pktmbuf_mtod(m, char *) != data)
+		GOTO_FAIL("mbuf was not detached properly");
+	rte_pktmbuf_free(m);
+	m = NULL;
+
+#ifdef RTE_LIBRTE_IP_FRAG
+	/* the fragments of a packet reference its external buffer */
+	buf_len = EXT_BUF_LEN;
+	shinfo = rte_pktmbuf_ext_shinfo_init_helper(buf, &buf_len,
+		ext_buf_free_cb, &freed);
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	rte_pktmbuf_attach_extbuf(m, buf, buf_physaddr, buf_len, shinfo);
+	hdr = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+		sizeof(struct ipv4_hdr) + EXT_BUF_FRAG_PAYLOAD);
+	if (hdr == NULL)
+		GOTO_FAIL("cannot append packet");
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->version_ihl = 0x45;
+	hdr->total_length = rte_cpu_to_be_16(rte_pktmbuf_pkt_len(m));
+	hdr->time_to_live = 64;
+	hdr->next_proto_id = IPPROTO_UDP;
+
+	nb_frags = rte_ipv4_fragment_packet(m, frags, RTE_DIM(frags),
+		EXT_BUF_FRAG_MTU, pktmbuf_pool, pktmbuf_pool2);
+	if (nb_frags != 3) {
+		nb_frags = 0;
+		GOTO_FAIL("bad number of fragments");
+	}
+	if (frags[0]->next == NULL || !RTE_MBUF_HAS_EXTBUF(frags[0]->next))
+		GOTO_FAIL("fragment does not reference the external buffer");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 1 + nb_frags)
+		GOTO_FAIL("invalid refcnt after fragmentation");
+
+	rte_pktmbuf_free(m);
+	m = NULL;
+	if (freed != 2)
+		GOTO_FAIL("external buffer freed too early");
+	rte_pktmbuf_free_bulk(frags, nb_frags);
+	nb_frags = 0;
+	if (freed != 3)
+		GOTO_FAIL("external buffer not freed with the fragments");
+#endif
+
+	rte_free(buf);
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (m)
+		rte_pktmbuf_free(m);
+	if (clone)
+		rte_pktmbuf_free(clone);
+#ifdef RTE_LIBRTE_IP_FRAG
+	rte_pktmbuf_free_bulk(frags, nb_frags);
+#endif
+	rte_free(buf);
+	return -1;
+}
+
+/*
+ * test registration and use of dynamic fields and flags
+ */
+static int
+test_mbuf_dyn(void)
+{
+	const struct rte_mbuf_dynfield field32 = {
+		.name = "test_dynfield32",
+		.size = sizeof(uint32_t),
+		.align = __alignof__(uint32_t),
+	};
+	const struct rte_mbuf_dynfield field16 = {
+		.name = "test_dynfield16",
+		.size = sizeof(uint16_t),
+		.align = __alignof__(uint16_t),
+	};
+	const struct rte_mbuf_dynflag flag1 = { .name = "test_dynflag1" };
+	const struct rte_mbuf_dynflag flag2 = { .name = "test_dynflag2" };
+	struct rte_mbuf_dynfield params;
+	struct rte_mbuf *m = NULL, *clone = NULL;
+	int off32, off16, bit1, bit2;
+
+	off32 = rte_mbuf_dynfield_register(&field32);
+	if (off32 < 0)
+		GOTO_FAIL("cannot register dynamic field: %d", off32);
+	off16 = rte_mbuf_dynfield_register(&field16);
+	if (off16 < 0)
+		GOTO_FAIL("cannot register dynamic field: %d", off16);
+	rte_mbuf_dyn_dump(stdout);
+
+	/* the fields are in the reserved space, without overlap */
+	if ((off32 % field32.align) != 0 || (off16 % field16.align) != 0)
+		GOTO_FAIL("dynamic fields are not aligned");
+	if (!((off32 >= (int)offsetof(struct rte_mbuf, dynfield0) &&
+			off32 + sizeof(uint32_t) <=
+			offsetof(struct rte_mbuf, dynfield0[3])) ||
+			off32 == (int)offsetof(struct rte_mbuf, dynfield1)))
+		GOTO_FAIL("dynamic field outside the reserved space");
+	if (off16 + sizeof(uint16_t) > (unsigned)off32 &&
+			off32 + sizeof(uint32_t) > (unsigned)off16)
+		GOTO_FAIL("dynamic fields overlap");
+
+	/* registering again is idempotent, conflicts are reported */
+	if (rte_mbuf_dynfield_register(&field32) != off32)
+		GOTO_FAIL("dynamic field registered twice");
+	params = field16;
+	params.size = sizeof(uint64_t);
+	if (rte_mbuf_dynfield_register(&params) != -EEXIST)
+		GOTO_FAIL("conflicting dynamic field registered");
+	snprintf(params.name, sizeof(params.name), "test_dynfield_large");
+	params.size = 2 * RTE_CACHE_LINE_MIN_SIZE;
+	params.align = 1;
+	if (rte_mbuf_dynfield_register(&params) != -ENOSPC)
+		GOTO_FAIL("too large dynamic field registered");
+	params.size = sizeof(uint32_t);
+	params.align = 3;
+	if (rte_mbuf_dynfield_register(&params) != -EINVAL)
+		GOTO_FAIL("misaligned dynamic field registered");
+	if (rte_mbuf_dynfield_lookup(field16.name, &params) != off16 ||
+			params.size != field16.size ||
+			params.align != field16.align)
+		GOTO_FAIL("cannot look up dynamic field");
+	if (rte_mbuf_dynfield_lookup("test_dynfield_none", NULL) != -ENOENT)
+		GOTO_FAIL("unknown dynamic field found");
+
+	/* flags use bits free in ol_flags */
+	bit1 = rte_mbuf_dynflag_register(&flag1);
+	bit2 = rte_mbuf_dynflag_register(&flag2);
+	if (bit1 < 0 || bit2 < 0 || bit1 == bit2 || bit1 > 63 || bit2 > 63)
+		GOTO_FAIL("cannot register dynamic flags");
+	if (((1ULL << bit1) | (1ULL << bit2)) & (PKT_RX_TIMESTAMP |
+			PKT_TX_QINQ_PKT | EXT_ATTACHED_MBUF |
+			IND_ATTACHED_MBUF | CTRL_MBUF_FLAG))
+		GOTO_FAIL("dynamic flag overlaps a static flag");
+	if (rte_mbuf_dynflag_register(&flag1) != bit1 ||
+			rte_mbuf_dynflag_lookup(flag2.name, NULL) != bit2)
+		GOTO_FAIL("cannot look up dynamic flag");
+
+	/* the static fields around the dynamic ones are preserved */
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	m->vlan_tci_outer = 0x1234;
+	m->timesync = 0x5678;
+	*RTE_MBUF_DYNFIELD(m, off32, uint32_t *) = 0xffffffff;
+	*RTE_MBUF_DYNFIELD(m, off16, uint16_t *) = 0xffff;
+	m->ol_flags |= 1ULL << bit1;
+	if (m->vlan_tci_outer != 0x1234 || m->timesync != 0x5678 ||
+			m->pool != pktmbuf_pool)
+		GOTO_FAIL("dynamic field overwrote a static field");
+	if (*RTE_MBUF_DYNFIELD(m, off32, uint32_t *) != 0xffffffff ||
+			*RTE_MBUF_DYNFIELD(m, off16, uint16_t *) != 0xffff)
+		GOTO_FAIL("bad dynamic field value");
+
+	/* a clone carries the dynamic fields along with the flags */
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf");
+	if (!(clone->ol_flags & (1ULL << bit1)) ||
+			*RTE_MBUF_DYNFIELD(clone, off32, uint32_t *) !=
+			0xffffffff ||
+			*RTE_MBUF_DYNFIELD(clone, off16, uint16_t *) != 0xffff)
+		GOTO_FAIL("dynamic field not copied to the clone");
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	rte_pktmbuf_free(m);
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (clone)
+		rte_pktmbuf_free(clone);
+	if (m)
+		rte_pktmbuf_free(m);
+	return -1;
+}
+
+/*
+ * append a segment of len bytes to a packet (or allocate the first one),
+ * filled with the offset of each byte in the packet
+ */
+static struct rte_mbuf *
+linearize_append_seg(struct rte_mbuf *m, uint16_t len)
+{
+	struct rte_mbuf *seg;
+	uint32_t off;
+	uint8_t *data;
+	uint16_t i;
+
+	seg = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (seg == NULL)
+		return NULL;
+	data = (uint8_t *)rte_pktmbuf_append(seg, len);
+	if (data == NULL && len != 0) {
+		rte_pktmbuf_free(seg);
+		return NULL;
+	}
+	off = m == NULL ? 0 : m->pkt_len;
+	for (i = 0; i < len; i++)
+		data[i] = (uint8_t)(off + i);
+	if (m == NULL)
+		return seg;
+	if (rte_pktmbuf_chain(m, seg) < 0) {
+		rte_pktmbuf_free(seg);
+		return NULL;
+	}
+	return m;
+}
+
+/* check the data of a packet filled by linearize_append_seg() */
+static int
+linearize_check_data(const struct rte_mbuf *m, uint32_t pkt_len)
+{
+	const struct rte_mbuf *seg;
+	const uint8_t *data;
+	uint32_t off = 0;
+	uint16_t i;
+
+	if (m->pkt_len != pkt_len)
+		return -1;
+	for (seg = m; seg != NULL; seg = seg->next) {
+		data = rte_pktmbuf_mtod(seg, const uint8_t *);
+		for (i = 0; i < seg->data_len; i++, off++)
+			if (data[i] != (uint8_t)off)
+				return -1;
+	}
+	return off == pkt_len ? 0 : -1;
+}
+
+/*
+ * test linearization and coalescing of multi-segment packets
+ */
+static int
+test_pktmbuf_linearize(void)
+{
+	static const uint16_t seg_lens[] = { 100, 1000, 20, 0, 30 };
+	struct rte_mbuf *m = NULL, *mc, *clone = NULL;
+	unsigned i, nb_free;
+
+	nb_free = rte_mempool_count(pktmbuf_pool);
+
+	/* in place, in the tailroom of the first segment */
+	for (i = 0; i < RTE_DIM(seg_lens); i++) {
+		mc = linearize_append_seg(m, seg_lens[i]);
+		if (mc == NULL)
+			GOTO_FAIL("cannot build the packet");
+		m = mc;
+	}
+	m->port = 3;
+	m->packet_type = RTE_PTYPE_L2_ETHER;
+	mc = rte_pktmbuf_linearize(m, NULL);
+	if (mc != m)
+		GOTO_FAIL("packet not linearized in place");
+	if (m->nb_segs != 1 || m->next != NULL || m->data_len != m->pkt_len)
+		GOTO_FAIL("packet still segmented");
+	if (linearize_check_data(m, 1150) < 0)
+		GOTO_FAIL("bad data after in place linearization");
+	if (rte_pktmbuf_linearize(m, NULL) != m)
+		GOTO_FAIL("single segment packet changed");
+
+	/* the buffer of a clone is shared: copy in a new mbuf */
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone the packet");
+	if (linearize_append_seg(clone, 50) == NULL)
+		GOTO_FAIL("cannot append a segment to the clone");
+	mc = rte_pktmbuf_linearize(clone, NULL);
+	if (mc == NULL || mc == clone)
+		GOTO_FAIL("packet not copied in a new mbuf");
+	clone = mc;
+	if (!RTE_MBUF_DIRECT(clone) || clone->nb_segs != 1 ||
+			clone->port != 3 ||
+			clone->packet_type != RTE_PTYPE_L2_ETHER)
+		GOTO_FAIL("bad linearized copy");
+	if (linearize_check_data(clone, 1200) < 0)
+		GOTO_FAIL("bad data after linearization in a new mbuf");
+	if (rte_mbuf_refcnt_read(m) != 1 ||
+			linearize_check_data(m, 1150) < 0)
+		GOTO_FAIL("original packet modified");
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+
+	/* too large for a mbuf: the packet is unchanged */
+	if (linearize_append_seg(m, MBUF_DATA_SIZE - RTE_PKTMBUF_HEADROOM -
+				 1150 + 1) == NULL)
+		GOTO_FAIL("cannot append a segment");
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone the packet");
+	if (rte_pktmbuf_linearize(clone, NULL) != NULL ||
+			rte_errno != ENOSPC)
+		GOTO_FAIL("too large packet linearized");
+	if (clone->nb_segs != 2)
+		GOTO_FAIL("packet modified by a failed linearization");
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	rte_pktmbuf_free(m);
+	m = NULL;
+
+	/* coalesce the small trailing segments */
+	for (i = 0; i < RTE_DIM(seg_lens); i++) {
+		mc = linearize_append_seg(m, seg_lens[i]);
+		if (mc == NULL)
+			GOTO_FAIL("cannot build the packet");
+		m = mc;
+	}
+	if (rte_pktmbuf_coalesce(m, 64) != 2)
+		GOTO_FAIL("bad number of segments after coalescing");
+	if (m->data_len != 100 || m->next->data_len != 1050)
+		GOTO_FAIL("bad segments after coalescing");
+	if (linearize_check_data(m, 1150) < 0)
+		GOTO_FAIL("bad data after coalescing");
+	rte_pktmbuf_free(m);
+	m = NULL;
+
+	if (rte_mempool_count(pktmbuf_pool) != nb_free)
+		GOTO_FAIL("mbufs leaked");
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (clone)
+		rte_pktmbuf_free(clone);
+	if (m)
+		rte_pktmbuf_free(m);
+	return -1;
+}
+
 #undef GOTO_FAIL
 
 /*
@@ -1000,6 +1571,12 @@ test_mbuf(void)
 		return -1;
 	}
 
+	/* test bulk alloc and free of pktmbufs */
+	if (test_pktmbuf_alloc_free_bulk() < 0) {
+		printf("test_pktmbuf_alloc_free_bulk() failed\n");
+		return -1;
+	}
+
 	if (testclone_testupdate_testdetach()<0){
 		printf("testclone_and_testupdate() failed \n");
 		return -1;
@@ -1010,6 +1587,21 @@ test_mbuf(void)
 		return -1;
 	}
 
+	if (test_pktmbuf_ext_buf() < 0) {
+		printf("test_pktmbuf_ext_buf() failed\n");
+		return -1;
+	}
+
+	if (test_mbuf_dyn() < 0) {
+		printf("test_mbuf_dyn() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_linearize() < 0) {
+		printf("test_pktmbuf_linearize() failed\n");
+		return -1;
+	}
+
 	if (test_refcnt_mbuf()<0){
 		printf("test_refcnt_mbuf() failed \n");
 		return -1;
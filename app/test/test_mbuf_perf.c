@@ -0,0 +1,217 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_mbuf.h>
+
+#include "test.h"
+
+/*
+ * Mbuf performance test
+ * =====================
+ *
+ * For packets of 1024 bytes split in 2, 4 and 8 segments, and for a
+ * packet with a large first segment followed by small ones, measure the
+ * cost per packet of:
+ *
+ *    - rte_pktmbuf_linearize() in the tailroom of the first segment;
+ *    - rte_pktmbuf_linearize() of a clone, copied in a new mbuf;
+ *    - rte_pktmbuf_coalesce() of the segments smaller than 128 bytes.
+ */
+
+#define MBUF_POOL_NAME "MBUF_PERF"
+#define MBUF_POOL_SIZE 2047
+#define MBUF_CACHE_SIZE 256
+#define BURST 32
+#define ITERATIONS 1024
+#define COALESCE_MAX_LEN 128
+
+struct mbuf_perf_case {
+	uint16_t first_len; /* data length of the first segment */
+	uint16_t seg_len;   /* data length of the next segments */
+	unsigned nb_segs;
+};
+
+static const struct mbuf_perf_case perf_cases[] = {
+	{ 512, 512, 2 },
+	{ 256, 256, 4 },
+	{ 128, 128, 8 },
+	{ 1024, 64, 4 },
+};
+
+enum mbuf_perf_op {
+	LINEARIZE_IN_PLACE,
+	LINEARIZE_COPY,
+	COALESCE,
+};
+
+static const char * const perf_op_names[] = {
+	[LINEARIZE_IN_PLACE] = "linearize in place",
+	[LINEARIZE_COPY] = "linearize clone",
+	[COALESCE] = "coalesce",
+};
+
+static struct rte_mempool *perf_pool;
+
+/* allocate a burst of chained packets */
+static int
+build_burst(struct rte_mbuf **pkts, const struct mbuf_perf_case *c)
+{
+	struct rte_mbuf *seg;
+	unsigned i, j;
+
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = rte_pktmbuf_alloc(perf_pool);
+		if (pkts[i] == NULL ||
+				rte_pktmbuf_append(pkts[i], c->first_len) == NULL)
+			goto fail;
+		for (j = 1; j < c->nb_segs; j++) {
+			seg = rte_pktmbuf_alloc(perf_pool);
+			if (seg == NULL)
+				goto fail;
+			if (rte_pktmbuf_append(seg, c->seg_len) == NULL ||
+					rte_pktmbuf_chain(pkts[i], seg) < 0) {
+				rte_pktmbuf_free(seg);
+				goto fail;
+			}
+		}
+	}
+	return 0;
+
+fail:
+	rte_pktmbuf_free_bulk(pkts, i + 1);
+	return -1;
+}
+
+/* run an operation on ITERATIONS bursts, return the cycles per packet */
+static int
+run_op(enum mbuf_perf_op op, const struct mbuf_perf_case *c,
+       double *cycles_per_pkt)
+{
+	struct rte_mbuf *pkts[BURST], *clones[BURST];
+	uint64_t start, cycles = 0;
+	unsigned i, n;
+
+	for (n = 0; n < ITERATIONS; n++) {
+		if (build_burst(pkts, c) < 0)
+			return -1;
+
+		if (op == LINEARIZE_COPY) {
+			for (i = 0; i < BURST; i++) {
+				clones[i] = rte_pktmbuf_clone(pkts[i],
+							      perf_pool);
+				if (clones[i] == NULL) {
+					rte_pktmbuf_free_bulk(clones, i);
+					rte_pktmbuf_free_bulk(pkts, BURST);
+					return -1;
+				}
+			}
+		}
+
+		start = rte_rdtsc();
+		switch (op) {
+		case LINEARIZE_IN_PLACE:
+			for (i = 0; i < BURST; i++)
+				pkts[i] = rte_pktmbuf_linearize(pkts[i], NULL);
+			break;
+		case LINEARIZE_COPY:
+			for (i = 0; i < BURST; i++)
+				clones[i] = rte_pktmbuf_linearize(clones[i],
+								  NULL);
+			break;
+		case COALESCE:
+			for (i = 0; i < BURST; i++)
+				rte_pktmbuf_coalesce(pkts[i],
+						     COALESCE_MAX_LEN);
+			break;
+		}
+		cycles += rte_rdtsc() - start;
+
+		/* NULL entries (failed linearization) are ignored */
+		if (op == LINEARIZE_COPY)
+			rte_pktmbuf_free_bulk(clones, BURST);
+		rte_pktmbuf_free_bulk(pkts, BURST);
+	}
+
+	*cycles_per_pkt = (double)cycles / ((uint64_t)ITERATIONS * BURST);
+	return 0;
+}
+
+static int
+test_mbuf_perf(void)
+{
+	const struct mbuf_perf_case *c;
+	double cycles;
+	unsigned i, op;
+
+	perf_pool = rte_mempool_lookup(MBUF_POOL_NAME);
+	if (perf_pool == NULL)
+		perf_pool = rte_pktmbuf_pool_create(MBUF_POOL_NAME,
+			MBUF_POOL_SIZE, MBUF_CACHE_SIZE, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (perf_pool == NULL) {
+		printf("[%s():%u] failed to create a mbuf pool\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	for (op = LINEARIZE_IN_PLACE; op <= COALESCE; op++) {
+		printf("### %s ###\n", perf_op_names[op]);
+		for (i = 0; i < RTE_DIM(perf_cases); i++) {
+			c = &perf_cases[i];
+			if (run_op(op, c, &cycles) < 0) {
+				printf("[%s():%u] failed to run the test\n",
+				       __func__, __LINE__);
+				return -1;
+			}
+			printf("%4u + %u x %4u bytes: %.2F cycles per packet\n",
+			       c->first_len, c->nb_segs - 1, c->seg_len,
+			       cycles);
+		}
+	}
+
+	return 0;
+}
+
+static struct test_command mbuf_perf_cmd = {
+	.command = "mbuf_perf_autotest",
+	.callback = test_mbuf_perf,
+};
+REGISTER_TEST_COMMAND(mbuf_perf_cmd);
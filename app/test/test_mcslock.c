@@ -0,0 +1,204 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_per_lcore.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_mcslock.h>
+#include <rte_atomic.h>
+
+#include "test.h"
+
+/*
+ * MCS lock test
+ * =============
+ *
+ * - There is a global MCS lock and a table of MCS locks (one per lcore).
+ *   Each lcore uses its own queue node, a per-lcore variable.
+ *
+ * - The test function takes all of these locks and launches the
+ *   ``test_mcslock_per_core()`` function on each core (except the master).
+ *
+ *   - The function takes the global lock, display something, then releases
+ *     the global lock.
+ *   - The function takes the per-lcore lock, display something, then releases
+ *     the per-core lock.
+ *
+ * - The main function unlocks the per-lcore locks sequentially and
+ *   waits between each lock.
+ *
+ * - All cores then increment a shared counter under the global lock, and
+ *   the final value of the counter is checked.
+ *
+ * - The trylock of a taken lock must fail on all cores.
+ */
+
+#define NB_INCREMENTS 100000
+
+static RTE_DEFINE_PER_LCORE(rte_mcslock_t, ml_me);
+static RTE_DEFINE_PER_LCORE(rte_mcslock_t, ml_try_me);
+
+static rte_mcslock_t *ml, *ml_try;
+static rte_mcslock_t *ml_tab[RTE_MAX_LCORE];
+static rte_mcslock_t ml_tab_me[RTE_MAX_LCORE];
+static unsigned count;
+static uint64_t shared_counter;
+
+static int
+test_mcslock_per_core(__attribute__((unused)) void *arg)
+{
+	unsigned lcore = rte_lcore_id();
+
+	rte_mcslock_lock(&ml, &RTE_PER_LCORE(ml_me));
+	printf("Global lock taken on core %u\n", lcore);
+	rte_mcslock_unlock(&ml, &RTE_PER_LCORE(ml_me));
+
+	rte_mcslock_lock(&ml_tab[lcore], &RTE_PER_LCORE(ml_me));
+	printf("Hello from core %u !\n", lcore);
+	rte_mcslock_unlock(&ml_tab[lcore], &RTE_PER_LCORE(ml_me));
+
+	return 0;
+}
+
+static int
+test_mcslock_increment(__attribute__((unused)) void *arg)
+{
+	unsigned i;
+
+	for (i = 0; i < NB_INCREMENTS; i++) {
+		rte_mcslock_lock(&ml, &RTE_PER_LCORE(ml_me));
+		shared_counter++;
+		rte_mcslock_unlock(&ml, &RTE_PER_LCORE(ml_me));
+	}
+	return 0;
+}
+
+static int
+test_mcslock_try(__attribute__((unused)) void *arg)
+{
+	if (rte_mcslock_trylock(&ml_try, &RTE_PER_LCORE(ml_try_me)) == 0) {
+		rte_mcslock_lock(&ml, &RTE_PER_LCORE(ml_me));
+		count++;
+		rte_mcslock_unlock(&ml, &RTE_PER_LCORE(ml_me));
+	}
+
+	return 0;
+}
+
+static int
+test_mcslock(void)
+{
+	int i;
+
+	rte_mcslock_init(&ml);
+	rte_mcslock_init(&ml_try);
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		rte_mcslock_init(&ml_tab[i]);
+
+	rte_mcslock_lock(&ml, &RTE_PER_LCORE(ml_me));
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_mcslock_lock(&ml_tab[i], &ml_tab_me[i]);
+		rte_eal_remote_launch(test_mcslock_per_core, NULL, i);
+	}
+	rte_mcslock_unlock(&ml, &RTE_PER_LCORE(ml_me));
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_mcslock_unlock(&ml_tab[i], &ml_tab_me[i]);
+		rte_delay_ms(100);
+	}
+
+	rte_eal_mp_wait_lcore();
+
+	/* mutual exclusion */
+	shared_counter = 0;
+	rte_eal_mp_remote_launch(test_mcslock_increment, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	if (shared_counter != (uint64_t)NB_INCREMENTS * rte_lcore_count()) {
+		printf("Counter is %"PRIu64" instead of %"PRIu64"\n",
+		       shared_counter,
+		       (uint64_t)NB_INCREMENTS * rte_lcore_count());
+		return -1;
+	}
+
+	/* trylock on a taken lock fails on all slave cores */
+	if (rte_mcslock_trylock(&ml_try, &RTE_PER_LCORE(ml_try_me)) == 0) {
+		printf("mcslock_trylock failed on a free lock\n");
+		return -1;
+	}
+	count = 0;
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_eal_remote_launch(test_mcslock_try, NULL, i);
+	}
+	rte_eal_mp_wait_lcore();
+	if (!rte_mcslock_is_locked(&ml_try)) {
+		printf("mcslock is not locked but it should be\n");
+		return -1;
+	}
+	rte_mcslock_unlock(&ml_try, &RTE_PER_LCORE(ml_try_me));
+	if (rte_mcslock_is_locked(&ml_try)) {
+		printf("mcslock is locked but it should not be\n");
+		return -1;
+	}
+	if (count != (rte_lcore_count() - 1)) {
+		printf("%u cores took a taken mcslock\n",
+		       rte_lcore_count() - 1 - count);
+		return -1;
+	}
+
+	/* elided critical section */
+	rte_mcslock_lock_tm(&ml, &RTE_PER_LCORE(ml_me));
+	shared_counter++;
+	rte_mcslock_unlock_tm(&ml, &RTE_PER_LCORE(ml_me));
+	if (rte_mcslock_is_locked(&ml)) {
+		printf("mcslock is locked after transaction\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static struct test_command mcslock_cmd = {
+	.command = "mcslock_autotest",
+	.callback = test_mcslock,
+};
+REGISTER_TEST_COMMAND(mcslock_cmd);
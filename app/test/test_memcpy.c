@@ -80,6 +80,10 @@ static size_t buf_sizes[TEST_VALUE_RANGE];
 /* Data is aligned on this many bytes (power of 2) */
 #define ALIGNMENT_UNIT          32
 
+#if defined(RTE_ARCH_X86) && defined(RTE_MEMCPY_RUNTIME_DISPATCH)
+#define TEST_MEMCPY_DISPATCH
+#endif
+
 
 /*
  * Create two buffers, and initialise one with random values. These are copied
@@ -88,7 +92,8 @@ static size_t buf_sizes[TEST_VALUE_RANGE];
  * changed.
  */
 static int
-test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size)
+test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size,
+		   int dispatched)
 {
 	unsigned int i;
 	uint8_t dest[SMALL_BUFFER_SIZE + ALIGNMENT_UNIT];
@@ -101,7 +106,14 @@ test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size)
 		src[i] = (uint8_t) rte_rand();
 	}
 
-	/* Do the copy */
+	/* Do the copy, through the run time selected kernel if asked to */
+#ifdef TEST_MEMCPY_DISPATCH
+	if (dispatched)
+		ret = (*rte_memcpy_ptr)(dest + off_dst, src + off_src, size);
+	else
+#else
+	RTE_SET_USED(dispatched);
+#endif
 	ret = rte_memcpy(dest + off_dst, src + off_src, size);
 	if (ret != (dest + off_dst)) {
 		printf("rte_memcpy() returned %p, not %p\n",
@@ -144,7 +156,7 @@ test_single_memcpy(unsigned int off_src, unsigned int off_dst, size_t size)
  * Check functionality for various buffer sizes and data offsets/alignments.
  */
 static int
-func_test(void)
+func_test(int dispatched)
 {
 	unsigned int off_src, off_dst, i;
 	unsigned int num_buf_sizes = sizeof(buf_sizes) / sizeof(buf_sizes[0]);
@@ -154,7 +166,7 @@ func_test(void)
 		for (off_dst = 0; off_dst < ALIGNMENT_UNIT; off_dst++) {
 			for (i = 0; i < num_buf_sizes; i++) {
 				ret = test_single_memcpy(off_src, off_dst,
-				                         buf_sizes[i]);
+				                         buf_sizes[i], dispatched);
 				if (ret != 0)
 					return -1;
 			}
@@ -168,9 +180,14 @@ test_memcpy(void)
 {
 	int ret;
 
-	ret = func_test();
+	ret = func_test(0);
+	if (ret != 0)
+		return -1;
+#ifdef TEST_MEMCPY_DISPATCH
+	ret = func_test(1);
 	if (ret != 0)
 		return -1;
+#endif
 	return 0;
 }
 
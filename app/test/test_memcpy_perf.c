@@ -87,6 +87,25 @@ static size_t buf_sizes[TEST_VALUE_RANGE];
 #define ALIGNMENT_UNIT          16
 #endif /* RTE_MACHINE_CPUFLAG */
 
+#if defined(RTE_ARCH_X86) && defined(RTE_MEMCPY_RUNTIME_DISPATCH)
+#define TEST_MEMCPY_DISPATCH
+#endif
+
+/* Packet size classes dominating vhost and reassembly copies */
+static size_t class_sizes[] = {
+	64, 128, 256, 1518
+};
+
+/* Copy routines compared in the size class report */
+enum copy_routine {
+	COPY_RTE_MEMCPY,
+#ifdef TEST_MEMCPY_DISPATCH
+	COPY_DISPATCHED,
+#endif
+	COPY_LIBC,
+	COPY_MAX
+};
+
 /*
  * Pointers used in performance tests. The two large buffers are for uncached
  * access where random addresses within the buffer are used for each
@@ -252,7 +271,8 @@ do {                                                                     \
 do {                                                                    \
     TEST_CONSTANT(6U); TEST_CONSTANT(64U); TEST_CONSTANT(128U);         \
     TEST_CONSTANT(192U); TEST_CONSTANT(256U); TEST_CONSTANT(512U);      \
-    TEST_CONSTANT(768U); TEST_CONSTANT(1024U); TEST_CONSTANT(1536U);    \
+    TEST_CONSTANT(768U); TEST_CONSTANT(1024U); TEST_CONSTANT(1518U);    \
+    TEST_CONSTANT(1536U);                                               \
 } while (0)
 
 /* Run all memcpy tests for aligned constant cases */
@@ -295,6 +315,86 @@ perf_test_variable_unaligned(void)
 	}
 }
 
+/* Average ticks per copy of one routine, size is not a compile-time constant */
+static double
+time_copy_routine(enum copy_routine routine,
+		  uint8_t *dst, int is_dst_cached, size_t dst_uoffset,
+		  const uint8_t *src, int is_src_cached, size_t src_uoffset,
+		  size_t size)
+{
+	unsigned int iter, t;
+	size_t dst_addrs[TEST_BATCH_SIZE], src_addrs[TEST_BATCH_SIZE];
+	uint64_t start_time, total_time = 0;
+
+	for (iter = 0; iter < (TEST_ITERATIONS / TEST_BATCH_SIZE); iter++) {
+		fill_addr_arrays(dst_addrs, is_dst_cached, dst_uoffset,
+				 src_addrs, is_src_cached, src_uoffset);
+		start_time = rte_rdtsc();
+		switch (routine) {
+		case COPY_RTE_MEMCPY:
+			for (t = 0; t < TEST_BATCH_SIZE; t++)
+				rte_memcpy(dst + dst_addrs[t],
+					   src + src_addrs[t], size);
+			break;
+#ifdef TEST_MEMCPY_DISPATCH
+		case COPY_DISPATCHED:
+			for (t = 0; t < TEST_BATCH_SIZE; t++)
+				(*rte_memcpy_ptr)(dst + dst_addrs[t],
+						  src + src_addrs[t], size);
+			break;
+#endif
+		default:
+			for (t = 0; t < TEST_BATCH_SIZE; t++)
+				memcpy(dst + dst_addrs[t],
+				       src + src_addrs[t], size);
+			break;
+		}
+		total_time += rte_rdtsc() - start_time;
+	}
+	return (double)total_time / TEST_ITERATIONS;
+}
+
+/*
+ * Report the packet size classes on their own, aligned and unaligned, so that
+ * the inlined, run time selected and libc copies can be compared directly.
+ */
+static void
+perf_test_size_classes(void)
+{
+	unsigned int n = sizeof(class_sizes) / sizeof(class_sizes[0]);
+	unsigned int i, unaligned, r;
+	int cached;
+
+	printf("\n** Packet size classes (ticks per copy, variable size) **\n"
+	       "======= ========= ================================= =================================\n"
+	       "   Size Alignment                    Cache to cache                        Mem to mem\n"
+	       "(bytes)           rte_memcpy   dispatch       libc rte_memcpy   dispatch       libc\n"
+	       "------- --------- ---------- ---------- ---------- ---------- ---------- ----------");
+
+	for (unaligned = 0; unaligned <= 1; unaligned++) {
+		for (i = 0; i < n; i++) {
+			printf("\n%7u %9s", (unsigned)class_sizes[i],
+			       unaligned ? "unaligned" : "aligned");
+			for (cached = 1; cached >= 0; cached--) {
+				for (r = 0; r < COPY_MAX; r++) {
+					printf(" %10.0f", time_copy_routine(r,
+						cached ? small_buf_write : large_buf_write,
+						cached, unaligned,
+						cached ? small_buf_read : large_buf_read,
+						cached, 5 * unaligned,
+						class_sizes[i]));
+#ifndef TEST_MEMCPY_DISPATCH
+					/* keep the dispatch column */
+					if (r == COPY_RTE_MEMCPY)
+						printf(" %10s", "-");
+#endif
+				}
+			}
+		}
+	}
+	printf("\n======= ========= ================================= =================================\n\n");
+}
+
 /* Run all memcpy tests */
 static int
 perf_test(void)
@@ -335,6 +435,8 @@ perf_test(void)
 	perf_test_constant_unaligned();
 	printf("\n======= ============== ============== ============== ==============\n\n");
 
+	perf_test_size_classes();
+
 	free_buffers();
 
 	return 0;
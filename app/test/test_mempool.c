@@ -38,6 +38,7 @@
 #include <inttypes.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
@@ -56,6 +57,7 @@
 #include <rte_mempool.h>
 #include <rte_spinlock.h>
 #include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -69,6 +71,23 @@
  *    - Get two objects, put two objects
  *    - Get all objects, test that their content is not modified and
  *      put them back in the pool.
+ *
+ * User-owned cache tests: a cache created by the application is used by
+ * rte_mempool_generic_get() and rte_mempool_generic_put(), and by the gets
+ * and puts of a non-EAL thread which attached it to the mempool, and its
+ * objects go back to the pool when it is flushed or detached.
+ *
+ * Per-lcore arrays tests: the caches of a mempool are sized to the enabled
+ * lcores, and a mempool without cache does not reserve memory for them.
+ *
+ * Adaptive cache tests: with MEMPOOL_F_CACHE_ADAPTIVE, the cache of an
+ * lcore shrinks when it rarely accesses the pool and grows back when it
+ * often does.
+ *
+ * Pool handler tests: the default handler follows the creation flags,
+ * the "stack" and "lf_stack" handlers pass the basic tests and give back
+ * the last freed object first, and unknown or duplicated handlers are
+ * rejected.
  */
 
 #define N 65536
@@ -454,6 +473,473 @@ test_mempool_xmem_misc(void)
 	return 0;
 }
 
+/* use a user-owned cache with the generic functions */
+static int
+test_mempool_user_cache(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache *cache;
+	void *obj, *obj2;
+	int ret = -1;
+
+	/* invalid sizes are rejected */
+	cache = rte_mempool_cache_create(0, SOCKET_ID_ANY);
+	if (cache != NULL || rte_errno != EINVAL) {
+		printf("cache created with a null size\n");
+		return -1;
+	}
+	cache = rte_mempool_cache_create(RTE_MEMPOOL_CACHE_MAX_SIZE + 1,
+					 SOCKET_ID_ANY);
+	if (cache != NULL || rte_errno != EINVAL) {
+		printf("cache created with a too large size\n");
+		return -1;
+	}
+
+	cache = rte_mempool_cache_create(RTE_MEMPOOL_CACHE_MAX_SIZE,
+					 SOCKET_ID_ANY);
+	if (cache == NULL) {
+		printf("cannot create a mempool cache\n");
+		return -1;
+	}
+
+	/* an EAL lcore uses its default cache */
+	if (rte_mempool_cache_attach(mp, cache) != -EINVAL) {
+		printf("cache attached by an EAL lcore\n");
+		goto exit;
+	}
+
+	printf("get 2 objects through the user cache\n");
+	if (rte_mempool_generic_get(mp, &obj, 1, cache) < 0)
+		goto exit;
+	if (rte_mempool_generic_get(mp, &obj2, 1, cache) < 0) {
+		rte_mempool_generic_put(mp, &obj, 1, cache);
+		goto exit;
+	}
+	if (cache->len != RTE_MEMPOOL_CACHE_MAX_SIZE - 1) {
+		printf("user cache was not filled\n");
+		goto flush;
+	}
+
+	printf("put the objects back\n");
+	rte_mempool_generic_put(mp, &obj, 1, cache);
+	rte_mempool_generic_put(mp, &obj2, 1, cache);
+	if (rte_mempool_count(mp) != MEMPOOL_SIZE - cache->len) {
+		printf("bad mempool count with a user cache\n");
+		goto flush;
+	}
+
+	ret = 0;
+flush:
+	rte_mempool_cache_flush(cache, mp);
+	if (cache->len != 0 || rte_mempool_count(mp) != MEMPOOL_SIZE) {
+		printf("user cache was not flushed\n");
+		ret = -1;
+	}
+exit:
+	rte_mempool_cache_free(cache);
+	return ret;
+}
+
+/* get and put objects from a non-EAL thread with an attached cache */
+static void *
+test_mempool_attached_cache_thread(void *arg)
+{
+	struct rte_mempool_cache *cache = arg;
+	intptr_t ret = -1;
+	void *obj;
+
+	if (rte_mempool_default_cache(mp, rte_lcore_id()) != NULL) {
+		printf("non-EAL thread has a default cache\n");
+		return (void *)ret;
+	}
+
+	if (rte_mempool_cache_attach(mp, cache) < 0)
+		return (void *)ret;
+	if (rte_mempool_cache_attach(mp, cache) != -EEXIST) {
+		printf("cache attached twice to the same mempool\n");
+		goto detach;
+	}
+	if (rte_mempool_default_cache(mp, rte_lcore_id()) != cache) {
+		printf("attached cache is not the default one\n");
+		goto detach;
+	}
+
+	if (rte_mempool_get(mp, &obj) < 0)
+		goto detach;
+	if (cache->len == 0) {
+		printf("attached cache is not used by gets\n");
+		rte_mempool_put(mp, obj);
+		goto detach;
+	}
+	rte_mempool_put(mp, obj);
+
+	ret = 0;
+detach:
+	if (rte_mempool_cache_detach(mp) != cache || cache->len != 0) {
+		printf("cannot detach the cache\n");
+		ret = -1;
+	}
+	return (void *)ret;
+}
+
+/* attach a user-owned cache to a mempool from a non-EAL thread */
+static int
+test_mempool_attached_cache(struct rte_mempool *pool)
+{
+	struct rte_mempool_cache *cache;
+	pthread_t thread;
+	void *ret;
+
+	cache = rte_mempool_cache_create(RTE_MEMPOOL_CACHE_MAX_SIZE,
+					 SOCKET_ID_ANY);
+	if (cache == NULL)
+		return -1;
+
+	mp = pool;
+	if (pthread_create(&thread, NULL, test_mempool_attached_cache_thread,
+			   cache) != 0) {
+		rte_mempool_cache_free(cache);
+		return -1;
+	}
+	pthread_join(thread, &ret);
+	rte_mempool_cache_free(cache);
+
+	if (ret != NULL || rte_mempool_count(mp) != MEMPOOL_SIZE)
+		return -1;
+
+	return 0;
+}
+
+#define SMALL_POOL_SIZE 16
+
+/* check the size and the location of the per-lcore arrays */
+static int
+test_mempool_lcore_arrays(void)
+{
+	struct rte_mempool *mp_small;
+	const struct rte_memzone *mz;
+	unsigned lcore_id, nb_lcores = 0;
+
+	/* service lcores have a cache too */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		if (rte_eal_lcore_role(lcore_id) != ROLE_OFF)
+			nb_lcores = lcore_id + 1;
+
+	if (mp_cache->nb_lcores != nb_lcores) {
+		printf("bad number of per-lcore entries: %u, %u expected\n",
+		       mp_cache->nb_lcores, nb_lcores);
+		return -1;
+	}
+	if ((char *)mp_cache->local_cache <
+			(char *)rte_mempool_get_priv(mp_cache) +
+			mp_cache->private_data_size ||
+			(uintptr_t)&mp_cache->local_cache[nb_lcores] >
+			mp_cache->elt_va_start) {
+		printf("caches are not between private data and objects\n");
+		return -1;
+	}
+	if (rte_mempool_default_cache(mp_cache, nb_lcores) != NULL) {
+		printf("disabled lcore has a cache\n");
+		return -1;
+	}
+
+	/* a mempool without cache only holds its header and objects */
+	mp_small = rte_mempool_lookup("test_small");
+	if (mp_small == NULL)
+		mp_small = rte_mempool_create("test_small", SMALL_POOL_SIZE,
+			sizeof(uint64_t), 0, 0, NULL, NULL, NULL, NULL,
+			SOCKET_ID_ANY, 0);
+	if (mp_small == NULL)
+		return -1;
+
+	if (mp_small->local_cache != NULL) {
+		printf("caches allocated for a mempool without cache\n");
+		return -1;
+	}
+	mz = rte_memzone_lookup(RTE_MEMPOOL_MZ_PREFIX "test_small");
+	if (mz == NULL || mz->len >= sizeof(struct rte_mempool_cache) *
+			RTE_MAX_LCORE) {
+		printf("mempool without cache is too large\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+#define ADAPTIVE_POOL_SIZE 4096
+#define ADAPTIVE_CACHE_SIZE 256
+#define ADAPTIVE_BULK 32
+
+/* resize the cache of an lcore with MEMPOOL_F_CACHE_ADAPTIVE */
+static int
+test_mempool_adaptive_cache(void)
+{
+	struct rte_mempool *mp_adaptive;
+	struct rte_mempool_cache *cache;
+	void **objtable;
+	uint32_t size;
+	unsigned i, n;
+	int ret = -1;
+
+	mp_adaptive = rte_mempool_lookup("test_adaptive");
+	if (mp_adaptive == NULL)
+		mp_adaptive = rte_mempool_create("test_adaptive",
+			ADAPTIVE_POOL_SIZE, sizeof(uint64_t),
+			ADAPTIVE_CACHE_SIZE, 0, NULL, NULL, NULL, NULL,
+			SOCKET_ID_ANY, MEMPOOL_F_CACHE_ADAPTIVE);
+	if (mp_adaptive == NULL)
+		return -1;
+
+	cache = rte_mempool_default_cache(mp_adaptive, rte_lcore_id());
+	if (cache == NULL || cache->size != ADAPTIVE_CACHE_SIZE)
+		return -1;
+
+	objtable = malloc(ADAPTIVE_POOL_SIZE * sizeof(void *));
+	if (objtable == NULL)
+		return -1;
+
+	/* many single gets for few pool accesses: the cache shrinks */
+	for (n = 0; n < ADAPTIVE_POOL_SIZE / 2; n++) {
+		if (rte_mempool_get(mp_adaptive, &objtable[n]) < 0)
+			goto exit;
+	}
+	size = cache->size;
+	printf("adaptive cache size after single gets: %u\n", size);
+	if (size >= ADAPTIVE_CACHE_SIZE) {
+		printf("adaptive cache did not shrink\n");
+		goto exit;
+	}
+	rte_mempool_put_bulk(mp_adaptive, objtable, n);
+	n = 0;
+
+	/* bulk gets going to the pool every few calls: the cache grows */
+	for (i = 0; i < 16; i++) {
+		if (rte_mempool_get_bulk(mp_adaptive, &objtable[n],
+					 ADAPTIVE_BULK) < 0)
+			goto exit;
+		n += ADAPTIVE_BULK;
+	}
+	printf("adaptive cache size after bulk gets: %u\n", cache->size);
+	if (cache->size <= size) {
+		printf("adaptive cache did not grow\n");
+		goto exit;
+	}
+
+	ret = 0;
+exit:
+	for (i = 0; i < n; i++)
+		rte_mempool_put(mp_adaptive, objtable[i]);
+	free(objtable);
+	return ret;
+}
+
+#define STATS_POOL_SIZE 256
+#define STATS_CACHE_SIZE 32
+
+/* check the statistics counters, or that they are reported as disabled */
+static int
+test_mempool_stats(void)
+{
+	struct rte_mempool *mp_stats;
+	struct rte_mempool_debug_stats stats;
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
+	struct rte_mempool_debug_stats lcore_stats;
+	void *obj[STATS_POOL_SIZE + 1];
+	unsigned i;
+#endif
+	int ret;
+
+	mp_stats = rte_mempool_lookup("test_stats");
+	if (mp_stats == NULL)
+		mp_stats = rte_mempool_create("test_stats", STATS_POOL_SIZE,
+			sizeof(uint64_t), STATS_CACHE_SIZE, 0, NULL, NULL,
+			NULL, NULL, SOCKET_ID_ANY, 0);
+	if (mp_stats == NULL)
+		return -1;
+
+	ret = rte_mempool_stats_get(mp_stats, LCORE_ID_ANY, &stats);
+#ifndef RTE_LIBRTE_MEMPOOL_STATS
+	if (ret != -ENOTSUP) {
+		printf("statistics should not be available\n");
+		return -1;
+	}
+	return 0;
+#else
+	if (ret != 0)
+		return -1;
+
+	/* start with an empty cache and cleared counters */
+	rte_mempool_cache_flush(rte_mempool_default_cache(mp_stats,
+		rte_lcore_id()), mp_stats);
+	rte_mempool_stats_reset(mp_stats);
+
+	/* a miss backfilling the cache, then a hit */
+	if (rte_mempool_get(mp_stats, &obj[0]) < 0 ||
+			rte_mempool_get(mp_stats, &obj[1]) < 0)
+		return -1;
+	/* too large for the cache: straight from the common pool */
+	if (rte_mempool_get_bulk(mp_stats, &obj[2], STATS_CACHE_SIZE) < 0)
+		return -1;
+	/* more than the pool holds */
+	if (rte_mempool_get_bulk(mp_stats, obj, STATS_POOL_SIZE + 1) == 0)
+		return -1;
+	for (i = 0; i < STATS_CACHE_SIZE + 2; i++)
+		rte_mempool_put(mp_stats, obj[i]);
+
+	if (rte_mempool_stats_get(mp_stats, LCORE_ID_ANY, &stats) != 0)
+		return -1;
+	rte_mempool_dump(stdout, mp_stats);
+
+	if (stats.get_success_bulk != 3 ||
+			stats.get_success_objs != STATS_CACHE_SIZE + 2 ||
+			stats.get_common_pool_bulk != 2 ||
+			stats.get_common_pool_objs != STATS_CACHE_SIZE * 2 + 1 ||
+			stats.get_fail_bulk != 1 ||
+			stats.get_fail_objs != STATS_POOL_SIZE + 1 ||
+			stats.put_bulk != STATS_CACHE_SIZE + 2 ||
+			stats.put_objs != STATS_CACHE_SIZE + 2 ||
+			stats.put_common_pool_bulk == 0) {
+		printf("unexpected mempool statistics\n");
+		return -1;
+	}
+
+	/* all the activity comes from this lcore */
+	if (rte_mempool_stats_get(mp_stats, rte_lcore_id(),
+			&lcore_stats) != 0 ||
+			memcmp(&stats, &lcore_stats, sizeof(stats)) != 0) {
+		printf("bad per-lcore mempool statistics\n");
+		return -1;
+	}
+	if (rte_mempool_stats_get(mp_stats, mp_stats->nb_lcores,
+			&lcore_stats) != -EINVAL)
+		return -1;
+
+	rte_mempool_stats_reset(mp_stats);
+	if (rte_mempool_stats_get(mp_stats, LCORE_ID_ANY, &stats) != 0 ||
+			stats.get_success_bulk != 0 || stats.put_bulk != 0) {
+		printf("mempool statistics not reset\n");
+		return -1;
+	}
+
+	return 0;
+#endif
+}
+
+#ifdef RTE_LIBRTE_STACK
+/*
+ * Run the basic tests on mempools using a stack handler, with and without
+ * cache, and check that the last freed object is the first one given back.
+ */
+static int
+test_mempool_stack_ops(const char *ops_name)
+{
+	struct rte_mempool *mp_stack, *mp_stack_cache;
+	char name[RTE_MEMPOOL_NAMESIZE];
+	void *obj, *obj2;
+
+	snprintf(name, sizeof(name), "test_%s", ops_name);
+	mp_stack = rte_mempool_lookup(name);
+	if (mp_stack == NULL)
+		mp_stack = rte_mempool_create_with_ops(name,
+			MEMPOOL_SIZE, MEMPOOL_ELT_SIZE, 0, 0,
+			NULL, NULL, my_obj_init, NULL,
+			SOCKET_ID_ANY, 0, ops_name);
+	if (mp_stack == NULL)
+		return -1;
+
+	snprintf(name, sizeof(name), "test_%s_cache", ops_name);
+	mp_stack_cache = rte_mempool_lookup(name);
+	if (mp_stack_cache == NULL)
+		mp_stack_cache = rte_mempool_create_with_ops(name,
+			MEMPOOL_SIZE, MEMPOOL_ELT_SIZE,
+			RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+			NULL, NULL, my_obj_init, NULL,
+			SOCKET_ID_ANY, 0, ops_name);
+	if (mp_stack_cache == NULL)
+		return -1;
+
+	mp = mp_stack;
+	if (test_mempool_basic() < 0)
+		return -1;
+
+	mp = mp_stack_cache;
+	if (test_mempool_basic() < 0)
+		return -1;
+
+	if (test_mempool_basic_ex(mp_stack) < 0)
+		return -1;
+
+	/* the last freed object is the first one given back */
+	if (rte_mempool_get(mp_stack, &obj) < 0)
+		return -1;
+	if (rte_mempool_get(mp_stack, &obj2) < 0) {
+		rte_mempool_put(mp_stack, obj);
+		return -1;
+	}
+	rte_mempool_put(mp_stack, obj2);
+	rte_mempool_put(mp_stack, obj);
+	if (rte_mempool_get(mp_stack, &obj2) < 0)
+		return -1;
+	rte_mempool_put(mp_stack, obj2);
+	if (obj2 != obj) {
+		printf("%s mempool is not LIFO\n", ops_name);
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
+/*
+ * Check the selection and the registration of pool handlers, and run
+ * the basic tests on mempools using the stack handlers.
+ */
+static int
+test_mempool_ops(void)
+{
+	struct rte_mempool_ops dup_ops;
+	struct rte_mempool *mp_inval;
+	int idx;
+
+	/* the default handler is a ring matching the creation flags */
+	if (strcmp(rte_mempool_get_ops(mp_nocache->ops_index)->name,
+			"ring_mp_mc") != 0) {
+		printf("default mempool ops is not ring_mp_mc\n");
+		return -1;
+	}
+	if (rte_mempool_ops_lookup("ring_sp_sc") < 0) {
+		printf("built-in mempool ops are not registered\n");
+		return -1;
+	}
+
+	/* an unknown handler is rejected */
+	mp_inval = rte_mempool_create_with_ops("test_ops_inval", MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE, 0, 0, NULL, NULL, NULL, NULL,
+		SOCKET_ID_ANY, 0, "no_such_ops");
+	if (mp_inval != NULL || rte_errno != EINVAL) {
+		printf("mempool created with an unknown ops\n");
+		return -1;
+	}
+
+	/* a handler cannot be registered twice */
+	idx = rte_mempool_ops_lookup("ring_mp_mc");
+	dup_ops = *rte_mempool_get_ops(idx);
+	if (rte_mempool_register_ops(&dup_ops) != -EEXIST) {
+		printf("mempool ops registered twice\n");
+		return -1;
+	}
+
+#ifdef RTE_LIBRTE_STACK
+	if (test_mempool_stack_ops("stack") < 0)
+		return -1;
+#ifdef RTE_ARCH_X86_64
+	if (test_mempool_stack_ops("lf_stack") < 0)
+		return -1;
+#endif
+#endif
+
+	return 0;
+}
+
 static int
 test_mempool(void)
 {
@@ -516,6 +1002,24 @@ test_mempool(void)
 	if (test_mempool_xmem_misc() < 0)
 		return -1;
 
+	if (test_mempool_lcore_arrays() < 0)
+		return -1;
+
+	if (test_mempool_user_cache(mp_nocache) < 0)
+		return -1;
+
+	if (test_mempool_attached_cache(mp_nocache) < 0)
+		return -1;
+
+	if (test_mempool_adaptive_cache() < 0)
+		return -1;
+
+	if (test_mempool_stats() < 0)
+		return -1;
+
+	if (test_mempool_ops() < 0)
+		return -1;
+
 	rte_mempool_list_dump(stdout);
 
 	return 0;
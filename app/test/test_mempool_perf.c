@@ -88,6 +88,14 @@
  *
  *      - 32
  *      - 128
+ *
+ *    Then, the pool handlers (*ops_tab*) are compared with the same
+ *    sequence, for several cache sizes (*cache_tab*), on one core, two
+ *    cores and max. cores (one core only for the single producer /
+ *    single consumer ring), for two bulk configurations:
+ *
+ *      - n_get_bulk = n_put_bulk = 1, n_keep = 32
+ *      - n_get_bulk = n_put_bulk = 32, n_keep = 128
  */
 
 #define N 65536
@@ -99,6 +107,19 @@
 static struct rte_mempool *mp;
 static struct rte_mempool *mp_cache, *mp_nocache;
 
+/* pool handlers and cache sizes compared by test_mempool_ops_perf() */
+static const char * const ops_tab[] = {
+	"ring_mp_mc", "ring_sp_sc",
+#ifdef RTE_LIBRTE_STACK
+	"stack",
+#ifdef RTE_ARCH_X86_64
+	"lf_stack",
+#endif
+#endif
+};
+static const unsigned cache_tab[] = { 0, 32, RTE_MEMPOOL_CACHE_MAX_SIZE };
+static struct rte_mempool *mp_ops[RTE_DIM(ops_tab)][RTE_DIM(cache_tab)];
+
 static rte_atomic32_t synchro;
 
 /* number of objects in one bulk operation (get or put) */
@@ -161,7 +182,6 @@ per_lcore_mempool_test(__attribute__((unused)) void *arg)
 							   n_get_bulk);
 				if (unlikely(ret < 0)) {
 					rte_mempool_dump(stdout, mp);
-					rte_ring_dump(stdout, mp->ring);
 					/* in this case, objects are lost... */
 					return -1;
 				}
@@ -198,8 +218,9 @@ launch_cores(unsigned cores)
 	/* reset stats */
 	memset(stats, 0, sizeof(stats));
 
-	printf("mempool_autotest cache=%u cores=%u n_get_bulk=%u "
+	printf("mempool_autotest ops=%s cache=%u cores=%u n_get_bulk=%u "
 	       "n_put_bulk=%u n_keep=%u ",
+	       rte_mempool_get_ops(mp->ops_index)->name,
 	       (unsigned) mp->cache_size, cores, n_get_bulk, n_put_bulk, n_keep);
 
 	if (rte_mempool_count(mp) != MEMPOOL_SIZE) {
@@ -272,6 +293,58 @@ do_one_mempool_test(unsigned cores)
 	return 0;
 }
 
+/* compare the pool handlers for several cache sizes and core counts */
+static int
+test_mempool_ops_perf(void)
+{
+	unsigned bulk_tab[][3] = { /* n_get_bulk, n_put_bulk, n_keep */
+		{ 1, 1, 32 },
+		{ 32, 32, 128 },
+	};
+	unsigned cores_tab[] = { 1, 2, rte_lcore_count() };
+	char name[RTE_MEMPOOL_NAMESIZE];
+	unsigned i, j, k, b;
+
+	printf("start pool handlers comparison\n");
+
+	for (i = 0; i < RTE_DIM(ops_tab); i++) {
+		for (j = 0; j < RTE_DIM(cache_tab); j++) {
+			if (mp_ops[i][j] == NULL) {
+				snprintf(name, sizeof(name), "perf_%s_%u",
+					 ops_tab[i], cache_tab[j]);
+				mp_ops[i][j] = rte_mempool_create_with_ops(
+					name, MEMPOOL_SIZE, MEMPOOL_ELT_SIZE,
+					cache_tab[j], 0, NULL, NULL,
+					my_obj_init, NULL, SOCKET_ID_ANY, 0,
+					ops_tab[i]);
+			}
+			if (mp_ops[i][j] == NULL)
+				return -1;
+			mp = mp_ops[i][j];
+
+			for (k = 0; k < RTE_DIM(cores_tab); k++) {
+				/* skip duplicated core counts */
+				if (k > 0 && cores_tab[k] <= cores_tab[k - 1])
+					continue;
+				/* the sp/sc ring is not multi-thread safe */
+				if (cores_tab[k] > 1 &&
+				    strcmp(ops_tab[i], "ring_sp_sc") == 0)
+					continue;
+
+				for (b = 0; b < RTE_DIM(bulk_tab); b++) {
+					n_get_bulk = bulk_tab[b][0];
+					n_put_bulk = bulk_tab[b][1];
+					n_keep = bulk_tab[b][2];
+					if (launch_cores(cores_tab[k]) < 0)
+						return -1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
 static int
 test_mempool_perf(void)
 {
@@ -324,6 +397,9 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(rte_lcore_count()) < 0)
 		return -1;
 
+	if (test_mempool_ops_perf() < 0)
+		return -1;
+
 	rte_mempool_list_dump(stdout);
 
 	return 0;
@@ -0,0 +1,205 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_memory.h>
+#include <rte_metrics.h>
+
+#include "test.h"
+
+#define NB_UPDATES 1000
+#define TEST_PORT 3
+
+static int update_key;
+
+/* get the value of a metric of an owner, UINT64_MAX if not found */
+static uint64_t
+get_value(int port_id, int key)
+{
+	struct rte_metric_value values[RTE_METRICS_MAX_METRICS];
+	int i, n;
+
+	n = rte_metrics_get_values(port_id, values, RTE_METRICS_MAX_METRICS);
+	for (i = 0; i < n; i++)
+		if (values[i].key == key)
+			return values[i].value;
+	return UINT64_MAX;
+}
+
+static int
+test_metrics_reg(void)
+{
+	static const char * const names[] = {
+		"test_reg_rx", "test_reg_tx", "test_reg_drop",
+	};
+	char long_name[RTE_METRICS_MAX_NAME_LEN + 1];
+	int key, key2, first;
+
+	key = rte_metrics_reg_name("test_reg", RTE_METRICS_GLOBAL);
+	TEST_ASSERT(key >= 0, "Cannot register metric: %d", key);
+
+	key2 = rte_metrics_reg_name("test_reg", RTE_METRICS_GLOBAL);
+	TEST_ASSERT_EQUAL(key, key2, "Metric registered twice");
+
+	key2 = rte_metrics_reg_name("test_reg", TEST_PORT);
+	TEST_ASSERT(key2 >= 0 && key2 != key,
+		"Port metric has the key of a global metric");
+
+	memset(long_name, 'a', sizeof(long_name) - 1);
+	long_name[sizeof(long_name) - 1] = '\0';
+	TEST_ASSERT_EQUAL(rte_metrics_reg_name(long_name, RTE_METRICS_GLOBAL),
+		-EINVAL, "Too long name registered");
+
+	first = rte_metrics_reg_names(names, RTE_DIM(names), TEST_PORT);
+	TEST_ASSERT(first > key2, "Cannot register metrics: %d", first);
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(NULL, 0), first + 3,
+		"Metrics not registered with consecutive keys");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_metrics_get(void)
+{
+	struct rte_metric_name names[RTE_METRICS_MAX_METRICS];
+	struct rte_metric_value values[RTE_METRICS_MAX_METRICS];
+	int key, cnt, i, n;
+
+	key = rte_metrics_reg_name("test_get", TEST_PORT);
+	TEST_ASSERT(key >= 0, "Cannot register metric: %d", key);
+	rte_metrics_set(key, 42);
+
+	cnt = rte_metrics_get_names(NULL, 0);
+	TEST_ASSERT(cnt > key, "Wrong number of metrics: %d", cnt);
+	memset(names, 0, sizeof(names));
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(names, cnt - 1), cnt,
+		"Wrong number of metrics with a small array");
+	TEST_ASSERT_EQUAL(names[0].name[0], '\0',
+		"Small array filled with names");
+	TEST_ASSERT_EQUAL(rte_metrics_get_names(names, cnt), cnt,
+		"Wrong number of metrics");
+	TEST_ASSERT(strcmp(names[key].name, "test_get") == 0 &&
+		names[key].port_id == TEST_PORT, "Wrong metric name");
+
+	n = rte_metrics_get_values(TEST_PORT, values, RTE_DIM(values));
+	TEST_ASSERT(n > 0 && n < cnt, "Wrong number of port metrics: %d", n);
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_EQUAL(names[values[i].key].port_id, TEST_PORT,
+			"Metric of another owner returned");
+	TEST_ASSERT_EQUAL(get_value(TEST_PORT, key), 42, "Wrong metric value");
+	TEST_ASSERT_EQUAL(get_value(RTE_METRICS_GLOBAL, key), UINT64_MAX,
+		"Port metric returned as global metric");
+
+	return TEST_SUCCESS;
+}
+
+static int
+update_lcore(__attribute__((unused)) void *arg)
+{
+	unsigned i;
+
+	for (i = 0; i < NB_UPDATES; i++)
+		rte_metrics_add(update_key, 1);
+	return 0;
+}
+
+static void *
+update_thread(__attribute__((unused)) void *arg)
+{
+	update_lcore(NULL);
+	return NULL;
+}
+
+static int
+test_metrics_update(void)
+{
+	pthread_t thread;
+	uint64_t before;
+
+	update_key = rte_metrics_reg_name("test_update", RTE_METRICS_GLOBAL);
+	TEST_ASSERT(update_key >= 0, "Cannot register metric: %d", update_key);
+	before = get_value(RTE_METRICS_GLOBAL, update_key);
+
+	/* each lcore in its own shard */
+	rte_eal_mp_remote_launch(update_lcore, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	TEST_ASSERT_EQUAL(get_value(RTE_METRICS_GLOBAL, update_key) - before,
+		(uint64_t)NB_UPDATES * rte_lcore_count(),
+		"Wrong sum of lcore shards");
+
+	/* non-EAL thread in the shared shard */
+	before = get_value(RTE_METRICS_GLOBAL, update_key);
+	TEST_ASSERT_SUCCESS(pthread_create(&thread, NULL, update_thread, NULL),
+		"Cannot create thread");
+	pthread_join(thread, NULL);
+	TEST_ASSERT_EQUAL(get_value(RTE_METRICS_GLOBAL, update_key) - before,
+		NB_UPDATES, "Wrong value of non-EAL thread shard");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_setup(void)
+{
+	return rte_metrics_init(SOCKET_ID_ANY);
+}
+
+static struct unit_test_suite metrics_test_suite  = {
+	.setup = test_setup,
+	.suite_name = "Metrics Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_metrics_reg),
+		TEST_CASE(test_metrics_get),
+		TEST_CASE(test_metrics_update),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_metrics(void)
+{
+	return unit_test_suite_runner(&metrics_test_suite);
+}
+
+static struct test_command metrics_cmd = {
+	.command = "metrics_autotest",
+	.callback = test_metrics,
+};
+REGISTER_TEST_COMMAND(metrics_cmd);
@@ -394,9 +394,8 @@ measure_rxtx(struct lcore_conf *conf,
 			nb_tx = rte_eth_tx_burst(portid, 0, pkts_burst, nb_rx);
 			if (unlikely(nb_tx < nb_rx)) {
 				drop += (nb_rx - nb_tx);
-				do {
-					rte_pktmbuf_free(pkts_burst[nb_tx]);
-				} while (++nb_tx < nb_rx);
+				rte_pktmbuf_free_bulk(&pkts_burst[nb_tx],
+						      nb_rx - nb_tx);
 			}
 		}
 		if (unlikely(count >= total_pkts))
@@ -434,9 +433,8 @@ measure_rxonly(struct lcore_conf *conf,
 			nb_tx = rte_eth_tx_burst(portid, 0, pkts_burst, nb_rx);
 			if (unlikely(nb_tx < nb_rx)) {
 				drop += (nb_rx - nb_tx);
-				do {
-					rte_pktmbuf_free(pkts_burst[nb_tx]);
-				} while (++nb_tx < nb_rx);
+				rte_pktmbuf_free_bulk(&pkts_burst[nb_tx],
+						      nb_rx - nb_tx);
 			}
 		}
 		if (unlikely(count >= total_pkts))
@@ -472,9 +470,8 @@ measure_txonly(struct lcore_conf *conf,
 			nb_tx = rte_eth_tx_burst(portid, 0, pkts_burst, nb_rx);
 			if (unlikely(nb_tx < nb_rx)) {
 				drop += (nb_rx - nb_tx);
-				do {
-					rte_pktmbuf_free(pkts_burst[nb_tx]);
-				} while (++nb_tx < nb_rx);
+				rte_pktmbuf_free_bulk(&pkts_burst[nb_tx],
+						      nb_rx - nb_tx);
 			}
 			diff_tsc += rte_rdtsc() - cur_tsc;
 		}
@@ -539,9 +536,7 @@ main_loop(__rte_unused void *args)
 		do { /* dry out */
 			nb_rx = rte_eth_rx_burst((uint8_t) portid, 0,
 						 pkts_burst, MAX_PKT_BURST);
-			nb_tx = 0;
-			while (nb_tx < nb_rx)
-				rte_pktmbuf_free(pkts_burst[nb_tx++]);
+			rte_pktmbuf_free_bulk(pkts_burst, nb_rx);
 			nb_free -= nb_rx;
 		} while (nb_free != 0);
 		printf("free %d mbuf left in port %u\n", pkt_per_port, portid);
@@ -553,6 +548,8 @@ main_loop(__rte_unused void *args)
 	printf("%"PRIu64" packet, %"PRIu64" drop, %"PRIu64" idle\n",
 	       count, drop, idle);
 	printf("Result: %"PRIu64" cycles per packet\n", diff_tsc / count);
+	printf("Result: %.2f Mpps\n",
+	       (double)count * rte_get_tsc_hz() / diff_tsc / 1E6);
 
 	return 0;
 }
@@ -621,8 +618,7 @@ timeout:
 
 	/* clean up */
 	total = pkt_per_port * conf->nb_ports - total;
-	for (i = 0; i < total; i++)
-		rte_pktmbuf_free(pkts_burst[i]);
+	rte_pktmbuf_free_bulk(pkts_burst, total);
 
 	rte_free(pkts_burst);
 
@@ -682,6 +678,8 @@ exec_burst(uint32_t flags, int lcore)
 	}
 
 	printf("Result: %d cycles per packet\n", diff_tsc);
+	printf("Result: %.2f Mpps\n",
+	       (double)rte_get_tsc_hz() / RTE_MAX(diff_tsc, 1) / 1E6);
 
 	return 0;
 }
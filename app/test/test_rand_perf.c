@@ -0,0 +1,226 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_random.h>
+
+#include "test.h"
+
+/*
+ * Random number generator performance test
+ * =========================================
+ *
+ * Measures the cycles per 64-bit value of the previous lrand48() based
+ * generator, which shares one locked state between all threads, and of
+ * rte_rand() and rte_rand_bulk(), which use one state per lcore. The
+ * measure is repeated on 1 to N lcores running concurrently.
+ */
+
+#define ITERATIONS (1 << 20)
+#define BULK_SIZE 32
+
+enum rand_type {
+	RAND_LEGACY,
+	RAND_SINGLE,
+	RAND_BULK,
+	RAND_MAX_BOUNDED,
+	RAND_TYPE_NUM
+};
+
+static const char * const rand_type_names[RAND_TYPE_NUM] = {
+	[RAND_LEGACY] = "lrand48 x2",
+	[RAND_SINGLE] = "rte_rand",
+	[RAND_BULK] = "rte_rand_bulk",
+	[RAND_MAX_BOUNDED] = "rte_rand_max",
+};
+
+static rte_atomic32_t synchro;
+static uint64_t lcore_cycles[RTE_MAX_LCORE];
+static uint64_t lcore_sum[RTE_MAX_LCORE];
+
+/* what rte_rand() used to be */
+static inline uint64_t
+legacy_rand(void)
+{
+	uint64_t val;
+
+	val = lrand48();
+	val <<= 32;
+	val += lrand48();
+	return val;
+}
+
+static int
+rand_perf_lcore(void *arg)
+{
+	enum rand_type type = *(enum rand_type *)arg;
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t vals[BULK_SIZE];
+	uint64_t sum = 0, start;
+	unsigned int i, j;
+
+	/* wait synchro for slaves */
+	if (lcore_id != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			;
+
+	start = rte_rdtsc();
+	switch (type) {
+	case RAND_LEGACY:
+		for (i = 0; i < ITERATIONS; i++)
+			sum += legacy_rand();
+		break;
+	case RAND_SINGLE:
+		for (i = 0; i < ITERATIONS; i++)
+			sum += rte_rand();
+		break;
+	case RAND_BULK:
+		for (i = 0; i < ITERATIONS; i += BULK_SIZE) {
+			rte_rand_bulk(vals, BULK_SIZE);
+			for (j = 0; j < BULK_SIZE; j++)
+				sum += vals[j];
+		}
+		break;
+	default:
+		for (i = 0; i < ITERATIONS; i++)
+			sum += rte_rand_max(1000);
+		break;
+	}
+	lcore_cycles[lcore_id] = rte_rdtsc() - start;
+	lcore_sum[lcore_id] = sum;
+
+	return 0;
+}
+
+/* run one generator on the master and the first nb_lcores - 1 slaves */
+static double
+rand_perf_run(enum rand_type type, unsigned int nb_lcores)
+{
+	unsigned int lcore_id, n = 1;
+	uint64_t cycles;
+
+	rte_atomic32_set(&synchro, 0);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n++ >= nb_lcores)
+			break;
+		rte_eal_remote_launch(rand_perf_lcore, &type, lcore_id);
+	}
+
+	rte_atomic32_set(&synchro, 1);
+	rand_perf_lcore(&type);
+	rte_eal_mp_wait_lcore();
+
+	cycles = lcore_cycles[rte_get_master_lcore()];
+	n = 1;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n++ >= nb_lcores)
+			break;
+		cycles += lcore_cycles[lcore_id];
+	}
+
+	return (double)cycles / ((double)ITERATIONS * nb_lcores);
+}
+
+static int
+test_rand_values(void)
+{
+	static const uint64_t bounds[] = {
+		0, 1, 2, 3, 1000, 1ULL << 32, (1ULL << 63) + 1, UINT64_MAX
+	};
+	uint64_t bulk[BULK_SIZE], val;
+	unsigned int i, j;
+
+	/* same seed, same sequence, whether generated in bulk or not */
+	rte_srand(0x1234);
+	rte_rand_bulk(bulk, BULK_SIZE);
+	rte_srand(0x1234);
+	for (i = 0; i < BULK_SIZE; i++) {
+		if (rte_rand() != bulk[i]) {
+			printf("rte_rand() sequence differs at %u\n", i);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < RTE_DIM(bounds); i++) {
+		for (j = 0; j < 1000; j++) {
+			val = rte_rand_max(bounds[i]);
+			if (bounds[i] < 2 ? val != 0 : val >= bounds[i]) {
+				printf("rte_rand_max(%"PRIu64") returned %"PRIu64"\n",
+				       bounds[i], val);
+				return -1;
+			}
+		}
+	}
+
+	rte_srand(rte_rdtsc());
+	return 0;
+}
+
+static int
+test_rand_perf(void)
+{
+	unsigned int type, nb_lcores;
+
+	if (test_rand_values() < 0)
+		return -1;
+
+	printf("\nCycles per 64-bit value, average over the lcores\n");
+	printf("%8s", "lcores");
+	for (type = 0; type < RAND_TYPE_NUM; type++)
+		printf(" %14s", rand_type_names[type]);
+	printf("\n");
+
+	for (nb_lcores = 1; nb_lcores <= rte_lcore_count(); nb_lcores++) {
+		printf("%8u", nb_lcores);
+		for (type = 0; type < RAND_TYPE_NUM; type++)
+			printf(" %14.1f", rand_perf_run(type, nb_lcores));
+		printf("\n");
+	}
+
+	return 0;
+}
+
+static struct test_command rand_perf_cmd = {
+	.command = "rand_perf_autotest",
+	.callback = test_rand_perf,
+};
+REGISTER_TEST_COMMAND(rand_perf_cmd);
@@ -0,0 +1,392 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+#define TEST_MAX_THREADS 128
+#define NB_UPDATES 200
+#define DQ_SIZE 16
+#define ELEM_MAGIC 0x5a5a5a5a
+
+struct test_elem {
+	volatile uint32_t magic;
+};
+
+static struct rte_rcu_qsbr *v;
+static struct test_elem *volatile shared_elem;
+static volatile int readers_stop;
+static volatile int reader_error;
+static unsigned int nb_freed;
+
+static struct test_elem *
+elem_alloc(void)
+{
+	struct test_elem *e = rte_malloc(NULL, sizeof(*e), 0);
+
+	if (e != NULL)
+		e->magic = ELEM_MAGIC;
+	return e;
+}
+
+/* poison the element before freeing it, so that late readers see it */
+static void
+elem_free(void *p, void *e)
+{
+	RTE_SET_USED(p);
+	((struct test_elem *)e)->magic = 0;
+	rte_free(e);
+	nb_freed++;
+}
+
+static int
+test_rcu_qsbr_reader(void *arg)
+{
+	unsigned int id = rte_lcore_id();
+	struct test_elem *e;
+
+	RTE_SET_USED(arg);
+
+	rte_rcu_qsbr_thread_register(v, id);
+	rte_rcu_qsbr_thread_online(v, id);
+	while (!readers_stop) {
+		e = shared_elem;
+		if (e->magic != ELEM_MAGIC)
+			reader_error = 1;
+		rte_rcu_qsbr_quiescent(v, id);
+	}
+	rte_rcu_qsbr_thread_offline(v, id);
+	rte_rcu_qsbr_thread_unregister(v, id);
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_memsize(void)
+{
+	size_t sz;
+
+	rte_errno = 0;
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_get_memsize(0), 1,
+		"Memory size of 0 threads");
+	TEST_ASSERT_EQUAL(rte_errno, EINVAL, "Wrong rte_errno");
+
+	sz = rte_rcu_qsbr_get_memsize(1);
+	TEST_ASSERT(sz >= sizeof(struct rte_rcu_qsbr) +
+		sizeof(struct rte_rcu_qsbr_cnt), "Memory size too small");
+	TEST_ASSERT_EQUAL(sz % RTE_CACHE_LINE_SIZE, 0,
+		"Memory size not aligned");
+	TEST_ASSERT(rte_rcu_qsbr_get_memsize(TEST_MAX_THREADS) > sz,
+		"Memory size not growing with threads");
+
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_init(NULL, 1), -EINVAL,
+		"NULL variable initialized");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_init(v, 0), -EINVAL,
+		"Variable of 0 threads initialized");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rcu_qsbr_register(void)
+{
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_init(v, TEST_MAX_THREADS),
+		"Cannot init variable");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_thread_register(v, TEST_MAX_THREADS),
+		-EINVAL, "Invalid thread registered");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 0),
+		"Cannot register thread");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 0),
+		"Cannot register thread twice");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 65),
+		"Cannot register thread of second word");
+	TEST_ASSERT_EQUAL(v->num_threads, 2, "Wrong number of threads");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 0),
+		"Cannot unregister thread");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 65),
+		"Cannot unregister thread");
+	TEST_ASSERT_EQUAL(v->num_threads, 0, "Wrong number of threads");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_thread_unregister(v, TEST_MAX_THREADS),
+		-EINVAL, "Invalid thread unregistered");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rcu_qsbr_check(void)
+{
+	uint64_t t;
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_init(v, TEST_MAX_THREADS),
+		"Cannot init variable");
+
+	/* no reader */
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over without readers");
+
+	/* offline readers are not waited for */
+	rte_rcu_qsbr_thread_register(v, 1);
+	rte_rcu_qsbr_thread_register(v, 100);
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over with offline readers");
+
+	/* online readers are */
+	rte_rcu_qsbr_thread_online(v, 1);
+	rte_rcu_qsbr_thread_online(v, 100);
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 0,
+		"Grace period over without quiescent state");
+	rte_rcu_qsbr_quiescent(v, 1);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 0,
+		"Grace period over without all quiescent states");
+	rte_rcu_qsbr_quiescent(v, 100);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over after quiescent states");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 1), 1,
+		"Grace period not over");
+
+	/* a reader going offline ends the grace period */
+	t = rte_rcu_qsbr_start(v);
+	rte_rcu_qsbr_quiescent(v, 1);
+	rte_rcu_qsbr_thread_offline(v, 100);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over after offline");
+
+	/* the writer does not wait for itself */
+	rte_rcu_qsbr_synchronize(v, 1);
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dump(stdout, v), "Cannot dump");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_dump(NULL, v), -EINVAL,
+		"Dumped to NULL");
+
+	rte_rcu_qsbr_thread_offline(v, 1);
+	rte_rcu_qsbr_thread_unregister(v, 1);
+	rte_rcu_qsbr_thread_unregister(v, 100);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rcu_qsbr_dq(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq;
+	unsigned int i, freed, pending;
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_init(v, TEST_MAX_THREADS),
+		"Cannot init variable");
+
+	memset(&params, 0, sizeof(params));
+	params.name = "test_dq";
+	params.socket_id = SOCKET_ID_ANY;
+	params.size = DQ_SIZE;
+	params.trigger_reclaim_limit = DQ_SIZE;
+	params.free_fn = elem_free;
+	params.v = v;
+
+	params.size = 0;
+	TEST_ASSERT_NULL(rte_rcu_qsbr_dq_create(&params),
+		"Defer queue of size 0 created");
+	TEST_ASSERT_EQUAL(rte_errno, EINVAL, "Wrong rte_errno");
+	params.size = DQ_SIZE;
+	params.free_fn = NULL;
+	TEST_ASSERT_NULL(rte_rcu_qsbr_dq_create(&params),
+		"Defer queue without free function created");
+	params.free_fn = elem_free;
+
+	dq = rte_rcu_qsbr_dq_create(&params);
+	TEST_ASSERT_NOT_NULL(dq, "Cannot create defer queue");
+
+	/* a reader which does not report quiescent states blocks frees */
+	rte_rcu_qsbr_thread_register(v, 0);
+	rte_rcu_qsbr_thread_online(v, 0);
+	nb_freed = 0;
+	for (i = 0; i < DQ_SIZE; i++)
+		TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_enqueue(dq, elem_alloc()),
+			"Cannot enqueue");
+	TEST_ASSERT_EQUAL(nb_freed, 0, "Element freed while in use");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_dq_enqueue(dq, shared_elem),
+		-ENOSPC, "Enqueued to a full queue");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_reclaim(dq, DQ_SIZE, &freed,
+		&pending), "Cannot reclaim");
+	TEST_ASSERT_EQUAL(freed, 0, "Element freed while in use");
+	TEST_ASSERT_EQUAL(pending, DQ_SIZE, "Wrong pending count");
+
+	/* after a quiescent state, a full queue is reclaimed on enqueue */
+	rte_rcu_qsbr_quiescent(v, 0);
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_enqueue(dq, elem_alloc()),
+		"Cannot enqueue after reclaim");
+	TEST_ASSERT_EQUAL(nb_freed, DQ_SIZE, "Elements not freed");
+
+	/* explicit reclaim, bounded */
+	rte_rcu_qsbr_dq_enqueue(dq, elem_alloc());
+	rte_rcu_qsbr_quiescent(v, 0);
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_reclaim(dq, 1, &freed, &pending),
+		"Cannot reclaim");
+	TEST_ASSERT_EQUAL(freed, 1, "Wrong freed count");
+	TEST_ASSERT_EQUAL(pending, 1, "Wrong pending count");
+
+	/* delete frees the remaining elements */
+	rte_rcu_qsbr_thread_offline(v, 0);
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_delete(dq),
+		"Cannot delete defer queue");
+	TEST_ASSERT_EQUAL(nb_freed, DQ_SIZE + 2, "Elements not freed");
+	rte_rcu_qsbr_thread_unregister(v, 0);
+
+	return TEST_SUCCESS;
+}
+
+/* readers on the slave lcores, the master lcore replaces the element */
+static int
+test_rcu_qsbr_mt(int use_dq)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq = NULL;
+	struct test_elem *old;
+	unsigned int i;
+
+	if (rte_lcore_count() < 2) {
+		printf("At least 2 lcores are needed, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_init(v, TEST_MAX_THREADS),
+		"Cannot init variable");
+	if (use_dq) {
+		memset(&params, 0, sizeof(params));
+		params.name = "test_dq_mt";
+		params.socket_id = SOCKET_ID_ANY;
+		params.size = DQ_SIZE;
+		params.free_fn = elem_free;
+		params.v = v;
+		dq = rte_rcu_qsbr_dq_create(&params);
+		TEST_ASSERT_NOT_NULL(dq, "Cannot create defer queue");
+	}
+
+	nb_freed = 0;
+	readers_stop = 0;
+	reader_error = 0;
+	rte_eal_mp_remote_launch(test_rcu_qsbr_reader, NULL, SKIP_MASTER);
+
+	for (i = 0; i < NB_UPDATES; i++) {
+		old = shared_elem;
+		shared_elem = elem_alloc();
+		if (use_dq) {
+			while (rte_rcu_qsbr_dq_enqueue(dq, old) == -ENOSPC)
+				rte_pause();
+		} else {
+			rte_rcu_qsbr_synchronize(v, RTE_QSBR_THRID_INVALID);
+			elem_free(NULL, old);
+		}
+	}
+
+	readers_stop = 1;
+	rte_eal_mp_wait_lcore();
+	rte_rcu_qsbr_dq_delete(dq);
+
+	TEST_ASSERT(!reader_error, "Reader accessed a freed element");
+	TEST_ASSERT_EQUAL(nb_freed, NB_UPDATES, "Elements not freed");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rcu_qsbr_mt_synchronize(void)
+{
+	return test_rcu_qsbr_mt(0);
+}
+
+static int
+test_rcu_qsbr_mt_dq(void)
+{
+	return test_rcu_qsbr_mt(1);
+}
+
+static int
+test_setup(void)
+{
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(TEST_MAX_THREADS),
+		RTE_CACHE_LINE_SIZE);
+	shared_elem = elem_alloc();
+	if (v == NULL || shared_elem == NULL)
+		return -1;
+	return 0;
+}
+
+static void
+test_teardown(void)
+{
+	rte_free(v);
+	rte_free(shared_elem);
+}
+
+static struct unit_test_suite rcu_qsbr_test_suite  = {
+	.setup = test_setup,
+	.teardown = test_teardown,
+	.suite_name = "RCU QSBR Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_rcu_qsbr_memsize),
+		TEST_CASE(test_rcu_qsbr_register),
+		TEST_CASE(test_rcu_qsbr_check),
+		TEST_CASE(test_rcu_qsbr_dq),
+		TEST_CASE(test_rcu_qsbr_mt_synchronize),
+		TEST_CASE(test_rcu_qsbr_mt_dq),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_rcu_qsbr(void)
+{
+	return unit_test_suite_runner(&rcu_qsbr_test_suite);
+}
+
+static struct test_command rcu_qsbr_cmd = {
+	.command = "rcu_qsbr_autotest",
+	.callback = test_rcu_qsbr,
+};
+REGISTER_TEST_COMMAND(rcu_qsbr_cmd);
@@ -0,0 +1,152 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+/*
+ * RCU QSBR performance test
+ * =========================
+ *
+ * Measure the cost of rte_rcu_qsbr_quiescent() for the readers, with no
+ * writer and while the master lcore keeps starting grace periods and
+ * waiting for them with rte_rcu_qsbr_synchronize().
+ */
+
+#define NB_QUIESCENT (1 << 24)
+
+static struct rte_rcu_qsbr *v;
+static volatile int readers_stop;
+static rte_atomic32_t readers_done;
+static uint64_t reader_cycles[RTE_MAX_LCORE];
+
+static int
+test_rcu_qsbr_perf_reader(void *arg)
+{
+	unsigned int id = rte_lcore_id();
+	uint64_t begin;
+	unsigned int i;
+
+	RTE_SET_USED(arg);
+
+	rte_rcu_qsbr_thread_register(v, id);
+	rte_rcu_qsbr_thread_online(v, id);
+
+	begin = rte_rdtsc();
+	for (i = 0; i < NB_QUIESCENT; i++)
+		rte_rcu_qsbr_quiescent(v, id);
+	reader_cycles[id] = rte_rdtsc() - begin;
+
+	rte_rcu_qsbr_thread_offline(v, id);
+	rte_rcu_qsbr_thread_unregister(v, id);
+	rte_atomic32_inc(&readers_done);
+
+	return 0;
+}
+
+static void
+print_reader_cycles(const char *title)
+{
+	uint64_t total = 0;
+	unsigned int lcore, n = 0;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore) {
+		total += reader_cycles[lcore];
+		n++;
+	}
+	printf("%s: %.2f cycles per quiescent state (%u readers)\n",
+	       title, (double)total / ((uint64_t)NB_QUIESCENT * n), n);
+}
+
+static int
+test_rcu_qsbr_perf(void)
+{
+	uint64_t begin, cycles, nb_sync = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("At least 2 lcores are needed, skipping\n");
+		return 0;
+	}
+
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+		RTE_CACHE_LINE_SIZE);
+	if (v == NULL) {
+		printf("Cannot allocate QSBR variable\n");
+		return -1;
+	}
+	rte_rcu_qsbr_init(v, RTE_MAX_LCORE);
+
+	/* readers only */
+	rte_atomic32_set(&readers_done, 0);
+	rte_eal_mp_remote_launch(test_rcu_qsbr_perf_reader, NULL,
+		SKIP_MASTER);
+	rte_eal_mp_wait_lcore();
+	print_reader_cycles("No writer");
+
+	/* readers and a writer synchronizing in a loop */
+	rte_atomic32_set(&readers_done, 0);
+	rte_eal_mp_remote_launch(test_rcu_qsbr_perf_reader, NULL,
+		SKIP_MASTER);
+	begin = rte_rdtsc();
+	while ((unsigned int)rte_atomic32_read(&readers_done) <
+			rte_lcore_count() - 1) {
+		rte_rcu_qsbr_synchronize(v, RTE_QSBR_THRID_INVALID);
+		nb_sync++;
+	}
+	cycles = rte_rdtsc() - begin;
+	rte_eal_mp_wait_lcore();
+	print_reader_cycles("Writer synchronizing");
+	printf("Writer: %"PRIu64" grace periods, %"PRIu64" cycles each\n",
+	       nb_sync, nb_sync != 0 ? cycles / nb_sync : 0);
+
+	rte_free(v);
+
+	return 0;
+}
+
+static struct test_command rcu_qsbr_perf_cmd = {
+	.command = "rcu_qsbr_perf_autotest",
+	.callback = test_rcu_qsbr_perf,
+};
+REGISTER_TEST_COMMAND(rcu_qsbr_perf_cmd);
@@ -0,0 +1,408 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_memory.h>
+#include <rte_service.h>
+#include <rte_timer.h>
+
+#include "test.h"
+
+#define WAIT_MS 1000
+
+static rte_atomic32_t service_calls;
+static rte_atomic32_t service_active;
+static volatile int service_overlap;
+
+static int32_t
+counter_service(void *args)
+{
+	RTE_SET_USED(args);
+	rte_atomic32_inc(&service_calls);
+	return 0;
+}
+
+/* fails if called by several lcores at the same time */
+static int32_t
+serial_service(void *args)
+{
+	RTE_SET_USED(args);
+	if (rte_atomic32_add_return(&service_active, 1) != 1)
+		service_overlap = 1;
+	rte_delay_us(10);
+	rte_atomic32_dec(&service_active);
+	rte_atomic32_inc(&service_calls);
+	return 0;
+}
+
+/* runs the timers of the service lcore */
+static int32_t
+timer_service(void *args)
+{
+	RTE_SET_USED(args);
+	rte_timer_manage();
+	return 0;
+}
+
+static void
+timer_cb(struct rte_timer *tim, void *arg)
+{
+	RTE_SET_USED(tim);
+	RTE_SET_USED(arg);
+	rte_atomic32_inc(&service_calls);
+}
+
+static int
+register_service(const char *name, rte_service_func callback,
+		uint32_t capabilities, uint32_t *id)
+{
+	struct rte_service_spec spec;
+
+	memset(&spec, 0, sizeof(spec));
+	snprintf(spec.name, sizeof(spec.name), "%s", name);
+	spec.callback = callback;
+	spec.capabilities = capabilities;
+	spec.socket_id = SOCKET_ID_ANY;
+	return rte_service_component_register(&spec, id);
+}
+
+/* wait until the service is called, return 0 if it is */
+static int
+wait_calls(void)
+{
+	int32_t before = rte_atomic32_read(&service_calls);
+	unsigned i;
+
+	for (i = 0; i < WAIT_MS; i++) {
+		if (rte_atomic32_read(&service_calls) != before)
+			return 0;
+		rte_delay_ms(1);
+	}
+	return -1;
+}
+
+static int
+test_service_reg(void)
+{
+	struct rte_service_spec spec;
+	uint32_t id, id2, count;
+
+	count = rte_service_get_count();
+	TEST_ASSERT_SUCCESS(register_service("test_reg", counter_service, 0,
+		&id), "Cannot register service");
+	TEST_ASSERT_EQUAL(rte_service_get_count(), count + 1,
+		"Wrong service count");
+	TEST_ASSERT_EQUAL(register_service("test_reg", counter_service, 0,
+		&id2), -EEXIST, "Duplicate name registered");
+	TEST_ASSERT_EQUAL(register_service("test_null", NULL, 0, &id2),
+		-EINVAL, "Service without callback registered");
+	memset(&spec, 0, sizeof(spec));
+	spec.callback = counter_service;
+	TEST_ASSERT_EQUAL(rte_service_component_register(&spec, &id2),
+		-EINVAL, "Service without name registered");
+
+	TEST_ASSERT_SUCCESS(rte_service_get_by_name("test_reg", &id2),
+		"Cannot find service");
+	TEST_ASSERT_EQUAL(id, id2, "Wrong service found");
+	TEST_ASSERT_EQUAL(rte_service_get_by_name("test_none", &id2),
+		-ENODEV, "Unknown service found");
+	TEST_ASSERT_SUCCESS(strcmp(rte_service_get_name(id), "test_reg"),
+		"Wrong service name");
+
+	TEST_ASSERT_EQUAL(rte_service_set_weight(id, 0), -EINVAL,
+		"Null weight accepted");
+	TEST_ASSERT_SUCCESS(rte_service_set_weight(id, 8),
+		"Cannot set weight");
+	TEST_ASSERT_EQUAL(rte_service_runstate_set(id, 2), -EINVAL,
+		"Invalid runstate accepted");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_RUNNING), "Cannot start service");
+	TEST_ASSERT_EQUAL(rte_service_runstate_get(id), 0,
+		"Service running without lcore");
+	TEST_ASSERT_EQUAL(rte_service_component_unregister(id), -EBUSY,
+		"Running service unregistered");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_STOPPED), "Cannot stop service");
+	TEST_ASSERT_SUCCESS(rte_service_component_unregister(id),
+		"Cannot unregister service");
+	TEST_ASSERT_EQUAL(rte_service_get_count(), count,
+		"Wrong service count");
+	TEST_ASSERT_NULL(rte_service_get_name(id), "Service still exists");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_service_lcore(void)
+{
+	unsigned lcore = rte_get_next_lcore(-1, 1, 0);
+	unsigned nb_lcores = rte_lcore_count();
+	uint32_t list[RTE_MAX_LCORE];
+	unsigned i;
+
+	if (lcore >= RTE_MAX_LCORE) {
+		printf("At least 2 lcores are needed, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(rte_get_master_lcore()),
+		-EINVAL, "Master lcore used as service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore),
+		"Cannot add service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_add(lcore), -EALREADY,
+		"Service lcore added twice");
+	TEST_ASSERT_EQUAL(rte_lcore_count(), nb_lcores - 1,
+		"Service lcore still counted");
+	TEST_ASSERT(!rte_lcore_is_enabled(lcore),
+		"Service lcore still enabled");
+	RTE_LCORE_FOREACH(i)
+		TEST_ASSERT(i != lcore, "Service lcore in lcore iterator");
+
+	TEST_ASSERT_EQUAL(rte_service_lcore_list(list, RTE_MAX_LCORE),
+		(int)rte_service_lcore_count(), "Wrong service lcore list");
+	for (i = 0; i < rte_service_lcore_count(); i++)
+		if (list[i] == lcore)
+			break;
+	TEST_ASSERT(i < rte_service_lcore_count(),
+		"Service lcore not listed");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore),
+		"Cannot start service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_start(lcore), -EALREADY,
+		"Service lcore started twice");
+	TEST_ASSERT_EQUAL(rte_service_lcore_del(lcore), -EBUSY,
+		"Running service lcore deleted");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_stop(lcore),
+		"Cannot stop service lcore");
+	TEST_ASSERT_EQUAL(rte_service_lcore_stop(lcore), -EALREADY,
+		"Service lcore stopped twice");
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_del(lcore),
+		"Cannot delete service lcore");
+	TEST_ASSERT_EQUAL(rte_lcore_count(), nb_lcores,
+		"Lcore not given back");
+	TEST_ASSERT(rte_lcore_is_enabled(lcore), "Lcore not enabled");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_service_run(void)
+{
+	unsigned lcore = rte_get_next_lcore(-1, 1, 0);
+	uint32_t id;
+	int32_t calls;
+
+	if (lcore >= RTE_MAX_LCORE) {
+		printf("At least 2 lcores are needed, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+	rte_atomic32_init(&service_calls);
+	TEST_ASSERT_SUCCESS(register_service("test_run", counter_service, 0,
+		&id), "Cannot register service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore),
+		"Cannot add service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore, 1),
+		"Cannot map service");
+	TEST_ASSERT_EQUAL(rte_service_map_lcore_get(id, lcore), 1,
+		"Service not mapped");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore),
+		"Cannot start service lcore");
+
+	/* a stopped service is not called */
+	rte_delay_ms(10);
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&service_calls), 0,
+		"Stopped service called");
+
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_RUNNING), "Cannot start service");
+	TEST_ASSERT_EQUAL(rte_service_runstate_get(id), 1,
+		"Service not running");
+	TEST_ASSERT_SUCCESS(wait_calls(), "Service not called");
+
+	/* a heavier service is still called, by bursts of its weight */
+	TEST_ASSERT_SUCCESS(rte_service_set_weight(id, 16),
+		"Cannot set weight");
+	TEST_ASSERT_SUCCESS(wait_calls(), "Weighted service not called");
+
+	/* unmapped from the running lcore */
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore, 0),
+		"Cannot unmap service");
+	TEST_ASSERT_EQUAL(rte_service_runstate_get(id), 0,
+		"Unmapped service running");
+	rte_delay_ms(10);
+	calls = rte_atomic32_read(&service_calls);
+	rte_delay_ms(10);
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&service_calls), calls,
+		"Unmapped service called");
+
+	rte_service_dump(stdout, id);
+
+	TEST_ASSERT_SUCCESS(rte_service_lcore_stop(lcore),
+		"Cannot stop service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_del(lcore),
+		"Cannot delete service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_STOPPED), "Cannot stop service");
+	TEST_ASSERT_SUCCESS(rte_service_component_unregister(id),
+		"Cannot unregister service");
+
+	return TEST_SUCCESS;
+}
+
+/* a service which is not MT-safe is called by one lcore at a time */
+static int
+test_service_serialize(void)
+{
+	unsigned lcores[2];
+	uint32_t id;
+	unsigned i;
+
+	lcores[0] = rte_get_next_lcore(-1, 1, 0);
+	lcores[1] = rte_get_next_lcore(lcores[0], 1, 0);
+	if (lcores[1] >= RTE_MAX_LCORE) {
+		printf("At least 3 lcores are needed, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+	rte_atomic32_init(&service_calls);
+	rte_atomic32_init(&service_active);
+	service_overlap = 0;
+	TEST_ASSERT_SUCCESS(register_service("test_serial", serial_service,
+		0, &id), "Cannot register service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_RUNNING), "Cannot start service");
+	for (i = 0; i < RTE_DIM(lcores); i++) {
+		TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcores[i]),
+			"Cannot add service lcore");
+		TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcores[i],
+			1), "Cannot map service");
+		TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcores[i]),
+			"Cannot start service lcore");
+	}
+
+	rte_delay_ms(100);
+	TEST_ASSERT_SUCCESS(wait_calls(), "Service not called");
+
+	for (i = 0; i < RTE_DIM(lcores); i++) {
+		TEST_ASSERT_SUCCESS(rte_service_lcore_stop(lcores[i]),
+			"Cannot stop service lcore");
+		TEST_ASSERT_SUCCESS(rte_service_lcore_del(lcores[i]),
+			"Cannot delete service lcore");
+	}
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_STOPPED), "Cannot stop service");
+	TEST_ASSERT_SUCCESS(rte_service_component_unregister(id),
+		"Cannot unregister service");
+	TEST_ASSERT(!service_overlap, "Service called by 2 lcores at once");
+
+	return TEST_SUCCESS;
+}
+
+/* a timer armed on a service lcore is run by a service */
+static int
+test_service_timer(void)
+{
+	unsigned lcore = rte_get_next_lcore(-1, 1, 0);
+	struct rte_timer tim;
+	uint32_t id;
+
+	if (lcore >= RTE_MAX_LCORE) {
+		printf("At least 2 lcores are needed, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+	rte_atomic32_init(&service_calls);
+	rte_timer_init(&tim);
+	TEST_ASSERT_SUCCESS(register_service("test_timer", timer_service, 0,
+		&id), "Cannot register service");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_RUNNING), "Cannot start service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_add(lcore),
+		"Cannot add service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(id, lcore, 1),
+		"Cannot map service");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_start(lcore),
+		"Cannot start service lcore");
+
+	TEST_ASSERT_SUCCESS(rte_timer_reset(&tim, rte_get_timer_hz() / 1000,
+		SINGLE, lcore, timer_cb, NULL),
+		"Cannot arm timer on service lcore");
+	TEST_ASSERT_SUCCESS(wait_calls(), "Timer not run");
+
+	rte_timer_stop_sync(&tim);
+	TEST_ASSERT_SUCCESS(rte_service_lcore_stop(lcore),
+		"Cannot stop service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_lcore_del(lcore),
+		"Cannot delete service lcore");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(id,
+		RTE_SERVICE_RUNSTATE_STOPPED), "Cannot stop service");
+	TEST_ASSERT_SUCCESS(rte_service_component_unregister(id),
+		"Cannot unregister service");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite service_test_suite  = {
+	.suite_name = "Service Cores Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_service_reg),
+		TEST_CASE(test_service_lcore),
+		TEST_CASE(test_service_run),
+		TEST_CASE(test_service_serialize),
+		TEST_CASE(test_service_timer),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_service_cores(void)
+{
+	return unit_test_suite_runner(&service_test_suite);
+}
+
+static struct test_command service_cmd = {
+	.command = "service_autotest",
+	.callback = test_service_cores,
+};
+REGISTER_TEST_COMMAND(service_cmd);
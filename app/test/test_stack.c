@@ -0,0 +1,443 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_errno.h>
+#include <rte_atomic.h>
+#include <rte_stack.h>
+
+#include "test.h"
+
+/*
+ * Stack
+ * =====
+ *
+ * The same tests are run on a standard and on a lock-free stack:
+ *
+ *    - Push and pop objects by bulks of 1 to MAX_BULK, checking the LIFO
+ *      order, the counters, and that a full or empty stack rejects a whole
+ *      bulk.
+ *    - Check the creation errors and the lookup.
+ *    - On all lcores, pop and push random bulks of objects; at the end,
+ *      every object must be in the stack exactly once.
+ */
+
+#define STACK_SIZE 4096
+#define MAX_BULK 32
+#define STACK_NAME "test_stack"
+#define NB_MT_ITERATIONS (1 << 16)
+
+static void *obj_table[STACK_SIZE];
+static void *popped_objs[STACK_SIZE];
+
+static int
+test_stack_push_pop(struct rte_stack *s, unsigned int bulk_sz)
+{
+	unsigned int i, j, ret;
+
+	for (i = 0; i < STACK_SIZE / bulk_sz; i++) {
+		ret = rte_stack_push(s, &obj_table[i * bulk_sz], bulk_sz);
+		if (ret != bulk_sz) {
+			printf("[%s():%u] push of %u objects failed\n",
+			       __func__, __LINE__, bulk_sz);
+			return -1;
+		}
+		if (rte_stack_count(s) != (i + 1) * bulk_sz ||
+		    rte_stack_free_count(s) != STACK_SIZE - (i + 1) * bulk_sz) {
+			printf("[%s():%u] invalid stack count\n",
+			       __func__, __LINE__);
+			return -1;
+		}
+	}
+
+	/* a push on a full stack does not push anything */
+	if (STACK_SIZE % bulk_sz == 0 &&
+	    rte_stack_push(s, obj_table, bulk_sz) != 0) {
+		printf("[%s():%u] push on a full stack succeeded\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < STACK_SIZE / bulk_sz; i++) {
+		ret = rte_stack_pop(s, &popped_objs[i * bulk_sz], bulk_sz);
+		if (ret != bulk_sz) {
+			printf("[%s():%u] pop of %u objects failed\n",
+			       __func__, __LINE__, bulk_sz);
+			return -1;
+		}
+	}
+
+	/* the objects are popped in the reverse order of the pushes */
+	for (i = 0, j = (STACK_SIZE / bulk_sz) * bulk_sz - 1;
+	     i < (STACK_SIZE / bulk_sz) * bulk_sz; i++, j--) {
+		if (popped_objs[i] != obj_table[j]) {
+			printf("[%s():%u] objects are not in LIFO order\n",
+			       __func__, __LINE__);
+			return -1;
+		}
+	}
+
+	/* a pop on an empty stack does not pop anything */
+	if (rte_stack_count(s) != 0 ||
+	    rte_stack_pop(s, popped_objs, bulk_sz) != 0) {
+		printf("[%s():%u] pop on an empty stack succeeded\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_stack_basic(uint32_t flags)
+{
+	struct rte_stack *s;
+	unsigned int i;
+	int ret = -1;
+
+	s = rte_stack_create(STACK_NAME, STACK_SIZE, rte_socket_id(), flags);
+	if (s == NULL) {
+		printf("[%s():%u] failed to create a stack\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	if (rte_stack_lookup(STACK_NAME) != s) {
+		printf("[%s():%u] failed to lookup a stack\n",
+		       __func__, __LINE__);
+		goto fail;
+	}
+
+	for (i = 0; i < STACK_SIZE; i++)
+		obj_table[i] = (void *)(uintptr_t)(i + 1);
+
+	for (i = 1; i <= MAX_BULK; i++) {
+		if (test_stack_push_pop(s, i) < 0)
+			goto fail;
+	}
+
+	rte_stack_dump(stdout, s);
+	ret = 0;
+
+fail:
+	rte_stack_free(s);
+
+	return ret;
+}
+
+static int
+test_stack_name_reuse(uint32_t flags)
+{
+	struct rte_stack *s[2];
+
+	s[0] = rte_stack_create("test", STACK_SIZE, rte_socket_id(), flags);
+	if (s[0] == NULL) {
+		printf("[%s():%u] Failed to create a stack\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	s[1] = rte_stack_create("test", STACK_SIZE, rte_socket_id(), flags);
+	if (s[1] != NULL) {
+		printf("[%s():%u] Failed to detect re-used name\n",
+		       __func__, __LINE__);
+		rte_stack_free(s[1]);
+		rte_stack_free(s[0]);
+		return -1;
+	}
+
+	rte_stack_free(s[0]);
+
+	/* the name can be used again once the stack is freed */
+	s[0] = rte_stack_create("test", STACK_SIZE, rte_socket_id(), flags);
+	if (s[0] == NULL) {
+		printf("[%s():%u] Failed to re-create a freed stack\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+	rte_stack_free(s[0]);
+
+	return 0;
+}
+
+static int
+test_stack_name_length(uint32_t flags)
+{
+	char name[RTE_STACK_NAMESIZE + 1];
+	struct rte_stack *s;
+
+	memset(name, 's', sizeof(name));
+	name[RTE_STACK_NAMESIZE] = '\0';
+
+	s = rte_stack_create(name, STACK_SIZE, rte_socket_id(), flags);
+	if (s != NULL || rte_errno != ENAMETOOLONG) {
+		printf("[%s():%u] Failed to prevent long name\n",
+		       __func__, __LINE__);
+		rte_stack_free(s);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_lookup_null(void)
+{
+	struct rte_stack *s = rte_stack_lookup("stack_not_found");
+
+	if (s != NULL || rte_errno != ENOENT) {
+		printf("[%s():%u] rte_stack found a non-existent stack\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	s = rte_stack_lookup(NULL);
+
+	if (s != NULL || rte_errno != EINVAL) {
+		printf("[%s():%u] rte_stack found a NULL name\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_stack_create_errors(uint32_t flags)
+{
+	struct rte_stack *s;
+
+	s = rte_stack_create(STACK_NAME, 0, rte_socket_id(), flags);
+	if (s != NULL || rte_errno != EINVAL) {
+		printf("[%s():%u] created a stack of size 0\n",
+		       __func__, __LINE__);
+		rte_stack_free(s);
+		return -1;
+	}
+
+	/* freeing NULL must not crash */
+	rte_stack_free(NULL);
+
+	if (test_stack_name_reuse(flags) < 0)
+		return -1;
+
+	if (test_stack_name_length(flags) < 0)
+		return -1;
+
+	return test_lookup_null();
+}
+
+/* objects shared by all lcores in the multi-thread test */
+static struct rte_stack *mt_stack;
+static rte_atomic32_t mt_errors;
+
+static int
+stack_thread_push_pop(__attribute__((unused)) void *arg)
+{
+	void *objs[MAX_BULK];
+	unsigned int i, n;
+
+	for (i = 0; i < NB_MT_ITERATIONS; i++) {
+		n = rte_rand_max(MAX_BULK) + 1;
+
+		/* the other lcores may have emptied the stack */
+		if (rte_stack_pop(mt_stack, objs, n) != n)
+			continue;
+
+		if (rte_stack_push(mt_stack, objs, n) != n) {
+			printf("[%s():%u] failed to push %u objects\n",
+			       __func__, __LINE__, n);
+			rte_atomic32_inc(&mt_errors);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_stack_multithreaded(uint32_t flags)
+{
+	uint8_t *seen;
+	unsigned int i;
+	uintptr_t obj;
+	int ret = -1;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for test_stack_multithreaded, "
+		       "expecting at least 2\n");
+		return 0;
+	}
+
+	mt_stack = rte_stack_create(STACK_NAME, STACK_SIZE, rte_socket_id(),
+				    flags);
+	if (mt_stack == NULL) {
+		printf("[%s():%u] failed to create a stack\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	seen = rte_zmalloc(NULL, STACK_SIZE, 0);
+	if (seen == NULL)
+		goto fail;
+
+	for (i = 0; i < STACK_SIZE; i++)
+		obj_table[i] = (void *)(uintptr_t)i;
+	if (rte_stack_push(mt_stack, obj_table, STACK_SIZE) != STACK_SIZE)
+		goto fail;
+
+	rte_atomic32_set(&mt_errors, 0);
+	rte_eal_mp_remote_launch(stack_thread_push_pop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	if (rte_atomic32_read(&mt_errors) != 0)
+		goto fail;
+
+	/* no object is lost nor duplicated */
+	if (rte_stack_count(mt_stack) != STACK_SIZE) {
+		printf("[%s():%u] stack lost objects: %u left\n",
+		       __func__, __LINE__, rte_stack_count(mt_stack));
+		goto fail;
+	}
+	if (rte_stack_pop(mt_stack, popped_objs, STACK_SIZE) != STACK_SIZE)
+		goto fail;
+	for (i = 0; i < STACK_SIZE; i++) {
+		obj = (uintptr_t)popped_objs[i];
+		if (obj >= STACK_SIZE || seen[obj]) {
+			printf("[%s():%u] invalid or duplicated object %p\n",
+			       __func__, __LINE__, popped_objs[i]);
+			goto fail;
+		}
+		seen[obj] = 1;
+	}
+
+	ret = 0;
+
+fail:
+	rte_free(seen);
+	rte_stack_free(mt_stack);
+
+	return ret;
+}
+
+static int
+test_stack_std_basic(void)
+{
+	return test_stack_basic(0);
+}
+
+static int
+test_stack_std_create_errors(void)
+{
+	return test_stack_create_errors(0);
+}
+
+static int
+test_stack_std_multithreaded(void)
+{
+	return test_stack_multithreaded(0);
+}
+
+#ifdef RTE_ARCH_X86_64
+static int
+test_stack_lf_basic(void)
+{
+	return test_stack_basic(RTE_STACK_F_LF);
+}
+
+static int
+test_stack_lf_create_errors(void)
+{
+	return test_stack_create_errors(RTE_STACK_F_LF);
+}
+
+static int
+test_stack_lf_multithreaded(void)
+{
+	return test_stack_multithreaded(RTE_STACK_F_LF);
+}
+#else
+static int
+test_stack_lf_unsupported(void)
+{
+	struct rte_stack *s;
+
+	s = rte_stack_create(STACK_NAME, STACK_SIZE, rte_socket_id(),
+			     RTE_STACK_F_LF);
+	if (s != NULL || rte_errno != ENOTSUP) {
+		printf("[%s():%u] created an unsupported lock-free stack\n",
+		       __func__, __LINE__);
+		rte_stack_free(s);
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
+static struct unit_test_suite stack_test_suite  = {
+	.suite_name = "Stack Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_stack_std_basic),
+		TEST_CASE(test_stack_std_create_errors),
+		TEST_CASE(test_stack_std_multithreaded),
+#ifdef RTE_ARCH_X86_64
+		TEST_CASE(test_stack_lf_basic),
+		TEST_CASE(test_stack_lf_create_errors),
+		TEST_CASE(test_stack_lf_multithreaded),
+#else
+		TEST_CASE(test_stack_lf_unsupported),
+#endif
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_stack(void)
+{
+	return unit_test_suite_runner(&stack_test_suite);
+}
+
+static struct test_command stack_cmd = {
+	.command = "stack_autotest",
+	.callback = test_stack,
+};
+REGISTER_TEST_COMMAND(stack_cmd);
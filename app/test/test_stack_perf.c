@@ -0,0 +1,181 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_stack.h>
+
+#include "test.h"
+
+/*
+ * Stack performance test
+ * ======================
+ *
+ * For the standard and the lock-free stacks, measure the cost per object
+ * of pushing then popping bulks of 1, 8 and 32 objects:
+ *
+ *    - on the master lcore only;
+ *    - on all lcores at the same time, sharing the same stack.
+ */
+
+#define STACK_NAME "STACK_PERF"
+#define STACK_SIZE 1024
+#define MAX_BURST 32
+#define ITERATIONS (1 << 18)
+
+static const unsigned int bulk_sizes[] = { 1, 8, 32 };
+
+static struct rte_stack *s;
+static rte_atomic32_t lcore_barrier;
+static volatile unsigned int bulk_sz;
+static uint64_t lcore_cycles[RTE_MAX_LCORE];
+
+/* push and pop bulk_sz objects ITERATIONS times */
+static uint64_t
+bulk_push_pop(void)
+{
+	void *objs[MAX_BURST] = { NULL };
+	unsigned int i, n = bulk_sz;
+	uint64_t start;
+
+	start = rte_rdtsc();
+
+	for (i = 0; i < ITERATIONS; i++) {
+		rte_stack_push(s, objs, n);
+		rte_stack_pop(s, objs, n);
+	}
+
+	return rte_rdtsc() - start;
+}
+
+static int
+bulk_push_pop_thread(__attribute__((unused)) void *arg)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	/* start all the lcores at the same time */
+	rte_atomic32_dec(&lcore_barrier);
+	while (rte_atomic32_read(&lcore_barrier) != 0)
+		rte_pause();
+
+	lcore_cycles[lcore_id] = bulk_push_pop();
+
+	return 0;
+}
+
+static void
+test_single_lcore(void)
+{
+	unsigned int i;
+	uint64_t cycles;
+
+	for (i = 0; i < RTE_DIM(bulk_sizes); i++) {
+		bulk_sz = bulk_sizes[i];
+		cycles = bulk_push_pop();
+		printf("Single lcore, bulk %2u: %.2F cycles per object\n",
+		       bulk_sz, (double)cycles / ((uint64_t)ITERATIONS * bulk_sz));
+	}
+}
+
+static void
+test_all_lcores(void)
+{
+	unsigned int i, lcore_id, n = rte_lcore_count();
+	uint64_t cycles;
+
+	for (i = 0; i < RTE_DIM(bulk_sizes); i++) {
+		bulk_sz = bulk_sizes[i];
+		rte_atomic32_set(&lcore_barrier, n);
+
+		rte_eal_mp_remote_launch(bulk_push_pop_thread, NULL,
+					 CALL_MASTER);
+		rte_eal_mp_wait_lcore();
+
+		cycles = 0;
+		RTE_LCORE_FOREACH(lcore_id)
+			cycles += lcore_cycles[lcore_id];
+
+		printf("%u lcores, bulk %2u: %.2F cycles per object\n",
+		       n, bulk_sz,
+		       (double)cycles / ((uint64_t)ITERATIONS * bulk_sz * n));
+	}
+}
+
+static int
+__test_stack_perf(uint32_t flags)
+{
+	s = rte_stack_create(STACK_NAME, STACK_SIZE, rte_socket_id(), flags);
+	if (s == NULL) {
+		printf("[%s():%u] failed to create a stack\n",
+		       __func__, __LINE__);
+		return -1;
+	}
+
+	printf("### %s stack ###\n",
+	       (flags & RTE_STACK_F_LF) ? "Lock-free" : "Standard");
+
+	test_single_lcore();
+	if (rte_lcore_count() > 1)
+		test_all_lcores();
+
+	rte_stack_free(s);
+
+	return 0;
+}
+
+static int
+test_stack_perf(void)
+{
+	if (__test_stack_perf(0) < 0)
+		return -1;
+
+#ifdef RTE_ARCH_X86_64
+	if (__test_stack_perf(RTE_STACK_F_LF) < 0)
+		return -1;
+#endif
+
+	return 0;
+}
+
+static struct test_command stack_perf_cmd = {
+	.command = "stack_perf_autotest",
+	.callback = test_stack_perf,
+};
+REGISTER_TEST_COMMAND(stack_perf_cmd);
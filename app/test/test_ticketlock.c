@@ -0,0 +1,200 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_ticketlock.h>
+#include <rte_atomic.h>
+
+#include "test.h"
+
+/*
+ * Ticketlock test
+ * ===============
+ *
+ * - There is a global ticketlock and a table of ticketlocks (one per lcore).
+ *
+ * - The test function takes all of these locks and launches the
+ *   ``test_ticketlock_per_core()`` function on each core (except the master).
+ *
+ *   - The function takes the global lock, display something, then releases
+ *     the global lock.
+ *   - The function takes the per-lcore lock, display something, then releases
+ *     the per-core lock.
+ *
+ * - The main function unlocks the per-lcore locks sequentially and
+ *   waits between each lock.
+ *
+ * - All cores then increment a shared counter under the global lock, and
+ *   the final value of the counter is checked.
+ *
+ * - The trylock of a taken lock must fail on all cores.
+ */
+
+#define NB_INCREMENTS 100000
+
+static rte_ticketlock_t tl, tl_try;
+static rte_ticketlock_t tl_tab[RTE_MAX_LCORE];
+static unsigned count;
+static uint64_t shared_counter;
+
+static int
+test_ticketlock_per_core(__attribute__((unused)) void *arg)
+{
+	rte_ticketlock_lock(&tl);
+	printf("Global lock taken on core %u\n", rte_lcore_id());
+	rte_ticketlock_unlock(&tl);
+
+	rte_ticketlock_lock(&tl_tab[rte_lcore_id()]);
+	printf("Hello from core %u !\n", rte_lcore_id());
+	rte_ticketlock_unlock(&tl_tab[rte_lcore_id()]);
+
+	return 0;
+}
+
+static int
+test_ticketlock_increment(__attribute__((unused)) void *arg)
+{
+	unsigned i;
+
+	for (i = 0; i < NB_INCREMENTS; i++) {
+		rte_ticketlock_lock(&tl);
+		shared_counter++;
+		rte_ticketlock_unlock(&tl);
+	}
+	return 0;
+}
+
+static int
+test_ticketlock_try(__attribute__((unused)) void *arg)
+{
+	if (rte_ticketlock_trylock(&tl_try) == 0) {
+		rte_ticketlock_lock(&tl);
+		count++;
+		rte_ticketlock_unlock(&tl);
+	}
+
+	return 0;
+}
+
+static int
+test_ticketlock(void)
+{
+	int i;
+
+	rte_ticketlock_init(&tl);
+	rte_ticketlock_init(&tl_try);
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		rte_ticketlock_init(&tl_tab[i]);
+
+	rte_ticketlock_lock(&tl);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_ticketlock_lock(&tl_tab[i]);
+		rte_eal_remote_launch(test_ticketlock_per_core, NULL, i);
+	}
+	rte_ticketlock_unlock(&tl);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_ticketlock_unlock(&tl_tab[i]);
+		rte_delay_ms(100);
+	}
+
+	rte_eal_mp_wait_lcore();
+
+	/* mutual exclusion */
+	shared_counter = 0;
+	rte_eal_mp_remote_launch(test_ticketlock_increment, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	if (shared_counter != (uint64_t)NB_INCREMENTS * rte_lcore_count()) {
+		printf("Counter is %"PRIu64" instead of %"PRIu64"\n",
+		       shared_counter,
+		       (uint64_t)NB_INCREMENTS * rte_lcore_count());
+		return -1;
+	}
+
+	/* trylock on a taken lock fails on all slave cores */
+	if (rte_ticketlock_trylock(&tl_try) == 0) {
+		printf("ticketlock_trylock failed on a free lock\n");
+		return -1;
+	}
+	if (rte_ticketlock_trylock(&tl_try) != 0) {
+		printf("ticketlock_trylock succeeded on a taken lock\n");
+		return -1;
+	}
+	count = 0;
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_eal_remote_launch(test_ticketlock_try, NULL, i);
+	}
+	rte_eal_mp_wait_lcore();
+	if (!rte_ticketlock_is_locked(&tl_try)) {
+		printf("ticketlock is not locked but it should be\n");
+		return -1;
+	}
+	rte_ticketlock_unlock(&tl_try);
+	if (rte_ticketlock_is_locked(&tl_try)) {
+		printf("ticketlock is locked but it should not be\n");
+		return -1;
+	}
+	if (count != (rte_lcore_count() - 1)) {
+		printf("%u cores took a taken ticketlock\n",
+		       rte_lcore_count() - 1 - count);
+		return -1;
+	}
+
+	/* elided critical section */
+	rte_ticketlock_lock_tm(&tl);
+	shared_counter++;
+	rte_ticketlock_unlock_tm(&tl);
+	if (rte_ticketlock_is_locked(&tl)) {
+		printf("ticketlock is locked after transaction\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static struct test_command ticketlock_cmd = {
+	.command = "ticketlock_autotest",
+	.callback = test_ticketlock,
+};
+REGISTER_TEST_COMMAND(ticketlock_cmd);
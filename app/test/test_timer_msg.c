@@ -0,0 +1,302 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_timer.h>
+
+#include "test.h"
+
+#define NB_TIMERS (2 * RTE_LIBRTE_TIMER_MSG_RING_SIZE)
+#define WAIT_SECONDS 2
+
+static struct rte_timer timers[NB_TIMERS];
+static volatile unsigned run_lcore[NB_TIMERS];
+static rte_atomic32_t cb_count;
+static unsigned slave;
+static volatile int slave_quit;
+static volatile int slave_paused;
+
+static void
+timer_cb(struct rte_timer *tim, void *arg __rte_unused)
+{
+	run_lcore[tim - timers] = rte_lcore_id();
+	rte_atomic32_inc(&cb_count);
+}
+
+/* the slave only runs its timers, all operations come from the master */
+static int
+slave_loop(__attribute__((unused)) void *arg)
+{
+	while (!slave_quit) {
+		if (!slave_paused)
+			rte_timer_manage();
+		rte_pause();
+	}
+	return 0;
+}
+
+/* wait until cond() is true, running the master timers meanwhile */
+static int
+wait_for(int (*cond)(unsigned), unsigned n)
+{
+	uint64_t end = rte_get_timer_cycles() +
+		WAIT_SECONDS * rte_get_timer_hz();
+
+	while (!cond(n)) {
+		if (rte_get_timer_cycles() > end)
+			return -1;
+		rte_timer_manage();
+	}
+	return 0;
+}
+
+static int
+all_called(unsigned n)
+{
+	return rte_atomic32_read(&cb_count) == (int32_t)n;
+}
+
+static int
+all_pending(unsigned n)
+{
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		if (!rte_timer_pending(&timers[i]))
+			return 0;
+	return 1;
+}
+
+static void
+reset_all(void)
+{
+	unsigned i;
+
+	for (i = 0; i < NB_TIMERS; i++) {
+		rte_timer_init(&timers[i]);
+		run_lcore[i] = LCORE_ID_ANY;
+	}
+	rte_atomic32_set(&cb_count, 0);
+}
+
+/* arm timers on the slave lcore */
+static int
+test_timer_msg_add(void)
+{
+	unsigned n = RTE_LIBRTE_TIMER_MSG_RING_SIZE / 2;
+	unsigned i;
+
+	reset_all();
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_SUCCESS(rte_timer_reset(&timers[i], 1, SINGLE,
+				slave, timer_cb, NULL),
+				"Cannot arm timer %u on lcore %u", i, slave);
+
+	TEST_ASSERT_SUCCESS(wait_for(all_called, n),
+			"Only %d callbacks out of %u",
+			rte_atomic32_read(&cb_count), n);
+	for (i = 0; i < n; i++) {
+		TEST_ASSERT_EQUAL(run_lcore[i], slave,
+				"Timer %u ran on lcore %u", i, run_lcore[i]);
+		TEST_ASSERT_EQUAL(timers[i].status.state, RTE_TIMER_STOP,
+				"Timer %u is not stopped", i);
+	}
+	return TEST_SUCCESS;
+}
+
+/* stop timers pending on the slave lcore */
+static int
+test_timer_msg_stop(void)
+{
+	uint64_t ticks = 10 * WAIT_SECONDS * rte_get_timer_hz();
+	unsigned n = RTE_LIBRTE_TIMER_MSG_RING_SIZE / 2;
+	unsigned i;
+
+	reset_all();
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_SUCCESS(rte_timer_reset(&timers[i], ticks, SINGLE,
+				slave, timer_cb, NULL),
+				"Cannot arm timer %u on lcore %u", i, slave);
+	TEST_ASSERT_SUCCESS(wait_for(all_pending, n),
+			"Timers not pending on lcore %u", slave);
+
+	/* the first stop only posts the operation */
+	TEST_ASSERT_EQUAL(rte_timer_stop(&timers[0]), -EINPROGRESS,
+			"Remote timer stop not posted");
+	for (i = 0; i < n; i++)
+		rte_timer_stop_sync(&timers[i]);
+
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_EQUAL(timers[i].status.state, RTE_TIMER_STOP,
+				"Timer %u is not stopped", i);
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&cb_count), 0,
+			"Stopped timers were called");
+	return TEST_SUCCESS;
+}
+
+/* move timers pending on the slave lcore to the master lcore */
+static int
+test_timer_msg_move(void)
+{
+	uint64_t ticks = 10 * WAIT_SECONDS * rte_get_timer_hz();
+	unsigned master = rte_lcore_id();
+	unsigned n = RTE_LIBRTE_TIMER_MSG_RING_SIZE / 2;
+	unsigned i;
+
+	reset_all();
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_SUCCESS(rte_timer_reset(&timers[i], ticks, SINGLE,
+				slave, timer_cb, NULL),
+				"Cannot arm timer %u on lcore %u", i, slave);
+	TEST_ASSERT_SUCCESS(wait_for(all_pending, n),
+			"Timers not pending on lcore %u", slave);
+
+	for (i = 0; i < n; i++)
+		rte_timer_reset_sync(&timers[i], 1, SINGLE, master,
+				timer_cb, NULL);
+
+	TEST_ASSERT_SUCCESS(wait_for(all_called, n),
+			"Only %d callbacks out of %u",
+			rte_atomic32_read(&cb_count), n);
+	for (i = 0; i < n; i++)
+		TEST_ASSERT_EQUAL(run_lcore[i], master,
+				"Timer %u ran on lcore %u", i, run_lcore[i]);
+	return TEST_SUCCESS;
+}
+
+/* arming fails when the ring of the target lcore is full */
+static int
+test_timer_msg_full(void)
+{
+	unsigned i, nb_fail = 0;
+
+	reset_all();
+	slave_paused = 1;
+	rte_delay_ms(10);
+	for (i = 0; i < NB_TIMERS; i++)
+		if (rte_timer_reset(&timers[i], 1, SINGLE, slave,
+				timer_cb, NULL) != 0)
+			nb_fail++;
+	slave_paused = 0;
+
+	TEST_ASSERT_EQUAL(nb_fail, NB_TIMERS - RTE_LIBRTE_TIMER_MSG_RING_SIZE,
+			"%u timers not armed", nb_fail);
+	for (i = RTE_LIBRTE_TIMER_MSG_RING_SIZE; i < NB_TIMERS; i++)
+		TEST_ASSERT_EQUAL(timers[i].status.state, RTE_TIMER_STOP,
+				"Timer %u is not stopped", i);
+
+	TEST_ASSERT_SUCCESS(wait_for(all_called,
+				RTE_LIBRTE_TIMER_MSG_RING_SIZE),
+			"Only %d callbacks out of %u",
+			rte_atomic32_read(&cb_count),
+			RTE_LIBRTE_TIMER_MSG_RING_SIZE);
+	return TEST_SUCCESS;
+}
+
+/* the mode cannot change while timers are pending */
+static int
+test_timer_msg_busy(void)
+{
+	reset_all();
+	TEST_ASSERT_SUCCESS(rte_timer_reset(&timers[0], rte_get_timer_hz(),
+			SINGLE, rte_lcore_id(), timer_cb, NULL),
+			"Cannot arm local timer");
+	TEST_ASSERT_EQUAL(rte_timer_subsystem_set_remote_mode(
+				RTE_TIMER_REMOTE_LOCK), -EBUSY,
+			"Mode changed with a pending timer");
+	TEST_ASSERT_SUCCESS(rte_timer_stop(&timers[0]),
+			"Cannot stop local timer");
+	return TEST_SUCCESS;
+}
+
+static int
+test_setup(void)
+{
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for this test\n");
+		return -1;
+	}
+	slave = rte_get_next_lcore(-1, 1, 0);
+
+	if (rte_timer_subsystem_set_remote_mode(RTE_TIMER_REMOTE_MSG) != 0) {
+		printf("Cannot enable timer message mode\n");
+		return -1;
+	}
+
+	slave_quit = 0;
+	slave_paused = 0;
+	rte_eal_remote_launch(slave_loop, NULL, slave);
+	return 0;
+}
+
+static void
+test_teardown(void)
+{
+	slave_quit = 1;
+	rte_eal_wait_lcore(slave);
+	rte_timer_subsystem_set_remote_mode(RTE_TIMER_REMOTE_LOCK);
+}
+
+static struct unit_test_suite timer_msg_test_suite  = {
+	.setup = test_setup,
+	.teardown = test_teardown,
+	.suite_name = "Timer Message Mode Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_timer_msg_add),
+		TEST_CASE(test_timer_msg_stop),
+		TEST_CASE(test_timer_msg_move),
+		TEST_CASE(test_timer_msg_full),
+		TEST_CASE(test_timer_msg_busy),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_timer_msg(void)
+{
+	return unit_test_suite_runner(&timer_msg_test_suite);
+}
+
+static struct test_command timer_msg_cmd = {
+	.command = "timer_msg_autotest",
+	.callback = test_timer_msg,
+};
+REGISTER_TEST_COMMAND(timer_msg_cmd);
@@ -61,17 +61,29 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
+static const char * const backend_names[] = {
+	[RTE_TIMER_BACKEND_SKIPLIST] = "skiplist",
+	[RTE_TIMER_BACKEND_WHEEL] = "wheel",
+};
+
+/* cycles per timer with MAX_ITERATIONS timers, for each backend */
+struct timer_perf_result {
+	uint64_t append;
+	uint64_t callback;
+	uint64_t reset;
+	uint64_t rearm;
+};
+
+static struct timer_perf_result results[RTE_DIM(backend_names)];
+
 static int
-test_timer_perf(void)
+test_timer_perf_backend(struct rte_timer *tms, struct timer_perf_result *res)
 {
 	unsigned iterations = 100;
 	unsigned i;
-	struct rte_timer *tms;
 	uint64_t start_tsc, end_tsc, delay_start;
 	unsigned lcore_id = rte_lcore_id();
 
-	tms = rte_malloc(NULL, sizeof(*tms) * MAX_ITERATIONS, 0);
-
 	for (i = 0; i < MAX_ITERATIONS; i++)
 		rte_timer_init(&tms[i]);
 
@@ -92,6 +104,7 @@ test_timer_perf(void)
 		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
 				(end_tsc-start_tsc)/iterations,
 				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res->append = (end_tsc - start_tsc) / iterations;
 		outstanding_count = iterations;
 		delay_start = rte_get_timer_cycles();
 		while (rte_get_timer_cycles() < delay_start + ticks)
@@ -106,6 +119,7 @@ test_timer_perf(void)
 		printf("Time per callback: %"PRIu64" (%"PRIu64"us)\n",
 				(end_tsc-start_tsc)/iterations,
 				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res->callback = (end_tsc - start_tsc) / iterations;
 
 		printf("Resetting %u timers\n", iterations);
 		start_tsc = rte_rdtsc();
@@ -118,6 +132,21 @@ test_timer_perf(void)
 		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
 				(end_tsc-start_tsc)/iterations,
 				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res->reset = (end_tsc - start_tsc) / iterations;
+
+		/* move pending timers, as done when refreshing flow ages */
+		printf("Re-arming %u pending timers\n", iterations);
+		start_tsc = rte_rdtsc();
+		for (i = 0; i < iterations; i++)
+			rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
+					timer_cb, NULL);
+		end_tsc = rte_rdtsc();
+		printf("Time for %u timers: %"PRIu64" (%"PRIu64"ms), ", iterations,
+				end_tsc-start_tsc, (end_tsc-start_tsc+ticks_per_ms/2)/(ticks_per_ms));
+		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
+				(end_tsc-start_tsc)/iterations,
+				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+		res->rearm = (end_tsc - start_tsc) / iterations;
 		outstanding_count = iterations;
 
 		delay_start = rte_get_timer_cycles();
@@ -154,6 +183,50 @@ test_timer_perf(void)
 	end_tsc = rte_rdtsc();
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
 			(end_tsc - start_tsc + iterations/2) / iterations);
+	rte_timer_stop(&tms[0]);
+
+	return 0;
+}
+
+static int
+test_timer_perf(void)
+{
+	enum rte_timer_backend backend, default_backend;
+	struct rte_timer *tms;
+	int ret = 0;
+
+	tms = rte_malloc(NULL, sizeof(*tms) * MAX_ITERATIONS, 0);
+	if (tms == NULL) {
+		printf("Cannot allocate %u timers\n", MAX_ITERATIONS);
+		return -1;
+	}
+
+	default_backend = rte_timer_subsystem_get_backend();
+	for (backend = 0; backend < RTE_DIM(backend_names); backend++) {
+		if (rte_timer_subsystem_set_backend(backend) != 0) {
+			printf("Cannot select %s backend\n",
+					backend_names[backend]);
+			ret = -1;
+			break;
+		}
+		printf("\n=== %s backend ===\n", backend_names[backend]);
+		ret = test_timer_perf_backend(tms, &results[backend]);
+		if (ret != 0)
+			break;
+	}
+	rte_timer_subsystem_set_backend(default_backend);
+	rte_free(tms);
+	if (ret != 0)
+		return ret;
+
+	printf("\nCycles per timer with %u timers:\n", MAX_ITERATIONS);
+	printf("%-10s %10s %10s %10s %10s\n", "backend",
+			"append", "callback", "reset", "re-arm");
+	for (backend = 0; backend < RTE_DIM(backend_names); backend++)
+		printf("%-10s %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64"\n",
+				backend_names[backend], results[backend].append,
+				results[backend].callback, results[backend].reset,
+				results[backend].rearm);
 
 	return 0;
 }
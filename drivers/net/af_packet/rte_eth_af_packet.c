@@ -135,22 +135,42 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	if (unlikely(nb_pkts == 0))
 		return 0;
 
-	/*
-	 * Reads the given number of packets from the AF_PACKET socket one by
-	 * one and copies the packet data into a newly allocated mbuf.
-	 */
+	/* count the frames ready to be received, up to nb_pkts */
 	framecount = pkt_q->framecount;
 	framenum = pkt_q->framenum;
-	for (i = 0; i < nb_pkts; i++) {
-		/* point at the next incoming frame */
+	for (num_rx = 0; num_rx < nb_pkts; num_rx++) {
 		ppd = (struct tpacket2_hdr *) pkt_q->rd[framenum].iov_base;
 		if ((ppd->tp_status & TP_STATUS_USER) == 0)
 			break;
+		if (++framenum >= framecount)
+			framenum = 0;
+	}
+	if (num_rx == 0)
+		return 0;
 
-		/* allocate the next mbuf */
-		mbuf = rte_pktmbuf_alloc(pkt_q->mb_pool);
-		if (unlikely(mbuf == NULL))
-			break;
+	/* allocate the mbufs for all of them at once, or one by one if the
+	 * pool runs low, only receiving the frames that got an mbuf */
+	if (unlikely(rte_pktmbuf_alloc_bulk(pkt_q->mb_pool, bufs,
+			num_rx) != 0)) {
+		for (i = 0; i < num_rx; i++) {
+			bufs[i] = rte_pktmbuf_alloc(pkt_q->mb_pool);
+			if (bufs[i] == NULL)
+				break;
+		}
+		num_rx = i;
+		if (num_rx == 0)
+			return 0;
+	}
+
+	/*
+	 * Reads the ready packets from the AF_PACKET socket one by one and
+	 * copies the packet data into the newly allocated mbufs.
+	 */
+	framenum = pkt_q->framenum;
+	for (i = 0; i < num_rx; i++) {
+		/* point at the next incoming frame */
+		ppd = (struct tpacket2_hdr *) pkt_q->rd[framenum].iov_base;
+		mbuf = bufs[i];
 
 		/* packet will fit in the mbuf, go ahead and receive it */
 		rte_pktmbuf_pkt_len(mbuf) = rte_pktmbuf_data_len(mbuf) = ppd->tp_snaplen;
@@ -162,10 +182,6 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		if (++framenum >= framecount)
 			framenum = 0;
 		mbuf->port = pkt_q->in_port;
-
-		/* account for the receive frame */
-		bufs[i] = mbuf;
-		num_rx++;
 	}
 	pkt_q->framenum = framenum;
 	pkt_q->rx_pkts += num_rx;
@@ -218,8 +234,8 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		ppd = (struct tpacket2_hdr *) pkt_q->rd[framenum].iov_base;
 
 		num_tx++;
-		rte_pktmbuf_free(mbuf);
 	}
+	rte_pktmbuf_free_bulk(bufs, num_tx);
 
 	/* kick-off transmits */
 	if (sendto(pkt_q->sockfd, NULL, 0, MSG_DONTWAIT, NULL, 0) == -1)
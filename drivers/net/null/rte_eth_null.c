@@ -98,6 +98,28 @@ static struct rte_eth_link pmd_link = {
 	.link_status = 0
 };
 
+/*
+ * Allocate up to nb_bufs mbufs, in one bulk when the pool holds enough of
+ * them, one by one otherwise so that a nearly empty pool still gives a
+ * partial burst. Returns the number of mbufs allocated.
+ */
+static uint16_t
+eth_null_alloc(struct rte_mempool *mp, struct rte_mbuf **bufs,
+		uint16_t nb_bufs)
+{
+	uint16_t i;
+
+	if (likely(rte_pktmbuf_alloc_bulk(mp, bufs, nb_bufs) == 0))
+		return nb_bufs;
+
+	for (i = 0; i < nb_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(mp);
+		if (bufs[i] == NULL)
+			break;
+	}
+	return i;
+}
+
 static uint16_t
 eth_null_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
@@ -109,14 +131,11 @@ eth_null_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 		return 0;
 
 	packet_size = h->internals->packet_size;
+	nb_bufs = eth_null_alloc(h->mb_pool, bufs, nb_bufs);
+
 	for (i = 0; i < nb_bufs; i++) {
-		bufs[i] = rte_pktmbuf_alloc(h->mb_pool);
-		if (!bufs[i])
-			break;
 		bufs[i]->data_len = (uint16_t)packet_size;
 		bufs[i]->pkt_len = packet_size;
-		bufs[i]->nb_segs = 1;
-		bufs[i]->next = NULL;
 	}
 
 	rte_atomic64_add(&(h->rx_pkts), i);
@@ -135,16 +154,13 @@ eth_null_copy_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 		return 0;
 
 	packet_size = h->internals->packet_size;
+	nb_bufs = eth_null_alloc(h->mb_pool, bufs, nb_bufs);
+
 	for (i = 0; i < nb_bufs; i++) {
-		bufs[i] = rte_pktmbuf_alloc(h->mb_pool);
-		if (!bufs[i])
-			break;
 		rte_memcpy(rte_pktmbuf_mtod(bufs[i], void *), h->dummy_packet,
 					packet_size);
 		bufs[i]->data_len = (uint16_t)packet_size;
 		bufs[i]->pkt_len = packet_size;
-		bufs[i]->nb_segs = 1;
-		bufs[i]->next = NULL;
 	}
 
 	rte_atomic64_add(&(h->rx_pkts), i);
@@ -155,18 +171,16 @@ eth_null_copy_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 static uint16_t
 eth_null_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
-	int i;
 	struct null_queue *h = q;
 
 	if ((q == NULL) || (bufs == NULL))
 		return 0;
 
-	for (i = 0; i < nb_bufs; i++)
-		rte_pktmbuf_free(bufs[i]);
+	rte_pktmbuf_free_bulk(bufs, nb_bufs);
 
-	rte_atomic64_add(&(h->tx_pkts), i);
+	rte_atomic64_add(&(h->tx_pkts), nb_bufs);
 
-	return i;
+	return nb_bufs;
 }
 
 static uint16_t
@@ -180,11 +194,10 @@ eth_null_copy_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 		return 0;
 
 	packet_size = h->internals->packet_size;
-	for (i = 0; i < nb_bufs; i++) {
+	for (i = 0; i < nb_bufs; i++)
 		rte_memcpy(h->dummy_packet, rte_pktmbuf_mtod(bufs[i], void *),
 					packet_size);
-		rte_pktmbuf_free(bufs[i]);
-	}
+	rte_pktmbuf_free_bulk(bufs, nb_bufs);
 
 	rte_atomic64_add(&(h->tx_pkts), i);
 
@@ -58,6 +58,9 @@
 
 #define ETH_PCAP_ARG_MAXLEN	64
 
+/* mbufs allocated at once by RX, as packets are read */
+#define ETH_PCAP_RX_ALLOC_CHUNK 8
+
 static char errbuf[PCAP_ERRBUF_SIZE];
 static unsigned char tx_pcap_data[RTE_ETH_PCAP_SNAPLEN];
 static struct timeval start_time;
@@ -196,29 +199,42 @@ eth_pcap_rx(void *queue,
 	const u_char *packet;
 	struct rte_mbuf *mbuf;
 	struct pcap_rx_queue *pcap_q = queue;
+	struct rte_mempool *mp;
 	uint16_t num_rx = 0;
-	uint16_t buf_size;
+	uint16_t num_alloc = 0;
+	uint16_t buf_size, n;
 	uint32_t rx_bytes = 0;
 
 	if (unlikely(pcap_q->pcap == NULL || nb_pkts == 0))
 		return 0;
 
+	/* Now get the space available for data in the mbufs */
+	mp = pcap_q->mb_pool;
+	buf_size = (uint16_t)(rte_pktmbuf_data_room_size(mp) -
+			RTE_PKTMBUF_HEADROOM);
+
 	/* Reads the given number of packets from the pcap file one by one
-	 * and copies the packet data into a newly allocated mbuf to return.
+	 * and copies the packet data into mbufs to return. The mbufs are
+	 * allocated a few at a time once packets are read, one by one if
+	 * the pool runs low.
 	 */
 	for (i = 0; i < nb_pkts; i++) {
 		/* Get the next PCAP packet */
 		packet = pcap_next(pcap_q->pcap, &header);
 		if (unlikely(packet == NULL))
 			break;
-		else
-			mbuf = rte_pktmbuf_alloc(pcap_q->mb_pool);
-		if (unlikely(mbuf == NULL))
-			break;
 
-		/* Now get the space available for data in the mbuf */
-		buf_size = (uint16_t)(rte_pktmbuf_data_room_size(pcap_q->mb_pool) -
-				RTE_PKTMBUF_HEADROOM);
+		if (num_rx == num_alloc) {
+			n = RTE_MIN(ETH_PCAP_RX_ALLOC_CHUNK, nb_pkts - num_rx);
+			if (rte_pktmbuf_alloc_bulk(mp, &bufs[num_rx], n) != 0) {
+				bufs[num_rx] = rte_pktmbuf_alloc(mp);
+				if (unlikely(bufs[num_rx] == NULL))
+					break;
+				n = 1;
+			}
+			num_alloc += n;
+		}
+		mbuf = bufs[num_rx];
 
 		if (header.len <= buf_size) {
 			/* pcap packet will fit in the mbuf, go ahead and copy */
@@ -227,7 +243,7 @@ eth_pcap_rx(void *queue,
 			mbuf->data_len = (uint16_t)header.len;
 		} else {
 			/* Try read jumbo frame into multi mbufs. */
-			if (unlikely(eth_pcap_rx_jumbo(pcap_q->mb_pool,
+			if (unlikely(eth_pcap_rx_jumbo(mp,
 						       mbuf,
 						       packet,
 						       header.len) == -1))
@@ -236,10 +252,13 @@ eth_pcap_rx(void *queue,
 
 		mbuf->pkt_len = (uint16_t)header.len;
 		mbuf->port = pcap_q->in_port;
-		bufs[num_rx] = mbuf;
 		num_rx++;
 		rx_bytes += header.len;
 	}
+
+	/* Release the mbufs that were not filled. */
+	rte_pktmbuf_free_bulk(&bufs[num_rx], num_alloc - num_rx);
+
 	pcap_q->rx_pkts += num_rx;
 	pcap_q->rx_bytes += rx_bytes;
 	return num_rx;
@@ -301,10 +320,10 @@ eth_pcap_tx_dumper(void *queue,
 			}
 		}
 
-		rte_pktmbuf_free(mbuf);
 		num_tx++;
 		tx_bytes += mbuf->pkt_len;
 	}
+	rte_pktmbuf_free_bulk(bufs, num_tx);
 
 	/*
 	 * Since there's no place to hook a callback when the forwarding
@@ -365,8 +384,8 @@ eth_pcap_tx(void *queue,
 			break;
 		num_tx++;
 		tx_bytes += mbuf->pkt_len;
-		rte_pktmbuf_free(mbuf);
 	}
+	rte_pktmbuf_free_bulk(bufs, num_tx);
 
 	tx_queue->tx_pkts += num_tx;
 	tx_queue->tx_bytes += tx_bytes;
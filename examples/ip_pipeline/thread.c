@@ -34,6 +34,7 @@
 #include <rte_common.h>
 #include <rte_cycles.h>
 #include <rte_pipeline.h>
+#include <rte_lcore_poll.h>
 
 #include "pipeline_common_be.h"
 #include "app.h"
@@ -182,14 +183,16 @@ app_thread(void *arg)
 	for (i = 0; ; i++) {
 		uint32_t n_regular = RTE_MIN(t->n_regular, RTE_DIM(t->regular));
 		uint32_t n_custom = RTE_MIN(t->n_custom, RTE_DIM(t->custom));
+		uint32_t n_pkts = 0;
 
 		/* Run regular pipelines */
 		for (j = 0; j < n_regular; j++) {
 			struct app_thread_pipeline_data *data = &t->regular[j];
 			struct pipeline *p = data->be;
 
-			rte_pipeline_run(p->p);
+			n_pkts += rte_pipeline_run(p->p);
 		}
+		rte_lcore_poll_update(n_pkts);
 
 		/* Run custom pipelines */
 		for (j = 0; j < n_custom; j++) {
@@ -73,6 +73,7 @@
 #include <rte_tcp.h>
 #include <rte_udp.h>
 #include <rte_string_fns.h>
+#include <rte_lcore_poll.h>
 
 #include <cmdline_parse.h>
 #include <cmdline_parse_etheraddr.h>
@@ -1522,6 +1523,7 @@ main_loop(__attribute__((unused)) void *dummy)
 	unsigned lcore_id;
 	uint64_t prev_tsc, diff_tsc, cur_tsc;
 	int i, j, nb_rx;
+	unsigned int nb_rx_total;
 	uint8_t portid, queueid;
 	struct lcore_conf *qconf;
 	const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) /
@@ -1587,6 +1589,7 @@ main_loop(__attribute__((unused)) void *dummy)
 		/*
 		 * Read packet from RX queues
 		 */
+		nb_rx_total = 0;
 		for (i = 0; i < qconf->n_rx_queue; ++i) {
 			portid = qconf->rx_queue_list[i].port_id;
 			queueid = qconf->rx_queue_list[i].queue_id;
@@ -1594,6 +1597,7 @@ main_loop(__attribute__((unused)) void *dummy)
 				MAX_PKT_BURST);
 			if (nb_rx == 0)
 				continue;
+			nb_rx_total += nb_rx;
 
 #if (ENABLE_MULTI_BUFFER_OPTIMIZE == 1)
 #if (APP_LOOKUP_METHOD == APP_LOOKUP_EXACT_MATCH)
@@ -1785,6 +1789,8 @@ main_loop(__attribute__((unused)) void *dummy)
 #endif /* ENABLE_MULTI_BUFFER_OPTIMIZE */
 
 		}
+
+		rte_lcore_poll_update(nb_rx_total);
 	}
 
 	return 0;
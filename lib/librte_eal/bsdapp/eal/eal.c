@@ -552,9 +552,15 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_tailqs_init() < 0)
 		rte_panic("Cannot init tail queues for objects\n");
 
+	/* not fatal, the statistics are then private to this process */
+	rte_eal_lcore_poll_init();
+
 /*	if (rte_eal_log_init(argv[0], internal_config.syslog_facility) < 0)
 		rte_panic("Cannot init logs\n");*/
 
+	if (internal_config.log_async && rte_log_async_enable() < 0)
+		rte_panic("Cannot init asynchronous logs\n");
+
 	if (rte_eal_alarm_init() < 0)
 		rte_panic("Cannot init interrupt-handling thread\n");
 
@@ -617,6 +623,9 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	if (rte_eal_service_init() < 0)
+		rte_panic("Cannot init service lcores\n");
+
 	/* Probe & Initialize PCI devices */
 	if (rte_eal_pci_probe())
 		rte_panic("Cannot probe PCI\n");
@@ -192,3 +192,16 @@ error:
 		close(fd_hugepage);
 	return -1;
 }
+
+/* contigmem memory is fixed at load time, heaps cannot grow */
+struct rte_memseg *
+rte_eal_memseg_grow(int socket_id __rte_unused, size_t min_len __rte_unused)
+{
+	return NULL;
+}
+
+int
+rte_eal_memseg_release(struct rte_memseg *ms __rte_unused)
+{
+	return -1;
+}
@@ -0,0 +1,89 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_cpuflags.h>
+#include <rte_memcpy.h>
+
+#include "eal_memcpy.h"
+
+/* XCR0 bits: SSE, AVX (YMM upper halves), opmask, ZMM upper halves, ZMM16-31 */
+#define XSTATE_SSE       (1ULL << 1)
+#define XSTATE_YMM       (1ULL << 2)
+#define XSTATE_AVX512    ((1ULL << 5) | (1ULL << 6) | (1ULL << 7))
+
+void *(*rte_memcpy_ptr)(void *dst, const void *src, size_t n) = rte_memcpy_sse;
+
+/*
+ * CPUID only tells whether the CPU implements an extension; the wider
+ * registers are usable only if the OS saves them on context switch.
+ */
+static int __rte_unused
+memcpy_xstate_enabled(uint64_t mask)
+{
+	uint32_t eax, edx;
+
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_OSXSAVE) <= 0)
+		return 0;
+
+	asm volatile("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+
+	return ((((uint64_t)edx << 32) | eax) & mask) == mask;
+}
+
+/*
+ * Run as a constructor so that rte_memcpy() can be used before
+ * rte_eal_init(), e.g. from other constructors.
+ */
+static void __attribute__((constructor))
+rte_memcpy_init(void)
+{
+#ifdef CC_SUPPORT_AVX512F
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+			memcpy_xstate_enabled(XSTATE_SSE | XSTATE_YMM |
+				XSTATE_AVX512)) {
+		rte_memcpy_ptr = rte_memcpy_avx512f;
+		return;
+	}
+#endif
+#ifdef CC_SUPPORT_AVX2
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0 &&
+			memcpy_xstate_enabled(XSTATE_SSE | XSTATE_YMM)) {
+		rte_memcpy_ptr = rte_memcpy_avx2;
+		return;
+	}
+#endif
+	rte_memcpy_ptr = rte_memcpy_sse;
+}
@@ -44,6 +44,8 @@
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
 
+#include "eal_private.h"
+
 /*
  * Wait until a lcore finished its job.
  */
@@ -87,7 +89,9 @@ rte_eal_mp_remote_launch(int (*f)(void *), void *arg,
 	}
 
 	if (call_master == CALL_MASTER) {
+		eal_lcore_poll_reset(master);
 		lcore_config[master].ret = f(arg);
+		eal_lcore_poll_reset(master);
 		lcore_config[master].state = FINISHED;
 	}
 
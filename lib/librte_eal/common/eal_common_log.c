@@ -40,6 +40,7 @@
 #include <unistd.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/queue.h>
 
 #include <rte_log.h>
@@ -57,6 +58,7 @@
 #include <rte_branch_prediction.h>
 #include <rte_ring.h>
 #include <rte_mempool.h>
+#include <rte_malloc.h>
 
 #include "eal_private.h"
 
@@ -101,6 +103,42 @@ struct log_cur_msg {
 } __rte_cache_aligned;
 static struct log_cur_msg log_cur_msg[RTE_MAX_LCORE]; /**< per core log */
 
+/** message being processed by a thread which is not an EAL lcore */
+static RTE_DEFINE_PER_LCORE(struct log_cur_msg, log_thread_msg);
+
+#define LOG_ASYNC_MSG_SIZE  256  /**< max size of an asynchronous message */
+#define LOG_ASYNC_POLL_US   1000 /**< writer thread sleep when idle */
+
+#if (RTE_LOG_ASYNC_RING_SIZE & (RTE_LOG_ASYNC_RING_SIZE - 1)) != 0
+#error RTE_LOG_ASYNC_RING_SIZE must be a power of 2
+#endif
+
+/** A formatted message waiting for the writer thread. */
+struct log_async_rec {
+	uint32_t loglevel;
+	uint32_t logtype;
+	unsigned len;
+	char buf[LOG_ASYNC_MSG_SIZE];
+};
+
+/**
+ * Single producer, single consumer ring of messages of one lcore. The
+ * lcore owns head and dropped, the writer thread owns tail and written.
+ */
+struct log_async_ring {
+	volatile uint32_t head;
+	uint64_t dropped;
+	volatile uint32_t tail __rte_cache_aligned;
+	uint64_t written;
+	uint64_t dropped_reported;
+	struct log_async_rec recs[RTE_LOG_ASYNC_RING_SIZE] __rte_cache_aligned;
+};
+
+static struct log_async_ring *log_async_rings[RTE_MAX_LCORE];
+static volatile int log_async_enabled;
+static volatile int log_async_stop;
+static pthread_t log_async_thread;
+
 
 /* default logs */
 
@@ -207,8 +245,11 @@ int rte_log_cur_msg_loglevel(void)
 {
 	unsigned lcore_id;
 	lcore_id = rte_lcore_id();
-	if (lcore_id >= RTE_MAX_LCORE)
+	if (lcore_id >= RTE_MAX_LCORE) {
+		if (RTE_PER_LCORE(log_thread_msg).loglevel != 0)
+			return RTE_PER_LCORE(log_thread_msg).loglevel;
 		return rte_get_log_level();
+	}
 	return log_cur_msg[lcore_id].loglevel;
 }
 
@@ -217,8 +258,11 @@ int rte_log_cur_msg_logtype(void)
 {
 	unsigned lcore_id;
 	lcore_id = rte_lcore_id();
-	if (lcore_id >= RTE_MAX_LCORE)
+	if (lcore_id >= RTE_MAX_LCORE) {
+		if (RTE_PER_LCORE(log_thread_msg).logtype != 0)
+			return RTE_PER_LCORE(log_thread_msg).logtype;
 		return rte_get_log_type();
+	}
 	return log_cur_msg[lcore_id].logtype;
 }
 
@@ -264,6 +308,172 @@ rte_log_dump_history(FILE *out)
 	rte_spinlock_unlock(&log_dump_lock);
 }
 
+/*
+ * Write the messages queued by the lcores to the log stream, and
+ * report the messages dropped since the last call. Returns the number
+ * of messages written.
+ */
+static unsigned
+log_async_drain(void)
+{
+	struct log_async_ring *r;
+	struct log_async_rec *rec;
+	unsigned lcore_id, count = 0;
+	uint32_t head, tail;
+	uint64_t dropped;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		r = log_async_rings[lcore_id];
+		if (r == NULL)
+			continue;
+
+		head = r->head;
+		rte_smp_rmb();
+		for (tail = r->tail; tail != head; tail++) {
+			rec = &r->recs[tail & (RTE_LOG_ASYNC_RING_SIZE - 1)];
+			RTE_PER_LCORE(log_thread_msg).loglevel = rec->loglevel;
+			RTE_PER_LCORE(log_thread_msg).logtype = rec->logtype;
+			fwrite(rec->buf, rec->len, 1, rte_logs.file);
+			r->written++;
+			count++;
+		}
+		/* records are read before the lcore can overwrite them */
+		rte_smp_mb();
+		r->tail = tail;
+
+		dropped = r->dropped;
+		if (dropped != r->dropped_reported) {
+			RTE_PER_LCORE(log_thread_msg).loglevel = RTE_LOG_WARNING;
+			RTE_PER_LCORE(log_thread_msg).logtype = RTE_LOGTYPE_EAL;
+			fprintf(rte_logs.file,
+				"EAL: lcore %u dropped %"PRIu64" log messages\n",
+				lcore_id, dropped - r->dropped_reported);
+			r->dropped_reported = dropped;
+		}
+	}
+	if (count != 0)
+		fflush(rte_logs.file);
+
+	memset(&RTE_PER_LCORE(log_thread_msg), 0,
+		sizeof(RTE_PER_LCORE(log_thread_msg)));
+	return count;
+}
+
+/* writer thread main loop, drains the rings until asked to stop */
+static void *
+log_async_thread_main(__attribute__((unused)) void *arg)
+{
+	for (;;) {
+		if (log_async_drain() != 0)
+			continue;
+		if (log_async_stop)
+			break;
+		usleep(LOG_ASYNC_POLL_US);
+	}
+	/* messages queued while stopping */
+	log_async_drain();
+	return NULL;
+}
+
+/*
+ * Format a message in the ring of the calling lcore. The message is
+ * dropped if the ring is full.
+ */
+static int
+log_async_enqueue(struct log_async_ring *r, uint32_t level,
+		uint32_t logtype, const char *format, va_list ap)
+{
+	struct log_async_rec *rec;
+	uint32_t head = r->head;
+	int ret;
+
+	if (head - r->tail >= RTE_LOG_ASYNC_RING_SIZE) {
+		r->dropped++;
+		return -ENOBUFS;
+	}
+
+	rec = &r->recs[head & (RTE_LOG_ASYNC_RING_SIZE - 1)];
+	ret = vsnprintf(rec->buf, sizeof(rec->buf), format, ap);
+	if (ret < 0)
+		return ret;
+
+	/* keep the end of line of truncated messages */
+	if ((unsigned)ret >= sizeof(rec->buf)) {
+		rec->len = sizeof(rec->buf) - 1;
+		rec->buf[rec->len - 1] = '\n';
+	} else
+		rec->len = ret;
+	rec->loglevel = level;
+	rec->logtype = logtype;
+
+	rte_smp_wmb();
+	r->head = head + 1;
+	return ret;
+}
+
+/* Send the logs of the lcores to a writer thread */
+int
+rte_log_async_enable(void)
+{
+	unsigned lcore_id;
+	int ret;
+
+	if (log_async_enabled)
+		return 0;
+
+	/* rings are kept when disabling, messages may still be queued */
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (log_async_rings[lcore_id] != NULL)
+			continue;
+		log_async_rings[lcore_id] = rte_zmalloc_socket("log_async",
+				sizeof(struct log_async_ring), RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore_id));
+		if (log_async_rings[lcore_id] == NULL) {
+			RTE_LOG(ERR, EAL, "Cannot allocate log ring for lcore %u\n",
+				lcore_id);
+			return -ENOMEM;
+		}
+	}
+
+	log_async_stop = 0;
+	ret = pthread_create(&log_async_thread, NULL,
+			log_async_thread_main, NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, EAL, "Cannot create log writer thread\n");
+		return -ret;
+	}
+	if (rte_thread_setname(log_async_thread, "eal-log-writer") != 0)
+		RTE_LOG(DEBUG, EAL, "Cannot set name for log writer thread\n");
+
+	rte_smp_wmb();
+	log_async_enabled = 1;
+	return 0;
+}
+
+/* Go back to writing logs from the calling thread */
+void
+rte_log_async_disable(void)
+{
+	if (!log_async_enabled)
+		return;
+
+	log_async_enabled = 0;
+	log_async_stop = 1;
+	pthread_join(log_async_thread, NULL);
+}
+
+/* Get the statistics of the ring of an lcore */
+int
+rte_log_async_get_stats(unsigned lcore_id, struct rte_log_async_stats *stats)
+{
+	if (lcore_id >= RTE_MAX_LCORE || log_async_rings[lcore_id] == NULL)
+		return -EINVAL;
+
+	stats->written = log_async_rings[lcore_id]->written;
+	stats->dropped = log_async_rings[lcore_id]->dropped;
+	return 0;
+}
+
 /*
  * Generates a log message The message will be sent in the stream
  * defined by the previous call to rte_openlog_stream().
@@ -283,6 +493,12 @@ rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 	if (lcore_id < RTE_MAX_LCORE) {
 		log_cur_msg[lcore_id].loglevel = level;
 		log_cur_msg[lcore_id].logtype = logtype;
+
+		/* critical messages are written before the lcore goes on */
+		if (log_async_enabled && level > RTE_LOG_CRIT &&
+				log_async_rings[lcore_id] != NULL)
+			return log_async_enqueue(log_async_rings[lcore_id],
+					level, logtype, format, ap);
 	}
 
 	ret = vfprintf(f, format, ap);
@@ -77,6 +77,10 @@ rte_eal_get_physmem_size(void)
 		total_len += mcfg->memseg[i].len;
 	}
 
+	/* add the memory the heaps have grown with */
+	for (i = 0; i < RTE_MAX_MEMSEG; i++)
+		total_len += mcfg->dyn_memseg[i].len;
+
 	return total_len;
 }
 
@@ -106,6 +110,20 @@ rte_dump_physmem_layout(FILE *f)
 		       mcfg->memseg[i].nchannel,
 		       mcfg->memseg[i].nrank);
 	}
+
+	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+		if (mcfg->dyn_memseg[i].len == 0)
+			continue;
+
+		fprintf(f, "Runtime segment %u: phys:0x%"PRIx64", len:%zu, "
+		       "virt:%p, socket_id:%"PRId32", "
+		       "hugepage_sz:%"PRIu64"\n", i,
+		       mcfg->dyn_memseg[i].phys_addr,
+		       mcfg->dyn_memseg[i].len,
+		       mcfg->dyn_memseg[i].addr,
+		       mcfg->dyn_memseg[i].socket_id,
+		       mcfg->dyn_memseg[i].hugepage_sz);
+	}
 }
 
 /* return the number of memory channels */
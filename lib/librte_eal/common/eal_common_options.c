@@ -67,6 +67,7 @@ eal_short_options[] =
 	"m:" /* memory size */
 	"n:" /* memory channels */
 	"r:" /* memory ranks */
+	"s:" /* service coremask */
 	"v"  /* version */
 	"w:" /* pci-whitelist */
 	;
@@ -75,11 +76,14 @@ const struct option
 eal_long_options[] = {
 	{OPT_BASE_VIRTADDR,     1, NULL, OPT_BASE_VIRTADDR_NUM    },
 	{OPT_CREATE_UIO_DEV,    0, NULL, OPT_CREATE_UIO_DEV_NUM   },
+	{OPT_FAST_START,        0, NULL, OPT_FAST_START_NUM       },
 	{OPT_FILE_PREFIX,       1, NULL, OPT_FILE_PREFIX_NUM      },
 	{OPT_HELP,              0, NULL, OPT_HELP_NUM             },
 	{OPT_HUGE_DIR,          1, NULL, OPT_HUGE_DIR_NUM         },
+	{OPT_HUGE_INIT_THREADS, 1, NULL, OPT_HUGE_INIT_THREADS_NUM},
 	{OPT_HUGE_UNLINK,       0, NULL, OPT_HUGE_UNLINK_NUM      },
 	{OPT_LCORES,            1, NULL, OPT_LCORES_NUM           },
+	{OPT_LOG_ASYNC,         0, NULL, OPT_LOG_ASYNC_NUM        },
 	{OPT_LOG_LEVEL,         1, NULL, OPT_LOG_LEVEL_NUM        },
 	{OPT_MASTER_LCORE,      1, NULL, OPT_MASTER_LCORE_NUM     },
 	{OPT_NO_HPET,           0, NULL, OPT_NO_HPET_NUM          },
@@ -89,6 +93,7 @@ eal_long_options[] = {
 	{OPT_PCI_BLACKLIST,     1, NULL, OPT_PCI_BLACKLIST_NUM    },
 	{OPT_PCI_WHITELIST,     1, NULL, OPT_PCI_WHITELIST_NUM    },
 	{OPT_PROC_TYPE,         1, NULL, OPT_PROC_TYPE_NUM        },
+	{OPT_SOCKET_LIMIT,      1, NULL, OPT_SOCKET_LIMIT_NUM     },
 	{OPT_SOCKET_MEM,        1, NULL, OPT_SOCKET_MEM_NUM       },
 	{OPT_SYSLOG,            1, NULL, OPT_SYSLOG_NUM           },
 	{OPT_VDEV,              1, NULL, OPT_VDEV_NUM             },
@@ -130,8 +135,10 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	internal_cfg->hugepage_dir = NULL;
 	internal_cfg->force_sockets = 0;
 	/* zero out the NUMA config */
-	for (i = 0; i < RTE_MAX_NUMA_NODES; i++)
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
 		internal_cfg->socket_mem[i] = 0;
+		internal_cfg->socket_limit[i] = 0;
+	}
 	/* zero out hugedir descriptors */
 	for (i = 0; i < MAX_HUGEPAGE_SIZES; i++)
 		internal_cfg->hugepage_info[i].lock_descriptor = -1;
@@ -140,6 +147,9 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	internal_cfg->syslog_facility = LOG_DAEMON;
 	/* default value from build option */
 	internal_cfg->log_level = RTE_LOG_LEVEL;
+	internal_cfg->log_async = 0;
+	memset(internal_cfg->service_lcores, 0,
+		sizeof(internal_cfg->service_lcores));
 
 	internal_cfg->xen_dom0_support = 0;
 
@@ -153,6 +163,8 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 #endif
 	internal_cfg->vmware_tsc_map = 0;
 	internal_cfg->create_uio_dev = 0;
+	internal_cfg->fast_start = 0;
+	internal_cfg->huge_init_threads = 0;
 }
 
 static int
@@ -321,6 +333,55 @@ eal_parse_coremask(const char *coremask)
 	return 0;
 }
 
+/*
+ * Parse the service coremask given as argument (hexadecimal string). The
+ * lcores are checked against the enabled lcores once all the options are
+ * parsed.
+ */
+static int
+eal_parse_service_coremask(const char *coremask)
+{
+	int i, j, idx = 0;
+	unsigned count = 0;
+	char c;
+	int val;
+
+	if (coremask == NULL)
+		return -1;
+	while (isblank(*coremask))
+		coremask++;
+	if (coremask[0] == '0' && ((coremask[1] == 'x')
+		|| (coremask[1] == 'X')))
+		coremask += 2;
+	i = strlen(coremask);
+	while ((i > 0) && isblank(coremask[i - 1]))
+		i--;
+	if (i == 0)
+		return -1;
+
+	memset(internal_config.service_lcores, 0,
+		sizeof(internal_config.service_lcores));
+	for (i = i - 1; i >= 0 && idx < RTE_MAX_LCORE; i--) {
+		c = coremask[i];
+		if (isxdigit(c) == 0)
+			return -1;
+		val = xdigit2val(c);
+		for (j = 0; j < BITS_PER_HEX && idx < RTE_MAX_LCORE; j++, idx++)
+		{
+			if ((1 << j) & val) {
+				internal_config.service_lcores[idx] = 1;
+				count++;
+			}
+		}
+	}
+	for (; i >= 0; i--)
+		if (coremask[i] != '0')
+			return -1;
+	if (count == 0)
+		return -1;
+	return 0;
+}
+
 static int
 eal_parse_corelist(const char *corelist)
 {
@@ -780,6 +841,13 @@ eal_parse_common_option(int opt, const char *optarg,
 			return -1;
 		}
 		break;
+	/* service coremask */
+	case 's':
+		if (eal_parse_service_coremask(optarg) < 0) {
+			RTE_LOG(ERR, EAL, "invalid service coremask\n");
+			return -1;
+		}
+		break;
 	/* corelist */
 	case 'l':
 		if (eal_parse_corelist(optarg) < 0) {
@@ -889,6 +957,10 @@ eal_parse_common_option(int opt, const char *optarg,
 		conf->log_level = log;
 		break;
 	}
+	case OPT_LOG_ASYNC_NUM:
+		conf->log_async = 1;
+		break;
+
 	case OPT_LCORES_NUM:
 		if (eal_parse_lcores(optarg) < 0) {
 			RTE_LOG(ERR, EAL, "invalid parameter for --"
@@ -931,12 +1003,28 @@ int
 eal_check_common_options(struct internal_config *internal_cfg)
 {
 	struct rte_config *cfg = rte_eal_get_configuration();
+	unsigned i;
 
 	if (cfg->lcore_role[cfg->master_lcore] != ROLE_RTE) {
 		RTE_LOG(ERR, EAL, "Master lcore is not enabled for DPDK\n");
 		return -1;
 	}
 
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!internal_cfg->service_lcores[i])
+			continue;
+		if (cfg->lcore_role[i] != ROLE_RTE) {
+			RTE_LOG(ERR, EAL, "Service lcore %u is not enabled "
+				"for DPDK\n", i);
+			return -1;
+		}
+		if (i == cfg->master_lcore) {
+			RTE_LOG(ERR, EAL, "Master lcore cannot be a service "
+				"lcore\n");
+			return -1;
+		}
+	}
+
 	if (internal_cfg->process_type == RTE_PROC_INVALID) {
 		RTE_LOG(ERR, EAL, "Invalid process type specified\n");
 		return -1;
@@ -991,6 +1079,8 @@ eal_common_usage(void)
 	       "                      '( )' can be omitted for single element group,\n"
 	       "                      '@' can be omitted if cpus and lcores have the same value\n"
 	       "  --"OPT_MASTER_LCORE" ID   Core ID that is used as master\n"
+	       "  -s SERVICE_COREMASK Hexadecimal bitmask of the lcores to use as service\n"
+	       "                      lcores, running the registered services\n"
 	       "  -n CHANNELS         Number of memory channels\n"
 	       "  -m MB               Memory to allocate (see also --"OPT_SOCKET_MEM")\n"
 	       "  -r RANKS            Force number of memory ranks (don't detect)\n"
@@ -1011,6 +1101,7 @@ eal_common_usage(void)
 	       "  --"OPT_PROC_TYPE"         Type of this process (primary|secondary|auto)\n"
 	       "  --"OPT_SYSLOG"            Set syslog facility\n"
 	       "  --"OPT_LOG_LEVEL"         Set default log level\n"
+	       "  --"OPT_LOG_ASYNC"         Write logs of lcores from a background thread\n"
 	       "  -v                  Display version information on startup\n"
 	       "  -h, --help          This help\n"
 	       "\nEAL options for DEBUG use only:\n"
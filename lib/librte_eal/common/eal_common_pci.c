@@ -263,6 +263,31 @@ rte_eal_pci_detach_dev(struct rte_pci_driver *dr,
 	return 1;
 }
 
+/* count the devices bound to kdrv that rte_eal_pci_probe() may init */
+unsigned
+pci_probe_candidate_count(enum rte_kernel_driver kdrv)
+{
+	struct rte_pci_device *dev;
+	struct rte_devargs *devargs;
+	unsigned count = 0;
+	int probe_all;
+
+	probe_all = rte_eal_devargs_type_count(RTE_DEVTYPE_WHITELISTED_PCI) == 0;
+
+	TAILQ_FOREACH(dev, &pci_device_list, next) {
+		if (dev->kdrv != kdrv)
+			continue;
+		devargs = pci_devargs_lookup(dev);
+		if (probe_all ? (devargs == NULL ||
+				devargs->type != RTE_DEVTYPE_BLACKLISTED_PCI) :
+				(devargs != NULL &&
+				devargs->type == RTE_DEVTYPE_WHITELISTED_PCI))
+			count++;
+	}
+
+	return count;
+}
+
 /*
  * If vendor/device ID match, call the devinit() function of all
  * registered driver for the given device. Return -1 if initialization
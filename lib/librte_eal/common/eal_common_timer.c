@@ -41,6 +41,8 @@
 #include <rte_common.h>
 #include <rte_log.h>
 #include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
 
 #include "eal_private.h"
 
@@ -76,10 +78,19 @@ estimate_tsc_freq(void)
 void
 set_tsc_freq(void)
 {
-	uint64_t freq = get_tsc_freq();
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	uint64_t freq;
 
-	if (!freq)
-		freq = estimate_tsc_freq();
+	/* a secondary process does not need to sleep to measure it again */
+	if (rte_eal_process_type() == RTE_PROC_SECONDARY && mcfg->tsc_hz != 0)
+		freq = mcfg->tsc_hz;
+	else {
+		freq = get_tsc_freq();
+		if (!freq)
+			freq = estimate_tsc_freq();
+		if (rte_eal_process_type() == RTE_PROC_PRIMARY)
+			mcfg->tsc_hz = freq;
+	}
 
 	RTE_LOG(INFO, EAL, "TSC frequency is ~%" PRIu64 " KHz\n", freq / 1000);
 	eal_tsc_resolution_hz = freq;
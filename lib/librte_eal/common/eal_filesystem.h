@@ -97,6 +97,19 @@ eal_get_hugefile_path(char *buffer, size_t buflen, const char *hugedir, int f_id
 	return buffer;
 }
 
+/** String format for the files backing the runtime growth of the heaps. */
+#define GROW_HUGEFILE_FMT "%s/%smap_grow_%d"
+
+static inline const char *
+eal_get_hugefile_grow_path(char *buffer, size_t buflen, const char *hugedir,
+		int socket_id)
+{
+	snprintf(buffer, buflen, GROW_HUGEFILE_FMT, hugedir,
+			internal_config.hugefile_prefix, socket_id);
+	buffer[buflen - 1] = '\0';
+	return buffer;
+}
+
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 static inline const char *
 eal_get_hugefile_temp_path(char *buffer, size_t buflen, const char *hugedir, int f_id)
@@ -72,13 +72,22 @@ struct internal_config {
 										* instead of native TSC */
 	volatile unsigned no_shconf;      /**< true if there is no shared config */
 	volatile unsigned create_uio_dev; /**< true to create /dev/uioX devices */
+	/** true to map only the needed hugepages, without physaddr sorting */
+	volatile unsigned fast_start;
+	/** threads faulting hugepages in at init, 0 for one per lcore */
+	volatile unsigned huge_init_threads;
 	volatile enum rte_proc_type_t process_type; /**< multi-process proc type */
 	/** true to try allocating memory on specific sockets */
 	volatile unsigned force_sockets;
 	volatile uint64_t socket_mem[RTE_MAX_NUMA_NODES]; /**< amount of memory per socket */
+	/** max amount of memory per socket, heaps can grow up to it at runtime */
+	volatile uint64_t socket_limit[RTE_MAX_NUMA_NODES];
 	uintptr_t base_virtaddr;          /**< base address to try and reserve memory from */
 	volatile int syslog_facility;	  /**< facility passed to openlog() */
 	volatile uint32_t log_level;	  /**< default log level */
+	volatile unsigned log_async;      /**< true to log from a writer thread */
+	/** non-zero for the lcores given with the -s option */
+	uint8_t service_lcores[RTE_MAX_LCORE];
 	/** default interrupt mode for VFIO */
 	volatile enum rte_intr_mode vfio_intr_mode;
 	const char *hugefile_prefix;      /**< the base filename of hugetlbfs files */
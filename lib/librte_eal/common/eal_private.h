@@ -129,6 +129,20 @@ int rte_eal_log_init(const char *id, int facility);
  */
 int rte_eal_pci_init(void);
 
+/**
+ * Count the PCI devices bound to a given kernel driver that
+ * rte_eal_pci_probe() may initialize: the devices that are not
+ * blacklisted, or the whitelisted ones if a whitelist is given.
+ *
+ * This function is private to EAL.
+ *
+ * @param kdrv
+ *   The kernel driver of the devices to count.
+ * @return
+ *   The number of devices.
+ */
+unsigned pci_probe_candidate_count(enum rte_kernel_driver kdrv);
+
 #ifdef RTE_LIBRTE_IVSHMEM
 /**
  * Init the memory from IVSHMEM devices
@@ -250,6 +264,38 @@ int rte_eal_tailqs_init(void);
  */
 int rte_eal_intr_init(void);
 
+/**
+ * Turn the lcores given with the -s option into service lcores.
+ *
+ * This function is private to EAL.
+ *
+ * @return
+ *  0 on success, negative on error
+ */
+int rte_eal_service_init(void);
+
+/**
+ * Map the lcore poll statistics shared by all processes, reserving them
+ * in the primary process.
+ *
+ * This function is private to EAL.
+ *
+ * @return
+ *  0 on success, negative on error
+ */
+int rte_eal_lcore_poll_init(void);
+
+/**
+ * Forget the end of the last polling iteration of an lcore, when a
+ * function is launched on it or returns.
+ *
+ * This function is private to EAL.
+ *
+ * @param lcore_id
+ *   The lcore id.
+ */
+void eal_lcore_poll_reset(unsigned int lcore_id);
+
 /**
  * Init alarm mechanism. This is to allow a callback be called after
  * specific time.
@@ -328,4 +374,32 @@ int rte_eal_hugepage_init(void);
  */
 int rte_eal_hugepage_attach(void);
 
+/**
+ * Back part of the growth area of a socket with hugepages, and describe
+ * it in a new entry of the runtime memseg table (dyn_memseg[] in the
+ * memory configuration). Only possible in the primary process, within
+ * the limit given with --socket-limit.
+ *
+ * This function is private to the EAL.
+ *
+ * @param socket_id
+ *   Socket on which memory is needed.
+ * @param min_len
+ *   Minimum length of the new memseg, rounded up to the hugepage size.
+ * @return
+ *   The new memseg, NULL on error.
+ */
+struct rte_memseg *rte_eal_memseg_grow(int socket_id, size_t min_len);
+
+/**
+ * Give the hugepages of a memseg added by rte_eal_memseg_grow() back to
+ * the system, in all processes, and free its slot.
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   0 on success, negative on error
+ */
+int rte_eal_memseg_release(struct rte_memseg *ms);
+
 #endif /* _EAL_PRIVATE_H_ */
@@ -188,4 +188,53 @@ static inline void rte_atomic64_clear(rte_atomic64_t *v)
 }
 #endif
 
+/*------------------------ 128 bit atomic operations -------------------------*/
+
+/**
+ * 128-bit integer, aligned as required by the 128-bit atomic operations.
+ */
+typedef struct {
+	uint64_t val[2];
+} __attribute__((aligned(16))) rte_int128_t;
+
+/**
+ * 128-bit atomic compare and exchange.
+ *
+ * Atomically compare the 16 bytes pointed by *dst* to the ones pointed by
+ * *exp*. If they are equal, write *src* to *dst*; otherwise, update *exp*
+ * with the current value of *dst*. This is a full memory barrier.
+ *
+ * @param dst
+ *   The destination location, 16-byte aligned.
+ * @param exp
+ *   Pointer to the expected value, updated with the current value on failure.
+ * @param src
+ *   Pointer to the new value.
+ * @return
+ *   Non-zero on success; 0 on failure.
+ */
+static inline int
+rte_atomic128_cmp_exchange(rte_int128_t *dst, rte_int128_t *exp,
+			   const rte_int128_t *src)
+{
+	uint8_t res;
+
+	asm volatile(
+			MPLOCKED
+			"cmpxchg16b %[dst];"
+			"sete %[res]"
+			: [dst] "=m" (dst->val[0]),  /* output */
+			  "=a" (exp->val[0]),
+			  "=d" (exp->val[1]),
+			  [res] "=r" (res)
+			: "b" (src->val[0]),         /* input */
+			  "c" (src->val[1]),
+			  "a" (exp->val[0]),
+			  "d" (exp->val[1]),
+			  "m" (dst->val[0])
+			: "memory");
+
+	return res;
+}
+
 #endif /* _RTE_ATOMIC_X86_64_H_ */
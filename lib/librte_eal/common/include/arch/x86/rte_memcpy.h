@@ -67,7 +67,16 @@ extern "C" {
 static inline void *
 rte_memcpy(void *dst, const void *src, size_t n) __attribute__((always_inline));
 
-#ifdef RTE_MACHINE_CPUFLAG_AVX512F
+/*
+ * The copy routines below are selected on the ISA the including object is
+ * compiled for, not on the build target, so that EAL can build one copy
+ * kernel per instruction set and pick the best one at run time.
+ */
+static inline void *
+rte_memcpy_internal(void *dst, const void *src, size_t n)
+	__attribute__((always_inline));
+
+#ifdef __AVX512F__
 
 /**
  * AVX512 implementation below
@@ -189,7 +198,7 @@ rte_mov512blocks(uint8_t *dst, const uint8_t *src, size_t n)
 }
 
 static inline void *
-rte_memcpy(void *dst, const void *src, size_t n)
+rte_memcpy_internal(void *dst, const void *src, size_t n)
 {
 	uintptr_t dstu = (uintptr_t)dst;
 	uintptr_t srcu = (uintptr_t)src;
@@ -306,7 +315,7 @@ COPY_BLOCK_128_BACK63:
 	goto COPY_BLOCK_128_BACK63;
 }
 
-#elif defined RTE_MACHINE_CPUFLAG_AVX2
+#elif defined __AVX2__
 
 /**
  * AVX2 implementation below
@@ -432,7 +441,7 @@ rte_mov256blocks(uint8_t *dst, const uint8_t *src, size_t n)
 }
 
 static inline void *
-rte_memcpy(void *dst, const void *src, size_t n)
+rte_memcpy_internal(void *dst, const void *src, size_t n)
 {
 	uintptr_t dstu = (uintptr_t)dst;
 	uintptr_t srcu = (uintptr_t)src;
@@ -553,7 +562,7 @@ COPY_BLOCK_64_BACK31:
 	goto COPY_BLOCK_64_BACK31;
 }
 
-#else /* RTE_MACHINE_CPUFLAG */
+#else /* __AVX512F__ */
 
 /**
  * SSE & AVX implementation below
@@ -733,7 +742,7 @@ rte_mov256(uint8_t *dst, const uint8_t *src)
 })
 
 static inline void *
-rte_memcpy(void *dst, const void *src, size_t n)
+rte_memcpy_internal(void *dst, const void *src, size_t n)
 {
 	__m128i xmm0, xmm1, xmm2, xmm3, xmm4, xmm5, xmm6, xmm7, xmm8;
 	uintptr_t dstu = (uintptr_t)dst;
@@ -875,7 +884,49 @@ COPY_BLOCK_64_BACK15:
 	goto COPY_BLOCK_64_BACK15;
 }
 
-#endif /* RTE_MACHINE_CPUFLAG */
+#endif /* __AVX512F__ */
+
+#ifdef RTE_MEMCPY_RUNTIME_DISPATCH
+
+/**
+ * Copies larger than this many bytes are not inlined but go through
+ * rte_memcpy_ptr, unless the object is already built for AVX512F.
+ */
+#define RTE_MEMCPY_DISPATCH_THRESHOLD 128
+
+/**
+ * Copy kernel selected by EAL for the running CPU: AVX512F, AVX2 or SSE,
+ * depending on the CPU flags and on the register state enabled by the OS.
+ */
+extern void *(*rte_memcpy_ptr)(void *dst, const void *src, size_t n);
+
+#endif /* RTE_MEMCPY_RUNTIME_DISPATCH */
+
+static inline void *
+rte_memcpy(void *dst, const void *src, size_t n)
+{
+	/* Dedicated paths for the dominant packet copy sizes */
+	if (__builtin_constant_p(n)) {
+		switch (n) {
+		case 64:
+			rte_mov64((uint8_t *)dst, (const uint8_t *)src);
+			return dst;
+		case 128:
+			rte_mov128((uint8_t *)dst, (const uint8_t *)src);
+			return dst;
+		case 256:
+			rte_mov256((uint8_t *)dst, (const uint8_t *)src);
+			return dst;
+		default:
+			return rte_memcpy_internal(dst, src, n);
+		}
+	}
+#if defined(RTE_MEMCPY_RUNTIME_DISPATCH) && !defined(__AVX512F__)
+	if (n > RTE_MEMCPY_DISPATCH_THRESHOLD)
+		return (*rte_memcpy_ptr)(dst, src, n);
+#endif
+	return rte_memcpy_internal(dst, src, n);
+}
 
 #ifdef __cplusplus
 }
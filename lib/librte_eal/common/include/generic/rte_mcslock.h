@@ -0,0 +1,220 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MCSLOCK_H_
+#define _RTE_MCSLOCK_H_
+
+/**
+ * @file
+ *
+ * RTE MCS Locks
+ *
+ * This file defines an API for MCS locks (Mellor-Crummey and Scott),
+ * queue-based locks which are granted in FIFO order. Each lcore taking
+ * the lock brings its own queue node, and waits by spinning on a flag of
+ * this node, so that a release only touches the cache line of the next
+ * waiting lcore. The MCS lock keeps scaling when many lcores contend for
+ * it, where the spinlock and the ticket lock have all waiting lcores spin
+ * on the same cache line.
+ *
+ * The lock itself is a pointer to the tail of the queue, NULL when the
+ * lock is free. The node given to rte_mcslock_lock() must remain valid,
+ * and must be given to rte_mcslock_unlock(), until the lock is released.
+ *
+ */
+
+#include <stddef.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+
+/**
+ * The rte_mcslock_t type, a node of the queue of an MCS lock.
+ */
+typedef struct rte_mcslock {
+	struct rte_mcslock *volatile next; /**< next waiting lcore */
+	volatile int locked; /**< 1 while waiting for the lock */
+} rte_mcslock_t;
+
+/**
+ * A static MCS lock initializer, for the rte_mcslock_t pointer.
+ */
+#define RTE_MCSLOCK_INITIALIZER NULL
+
+/**
+ * Initialize the MCS lock to an unlocked state.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ */
+static inline void
+rte_mcslock_init(rte_mcslock_t **msl)
+{
+	*msl = NULL;
+}
+
+/**
+ * Take the MCS lock, waiting for the lcores which asked for it before.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node of the calling lcore.
+ */
+static inline void
+rte_mcslock_lock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	rte_mcslock_t *prev;
+
+	me->next = NULL;
+	me->locked = 1;
+	rte_smp_wmb();
+
+	/* append to the queue */
+	prev = __sync_lock_test_and_set(msl, me);
+	if (likely(prev == NULL))
+		return;
+
+	/* link behind the previous lcore and wait for its hand-over */
+	prev->next = me;
+	while (me->locked)
+		rte_pause();
+	rte_smp_rmb();
+}
+
+/**
+ * Release the MCS lock, handing it over to the next waiting lcore.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node given when taking the lock.
+ */
+static inline void
+rte_mcslock_unlock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	if (likely(me->next == NULL)) {
+		/* no known waiting lcore, try to empty the queue */
+		if (__sync_bool_compare_and_swap(msl, me, NULL))
+			return;
+
+		/* an lcore is appending itself, wait for the link */
+		while (me->next == NULL)
+			rte_pause();
+	}
+
+	__sync_lock_release(&me->next->locked);
+}
+
+/**
+ * Try to take the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node of the calling lcore.
+ * @return
+ *   1 if the lock is successfully taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_trylock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	me->next = NULL;
+	me->locked = 1;
+	rte_smp_wmb();
+
+	return __sync_bool_compare_and_swap(msl, NULL, me);
+}
+
+/**
+ * Test if the lock is taken.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @return
+ *   1 if the lock is currently taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_is_locked(rte_mcslock_t **msl)
+{
+	rte_compiler_barrier();
+	return *msl != NULL;
+}
+
+/**
+ * Try to execute critical section in a hardware memory transaction,
+ * if it fails or not available take the MCS lock.
+ *
+ * NOTE: An attempt to perform a HW I/O operation inside a hardware memory
+ * transaction always aborts the transaction since the CPU is not able to
+ * roll-back should the transaction fail. Therefore, hardware transactional
+ * locks are not advised to be used around rte_eth_rx_burst() and
+ * rte_eth_tx_burst() calls.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node of the calling lcore.
+ */
+static inline void
+rte_mcslock_lock_tm(rte_mcslock_t **msl, rte_mcslock_t *me);
+
+/**
+ * Commit hardware memory transaction or release the MCS lock if
+ * the MCS lock is used as a fall-back
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node given when taking the lock.
+ */
+static inline void
+rte_mcslock_unlock_tm(rte_mcslock_t **msl, rte_mcslock_t *me);
+
+/**
+ * Try to execute critical section in a hardware memory transaction,
+ * if it fails or not available try to take the lock.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node of the calling lcore.
+ * @return
+ *   1 if the hardware memory transaction is successfully started
+ *   or lock is successfully taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_trylock_tm(rte_mcslock_t **msl, rte_mcslock_t *me);
+
+#endif /* _RTE_MCSLOCK_H_ */
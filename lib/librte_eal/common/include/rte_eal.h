@@ -55,11 +55,12 @@ extern "C" {
 #define RTE_MAX_THREAD_NAME_LEN 16
 
 /**
- * The lcore role (used in RTE or not).
+ * The lcore role (used in RTE, running services, or not used).
  */
 enum rte_lcore_role_t {
 	ROLE_RTE,
 	ROLE_OFF,
+	ROLE_SERVICE,
 };
 
 /**
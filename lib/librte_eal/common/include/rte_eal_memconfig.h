@@ -78,6 +78,13 @@ struct rte_mem_config {
 	/* Heaps of Malloc per socket */
 	struct malloc_heap malloc_heaps[RTE_MAX_NUMA_NODES];
 
+	/* runtime growth of the heaps, len is 0 for unused entries */
+	struct rte_memseg dyn_area[RTE_MAX_NUMA_NODES]; /**< Growth areas. */
+	struct rte_memseg dyn_memseg[RTE_MAX_MEMSEG];   /**< Runtime memsegs. */
+
+	/* TSC frequency measured by the primary process, 0 if unknown */
+	uint64_t tsc_hz;
+
 	/* address of mem_config in primary process. used to map shared config into
 	 * exact same address the primary process maps it.
 	 */
@@ -0,0 +1,146 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LCORE_POLL_H_
+#define _RTE_LCORE_POLL_H_
+
+/**
+ * @file
+ *
+ * RTE Lcore Poll Statistics
+ *
+ * A polling loop keeps its lcore 100% busy from the point of view of the
+ * OS, whatever the load. To know how much headroom is left, the main loop
+ * of an lcore calls rte_lcore_poll_update() once per iteration with the
+ * amount of work found, e.g. the number of packets received. The
+ * iterations and the TSC cycles between two calls are then accounted as
+ * busy or idle for this lcore.
+ *
+ * The statistics are kept in a memzone reserved by the primary process,
+ * so that other processes, such as dpdk_proc_info, can read them while
+ * the application runs.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_branch_prediction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Poll statistics of one lcore, only written by this lcore.
+ */
+struct rte_lcore_poll_stats {
+	uint64_t busy_iters;  /**< Iterations which found some work. */
+	uint64_t idle_iters;  /**< Iterations which found nothing to do. */
+	uint64_t busy_cycles; /**< TSC cycles spent in busy iterations. */
+	uint64_t idle_cycles; /**< TSC cycles spent in idle iterations. */
+	uint64_t last_tsc;    /**< End of the last iteration, 0 out of a loop. */
+} __rte_cache_aligned;
+
+/**
+ * @internal Statistics of all lcores, indexed by lcore id.
+ */
+extern struct rte_lcore_poll_stats *rte_lcore_poll_stats;
+
+/**
+ * Account one iteration of the polling loop of the calling lcore.
+ *
+ * The cycles elapsed since the previous call are counted as busy if
+ * nb_work is not 0, as idle otherwise. The first call after the function
+ * launched on the lcore started only marks the beginning of the loop.
+ *
+ * It does nothing when called from a non-EAL thread, or when
+ * CONFIG_RTE_LCORE_POLL_STATS is disabled.
+ *
+ * @param nb_work
+ *   Amount of work done by the iteration, e.g. number of packets.
+ */
+static inline void
+rte_lcore_poll_update(unsigned int nb_work)
+{
+#ifdef RTE_LCORE_POLL_STATS
+	unsigned int lcore_id = rte_lcore_id();
+	struct rte_lcore_poll_stats *stats;
+	uint64_t now, cycles;
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	stats = &rte_lcore_poll_stats[lcore_id];
+	now = rte_rdtsc();
+	if (likely(stats->last_tsc != 0)) {
+		cycles = now - stats->last_tsc;
+		if (nb_work != 0) {
+			stats->busy_iters++;
+			stats->busy_cycles += cycles;
+		} else {
+			stats->idle_iters++;
+			stats->idle_cycles += cycles;
+		}
+	}
+	stats->last_tsc = now;
+#else
+	RTE_SET_USED(nb_work);
+#endif
+}
+
+/**
+ * Read the poll statistics of an lcore.
+ *
+ * The lcore does not need to be enabled in the calling process, which
+ * may be a secondary process reading the statistics of the primary.
+ *
+ * @param lcore_id
+ *   The lcore id.
+ * @param stats
+ *   Structure receiving a copy of the statistics.
+ * @return
+ *   0 on success, -EINVAL if lcore_id or stats is invalid, -ENOTSUP if the
+ *   statistics are not shared by the primary process or not compiled in.
+ */
+int
+rte_lcore_poll_stats_get(unsigned int lcore_id,
+		struct rte_lcore_poll_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LCORE_POLL_H_ */
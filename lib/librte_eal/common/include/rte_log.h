@@ -211,6 +211,55 @@ void rte_log_dump_history(FILE *f);
  */
 int rte_log_add_in_history(const char *buf, size_t size);
 
+/** Statistics of the asynchronous log ring of an lcore. */
+struct rte_log_async_stats {
+	uint64_t written; /**< Messages written by the writer thread. */
+	uint64_t dropped; /**< Messages dropped because the ring was full. */
+};
+
+/**
+ * Enable asynchronous logging.
+ *
+ * Once enabled, the messages logged by an EAL lcore are formatted in a
+ * lock-free ring of this lcore, of RTE_LOG_ASYNC_RING_SIZE messages, and
+ * written to the log stream by a background thread. Messages longer
+ * than 255 characters are truncated, and messages logged while the
+ * ring is full are dropped and counted. Messages of level RTE_LOG_CRIT
+ * or more urgent, and messages from other threads, are still written
+ * by the calling thread. The order of messages from different lcores
+ * is not preserved.
+ *
+ * This function is not thread-safe, it is usually called during
+ * initialization, for example through the --log-async EAL option.
+ *
+ * @return
+ *   - 0: Success.
+ *   - Negative on error.
+ */
+int rte_log_async_enable(void);
+
+/**
+ * Disable asynchronous logging.
+ *
+ * The writer thread writes the queued messages and exits. This function
+ * is not thread-safe.
+ */
+void rte_log_async_disable(void);
+
+/**
+ * Get the statistics of the asynchronous log ring of an lcore.
+ *
+ * @param lcore_id
+ *   The lcore identifier.
+ * @param stats
+ *   A pointer to a structure filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the lcore has no asynchronous log ring.
+ */
+int rte_log_async_get_stats(unsigned lcore_id,
+		struct rte_log_async_stats *stats);
+
 /**
  * Generates a log message.
  *
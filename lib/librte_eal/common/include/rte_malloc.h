@@ -60,6 +60,19 @@ struct rte_malloc_socket_stats {
 	size_t heap_allocsz_bytes; /**< Total allocated bytes on heap */
 };
 
+/**
+ * Statistics of the cache of small allocations of an lcore, obtained from
+ * rte_malloc_get_lcore_cache_stats function.
+ */
+struct rte_malloc_lcore_cache_stats {
+	uint64_t alloc_hits;     /**< Allocations served by the cache */
+	uint64_t alloc_misses;   /**< Allocations refilling the cache */
+	uint64_t free_hits;      /**< Frees kept in the cache */
+	uint64_t flushes;        /**< Flushes of the cache to the heap */
+	uint64_t lock_contended; /**< Times a heap lock was already taken */
+	unsigned cached_count;   /**< Elements currently in the cache */
+};
+
 /**
  * This function allocates memory from the huge-page area of memory. The memory
  * is not cleared. In NUMA systems, the memory allocated resides on the same
@@ -306,6 +319,54 @@ rte_malloc_get_socket_stats(int socket,
 void
 rte_malloc_dump_stats(FILE *f, const char *type);
 
+/**
+ * Enable the cache of small allocations of the calling lcore.
+ *
+ * Once enabled, allocations of up to 64 cache lines, without alignment
+ * constraint beyond a cache line, on the socket of the calling lcore, are
+ * served by a per lcore cache refilled from and flushed to the heap in
+ * batches, which avoids taking the heap lock for most of them. Frees of
+ * such elements go back to the cache of the calling lcore. Elements in
+ * the caches are reported as free by rte_malloc_get_socket_stats().
+ *
+ * The cache is disabled by default, and not available when
+ * CONFIG_RTE_MALLOC_CACHE_SIZE is 0 or in debug builds.
+ *
+ * @return
+ *   -1 if the calling thread is not an EAL thread or if the cache is not
+ *   available, 0 on success
+ */
+int
+rte_malloc_cache_enable(void);
+
+/**
+ * Disable the cache of small allocations of the calling lcore, giving
+ * all the memory in it back to the heap.
+ */
+void
+rte_malloc_cache_disable(void);
+
+/**
+ * Get the statistics of the cache of small allocations of an lcore.
+ *
+ * @param lcore_id
+ *   The lcore to get cache statistics for
+ * @param stats
+ *   A structure which provides memory to store statistics
+ * @return
+ *   -1 on error (invalid lcore_id), 0 on success
+ */
+int
+rte_malloc_get_lcore_cache_stats(unsigned lcore_id,
+		struct rte_malloc_lcore_cache_stats *stats);
+
+/**
+ * Give all the memory in the cache of small allocations of the calling
+ * lcore back to the heap.
+ */
+void
+rte_malloc_cache_flush(void);
+
 /**
  * Set the maximum amount of allocated memory for this type.
  *
@@ -54,38 +54,65 @@ extern "C" {
  * value. It may need to be re-seeded by the user with a real random
  * value.
  *
+ * Each lcore has its own generator state. All of them are derived from
+ * the seed, with non-overlapping sequences. This function must not be
+ * called while other threads are generating numbers.
+ *
  * @param seedval
  *   The value of the seed.
  */
-static inline void
-rte_srand(uint64_t seedval)
-{
-	srand48((long unsigned int)seedval);
-}
+void
+rte_srand(uint64_t seedval);
 
 /**
  * Get a pseudo-random value.
  *
- * This function generates pseudo-random numbers using the linear
- * congruential algorithm and 48-bit integer arithmetic, called twice
- * to generate a 64-bit value.
+ * This function generates pseudo-random numbers using the xoshiro256**
+ * algorithm, with one generator state per lcore, so that lcores do not
+ * share any data. It is not suitable for cryptography.
+ *
+ * The function is MT-safe when called from EAL threads. Threads that are
+ * not EAL threads share a single state and must not call it concurrently.
  *
  * @return
  *   A pseudo-random value between 0 and (1<<64)-1.
  */
-static inline uint64_t
-rte_rand(void)
-{
-	uint64_t val;
-	val = lrand48();
-	val <<= 32;
-	val += lrand48();
-	return val;
-}
+uint64_t
+rte_rand(void);
+
+/**
+ * Get several pseudo-random values.
+ *
+ * Equivalent to calling rte_rand() n times, but the generator state is
+ * looked up only once. The same MT-safety rules apply.
+ *
+ * @param vals
+ *   Array receiving the values.
+ * @param n
+ *   Number of values to generate.
+ */
+void
+rte_rand_bulk(uint64_t *vals, unsigned int n);
+
+/**
+ * Get a pseudo-random value in the range [0, upper_bound).
+ *
+ * The values are uniformly distributed: candidates above the bound are
+ * rejected instead of being reduced with a modulo. The same MT-safety
+ * rules as rte_rand() apply.
+ *
+ * @param upper_bound
+ *   Upper bound, excluded.
+ * @return
+ *   A pseudo-random value between 0 and upper_bound - 1, or 0 if
+ *   upper_bound is 0.
+ */
+uint64_t
+rte_rand_max(uint64_t upper_bound);
 
 #ifdef __cplusplus
 }
 #endif
 
 
-#endif /* _RTE_PER_LCORE_H_ */
+#endif /* _RTE_RANDOM_H_ */
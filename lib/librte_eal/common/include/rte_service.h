@@ -0,0 +1,330 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SERVICE_H_
+#define _RTE_SERVICE_H_
+
+/**
+ * @file
+ *
+ * RTE Service Cores
+ *
+ * Service cores run the background tasks of the components, such as
+ * timer management or statistics collection, on a few dedicated lcores
+ * so that the other lcores can stay in their packet processing loop.
+ *
+ * A component registers a service, that is a callback which does a
+ * bounded amount of work each time it is called. The application maps
+ * the services onto service lcores, given with the -s EAL option or
+ * added with rte_service_lcore_add(), and starts these lcores. Each
+ * service lcore then calls in a loop the running services mapped onto
+ * it, a service being called as many times in a row as its weight.
+ *
+ * The functions of this API are not thread-safe, except the ones
+ * changing the run state or the weight of a service.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of services. */
+#define RTE_SERVICE_NUM_MAX 64
+
+/** Maximum length of a service name, including the terminating '\0'. */
+#define RTE_SERVICE_NAME_MAX 32
+
+/**
+ * The callback of the service can be called by several lcores at the
+ * same time. Other services mapped onto several lcores are called by a
+ * single lcore at a time.
+ */
+#define RTE_SERVICE_CAP_MT_SAFE (1 << 0)
+
+/** Run state of a service or a service lcore. */
+#define RTE_SERVICE_RUNSTATE_STOPPED 0
+#define RTE_SERVICE_RUNSTATE_RUNNING 1
+
+/**
+ * Callback of a service.
+ *
+ * @param args
+ *   The callback_userdata of the service.
+ * @return
+ *   0 if work was done, or a negative value if there was nothing to do.
+ */
+typedef int32_t (*rte_service_func)(void *args);
+
+/** Description of a service given by its component. */
+struct rte_service_spec {
+	char name[RTE_SERVICE_NAME_MAX]; /**< Unique name of the service. */
+	rte_service_func callback;       /**< Work function. */
+	void *callback_userdata;         /**< Argument of the callback. */
+	uint32_t capabilities;           /**< RTE_SERVICE_CAP_* flags. */
+	int socket_id; /**< Preferred socket, or SOCKET_ID_ANY. */
+};
+
+/**
+ * Register a service.
+ *
+ * The service is stopped and not mapped onto any lcore, its weight is 1.
+ *
+ * @param spec
+ *   Description of the service, copied by the function.
+ * @param service_id
+ *   Set to the identifier of the service, if not NULL.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the name or the callback is invalid.
+ *   - (-EEXIST) if a service with the same name exists.
+ *   - (-ENOSPC) if RTE_SERVICE_NUM_MAX services are registered.
+ */
+int rte_service_component_register(const struct rte_service_spec *spec,
+		uint32_t *service_id);
+
+/**
+ * Unregister a service.
+ *
+ * The service must be stopped, and the service lcores must not be
+ * calling it any more.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the identifier is invalid.
+ *   - (-EBUSY) if the service is running.
+ */
+int rte_service_component_unregister(uint32_t service_id);
+
+/**
+ * Get the identifier of a service from its name.
+ *
+ * @param name
+ *   Name of the service.
+ * @param service_id
+ *   Set to the identifier of the service.
+ * @return
+ *   - 0: Success.
+ *   - (-ENODEV) if no service has this name.
+ */
+int rte_service_get_by_name(const char *name, uint32_t *service_id);
+
+/**
+ * Get the name of a service.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @return
+ *   The name of the service, or NULL if the identifier is invalid.
+ */
+const char *rte_service_get_name(uint32_t service_id);
+
+/**
+ * Get the number of registered services.
+ *
+ * @return
+ *   The number of registered services.
+ */
+uint32_t rte_service_get_count(void);
+
+/**
+ * Start or stop a service.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @param runstate
+ *   RTE_SERVICE_RUNSTATE_RUNNING or RTE_SERVICE_RUNSTATE_STOPPED.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the identifier or the run state is invalid.
+ */
+int rte_service_runstate_set(uint32_t service_id, uint32_t runstate);
+
+/**
+ * Get the run state of a service.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @return
+ *   - 1 if the service is running and mapped onto a running service
+ *     lcore, 0 otherwise.
+ *   - (-EINVAL) if the identifier is invalid.
+ */
+int rte_service_runstate_get(uint32_t service_id);
+
+/**
+ * Set the weight of a service.
+ *
+ * The weight is the number of times in a row the service is called by a
+ * service lcore in each round over its services. It can be changed
+ * while the service is running.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @param weight
+ *   Weight of the service, at least 1.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the identifier or the weight is invalid.
+ */
+int rte_service_set_weight(uint32_t service_id, uint32_t weight);
+
+/**
+ * Map or unmap a service onto a service lcore.
+ *
+ * It can be called while the lcore is running.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @param lcore
+ *   Identifier of the service lcore.
+ * @param enable
+ *   Non-zero to map the service, zero to unmap it.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the service or the lcore is invalid.
+ */
+int rte_service_map_lcore_set(uint32_t service_id, uint32_t lcore,
+		uint32_t enable);
+
+/**
+ * Check whether a service is mapped onto a service lcore.
+ *
+ * @param service_id
+ *   Identifier of the service.
+ * @param lcore
+ *   Identifier of the service lcore.
+ * @return
+ *   - 1 if the service is mapped onto the lcore, 0 otherwise.
+ *   - (-EINVAL) if the service or the lcore is invalid.
+ */
+int rte_service_map_lcore_get(uint32_t service_id, uint32_t lcore);
+
+/**
+ * Turn an lcore into a service lcore.
+ *
+ * The lcore must be an enabled slave lcore waiting for work. It is not
+ * enabled any more for the application, so it is skipped by
+ * RTE_LCORE_FOREACH() and rte_eal_mp_remote_launch(), and is not counted
+ * by rte_lcore_count().
+ *
+ * @param lcore
+ *   Identifier of the lcore.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the lcore is invalid or is the master lcore.
+ *   - (-EALREADY) if the lcore is already a service lcore.
+ *   - (-EBUSY) if the lcore is running a function.
+ */
+int rte_service_lcore_add(uint32_t lcore);
+
+/**
+ * Give a stopped service lcore back to the application.
+ *
+ * @param lcore
+ *   Identifier of the service lcore.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the lcore is not a service lcore.
+ *   - (-EBUSY) if the lcore is running.
+ */
+int rte_service_lcore_del(uint32_t lcore);
+
+/**
+ * Start a service lcore, which calls the services mapped onto it until
+ * it is stopped.
+ *
+ * @param lcore
+ *   Identifier of the service lcore.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the lcore is not a service lcore.
+ *   - (-EALREADY) if the lcore is already running.
+ */
+int rte_service_lcore_start(uint32_t lcore);
+
+/**
+ * Stop a service lcore and wait for the end of its current round.
+ *
+ * @param lcore
+ *   Identifier of the service lcore.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the lcore is not a service lcore.
+ *   - (-EALREADY) if the lcore is not running.
+ */
+int rte_service_lcore_stop(uint32_t lcore);
+
+/**
+ * Get the number of service lcores.
+ *
+ * @return
+ *   The number of service lcores.
+ */
+uint32_t rte_service_lcore_count(void);
+
+/**
+ * Get the list of the service lcores.
+ *
+ * @param array
+ *   Array filled with the identifiers of the service lcores.
+ * @param n
+ *   Number of entries in the array.
+ * @return
+ *   - The number of service lcores.
+ *   - (-ENOMEM) if the array is too small.
+ */
+int rte_service_lcore_list(uint32_t array[], uint32_t n);
+
+/**
+ * Dump the state and the statistics of services.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ * @param service_id
+ *   Identifier of the service, or UINT32_MAX for all services.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the identifier is invalid.
+ */
+int rte_service_dump(FILE *f, uint32_t service_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SERVICE_H_ */
@@ -266,16 +266,14 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 /*
  * free a malloc_elem block by adding it to the free list. If the
  * blocks either immediately before or immediately after newly freed block
- * are also free, the blocks are merged together.
+ * are also free, the blocks are merged together. The heap lock must be held.
  */
-int
-malloc_elem_free(struct malloc_elem *elem)
+struct rte_memseg *
+malloc_elem_free_locked(struct malloc_elem *elem)
 {
-	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
-		return -1;
-
-	rte_spinlock_lock(&(elem->heap->lock));
+	struct malloc_heap *heap = elem->heap;
 	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
+
 	if (next->state == ELEM_FREE){
 		/* remove from free list, join to this one */
 		elem_free_list_remove(next);
@@ -289,6 +287,7 @@ malloc_elem_free(struct malloc_elem *elem)
 		elem_free_list_remove(elem->prev);
 		join_elem(elem->prev, elem);
 		malloc_elem_free_list_insert(elem->prev);
+		elem = elem->prev;
 	}
 	/* otherwise add ourselves to the free list */
 	else {
@@ -296,8 +295,25 @@ malloc_elem_free(struct malloc_elem *elem)
 		elem->pad = 0;
 	}
 	/* decrease heap's count of allocated elements */
-	elem->heap->alloc_count--;
-	rte_spinlock_unlock(&(elem->heap->lock));
+	heap->alloc_count--;
+	/* give memory added at runtime back once entirely free */
+	return malloc_heap_shrink(elem);
+}
+
+int
+malloc_elem_free(struct malloc_elem *elem)
+{
+	struct malloc_heap *heap;
+	struct rte_memseg *ms;
+
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
+		return -1;
+
+	heap = elem->heap;
+	malloc_heap_lock(heap);
+	ms = malloc_elem_free_locked(elem);
+	rte_spinlock_unlock(&heap->lock);
+	malloc_heap_release(heap, ms);
 
 	return 0;
 }
@@ -316,7 +332,7 @@ malloc_elem_resize(struct malloc_elem *elem, size_t size)
 		return 0;
 
 	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
-	rte_spinlock_lock(&elem->heap->lock);
+	malloc_heap_lock(elem->heap);
 	if (next ->state != ELEM_FREE)
 		goto err_return;
 	if (current_size + next->size < new_size)
@@ -170,6 +170,14 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size,
 int
 malloc_elem_free(struct malloc_elem *elem);
 
+/*
+ * same as malloc_elem_free(), for a valid busy element, with the heap
+ * lock already held. Returns a memseg to give to malloc_heap_release()
+ * once the lock is dropped, or NULL.
+ */
+struct rte_memseg *
+malloc_elem_free_locked(struct malloc_elem *elem);
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
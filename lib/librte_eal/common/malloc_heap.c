@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <errno.h>
 #include <sys/queue.h>
 
@@ -50,9 +51,39 @@
 #include <rte_memcpy.h>
 #include <rte_atomic.h>
 
+#include "eal_private.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
+/* debug builds check every free, so they don't cache anything */
+#ifdef RTE_LIBRTE_MALLOC_DEBUG
+#define MALLOC_CACHE_SIZE 0
+#else
+#define MALLOC_CACHE_SIZE RTE_MALLOC_CACHE_SIZE
+#endif
+
+/* number of elements moved between a cache and the heap at once */
+#define MALLOC_CACHE_BULK (MALLOC_CACHE_SIZE / 2 > 0 ? MALLOC_CACHE_SIZE / 2 : 1)
+
+/*
+ * Per lcore cache of small busy elements of the heap of the lcore socket,
+ * one stack of data pointers per size class. Elements in the caches are
+ * allocated from the heap point of view.
+ */
+struct malloc_lcore_cache {
+	int enabled;                 /**< set by rte_malloc_cache_enable() */
+	struct {
+		unsigned len;
+		void *objs[MALLOC_CACHE_SIZE];
+	} classes[MALLOC_CACHE_NUM_CLASSES];
+	unsigned socket_id;          /**< socket of the cached elements */
+	unsigned cached_count;       /**< elements in all classes */
+	size_t cached_bytes;         /**< size of these elements */
+	struct rte_malloc_lcore_cache_stats stats;
+} __rte_cache_aligned;
+
+static struct malloc_lcore_cache lcore_caches[RTE_MAX_LCORE];
+
 static unsigned
 check_hugepage_sz(unsigned flags, uint64_t hugepage_sz)
 {
@@ -145,6 +176,115 @@ find_suitable_element(struct malloc_heap *heap, size_t size,
 	return NULL;
 }
 
+/* per heap, a memseg added at runtime kept once entirely free */
+static struct rte_memseg *spare_memseg[RTE_MAX_NUMA_NODES];
+
+/* check if a memseg added at runtime holds a single free element */
+static int
+malloc_heap_memseg_empty(const struct rte_memseg *ms)
+{
+	const struct malloc_elem *elem = ms->addr;
+	const struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
+
+	return ms->len != 0 && elem->state == ELEM_FREE && next->size == 0;
+}
+
+/* remove the free element spanning a whole memseg from the heap */
+static void
+malloc_heap_detach_memseg(struct malloc_heap *heap, struct malloc_elem *elem)
+{
+	/* the element is gone with the memory, don't touch it afterwards */
+	LIST_REMOVE(elem, free_list);
+	heap->total_size -= elem->size;
+}
+
+/*
+ * Grow the heap with a new memseg large enough for the request, then
+ * re-scan the free list. The memseg is given back if it doesn't help.
+ * Must be called with the heap lock held, which is dropped around the
+ * system calls growing the heap.
+ */
+static struct malloc_elem *
+malloc_heap_grow(struct malloc_heap *heap, size_t size,
+		unsigned flags, size_t align, size_t bound)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct malloc_elem *elem;
+	struct rte_memseg *ms;
+
+	rte_spinlock_unlock(&heap->lock);
+	ms = rte_eal_memseg_grow(heap - mcfg->malloc_heaps,
+			size + align + 2 * MALLOC_ELEM_OVERHEAD);
+	malloc_heap_lock(heap);
+	if (ms == NULL)
+		return NULL;
+
+	malloc_heap_add_memseg(heap, ms);
+
+	elem = find_suitable_element(heap, size, flags, align, bound);
+	if (elem == NULL) {
+		malloc_heap_detach_memseg(heap, ms->addr);
+		rte_spinlock_unlock(&heap->lock);
+		malloc_heap_release(heap, ms);
+		malloc_heap_lock(heap);
+	}
+
+	return elem;
+}
+
+/*
+ * Detach a memseg added at runtime from the heap, once the given free
+ * element covers all of it, unless it is the only such empty memseg of
+ * the heap, which is kept to not grow again on the next allocation.
+ * Must be called with the heap lock held. Returns the memseg to give to
+ * malloc_heap_release() once the lock is dropped, or NULL.
+ */
+struct rte_memseg *
+malloc_heap_shrink(struct malloc_elem *elem)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
+	struct malloc_heap *heap = elem->heap;
+	struct rte_memseg *ms, **spare;
+
+	if (elem->ms < mcfg->dyn_memseg ||
+			elem->ms >= &mcfg->dyn_memseg[RTE_MAX_MEMSEG] ||
+			rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return NULL;
+
+	/* only an element spanning from the start to the end marker */
+	if (elem->state != ELEM_FREE || elem->prev != NULL || next->size != 0)
+		return NULL;
+
+	ms = &mcfg->dyn_memseg[elem->ms - mcfg->dyn_memseg];
+
+	spare = &spare_memseg[heap - mcfg->malloc_heaps];
+	if (*spare == NULL || *spare == ms ||
+			!malloc_heap_memseg_empty(*spare)) {
+		*spare = ms;
+		return NULL;
+	}
+
+	malloc_heap_detach_memseg(heap, elem);
+	return ms;
+}
+
+/*
+ * Give a memseg detached from the heap back to the system. Must be called
+ * without the heap lock, which is only taken to add the memseg back if it
+ * can't be released.
+ */
+void
+malloc_heap_release(struct malloc_heap *heap, struct rte_memseg *ms)
+{
+	if (ms == NULL || rte_eal_memseg_release(ms) == 0)
+		return;
+
+	malloc_heap_lock(heap);
+	malloc_heap_add_memseg(heap, ms);
+	rte_spinlock_unlock(&heap->lock);
+}
+
 /*
  * Main function to allocate a block of memory from the heap.
  * It locks the free list, scans it, and adds a new memseg if the
@@ -161,9 +301,11 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	size = RTE_CACHE_LINE_ROUNDUP(size);
 	align = RTE_CACHE_LINE_ROUNDUP(align);
 
-	rte_spinlock_lock(&heap->lock);
+	malloc_heap_lock(heap);
 
 	elem = find_suitable_element(heap, size, flags, align, bound);
+	if (elem == NULL)
+		elem = malloc_heap_grow(heap, size, flags, align, bound);
 	if (elem != NULL) {
 		elem = malloc_elem_alloc(elem, size, align, bound);
 		/* increase heap's count of allocated elements */
@@ -174,6 +316,235 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	return elem == NULL ? NULL : (void *)(&elem[1]);
 }
 
+/*
+ * Take the heap lock, counting for the calling lcore how often it was
+ * already taken.
+ */
+void
+malloc_heap_lock(struct malloc_heap *heap)
+{
+	unsigned lcore_id;
+
+	if (rte_spinlock_trylock(&heap->lock))
+		return;
+
+	lcore_id = rte_lcore_id();
+	if (lcore_id < RTE_MAX_LCORE)
+		lcore_caches[lcore_id].stats.lock_contended++;
+	rte_spinlock_lock(&heap->lock);
+}
+
+/*
+ * Allocate up to n elements of the given size, aligned on a cache line,
+ * taking the heap lock once. Returns the number of elements allocated.
+ */
+static unsigned
+malloc_heap_alloc_bulk(struct malloc_heap *heap, size_t size,
+		void **objs, unsigned n)
+{
+	struct malloc_elem *elem;
+	unsigned i;
+
+	malloc_heap_lock(heap);
+	for (i = 0; i < n; i++) {
+		elem = find_suitable_element(heap, size, 0,
+				RTE_CACHE_LINE_SIZE, 0);
+		/* only grow the heap for the element actually asked for */
+		if (elem == NULL && i == 0)
+			elem = malloc_heap_grow(heap, size, 0,
+					RTE_CACHE_LINE_SIZE, 0);
+		if (elem == NULL)
+			break;
+		elem = malloc_elem_alloc(elem, size, RTE_CACHE_LINE_SIZE, 0);
+		heap->alloc_count++;
+		objs[i] = &elem[1];
+	}
+	rte_spinlock_unlock(&heap->lock);
+
+	return i;
+}
+
+/* Free n valid busy elements of a heap, taking the heap lock once. */
+static void
+malloc_heap_free_bulk(struct malloc_heap *heap, void * const *objs,
+		unsigned n)
+{
+	struct rte_memseg *ms;
+	unsigned i;
+
+	malloc_heap_lock(heap);
+	for (i = 0; i < n; i++) {
+		ms = malloc_elem_free_locked(malloc_elem_from_data(objs[i]));
+		if (ms != NULL) {
+			rte_spinlock_unlock(&heap->lock);
+			malloc_heap_release(heap, ms);
+			malloc_heap_lock(heap);
+		}
+	}
+	rte_spinlock_unlock(&heap->lock);
+}
+
+/* get the cache of the calling lcore if it can cache elements of heap */
+static inline struct malloc_lcore_cache *
+malloc_cache_get(const struct malloc_heap *heap)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned socket_id = malloc_get_numa_socket();
+
+	if (MALLOC_CACHE_SIZE == 0 || lcore_id >= RTE_MAX_LCORE ||
+			!lcore_caches[lcore_id].enabled ||
+			heap != &mcfg->malloc_heaps[socket_id])
+		return NULL;
+
+	lcore_caches[lcore_id].socket_id = socket_id;
+	return &lcore_caches[lcore_id];
+}
+
+/* account an element entering or leaving a cache */
+static inline void
+malloc_cache_account(struct malloc_lcore_cache *cache, const void *obj,
+		int enter)
+{
+	const struct malloc_elem *elem = malloc_elem_from_data(obj);
+
+	if (enter) {
+		cache->cached_count++;
+		cache->cached_bytes += elem->size;
+	} else {
+		cache->cached_count--;
+		cache->cached_bytes -= elem->size;
+	}
+}
+
+/*
+ * Allocate an element of at least size bytes from the cache of the
+ * calling lcore, refilling it from the heap if needed. Returns NULL if
+ * the size is not cached, or if the heap is out of memory.
+ */
+void *
+malloc_heap_cache_alloc(struct malloc_heap *heap, size_t size)
+{
+	struct malloc_lcore_cache *cache = malloc_cache_get(heap);
+	unsigned cls, i, n;
+	void *obj;
+
+	if (cache == NULL || size > MALLOC_CACHE_MAX_SIZE)
+		return NULL;
+
+	/* smallest class holding size */
+	cls = size <= RTE_CACHE_LINE_SIZE ? 0 :
+		sizeof(size) * 8 - __builtin_clzl(size - 1) -
+		RTE_CACHE_LINE_SIZE_LOG2;
+
+	if (cache->classes[cls].len == 0) {
+		n = malloc_heap_alloc_bulk(heap,
+				(size_t)RTE_CACHE_LINE_SIZE << cls,
+				cache->classes[cls].objs, MALLOC_CACHE_BULK);
+		if (n == 0)
+			return NULL;
+		for (i = 0; i < n; i++)
+			malloc_cache_account(cache,
+					cache->classes[cls].objs[i], 1);
+		cache->classes[cls].len = n;
+		cache->stats.alloc_misses++;
+	} else
+		cache->stats.alloc_hits++;
+
+	obj = cache->classes[cls].objs[--cache->classes[cls].len];
+	malloc_cache_account(cache, obj, 0);
+	return obj;
+}
+
+/*
+ * Put a valid busy element in the cache of the calling lcore, flushing
+ * the oldest half of the cache to the heap if it is full. Returns -1 if
+ * the element cannot be cached.
+ */
+int
+malloc_heap_cache_free(struct malloc_elem *elem, void *obj)
+{
+	struct malloc_lcore_cache *cache = malloc_cache_get(elem->heap);
+	size_t size = elem->size - elem->pad - MALLOC_ELEM_OVERHEAD;
+	unsigned cls, len;
+	void **objs;
+
+	/* larger elements would be wasted in the top class */
+	if (cache == NULL || size >= 2 * MALLOC_CACHE_MAX_SIZE)
+		return -1;
+
+	/* largest class held by the element */
+	cls = sizeof(size) * 8 - __builtin_clzl(size) - 1 -
+		RTE_CACHE_LINE_SIZE_LOG2;
+
+	objs = cache->classes[cls].objs;
+	len = cache->classes[cls].len;
+	if (len == MALLOC_CACHE_SIZE) {
+		unsigned i;
+
+		for (i = 0; i < MALLOC_CACHE_BULK; i++)
+			malloc_cache_account(cache, objs[i], 0);
+		malloc_heap_free_bulk(elem->heap, objs, MALLOC_CACHE_BULK);
+		len -= MALLOC_CACHE_BULK;
+		memmove(objs, &objs[MALLOC_CACHE_BULK], len * sizeof(objs[0]));
+		cache->stats.flushes++;
+	}
+
+	objs[len] = obj;
+	cache->classes[cls].len = len + 1;
+	malloc_cache_account(cache, obj, 1);
+	cache->stats.free_hits++;
+	return 0;
+}
+
+/* Enable or disable the cache of the calling lcore, flushing it on disable. */
+int
+malloc_heap_cache_enable(int enable)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	if (MALLOC_CACHE_SIZE == 0 || lcore_id >= RTE_MAX_LCORE)
+		return -1;
+
+	if (!enable)
+		malloc_heap_cache_flush();
+	lcore_caches[lcore_id].enabled = enable;
+	return 0;
+}
+
+/* Give all elements in the cache of the calling lcore back to the heap. */
+void
+malloc_heap_cache_flush(void)
+{
+	struct malloc_lcore_cache *cache;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned cls;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	cache = &lcore_caches[lcore_id];
+	for (cls = 0; cls < MALLOC_CACHE_NUM_CLASSES; cls++) {
+		if (cache->classes[cls].len == 0)
+			continue;
+		malloc_heap_free_bulk(
+			malloc_elem_from_data(cache->classes[cls].objs[0])->heap,
+			cache->classes[cls].objs, cache->classes[cls].len);
+		cache->classes[cls].len = 0;
+		cache->stats.flushes++;
+	}
+	cache->cached_count = 0;
+	cache->cached_bytes = 0;
+}
+
+void
+malloc_heap_get_cache_stats(unsigned lcore_id,
+		struct rte_malloc_lcore_cache_stats *stats)
+{
+	*stats = lcore_caches[lcore_id].stats;
+	stats->cached_count = lcore_caches[lcore_id].cached_count;
+}
+
 /*
  * Function to retrieve data for heap on given socket
  */
@@ -181,6 +552,9 @@ int
 malloc_heap_get_stats(const struct malloc_heap *heap,
 		struct rte_malloc_socket_stats *socket_stats)
 {
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned socket = heap - mcfg->malloc_heaps;
+	unsigned lcore_id, cached_count = 0;
 	size_t idx;
 	struct malloc_elem *elem;
 
@@ -200,11 +574,22 @@ malloc_heap_get_stats(const struct malloc_heap *heap,
 				socket_stats->greatest_free_size = elem->size;
 		}
 	}
+
+	/* elements in the lcore caches are free from the user point of view */
+	for (lcore_id = 0; MALLOC_CACHE_SIZE > 0 && lcore_id < RTE_MAX_LCORE;
+			lcore_id++) {
+		if (lcore_caches[lcore_id].socket_id != socket)
+			continue;
+		cached_count += lcore_caches[lcore_id].cached_count;
+		socket_stats->heap_freesz_bytes +=
+			lcore_caches[lcore_id].cached_bytes;
+	}
+
 	/* Get stats on overall heap and allocated memory on this heap */
 	socket_stats->heap_totalsz_bytes = heap->total_size;
 	socket_stats->heap_allocsz_bytes = (socket_stats->heap_totalsz_bytes -
 			socket_stats->heap_freesz_bytes);
-	socket_stats->alloc_count = heap->alloc_count;
+	socket_stats->alloc_count = heap->alloc_count - cached_count;
 	return 0;
 }
 
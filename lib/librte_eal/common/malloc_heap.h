@@ -37,6 +37,11 @@
 #include <rte_malloc.h>
 #include <rte_malloc_heap.h>
 
+/* size classes of the lcore caches, from a cache line to 64 lines */
+#define MALLOC_CACHE_NUM_CLASSES 7
+#define MALLOC_CACHE_MAX_SIZE \
+	((size_t)RTE_CACHE_LINE_SIZE << (MALLOC_CACHE_NUM_CLASSES - 1))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -56,6 +61,33 @@ void *
 malloc_heap_alloc(struct malloc_heap *heap,	const char *type, size_t size,
 		unsigned flags, size_t align, size_t bound);
 
+struct malloc_elem;
+
+struct rte_memseg *
+malloc_heap_shrink(struct malloc_elem *elem);
+
+void
+malloc_heap_release(struct malloc_heap *heap, struct rte_memseg *ms);
+
+void
+malloc_heap_lock(struct malloc_heap *heap);
+
+void *
+malloc_heap_cache_alloc(struct malloc_heap *heap, size_t size);
+
+int
+malloc_heap_cache_free(struct malloc_elem *elem, void *obj);
+
+int
+malloc_heap_cache_enable(int enable);
+
+void
+malloc_heap_cache_flush(void);
+
+void
+malloc_heap_get_cache_stats(unsigned lcore_id,
+		struct rte_malloc_lcore_cache_stats *stats);
+
 int
 malloc_heap_get_stats(const struct malloc_heap *heap,
 		struct rte_malloc_socket_stats *socket_stats);
@@ -0,0 +1,98 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_memzone.h>
+#include <rte_log.h>
+#include <rte_lcore_poll.h>
+
+#include "eal_private.h"
+
+#define LCORE_POLL_MZ_NAME "RTE_LCORE_POLL"
+
+/* used until rte_eal_lcore_poll_init() maps the shared statistics */
+static struct rte_lcore_poll_stats lcore_poll_local[RTE_MAX_LCORE];
+static int lcore_poll_shared;
+
+struct rte_lcore_poll_stats *rte_lcore_poll_stats = lcore_poll_local;
+
+int
+rte_eal_lcore_poll_init(void)
+{
+#ifdef RTE_LCORE_POLL_STATS
+	const struct rte_memzone *mz;
+	const size_t len = sizeof(struct rte_lcore_poll_stats) * RTE_MAX_LCORE;
+
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		mz = rte_memzone_reserve(LCORE_POLL_MZ_NAME, len,
+				SOCKET_ID_ANY, 0);
+		if (mz != NULL)
+			memset(mz->addr, 0, len);
+	} else
+		mz = rte_memzone_lookup(LCORE_POLL_MZ_NAME);
+
+	if (mz == NULL) {
+		/* keep counting in process memory, not visible to others */
+		RTE_LOG(WARNING, EAL, "Cannot share lcore poll statistics\n");
+		return -1;
+	}
+
+	rte_lcore_poll_stats = mz->addr;
+	lcore_poll_shared = 1;
+#endif
+	return 0;
+}
+
+void
+eal_lcore_poll_reset(unsigned int lcore_id)
+{
+	/* the time out of the launched function is not an iteration */
+	rte_lcore_poll_stats[lcore_id].last_tsc = 0;
+}
+
+int
+rte_lcore_poll_stats_get(unsigned int lcore_id,
+		struct rte_lcore_poll_stats *stats)
+{
+	if (lcore_id >= RTE_MAX_LCORE || stats == NULL)
+		return -EINVAL;
+	if (!lcore_poll_shared)
+		return -ENOTSUP;
+
+	*stats = rte_lcore_poll_stats[lcore_id];
+	return 0;
+}
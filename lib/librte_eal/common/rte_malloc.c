@@ -33,6 +33,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/queue.h>
@@ -54,11 +55,18 @@
 #include "malloc_heap.h"
 
 
-/* Free the memory space back to heap */
+/* Free the memory space back to heap, through the lcore cache if possible */
 void rte_free(void *addr)
 {
+	struct malloc_elem *elem;
+
 	if (addr == NULL) return;
-	if (malloc_elem_free(malloc_elem_from_data(addr)) < 0)
+	elem = malloc_elem_from_data(addr);
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
+		rte_panic("Fatal error: Invalid memory\n");
+	if (malloc_heap_cache_free(elem, addr) == 0)
+		return;
+	if (malloc_elem_free(elem) < 0)
 		rte_panic("Fatal error: Invalid memory\n");
 }
 
@@ -88,6 +96,14 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 	if (socket >= RTE_MAX_NUMA_NODES)
 		return NULL;
 
+	/* small allocations come from the lcore cache */
+	if (align <= RTE_CACHE_LINE_SIZE) {
+		ret = malloc_heap_cache_alloc(&mcfg->malloc_heaps[socket],
+				size);
+		if (ret != NULL)
+			return ret;
+	}
+
 	ret = malloc_heap_alloc(&mcfg->malloc_heaps[socket], type,
 				size, 0, align == 0 ? 1 : align, 0);
 	if (ret != NULL || socket_arg != SOCKET_ID_ANY)
@@ -172,9 +188,14 @@ rte_realloc(void *ptr, size_t size, unsigned align)
 
 	size = RTE_CACHE_LINE_ROUNDUP(size), align = RTE_CACHE_LINE_ROUNDUP(align);
 	/* check alignment matches first, and if ok, see if we can resize block */
-	if (RTE_PTR_ALIGN(ptr,align) == ptr &&
-			malloc_elem_resize(elem, size) == 0)
-		return ptr;
+	if (RTE_PTR_ALIGN(ptr,align) == ptr) {
+		if (malloc_elem_resize(elem, size) == 0)
+			return ptr;
+		/* cached free elements may be in the way, retry without them */
+		malloc_heap_cache_flush();
+		if (malloc_elem_resize(elem, size) == 0)
+			return ptr;
+	}
 
 	/* either alignment is off, or we have no room to expand,
 	 * so move data. */
@@ -220,8 +241,9 @@ rte_malloc_get_socket_stats(int socket,
 void
 rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 {
-	unsigned int socket;
+	unsigned int socket, lcore_id;
 	struct rte_malloc_socket_stats sock_stats;
+	struct rte_malloc_lcore_cache_stats cache_stats;
 	/* Iterate through all initialised heaps */
 	for (socket=0; socket< RTE_MAX_NUMA_NODES; socket++) {
 		if ((rte_malloc_get_socket_stats(socket, &sock_stats) < 0))
@@ -236,9 +258,69 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 		fprintf(f, "\tAlloc_count:%u,\n",sock_stats.alloc_count);
 		fprintf(f, "\tFree_count:%u,\n", sock_stats.free_count);
 	}
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!rte_lcore_is_enabled(lcore_id))
+			continue;
+		rte_malloc_get_lcore_cache_stats(lcore_id, &cache_stats);
+
+		fprintf(f, "Lcore:%u\n", lcore_id);
+		fprintf(f, "\tCache_alloc_hits:%"PRIu64",\n",
+				cache_stats.alloc_hits);
+		fprintf(f, "\tCache_alloc_misses:%"PRIu64",\n",
+				cache_stats.alloc_misses);
+		fprintf(f, "\tCache_free_hits:%"PRIu64",\n",
+				cache_stats.free_hits);
+		fprintf(f, "\tCache_flushes:%"PRIu64",\n",
+				cache_stats.flushes);
+		fprintf(f, "\tCache_count:%u,\n", cache_stats.cached_count);
+		fprintf(f, "\tLock_contended:%"PRIu64",\n",
+				cache_stats.lock_contended);
+	}
 	return;
 }
 
+/*
+ * Function to retrieve the cache statistics of an lcore
+ */
+int
+rte_malloc_get_lcore_cache_stats(unsigned lcore_id,
+		struct rte_malloc_lcore_cache_stats *stats)
+{
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -1;
+
+	malloc_heap_get_cache_stats(lcore_id, stats);
+	return 0;
+}
+
+/*
+ * Enable the cache of the calling lcore
+ */
+int
+rte_malloc_cache_enable(void)
+{
+	return malloc_heap_cache_enable(1);
+}
+
+/*
+ * Disable the cache of the calling lcore
+ */
+void
+rte_malloc_cache_disable(void)
+{
+	malloc_heap_cache_enable(0);
+}
+
+/*
+ * Flush the cache of the calling lcore
+ */
+void
+rte_malloc_cache_flush(void)
+{
+	malloc_heap_cache_flush();
+}
+
 /*
  * TODO: Set limit to memory that can be allocated to memory type
  */
@@ -0,0 +1,173 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_random.h>
+
+/* xoshiro256** state, kept on its own cache line */
+struct rte_rand_state {
+	uint64_t s[4];
+} __rte_cache_aligned;
+
+/* one state per lcore, the last one is shared by non-EAL threads */
+static struct rte_rand_state rand_states[RTE_MAX_LCORE + 1];
+
+static inline uint64_t
+rand_rotl(uint64_t x, unsigned int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/* splitmix64, only used to expand the seed into a full state */
+static uint64_t
+rand_splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static inline uint64_t
+rand_next(struct rte_rand_state *state)
+{
+	uint64_t *s = state->s;
+	const uint64_t result = rand_rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rand_rotl(s[3], 45);
+
+	return result;
+}
+
+/* advance a state by 2^128 steps, so that each lcore gets its own sequence */
+static void
+rand_jump(struct rte_rand_state *state)
+{
+	static const uint64_t jump[] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+		0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+	};
+	uint64_t s[4] = { 0, 0, 0, 0 };
+	unsigned int i, b, j;
+
+	for (i = 0; i < RTE_DIM(jump); i++) {
+		for (b = 0; b < 64; b++) {
+			if (jump[i] & (1ULL << b))
+				for (j = 0; j < 4; j++)
+					s[j] ^= state->s[j];
+			rand_next(state);
+		}
+	}
+	for (j = 0; j < 4; j++)
+		state->s[j] = s[j];
+}
+
+static inline struct rte_rand_state *
+rand_get_state(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return &rand_states[RTE_MAX_LCORE];
+
+	return &rand_states[lcore_id];
+}
+
+void
+rte_srand(uint64_t seedval)
+{
+	unsigned int i, j;
+
+	for (j = 0; j < 4; j++)
+		rand_states[0].s[j] = rand_splitmix64(&seedval);
+
+	for (i = 1; i < RTE_DIM(rand_states); i++) {
+		rand_states[i] = rand_states[i - 1];
+		rand_jump(&rand_states[i]);
+	}
+}
+
+uint64_t
+rte_rand(void)
+{
+	return rand_next(rand_get_state());
+}
+
+void
+rte_rand_bulk(uint64_t *vals, unsigned int n)
+{
+	struct rte_rand_state *state = rand_get_state();
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		vals[i] = rand_next(state);
+}
+
+uint64_t
+rte_rand_max(uint64_t upper_bound)
+{
+	struct rte_rand_state *state;
+	uint64_t mask, res;
+
+	if (unlikely(upper_bound < 2))
+		return 0;
+
+	state = rand_get_state();
+
+	/* smallest all-ones mask covering the bound, rejects less than half */
+	mask = ~0ULL >> __builtin_clzll(upper_bound - 1);
+	do {
+		res = rand_next(state) & mask;
+	} while (unlikely(res >= upper_bound));
+
+	return res;
+}
+
+/* rte_rand() may be called before rte_eal_init(), which seeds again */
+static void __attribute__((constructor))
+rte_rand_init(void)
+{
+	rte_srand(rte_rdtsc());
+}
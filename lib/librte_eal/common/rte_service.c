@@ -0,0 +1,473 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_eal.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_log.h>
+#include <rte_string_fns.h>
+#include <rte_service.h>
+
+#include "eal_private.h"
+#include "eal_internal_cfg.h"
+
+/* one registered service */
+struct rte_service {
+	struct rte_service_spec spec;
+	uint8_t registered;
+	/* the fields below can be changed while the service lcores run */
+	volatile uint32_t runstate;
+	volatile uint32_t weight;
+	/* taken by the lcore calling a service which is not MT-safe */
+	rte_atomic32_t execute_lock;
+} __rte_cache_aligned;
+
+/* state of one service lcore, only written by this lcore in its loop */
+struct service_core {
+	volatile uint64_t service_mask;
+	volatile uint32_t runstate;
+	uint8_t is_service_core;
+	uint64_t calls[RTE_SERVICE_NUM_MAX];
+	uint64_t cycles[RTE_SERVICE_NUM_MAX];
+} __rte_cache_aligned;
+
+static struct rte_service services[RTE_SERVICE_NUM_MAX];
+static struct service_core service_cores[RTE_MAX_LCORE];
+static uint32_t service_count;
+
+static inline int
+service_valid(uint32_t id)
+{
+	return id < RTE_SERVICE_NUM_MAX && services[id].registered;
+}
+
+static inline int
+service_core_valid(uint32_t lcore)
+{
+	return lcore < RTE_MAX_LCORE && service_cores[lcore].is_service_core;
+}
+
+/* call a service weight times, unless another lcore is calling it */
+static inline void
+service_run(struct service_core *cs, uint32_t id)
+{
+	struct rte_service *s = &services[id];
+	uint32_t weight = s->weight;
+	int serialize;
+	uint64_t start;
+	uint32_t i;
+
+	if (s->runstate != RTE_SERVICE_RUNSTATE_RUNNING)
+		return;
+
+	/* the lock is taken even when the service is mapped onto a single
+	 * lcore, as it can be mapped onto another one meanwhile */
+	serialize = !(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE);
+	if (serialize && !rte_atomic32_test_and_set(&s->execute_lock))
+		return;
+
+	start = rte_rdtsc();
+	for (i = 0; i < weight; i++)
+		s->spec.callback(s->spec.callback_userdata);
+	cs->cycles[id] += rte_rdtsc() - start;
+	cs->calls[id] += weight;
+
+	if (serialize)
+		rte_atomic32_clear(&s->execute_lock);
+}
+
+/* main loop of a service lcore */
+static int
+service_runner_func(void *arg)
+{
+	struct service_core *cs = &service_cores[rte_lcore_id()];
+	uint64_t mask;
+	uint32_t id;
+
+	RTE_SET_USED(arg);
+
+	while (cs->runstate == RTE_SERVICE_RUNSTATE_RUNNING) {
+		mask = cs->service_mask;
+		while (mask != 0) {
+			id = __builtin_ctzll(mask);
+			mask &= mask - 1;
+			service_run(cs, id);
+		}
+		rte_compiler_barrier();
+	}
+
+	return 0;
+}
+
+int
+rte_service_component_register(const struct rte_service_spec *spec,
+		uint32_t *service_id)
+{
+	uint32_t i, free_id = RTE_SERVICE_NUM_MAX;
+
+	if (spec == NULL || spec->callback == NULL ||
+			spec->name[0] == '\0' ||
+			memchr(spec->name, '\0', RTE_SERVICE_NAME_MAX) == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (!services[i].registered) {
+			if (free_id == RTE_SERVICE_NUM_MAX)
+				free_id = i;
+			continue;
+		}
+		if (strcmp(services[i].spec.name, spec->name) == 0)
+			return -EEXIST;
+	}
+	if (free_id == RTE_SERVICE_NUM_MAX)
+		return -ENOSPC;
+
+	memset(&services[free_id], 0, sizeof(services[free_id]));
+	services[free_id].spec = *spec;
+	services[free_id].weight = 1;
+	services[free_id].runstate = RTE_SERVICE_RUNSTATE_STOPPED;
+	rte_atomic32_init(&services[free_id].execute_lock);
+	rte_wmb();
+	services[free_id].registered = 1;
+	service_count++;
+
+	if (service_id != NULL)
+		*service_id = free_id;
+	return 0;
+}
+
+int
+rte_service_component_unregister(uint32_t service_id)
+{
+	uint64_t bit = UINT64_C(1) << service_id;
+	uint32_t i;
+
+	if (!service_valid(service_id))
+		return -EINVAL;
+	if (services[service_id].runstate == RTE_SERVICE_RUNSTATE_RUNNING)
+		return -EBUSY;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		service_cores[i].service_mask &= ~bit;
+		service_cores[i].calls[service_id] = 0;
+		service_cores[i].cycles[service_id] = 0;
+	}
+	services[service_id].registered = 0;
+	service_count--;
+	return 0;
+}
+
+int
+rte_service_get_by_name(const char *name, uint32_t *service_id)
+{
+	uint32_t i;
+
+	if (name == NULL || service_id == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (services[i].registered &&
+				strcmp(services[i].spec.name, name) == 0) {
+			*service_id = i;
+			return 0;
+		}
+	}
+	return -ENODEV;
+}
+
+const char *
+rte_service_get_name(uint32_t service_id)
+{
+	if (!service_valid(service_id))
+		return NULL;
+	return services[service_id].spec.name;
+}
+
+uint32_t
+rte_service_get_count(void)
+{
+	return service_count;
+}
+
+int
+rte_service_runstate_set(uint32_t service_id, uint32_t runstate)
+{
+	if (!service_valid(service_id))
+		return -EINVAL;
+	if (runstate != RTE_SERVICE_RUNSTATE_RUNNING &&
+			runstate != RTE_SERVICE_RUNSTATE_STOPPED)
+		return -EINVAL;
+
+	services[service_id].runstate = runstate;
+	return 0;
+}
+
+int
+rte_service_runstate_get(uint32_t service_id)
+{
+	uint64_t bit = UINT64_C(1) << service_id;
+	uint32_t i;
+
+	if (!service_valid(service_id))
+		return -EINVAL;
+	if (services[service_id].runstate != RTE_SERVICE_RUNSTATE_RUNNING)
+		return 0;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (service_cores[i].is_service_core &&
+				service_cores[i].runstate ==
+					RTE_SERVICE_RUNSTATE_RUNNING &&
+				(service_cores[i].service_mask & bit))
+			return 1;
+	}
+	return 0;
+}
+
+int
+rte_service_set_weight(uint32_t service_id, uint32_t weight)
+{
+	if (!service_valid(service_id) || weight == 0)
+		return -EINVAL;
+
+	services[service_id].weight = weight;
+	return 0;
+}
+
+int
+rte_service_map_lcore_set(uint32_t service_id, uint32_t lcore,
+		uint32_t enable)
+{
+	struct service_core *cs;
+	uint64_t bit = UINT64_C(1) << service_id;
+
+	if (!service_valid(service_id) || !service_core_valid(lcore))
+		return -EINVAL;
+
+	cs = &service_cores[lcore];
+	if (enable)
+		cs->service_mask |= bit;
+	else
+		cs->service_mask &= ~bit;
+	return 0;
+}
+
+int
+rte_service_map_lcore_get(uint32_t service_id, uint32_t lcore)
+{
+	if (!service_valid(service_id) || !service_core_valid(lcore))
+		return -EINVAL;
+
+	return !!(service_cores[lcore].service_mask &
+		(UINT64_C(1) << service_id));
+}
+
+int
+rte_service_lcore_add(uint32_t lcore)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+
+	if (lcore >= RTE_MAX_LCORE || lcore == cfg->master_lcore)
+		return -EINVAL;
+	if (service_cores[lcore].is_service_core)
+		return -EALREADY;
+	if (cfg->lcore_role[lcore] != ROLE_RTE)
+		return -EINVAL;
+	if (rte_eal_get_lcore_state(lcore) != WAIT)
+		return -EBUSY;
+
+	memset(&service_cores[lcore], 0, sizeof(service_cores[lcore]));
+	service_cores[lcore].runstate = RTE_SERVICE_RUNSTATE_STOPPED;
+	service_cores[lcore].is_service_core = 1;
+	cfg->lcore_role[lcore] = ROLE_SERVICE;
+	cfg->lcore_count--;
+	return 0;
+}
+
+int
+rte_service_lcore_del(uint32_t lcore)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	struct service_core *cs;
+	uint32_t i;
+
+	if (!service_core_valid(lcore))
+		return -EINVAL;
+
+	cs = &service_cores[lcore];
+	if (cs->runstate == RTE_SERVICE_RUNSTATE_RUNNING)
+		return -EBUSY;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++)
+		rte_service_map_lcore_set(i, lcore, 0);
+	cs->is_service_core = 0;
+	cfg->lcore_role[lcore] = ROLE_RTE;
+	cfg->lcore_count++;
+	return 0;
+}
+
+int
+rte_service_lcore_start(uint32_t lcore)
+{
+	struct service_core *cs;
+	int ret;
+
+	if (!service_core_valid(lcore))
+		return -EINVAL;
+
+	cs = &service_cores[lcore];
+	if (cs->runstate == RTE_SERVICE_RUNSTATE_RUNNING)
+		return -EALREADY;
+
+	cs->runstate = RTE_SERVICE_RUNSTATE_RUNNING;
+	ret = rte_eal_remote_launch(service_runner_func, NULL, lcore);
+	if (ret < 0)
+		cs->runstate = RTE_SERVICE_RUNSTATE_STOPPED;
+	return ret;
+}
+
+int
+rte_service_lcore_stop(uint32_t lcore)
+{
+	struct service_core *cs;
+
+	if (!service_core_valid(lcore))
+		return -EINVAL;
+
+	cs = &service_cores[lcore];
+	if (cs->runstate != RTE_SERVICE_RUNSTATE_RUNNING)
+		return -EALREADY;
+
+	cs->runstate = RTE_SERVICE_RUNSTATE_STOPPED;
+	rte_eal_wait_lcore(lcore);
+	return 0;
+}
+
+uint32_t
+rte_service_lcore_count(void)
+{
+	uint32_t i, count = 0;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		count += service_cores[i].is_service_core;
+	return count;
+}
+
+int
+rte_service_lcore_list(uint32_t array[], uint32_t n)
+{
+	uint32_t i, count = 0;
+
+	if (rte_service_lcore_count() > n)
+		return -ENOMEM;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (service_cores[i].is_service_core)
+			array[count++] = i;
+	}
+	return count;
+}
+
+static void
+service_dump_one(FILE *f, uint32_t id)
+{
+	struct rte_service *s = &services[id];
+	uint64_t bit = UINT64_C(1) << id;
+	uint64_t calls = 0, cycles = 0;
+	uint32_t i;
+
+	fprintf(f, "service %u: %s\n", id, s->spec.name);
+	fprintf(f, "  runstate=%s weight=%u mt_safe=%d\n",
+		s->runstate == RTE_SERVICE_RUNSTATE_RUNNING ?
+			"running" : "stopped",
+		s->weight,
+		!!(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE));
+	fprintf(f, "  lcores:");
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		calls += service_cores[i].calls[id];
+		cycles += service_cores[i].cycles[id];
+		if (service_cores[i].service_mask & bit)
+			fprintf(f, " %u", i);
+	}
+	fprintf(f, "\n  calls=%"PRIu64" cycles=%"PRIu64
+		" cycles/call=%"PRIu64"\n",
+		calls, cycles, calls != 0 ? cycles / calls : 0);
+}
+
+int
+rte_service_dump(FILE *f, uint32_t service_id)
+{
+	uint32_t i;
+
+	if (service_id == UINT32_MAX) {
+		for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+			if (services[i].registered)
+				service_dump_one(f, i);
+		}
+		return 0;
+	}
+
+	if (!service_valid(service_id))
+		return -EINVAL;
+	service_dump_one(f, service_id);
+	return 0;
+}
+
+/* turn the lcores given with the -s option into service lcores */
+int
+rte_eal_service_init(void)
+{
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!internal_config.service_lcores[i])
+			continue;
+		ret = rte_service_lcore_add(i);
+		if (ret < 0) {
+			RTE_LOG(ERR, EAL, "Cannot use lcore %u as service "
+				"lcore\n", i);
+			return ret;
+		}
+	}
+	return 0;
+}
@@ -337,12 +337,18 @@ eal_usage(const char *prgname)
 	eal_common_usage();
 	printf("EAL Linux options:\n"
 	       "  --"OPT_SOCKET_MEM"        Memory to allocate on sockets (comma separated values)\n"
+	       "  --"OPT_SOCKET_LIMIT"      Limit up to which the heaps may grow at runtime\n"
+	       "                      (comma separated values)\n"
 	       "  --"OPT_HUGE_DIR"          Directory where hugetlbfs is mounted\n"
+	       "  --"OPT_HUGE_INIT_THREADS" Number of threads faulting hugepages in at init\n"
+	       "                      (default is one per lcore)\n"
 	       "  --"OPT_FILE_PREFIX"       Prefix for hugepage filenames\n"
 	       "  --"OPT_BASE_VIRTADDR"     Base virtual address\n"
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
 	       "  --"OPT_XEN_DOM0"          Support running on Xen dom0 without hugetlbfs\n"
+	       "  --"OPT_FAST_START"        Map only the needed hugepages, without sorting\n"
+	       "                      them by physical address (requires VFIO)\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if ( rte_application_usage_hook ) {
@@ -364,47 +370,46 @@ rte_set_application_usage_hook( rte_usage_hook_t usage_func )
 	return old_func;
 }
 
+/* parse a comma separated list of per socket amounts of memory in MB */
 static int
-eal_parse_socket_mem(char *socket_mem)
+eal_parse_socket_values(char *str, volatile uint64_t *values, const char *opt)
 {
 	char * arg[RTE_MAX_NUMA_NODES];
 	char *end;
 	int arg_num, i, len;
 	uint64_t total_mem = 0;
 
-	len = strnlen(socket_mem, SOCKET_MEM_STRLEN);
+	len = strnlen(str, SOCKET_MEM_STRLEN);
 	if (len == SOCKET_MEM_STRLEN) {
-		RTE_LOG(ERR, EAL, "--socket-mem is too long\n");
+		RTE_LOG(ERR, EAL, "--%s is too long\n", opt);
 		return -1;
 	}
 
 	/* all other error cases will be caught later */
-	if (!isdigit(socket_mem[len-1]))
+	if (!isdigit(str[len-1]))
 		return -1;
 
 	/* split the optarg into separate socket values */
-	arg_num = rte_strsplit(socket_mem, len,
+	arg_num = rte_strsplit(str, len,
 			arg, RTE_MAX_NUMA_NODES, ',');
 
 	/* if split failed, or 0 arguments */
 	if (arg_num <= 0)
 		return -1;
 
-	internal_config.force_sockets = 1;
-
 	/* parse each defined socket option */
 	errno = 0;
 	for (i = 0; i < arg_num; i++) {
 		end = NULL;
-		internal_config.socket_mem[i] = strtoull(arg[i], &end, 10);
+		values[i] = strtoull(arg[i], &end, 10);
 
 		/* check for invalid input */
 		if ((errno != 0)  ||
 				(arg[i][0] == '\0') || (end == NULL) || (*end != '\0'))
 			return -1;
-		internal_config.socket_mem[i] *= 1024ULL;
-		internal_config.socket_mem[i] *= 1024ULL;
-		total_mem += internal_config.socket_mem[i];
+		values[i] *= 1024ULL;
+		values[i] *= 1024ULL;
+		total_mem += values[i];
 	}
 
 	/* check if we have a positive amount of total memory */
@@ -414,6 +419,24 @@ eal_parse_socket_mem(char *socket_mem)
 	return 0;
 }
 
+static int
+eal_parse_socket_mem(char *socket_mem)
+{
+	if (eal_parse_socket_values(socket_mem, internal_config.socket_mem,
+			OPT_SOCKET_MEM) < 0)
+		return -1;
+
+	internal_config.force_sockets = 1;
+	return 0;
+}
+
+static int
+eal_parse_socket_limit(char *socket_limit)
+{
+	return eal_parse_socket_values(socket_limit,
+			internal_config.socket_limit, OPT_SOCKET_LIMIT);
+}
+
 static int
 eal_parse_base_virtaddr(const char *arg)
 {
@@ -443,6 +466,26 @@ eal_parse_base_virtaddr(const char *arg)
 	return 0;
 }
 
+static int
+eal_parse_huge_init_threads(const char *arg)
+{
+	char *end;
+	unsigned long nb_threads;
+
+	errno = 0;
+	nb_threads = strtoul(arg, &end, 10);
+
+	/* check for errors */
+	if ((errno != 0) || (arg[0] == '\0') || end == NULL || (*end != '\0'))
+		return -1;
+
+	if (nb_threads == 0 || nb_threads > RTE_MAX_LCORE)
+		return -1;
+
+	internal_config.huge_init_threads = nb_threads;
+	return 0;
+}
+
 static int
 eal_parse_vfio_intr(const char *mode)
 {
@@ -526,7 +569,7 @@ eal_log_level_parse(int argc, char **argv)
 static int
 eal_parse_args(int argc, char **argv)
 {
-	int opt, ret;
+	int opt, ret, i;
 	char **argvopt;
 	int option_index;
 	char *prgname = argv[0];
@@ -594,6 +637,16 @@ eal_parse_args(int argc, char **argv)
 			}
 			break;
 
+		case OPT_SOCKET_LIMIT_NUM:
+			if (eal_parse_socket_limit(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameters for --"
+						OPT_SOCKET_LIMIT "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
 		case OPT_BASE_VIRTADDR_NUM:
 			if (eal_parse_base_virtaddr(optarg) < 0) {
 				RTE_LOG(ERR, EAL, "invalid parameter for --"
@@ -604,6 +657,16 @@ eal_parse_args(int argc, char **argv)
 			}
 			break;
 
+		case OPT_HUGE_INIT_THREADS_NUM:
+			if (eal_parse_huge_init_threads(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameter for --"
+						OPT_HUGE_INIT_THREADS "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
 		case OPT_VFIO_INTR_NUM:
 			if (eal_parse_vfio_intr(optarg) < 0) {
 				RTE_LOG(ERR, EAL, "invalid parameters for --"
@@ -618,6 +681,10 @@ eal_parse_args(int argc, char **argv)
 			internal_config.create_uio_dev = 1;
 			break;
 
+		case OPT_FAST_START_NUM:
+			internal_config.fast_start = 1;
+			break;
+
 		default:
 			if (opt < OPT_LONG_MIN_NUM && isprint(opt)) {
 				RTE_LOG(ERR, EAL, "Option %c is not supported "
@@ -658,6 +725,41 @@ eal_parse_args(int argc, char **argv)
 		goto out;
 	}
 
+	/* --fast-start only changes the way hugepages are mapped */
+	if (internal_config.fast_start &&
+			(internal_config.no_hugetlbfs ||
+			 internal_config.xen_dom0_support)) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_FAST_START" cannot be "
+			"specified together with --"OPT_NO_HUGE" or --"
+			OPT_XEN_DOM0"\n");
+		eal_usage(prgname);
+		ret = -1;
+		goto out;
+	}
+
+	/* --socket-limit needs hugetlbfs and can't be below --socket-mem */
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+		if (internal_config.socket_limit[i] == 0)
+			continue;
+		if (internal_config.no_hugetlbfs ||
+				internal_config.xen_dom0_support) {
+			RTE_LOG(ERR, EAL, "Option --"OPT_SOCKET_LIMIT" cannot be "
+				"specified together with --"OPT_NO_HUGE" or --"
+				OPT_XEN_DOM0"\n");
+			eal_usage(prgname);
+			ret = -1;
+			goto out;
+		}
+		if (internal_config.socket_limit[i] <
+				internal_config.socket_mem[i]) {
+			RTE_LOG(ERR, EAL, "Option --"OPT_SOCKET_LIMIT" is lower "
+				"than --"OPT_SOCKET_MEM" on socket %d\n", i);
+			eal_usage(prgname);
+			ret = -1;
+			goto out;
+		}
+	}
+
 	if (optind >= 0)
 		argv[optind-1] = prgname;
 	ret = optind-1;
@@ -805,6 +907,9 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_tailqs_init() < 0)
 		rte_panic("Cannot init tail queues for objects\n");
 
+	/* not fatal, the statistics are then private to this process */
+	rte_eal_lcore_poll_init();
+
 #ifdef RTE_LIBRTE_IVSHMEM
 	if (rte_eal_ivshmem_obj_init() < 0)
 		rte_panic("Cannot init IVSHMEM objects\n");
@@ -813,6 +918,9 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_log_init(logid, internal_config.syslog_facility) < 0)
 		rte_panic("Cannot init logs\n");
 
+	if (internal_config.log_async && rte_log_async_enable() < 0)
+		rte_panic("Cannot init asynchronous logs\n");
+
 	if (rte_eal_alarm_init() < 0)
 		rte_panic("Cannot init interrupt-handling thread\n");
 
@@ -876,6 +984,9 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	if (rte_eal_service_init() < 0)
+		rte_panic("Cannot init service lcores\n");
+
 	/* Probe & Initialize PCI devices */
 	if (rte_eal_pci_probe())
 		rte_panic("Cannot probe PCI\n");
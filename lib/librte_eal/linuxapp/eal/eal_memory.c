@@ -75,11 +75,17 @@
 #include <sys/stat.h>
 #include <sys/queue.h>
 #include <sys/file.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <limits.h>
 #include <errno.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <linux/mempolicy.h>
+#include <linux/falloc.h>
 
 #include <rte_log.h>
 #include <rte_memory.h>
@@ -91,11 +97,14 @@
 #include <rte_lcore.h>
 #include <rte_common.h>
 #include <rte_string_fns.h>
+#include <rte_spinlock.h>
+#include <rte_pci.h>
 
 #include "eal_private.h"
 #include "eal_internal_cfg.h"
 #include "eal_filesystem.h"
 #include "eal_hugepages.h"
+#include "eal_pci_init.h"
 
 #ifdef RTE_LIBRTE_XEN_DOM0
 int rte_xen_dom0_supported(void)
@@ -114,6 +123,10 @@ int rte_xen_dom0_supported(void)
  * map them in virtual memory. For each page, we will retrieve its
  * physical address and remap it in order to have a virtual contiguous
  * zone as well as a physical contiguous zone.
+ *
+ * With --fast-start, only the needed pages are mapped, directly into one
+ * virtual area per socket, and the resulting zones are only virtually
+ * contiguous: devices then have to use virtual addresses through VFIO.
  */
 
 static uint64_t baseaddr_offset;
@@ -121,6 +134,27 @@ static uint64_t baseaddr_offset;
 static unsigned proc_pagemap_readable;
 
 #define RANDOMIZE_VA_SPACE_FILE "/proc/sys/kernel/randomize_va_space"
+#define NUMA_NODE_PATH "/sys/devices/system/node"
+
+/*
+ * Time spent in each stage of the hugepage initialization, in
+ * nanoseconds. Reported in the EAL log once init is done.
+ */
+struct hugepage_init_times {
+	uint64_t map;   /**< mmap() of the hugepage files */
+	uint64_t fault; /**< faulting in (and zeroing) of the pages */
+	uint64_t sort;  /**< physaddr and socket lookup, sorting */
+	uint64_t remap; /**< remapping, unmapping of unneeded pages */
+};
+
+static uint64_t
+get_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
 static void
 test_proc_pagemap_readable(void)
@@ -315,6 +349,8 @@ get_virtual_area(size_t *size, size_t hugepage_sz)
  * virtual address is stored in hugepg_tbl[i].orig_va, else it is stored
  * in hugepg_tbl[i].final_va. The second mapping (when orig is 0) tries to
  * map continguous physical blocks in contiguous virtual blocks.
+ * The pages of the first mapping are not populated here, this is done
+ * afterwards by fault_all_hugepages().
  */
 static int
 map_all_hugepages(struct hugepage_file *hugepg_tbl,
@@ -399,10 +435,11 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 			return -1;
 		}
 
-		/* map the segment, and populate page tables,
-		 * the kernel fills this segment with zeros */
+		/* map the segment, and populate page tables if the
+		 * pages were already faulted in by the first mapping */
 		virtaddr = mmap(vma_addr, hugepage_sz, PROT_READ | PROT_WRITE,
-				MAP_SHARED | MAP_POPULATE, fd, 0);
+				orig ? MAP_SHARED : MAP_SHARED | MAP_POPULATE,
+				fd, 0);
 		if (virtaddr == MAP_FAILED) {
 			RTE_LOG(ERR, EAL, "%s(): mmap failed: %s\n", __func__,
 					strerror(errno));
@@ -917,13 +954,13 @@ unmap_unneeded_hugepages(struct hugepage_file *hugepg_tbl,
 }
 
 static inline uint64_t
-get_socket_mem_size(int socket)
+get_socket_mem_size(const struct hugepage_info *hp_info, int socket)
 {
 	uint64_t size = 0;
 	unsigned i;
 
 	for (i = 0; i < internal_config.num_hugepage_sizes; i++){
-		struct hugepage_info *hpi = &internal_config.hugepage_info[i];
+		const struct hugepage_info *hpi = &hp_info[i];
 		if (hpi->hugedir != NULL)
 			size += hpi->hugepage_sz * hpi->num_pages[socket];
 	}
@@ -976,7 +1013,8 @@ calc_num_pages_per_socket(uint64_t * memory,
 			                / rte_lcore_count();
 
 			/* Limit to maximum available memory on socket */
-			default_size = RTE_MIN(default_size, get_socket_mem_size(socket));
+			default_size = RTE_MIN(default_size,
+					get_socket_mem_size(hp_info, socket));
 
 			/* Update sizes */
 			memory[socket] = default_size;
@@ -989,7 +1027,7 @@ calc_num_pages_per_socket(uint64_t * memory,
 		 */
 		for (socket = 0; socket < RTE_MAX_NUMA_NODES && total_size != 0; socket++) {
 			/* take whatever is available */
-			default_size = RTE_MIN(get_socket_mem_size(socket) - memory[socket],
+			default_size = RTE_MIN(get_socket_mem_size(hp_info, socket) - memory[socket],
 			                       total_size);
 
 			/* Update sizes */
@@ -1067,6 +1105,866 @@ calc_num_pages_per_socket(uint64_t * memory,
 	return total_num_pages;
 }
 
+/*
+ * Get the number of free hugepages of a given size on a NUMA node, as
+ * reported by sysfs. Returns 0 if there is no such node.
+ */
+static uint32_t
+get_num_hugepages_on_node(unsigned node, uint64_t hugepage_sz)
+{
+	char path[PATH_MAX];
+	unsigned long num_pages;
+
+	snprintf(path, sizeof(path),
+			"%s/node%u/hugepages/hugepages-%" PRIu64 "kB/free_hugepages",
+			NUMA_NODE_PATH, node, hugepage_sz >> 10);
+	if (eal_parse_sysfs_value(path, &num_pages) < 0)
+		return 0;
+
+	return RTE_MIN(num_pages, (unsigned long)UINT32_MAX);
+}
+
+/*
+ * Make the calling thread allocate memory on socket_id, or from the
+ * default policy if socket_id is negative. Pages can still be taken
+ * from another socket if socket_id runs out of them.
+ */
+static int
+set_preferred_socket(int socket_id)
+{
+	unsigned long mask[RTE_MAX_NUMA_NODES / (sizeof(unsigned long) * 8) + 1];
+
+	if (socket_id < 0)
+		return syscall(__NR_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+
+	memset(mask, 0, sizeof(mask));
+	mask[socket_id / (sizeof(unsigned long) * 8)] =
+		1UL << (socket_id % (sizeof(unsigned long) * 8));
+	return syscall(__NR_set_mempolicy, MPOL_PREFERRED, mask,
+			sizeof(mask) * 8);
+}
+
+/* get the NUMA socket of an already faulted in page */
+static int
+get_page_socket(void *addr)
+{
+	int socket_id;
+
+	if (syscall(__NR_get_mempolicy, &socket_id, NULL, 0, addr,
+			MPOL_F_NODE | MPOL_F_ADDR) < 0)
+		return -1;
+
+	return socket_id;
+}
+
+/* hugepages faulted in by one thread */
+struct fault_work {
+	struct hugepage_file *hugepg_tbl;
+	unsigned num_pages;
+	int final;             /**< touch final_va rather than orig_va */
+	int socket_id;         /**< socket to take the pages from, or -1 */
+	int has_cpuset;        /**< pin the thread to cpuset */
+	rte_cpuset_t cpuset;
+	pthread_t thread;
+	int started;           /**< thread created to do the work */
+	int ret;
+};
+
+static void
+fault_hugepages(struct fault_work *work)
+{
+	unsigned i;
+
+	if (work->socket_id >= 0 && set_preferred_socket(work->socket_id) < 0) {
+		work->ret = -1;
+		return;
+	}
+
+	for (i = 0; i < work->num_pages; i++) {
+		struct hugepage_file *hp = &work->hugepg_tbl[i];
+
+		*(volatile int *)(work->final ? hp->final_va : hp->orig_va) = 0;
+	}
+
+	if (work->socket_id >= 0)
+		set_preferred_socket(-1);
+	work->ret = 0;
+}
+
+static void *
+fault_hugepages_thread(void *arg)
+{
+	struct fault_work *work = arg;
+
+	if (work->has_cpuset)
+		pthread_setaffinity_np(pthread_self(), sizeof(work->cpuset),
+				&work->cpuset);
+	fault_hugepages(work);
+	return NULL;
+}
+
+/*
+ * Get the cpuset of the n-th enabled lcore, among the ones of socket_id
+ * if there are any. Returns 0 if no lcore is enabled.
+ */
+static int
+get_fault_cpuset(int socket_id, unsigned n, rte_cpuset_t *cpuset)
+{
+	unsigned lcore_id, count = 0;
+	int any_socket;
+
+	for (lcore_id = 0; socket_id >= 0 && lcore_id < RTE_MAX_LCORE;
+			lcore_id++)
+		if (rte_lcore_is_enabled(lcore_id) &&
+				lcore_config[lcore_id].socket_id ==
+				(unsigned)socket_id)
+			count++;
+	any_socket = count == 0;
+	if (any_socket)
+		count = rte_lcore_count();
+	if (count == 0)
+		return 0;
+
+	n %= count;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!rte_lcore_is_enabled(lcore_id) || (!any_socket &&
+				lcore_config[lcore_id].socket_id !=
+				(unsigned)socket_id))
+			continue;
+		if (n-- == 0) {
+			*cpuset = lcore_config[lcore_id].cpuset;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Touch hugepages so that the kernel allocates them and fills them with
+ * zeros. The pages are split between up to --huge-init-threads threads
+ * (one per enabled lcore by default), pinned to the lcores of the socket
+ * the pages are wanted on. The pages were reserved by mmap(), so this
+ * only fails if the memory policy for socket_id cannot be set.
+ */
+static int
+fault_all_hugepages(struct hugepage_file *hugepg_tbl, unsigned num_pages,
+		int final, int socket_id)
+{
+	struct fault_work *work;
+	unsigned nb_threads, per_thread, i;
+	int ret = 0;
+
+	nb_threads = internal_config.huge_init_threads;
+	if (nb_threads == 0)
+		nb_threads = rte_lcore_count();
+	nb_threads = RTE_MIN(nb_threads,
+			RTE_MIN(num_pages, (unsigned)RTE_MAX_LCORE));
+
+	work = NULL;
+	if (nb_threads > 1)
+		work = calloc(nb_threads, sizeof(*work));
+
+	/* do the work here if there is no more than one thread to use */
+	if (work == NULL) {
+		struct fault_work single;
+
+		memset(&single, 0, sizeof(single));
+		single.hugepg_tbl = hugepg_tbl;
+		single.num_pages = num_pages;
+		single.final = final;
+		single.socket_id = socket_id;
+		fault_hugepages(&single);
+		return single.ret;
+	}
+
+	per_thread = (num_pages + nb_threads - 1) / nb_threads;
+	nb_threads = (num_pages + per_thread - 1) / per_thread;
+	for (i = 0; i < nb_threads; i++) {
+		work[i].hugepg_tbl = &hugepg_tbl[i * per_thread];
+		work[i].num_pages = RTE_MIN(per_thread,
+				num_pages - i * per_thread);
+		work[i].final = final;
+		work[i].socket_id = socket_id;
+		work[i].has_cpuset = get_fault_cpuset(socket_id, i,
+				&work[i].cpuset);
+
+		/* do the work here if no thread can be created */
+		work[i].started = pthread_create(&work[i].thread, NULL,
+				fault_hugepages_thread, &work[i]) == 0;
+		if (!work[i].started)
+			fault_hugepages(&work[i]);
+	}
+
+	for (i = 0; i < nb_threads; i++) {
+		if (work[i].started)
+			pthread_join(work[i].thread, NULL);
+		if (work[i].ret < 0)
+			ret = -1;
+	}
+
+	free(work);
+	return ret;
+}
+
+/*
+ * Unmap hugepages mapped by map_hugepages_fast() and remove their files,
+ * on error.
+ */
+static void
+unmap_hugepages_fast(struct hugepage_file *hugepg_tbl, unsigned num_pages)
+{
+	unsigned i;
+
+	for (i = 0; i < num_pages; i++) {
+		struct hugepage_file *hp = &hugepg_tbl[i];
+
+		if (hp->final_va == NULL)
+			continue;
+		munmap(hp->final_va, hp->size);
+		unlink(hp->filepath);
+		memset(hp, 0, sizeof(*hp));
+	}
+}
+
+/*
+ * Map num_pages hugepages of the given size, backed by new files in
+ * hugetlbfs, in a virtually contiguous area preferably located on
+ * socket_id. The page descriptions are stored in hugepg_tbl, starting
+ * at file_id. Returns the number of pages mapped (that can be less than
+ * asked if no virtual area large enough was found), or -1 on error.
+ */
+static int
+map_hugepages_fast(struct hugepage_file *hugepg_tbl, int file_id,
+		const struct hugepage_info *hpi, unsigned num_pages,
+		int socket_id, int numa, void **area,
+		struct hugepage_init_times *times)
+{
+	uint64_t hugepage_sz = hpi->hugepage_sz;
+	size_t vma_len = num_pages * hugepage_sz;
+	void *vma_addr, *virtaddr;
+	uint64_t start;
+	unsigned i;
+	int fd;
+
+	vma_addr = get_virtual_area(&vma_len, hugepage_sz);
+	if (vma_addr == NULL)
+		return -1;
+	num_pages = vma_len / hugepage_sz;
+
+	start = get_time_ns();
+	for (i = 0; i < num_pages; i++) {
+		struct hugepage_file *hp = &hugepg_tbl[i];
+
+		hp->file_id = file_id + i;
+		hp->size = hugepage_sz;
+		eal_get_hugefile_path(hp->filepath, sizeof(hp->filepath),
+				hpi->hugedir, hp->file_id);
+		hp->filepath[sizeof(hp->filepath) - 1] = '\0';
+
+		fd = open(hp->filepath, O_CREAT | O_RDWR, 0755);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "%s(): open failed: %s\n", __func__,
+					strerror(errno));
+			goto fail;
+		}
+
+		virtaddr = mmap(RTE_PTR_ADD(vma_addr, i * hugepage_sz),
+				hugepage_sz, PROT_READ | PROT_WRITE,
+				MAP_SHARED, fd, 0);
+		if (virtaddr != RTE_PTR_ADD(vma_addr, i * hugepage_sz)) {
+			RTE_LOG(ERR, EAL, "%s(): mmap failed: %s\n", __func__,
+					virtaddr == MAP_FAILED ?
+					strerror(errno) : "wrong address");
+			if (virtaddr != MAP_FAILED)
+				munmap(virtaddr, hugepage_sz);
+			close(fd);
+			unlink(hp->filepath);
+			goto fail;
+		}
+
+		/* set shared flock on the file. */
+		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			RTE_LOG(ERR, EAL, "%s(): Locking file failed:%s \n",
+				__func__, strerror(errno));
+			munmap(virtaddr, hugepage_sz);
+			close(fd);
+			unlink(hp->filepath);
+			goto fail;
+		}
+		close(fd);
+
+		hp->final_va = virtaddr;
+		/* IOVA is the virtual address */
+		hp->physaddr = (uintptr_t)virtaddr;
+		hp->socket_id = socket_id;
+	}
+	times->map += get_time_ns() - start;
+
+	/* fault the pages in on the right socket, the kernel zeroes them */
+	start = get_time_ns();
+	if (fault_all_hugepages(hugepg_tbl, num_pages, 1,
+			numa ? socket_id : -1) < 0) {
+		RTE_LOG(ERR, EAL, "%s(): cannot set memory policy for "
+				"socket %d\n", __func__, socket_id);
+		goto fail;
+	}
+	if (numa) {
+		for (i = 0; i < num_pages; i++) {
+			if (get_page_socket(hugepg_tbl[i].final_va) !=
+					socket_id) {
+				RTE_LOG(ERR, EAL, "%s(): hugepage at %p is not "
+					"on socket %d\n", __func__,
+					hugepg_tbl[i].final_va, socket_id);
+				goto fail;
+			}
+		}
+	}
+	times->fault += get_time_ns() - start;
+
+	*area = vma_addr;
+	return num_pages;
+
+fail:
+	/* the pages mapped so far are the ones with a final_va */
+	unmap_hugepages_fast(hugepg_tbl, num_pages);
+	return -1;
+}
+
+/*
+ * Runtime growth of the heaps.
+ *
+ * For each socket with a --socket-limit above the memory mapped at init,
+ * a virtual area covering the difference is reserved and mapped, without
+ * reserving any page, to a file in hugetlbfs. Pages are allocated in this
+ * file with fallocate() when a heap runs out of memory, and given back to
+ * the system by punching holes in it, which removes them from the mappings
+ * of all processes. The files are described by RTE_MAX_NUMA_NODES entries
+ * at the end of the hugepage table, so secondary processes can map them.
+ */
+
+/* fds of the files backing the growth areas, -1 if none */
+static int grow_fd[RTE_MAX_NUMA_NODES];
+
+/* growths in progress, reserving their dyn_memseg slot and their room */
+static struct rte_memseg grow_pending[RTE_MAX_MEMSEG];
+
+/* protects the dyn_memseg slots and the growth reservations */
+static rte_spinlock_t grow_lock = RTE_SPINLOCK_INITIALIZER;
+
+/* undo setup_heap_growth(), on error */
+static void
+teardown_heap_growth(struct rte_mem_config *mcfg, struct hugepage_file *hp_tbl)
+{
+	unsigned socket;
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		struct rte_memseg *area = &mcfg->dyn_area[socket];
+
+		if (grow_fd[socket] < 0)
+			continue;
+		munmap(area->addr, area->len);
+		close(grow_fd[socket]);
+		grow_fd[socket] = -1;
+		if (!internal_config.hugepage_unlink)
+			unlink(hp_tbl[socket].filepath);
+		memset(area, 0, sizeof(*area));
+		memset(&hp_tbl[socket], 0, sizeof(hp_tbl[socket]));
+		hp_tbl[socket].memseg_id = -1;
+	}
+}
+
+static int
+setup_heap_growth(struct rte_mem_config *mcfg, struct hugepage_file *hp_tbl)
+{
+	const struct hugepage_info *hpi = &internal_config.hugepage_info[0];
+	unsigned socket;
+	int i;
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		grow_fd[socket] = -1;
+		hp_tbl[socket].memseg_id = -1;
+	}
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		struct hugepage_file *hp = &hp_tbl[socket];
+		struct rte_memseg *area = &mcfg->dyn_area[socket];
+		uint64_t used = 0;
+		size_t len;
+		void *addr, *vma_addr;
+		int fd;
+
+		if (internal_config.socket_limit[socket] == 0)
+			continue;
+
+		for (i = 0; i < RTE_MAX_MEMSEG; i++)
+			if (mcfg->memseg[i].socket_id == (int)socket)
+				used += mcfg->memseg[i].len;
+		if (internal_config.socket_limit[socket] <= used)
+			continue;
+
+		/* use the largest page size, it is the first one */
+		len = RTE_ALIGN_CEIL(internal_config.socket_limit[socket] - used,
+				hpi->hugepage_sz);
+		vma_addr = get_virtual_area(&len, hpi->hugepage_sz);
+		if (vma_addr == NULL)
+			goto fail;
+
+		eal_get_hugefile_grow_path(hp->filepath, sizeof(hp->filepath),
+				hpi->hugedir, socket);
+		fd = open(hp->filepath, O_CREAT | O_RDWR, 0600);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "%s(): open failed: %s\n", __func__,
+					strerror(errno));
+			goto fail;
+		}
+
+		/* set shared lock on the file, like all hugepage files */
+		if (flock(fd, LOCK_SH) < 0 || ftruncate(fd, len) < 0) {
+			RTE_LOG(ERR, EAL, "%s(): cannot set up %s: %s\n",
+				__func__, hp->filepath, strerror(errno));
+			close(fd);
+			unlink(hp->filepath);
+			goto fail;
+		}
+
+		addr = mmap(vma_addr, len, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_NORESERVE, fd, 0);
+		if (addr == MAP_FAILED || addr != vma_addr) {
+			RTE_LOG(ERR, EAL, "%s(): mmap failed: %s\n", __func__,
+					strerror(errno));
+			if (addr != MAP_FAILED)
+				munmap(addr, len);
+			close(fd);
+			unlink(hp->filepath);
+			goto fail;
+		}
+
+		if (internal_config.hugepage_unlink && unlink(hp->filepath))
+			RTE_LOG(WARNING, EAL, "%s(): Removing %s failed: %s\n",
+				__func__, hp->filepath, strerror(errno));
+
+		hp->final_va = addr;
+		hp->size = hpi->hugepage_sz;
+		hp->socket_id = socket;
+		hp->file_id = socket;
+
+		area->addr = addr;
+		area->len = len;
+		area->hugepage_sz = hpi->hugepage_sz;
+		area->socket_id = socket;
+		grow_fd[socket] = fd;
+
+		RTE_LOG(DEBUG, EAL, "Heap on socket %u can grow by %zu MB\n",
+			socket, len >> 20);
+	}
+
+	return 0;
+
+fail:
+	teardown_heap_growth(mcfg, hp_tbl);
+	return -1;
+}
+
+/* check if a memseg of a socket overlaps [off, off + len) of its area */
+static int
+grow_overlaps(const struct rte_memseg *area, const struct rte_memseg *ms,
+		int socket_id, uint64_t *off, size_t len)
+{
+	uint64_t start, end;
+
+	if (ms->len == 0 || ms->socket_id != socket_id)
+		return 0;
+
+	start = RTE_PTR_DIFF(ms->addr, area->addr);
+	end = start + ms->len;
+	if (*off < end && start < *off + len) {
+		*off = end;
+		return 1;
+	}
+	return 0;
+}
+
+/* find room for len bytes in the growth area of a socket */
+static int64_t
+find_grow_offset(const struct rte_mem_config *mcfg, int socket_id,
+		size_t len)
+{
+	const struct rte_memseg *area = &mcfg->dyn_area[socket_id];
+	uint64_t off = 0;
+	int i, moved;
+
+	do {
+		moved = 0;
+		for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+			moved |= grow_overlaps(area, &mcfg->dyn_memseg[i],
+					socket_id, &off, len);
+			moved |= grow_overlaps(area, &grow_pending[i],
+					socket_id, &off, len);
+		}
+	} while (moved && off + len <= area->len);
+
+	if (off + len > area->len)
+		return -1;
+
+	return off;
+}
+
+/*
+ * Only the slot and the room in the growth area are reserved with the
+ * grow lock held, the system calls allocating, faulting and mapping the
+ * pages are done without it.
+ */
+struct rte_memseg *
+rte_eal_memseg_grow(int socket_id, size_t min_len)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct rte_memseg *area, *ms = NULL;
+	struct rte_memseg seg;
+	size_t len, off;
+	int64_t ret;
+	phys_addr_t phys_addr;
+	void *addr;
+	int i, fd;
+
+	if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES ||
+			rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return NULL;
+
+	area = &mcfg->dyn_area[socket_id];
+	if (area->len == 0)
+		return NULL;
+
+	len = RTE_ALIGN_CEIL(min_len, area->hugepage_sz);
+
+	/* physically contiguous memory is only guaranteed within a page */
+	if (!internal_config.fast_start && len > area->hugepage_sz) {
+		RTE_LOG(DEBUG, EAL, "Cannot grow heap by more than one page "
+			"without fast-start\n");
+		return NULL;
+	}
+
+	rte_spinlock_lock(&grow_lock);
+
+	fd = grow_fd[socket_id];
+	if (fd < 0) {
+		rte_spinlock_unlock(&grow_lock);
+		return NULL;
+	}
+
+	for (i = 0; i < RTE_MAX_MEMSEG; i++)
+		if (mcfg->dyn_memseg[i].len == 0 && grow_pending[i].len == 0)
+			break;
+	if (i == RTE_MAX_MEMSEG) {
+		rte_spinlock_unlock(&grow_lock);
+		return NULL;
+	}
+
+	ret = find_grow_offset(mcfg, socket_id, len);
+	if (ret < 0) {
+		rte_spinlock_unlock(&grow_lock);
+		RTE_LOG(DEBUG, EAL, "Heap on socket %d reached its limit\n",
+			socket_id);
+		return NULL;
+	}
+	off = ret;
+	addr = RTE_PTR_ADD(area->addr, off);
+
+	grow_pending[i].addr = addr;
+	grow_pending[i].socket_id = socket_id;
+	grow_pending[i].len = len;
+
+	rte_spinlock_unlock(&grow_lock);
+
+	set_preferred_socket(socket_id);
+	ret = fallocate(fd, 0, off, len);
+	set_preferred_socket(-1);
+	if (ret < 0) {
+		if (errno == EOPNOTSUPP) {
+			RTE_LOG(WARNING, EAL, "hugetlbfs does not support "
+				"fallocate(), heaps cannot grow\n");
+			/* the fd is left open, other growths may use it */
+			grow_fd[socket_id] = -1;
+		} else
+			RTE_LOG(DEBUG, EAL, "Cannot allocate %zu MB on socket "
+				"%d: %s\n", len >> 20, socket_id,
+				strerror(errno));
+		goto out;
+	}
+
+	/* fault the pages in this process, and check where they are */
+	for (off = 0; off < len; off += area->hugepage_sz)
+		*(volatile int *)RTE_PTR_ADD(addr, off) = 0;
+
+	if (access(NUMA_NODE_PATH, F_OK) == 0 &&
+			get_page_socket(addr) != socket_id) {
+		RTE_LOG(DEBUG, EAL, "No free hugepage on socket %d\n",
+			socket_id);
+		goto punch;
+	}
+
+	if (internal_config.fast_start)
+		phys_addr = (uintptr_t)addr;
+	else
+		phys_addr = rte_mem_virt2phy(addr);
+	if (phys_addr == RTE_BAD_PHYS_ADDR)
+		goto punch;
+
+	memset(&seg, 0, sizeof(seg));
+	seg.phys_addr = phys_addr;
+	seg.addr = addr;
+	seg.hugepage_sz = area->hugepage_sz;
+	seg.socket_id = socket_id;
+	seg.nchannel = mcfg->nchannel;
+	seg.nrank = mcfg->nrank;
+	seg.len = len;
+
+#ifdef VFIO_PRESENT
+	if (pci_vfio_dma_map_memseg(&seg) < 0)
+		goto punch;
+#endif
+
+	RTE_LOG(INFO, EAL, "Heap on socket %d grown by %zu MB\n",
+		socket_id, len >> 20);
+
+	/* publish the memseg and drop the reservation */
+	rte_spinlock_lock(&grow_lock);
+	ms = &mcfg->dyn_memseg[i];
+	*ms = seg;
+	memset(&grow_pending[i], 0, sizeof(grow_pending[i]));
+	rte_spinlock_unlock(&grow_lock);
+	return ms;
+
+punch:
+	fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			RTE_PTR_DIFF(addr, area->addr), len);
+out:
+	rte_spinlock_lock(&grow_lock);
+	memset(&grow_pending[i], 0, sizeof(grow_pending[i]));
+	rte_spinlock_unlock(&grow_lock);
+	return NULL;
+}
+
+/*
+ * The memseg keeps its slot and its room in the growth area until its
+ * pages are unmapped and given back, only clearing it takes the grow lock.
+ */
+int
+rte_eal_memseg_release(struct rte_memseg *ms)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	const struct rte_memseg *area;
+
+	if (ms < mcfg->dyn_memseg || ms >= &mcfg->dyn_memseg[RTE_MAX_MEMSEG] ||
+			ms->len == 0 ||
+			rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -1;
+
+#ifdef VFIO_PRESENT
+	if (pci_vfio_dma_unmap_memseg(ms) < 0)
+		return -1;
+#endif
+
+	area = &mcfg->dyn_area[ms->socket_id];
+	if (grow_fd[ms->socket_id] < 0 ||
+			fallocate(grow_fd[ms->socket_id],
+				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				RTE_PTR_DIFF(ms->addr, area->addr),
+				ms->len) < 0) {
+		RTE_LOG(ERR, EAL, "Cannot release %zu MB on socket %d\n",
+			ms->len >> 20, ms->socket_id);
+#ifdef VFIO_PRESENT
+		pci_vfio_dma_map_memseg(ms);
+#endif
+		return -1;
+	}
+
+	RTE_LOG(INFO, EAL, "Heap on socket %d shrunk by %zu MB\n",
+		ms->socket_id, ms->len >> 20);
+
+	rte_spinlock_lock(&grow_lock);
+	memset(ms, 0, sizeof(*ms));
+	rte_spinlock_unlock(&grow_lock);
+	return 0;
+}
+
+/*
+ * Fast-start variant of rte_eal_hugepage_init(). Rather than mapping all
+ * hugepages of the system, sorting them by physical address and remapping
+ * them, only map the pages needed on each socket, in one virtual area per
+ * socket and page size (more if no area that large can be found). Memory
+ * segments are only virtually contiguous, so their physical address is
+ * set to their virtual address, which is what VFIO maps in the IOMMU.
+ */
+static int
+hugepage_init_fast(struct rte_mem_config *mcfg,
+		struct hugepage_init_times *times)
+{
+	struct hugepage_info avail_hp[MAX_HUGEPAGE_SIZES];
+	struct hugepage_info used_hp[MAX_HUGEPAGE_SIZES];
+	struct hugepage_file *hugepage;
+	uint64_t memory[RTE_MAX_NUMA_NODES];
+	unsigned size, socket, num_pages;
+	int i, j, j_first, nr_hugepages, numa;
+	void *addr;
+
+	memset(used_hp, 0, sizeof(used_hp));
+	memcpy(avail_hp, internal_config.hugepage_info, sizeof(avail_hp));
+
+	/* without NUMA support in the kernel, everything is on socket 0 */
+	numa = access(NUMA_NODE_PATH, F_OK) == 0;
+
+	/*
+	 * Spread the free hugepages on their sockets, as reported by sysfs,
+	 * in a copy of the hugepage info: the pages are not sorted, so the
+	 * configuration keeps the counts found at hugepage info init.
+	 */
+	for (size = 0; size < internal_config.num_hugepage_sizes; size++) {
+		struct hugepage_info *hpi = &avail_hp[size];
+		uint32_t total = hpi->num_pages[0];
+
+		used_hp[size].hugepage_sz = hpi->hugepage_sz;
+
+		for (socket = 0; numa && socket < RTE_MAX_NUMA_NODES; socket++) {
+			hpi->num_pages[socket] = RTE_MIN(total,
+				get_num_hugepages_on_node(socket,
+					hpi->hugepage_sz));
+			total -= hpi->num_pages[socket];
+		}
+	}
+
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++)
+		memory[i] = internal_config.socket_mem[i];
+
+	nr_hugepages = calc_num_pages_per_socket(memory, avail_hp, used_hp,
+			internal_config.num_hugepage_sizes);
+	if (nr_hugepages < 0)
+		return -1;
+
+	/* the table ends with the description of the growth areas */
+	hugepage = create_shared_memory(eal_hugepage_info_path(),
+			(nr_hugepages + RTE_MAX_NUMA_NODES) *
+			sizeof(struct hugepage_file));
+	if (hugepage == NULL) {
+		RTE_LOG(ERR, EAL, "Failed to create shared memory!\n");
+		return -1;
+	}
+	memset(hugepage, 0, (nr_hugepages + RTE_MAX_NUMA_NODES) *
+			sizeof(struct hugepage_file));
+
+	/* find earliest free memseg, some may be used by IVSHMEM */
+	for (j = 0; j < RTE_MAX_MEMSEG; j++)
+		if (mcfg->memseg[j].addr == NULL)
+			break;
+	j_first = j;
+
+	i = 0;
+	for (size = 0; size < internal_config.num_hugepage_sizes; size++) {
+		for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+			int k, ret;
+
+			num_pages = used_hp[size].num_pages[socket];
+			while (num_pages > 0) {
+				if (j == RTE_MAX_MEMSEG) {
+					RTE_LOG(ERR, EAL, "Current %s=%d is "
+						"not enough\n",
+						RTE_STR(CONFIG_RTE_MAX_MEMSEG),
+						RTE_MAX_MEMSEG);
+					goto fail;
+				}
+
+				ret = map_hugepages_fast(&hugepage[i], i,
+						&used_hp[size], num_pages,
+						socket, numa, &addr, times);
+				if (ret < 0) {
+					RTE_LOG(ERR, EAL, "Failed to map %u MB "
+						"hugepages on socket %u\n",
+						(unsigned)(used_hp[size].hugepage_sz /
+							0x100000), socket);
+					goto fail;
+				}
+
+				mcfg->memseg[j].phys_addr = (uintptr_t)addr;
+				mcfg->memseg[j].addr = addr;
+				mcfg->memseg[j].len =
+					(size_t)ret * used_hp[size].hugepage_sz;
+				mcfg->memseg[j].socket_id = socket;
+				mcfg->memseg[j].hugepage_sz =
+					used_hp[size].hugepage_sz;
+				for (k = 0; k < ret; k++)
+					hugepage[i + k].memseg_id = j;
+
+				i += ret;
+				j++;
+				num_pages -= ret;
+			}
+		}
+	}
+
+	/* free the hugepage backing files */
+	if (internal_config.hugepage_unlink) {
+		for (i = 0; i < nr_hugepages; i++) {
+			if (unlink(hugepage[i].filepath))
+				RTE_LOG(WARNING, EAL, "%s(): Removing %s "
+					"failed: %s\n", __func__,
+					hugepage[i].filepath, strerror(errno));
+		}
+	}
+
+	if (setup_heap_growth(mcfg, &hugepage[nr_hugepages]) < 0)
+		goto fail;
+
+	return 0;
+
+fail:
+	/* unmap the pages mapped so far and forget their memsegs */
+	unmap_hugepages_fast(hugepage, i);
+	for (; j > j_first; j--)
+		memset(&mcfg->memseg[j - 1], 0, sizeof(mcfg->memseg[j - 1]));
+	munmap(hugepage, (nr_hugepages + RTE_MAX_NUMA_NODES) *
+			sizeof(struct hugepage_file));
+	return -1;
+}
+
+/*
+ * Fast-start needs all devices to be accessed through an IOMMU
+ * programmed with virtual addresses: the devices that may be probed must
+ * all be bound to vfio-pci, with a type 1 IOMMU. Devices bound to a UIO
+ * driver would be given virtual addresses as DMA addresses.
+ */
+static int
+hugepage_fast_start_check(void)
+{
+#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
+	RTE_LOG(ERR, EAL, "Fast-start is not supported with "
+		"CONFIG_RTE_EAL_SINGLE_FILE_SEGMENTS\n");
+	return -1;
+#else
+	unsigned nb_uio;
+
+	if (internal_config.no_pci)
+		return 0;
+
+	nb_uio = pci_probe_candidate_count(RTE_KDRV_IGB_UIO) +
+		pci_probe_candidate_count(RTE_KDRV_UIO_GENERIC) +
+		pci_probe_candidate_count(RTE_KDRV_NIC_UIO);
+	if (nb_uio != 0) {
+		RTE_LOG(ERR, EAL, "Fast-start needs all devices bound to "
+			"vfio-pci, %u device(s) bound to a UIO driver\n",
+			nb_uio);
+		return -1;
+	}
+
+	if (pci_probe_candidate_count(RTE_KDRV_VFIO) == 0)
+		return 0;
+#ifdef VFIO_PRESENT
+	if (pci_vfio_has_type1_iommu())
+		return 0;
+#endif
+	RTE_LOG(ERR, EAL, "Fast-start needs VFIO with a type 1 IOMMU\n");
+	return -1;
+#endif
+}
+
 /*
  * Prepare physical memory mapping: fill configuration structure with
  * these infos, return 0 on success.
@@ -1077,6 +1975,7 @@ calc_num_pages_per_socket(uint64_t * memory,
  *  5. remap these N huge pages in the correct order
  *  6. unmap the first mapping
  *  7. fill memsegs in configuration with contiguous zones
+ * With --fast-start, hugepage_init_fast() is used instead.
  */
 int
 rte_eal_hugepage_init(void)
@@ -1084,8 +1983,10 @@ rte_eal_hugepage_init(void)
 	struct rte_mem_config *mcfg;
 	struct hugepage_file *hugepage, *tmp_hp = NULL;
 	struct hugepage_info used_hp[MAX_HUGEPAGE_SIZES];
+	struct hugepage_init_times times;
 
 	uint64_t memory[RTE_MAX_NUMA_NODES];
+	uint64_t init_start, start;
 
 	unsigned hp_offset;
 	int i, j, new_memseg;
@@ -1098,6 +1999,8 @@ rte_eal_hugepage_init(void)
 	test_proc_pagemap_readable();
 
 	memset(used_hp, 0, sizeof(used_hp));
+	memset(&times, 0, sizeof(times));
+	init_start = get_time_ns();
 
 	/* get pointer to global configuration */
 	mcfg = rte_eal_get_configuration()->mem_config;
@@ -1130,6 +2033,13 @@ rte_eal_hugepage_init(void)
 #endif
 	}
 
+	if (internal_config.fast_start) {
+		if (hugepage_fast_start_check() < 0 ||
+				hugepage_init_fast(mcfg, &times) < 0)
+			return -1;
+		goto done;
+	}
+
 	/* calculate total number of hugepages available. at this point we haven't
 	 * yet started sorting them so they all are on socket 0 */
 	for (i = 0; i < (int) internal_config.num_hugepage_sizes; i++) {
@@ -1168,13 +2078,21 @@ rte_eal_hugepage_init(void)
 			continue;
 
 		/* map all hugepages available */
+		start = get_time_ns();
 		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 1) < 0){
 			RTE_LOG(DEBUG, EAL, "Failed to mmap %u MB hugepages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
 		}
+		times.map += get_time_ns() - start;
+
+		start = get_time_ns();
+		fault_all_hugepages(&tmp_hp[hp_offset], hpi->num_pages[0],
+				0, -1);
+		times.fault += get_time_ns() - start;
 
 		/* find physical addresses and sockets for each hugepage */
+		start = get_time_ns();
 		if (find_physaddrs(&tmp_hp[hp_offset], hpi) < 0){
 			RTE_LOG(DEBUG, EAL, "Failed to find phys addr for %u MB pages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
@@ -1189,6 +2107,9 @@ rte_eal_hugepage_init(void)
 
 		if (sort_by_physaddr(&tmp_hp[hp_offset], hpi) < 0)
 			goto fail;
+		times.sort += get_time_ns() - start;
+
+		start = get_time_ns();
 
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 		/* remap all hugepages into single file segments */
@@ -1201,6 +2122,7 @@ rte_eal_hugepage_init(void)
 
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += new_pages_count[i];
+		times.remap += get_time_ns() - start;
 #else
 		/* remap all hugepages */
 		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0) < 0){
@@ -1215,6 +2137,7 @@ rte_eal_hugepage_init(void)
 
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += hpi->num_pages[0];
+		times.remap += get_time_ns() - start;
 #endif
 	}
 
@@ -1281,25 +2204,29 @@ rte_eal_hugepage_init(void)
 		}
 	}
 
-	/* create shared memory */
+	/* create shared memory, ending with the growth areas description */
 	hugepage = create_shared_memory(eal_hugepage_info_path(),
-			nr_hugefiles * sizeof(struct hugepage_file));
+			(nr_hugefiles + RTE_MAX_NUMA_NODES) *
+			sizeof(struct hugepage_file));
 
 	if (hugepage == NULL) {
 		RTE_LOG(ERR, EAL, "Failed to create shared memory!\n");
 		goto fail;
 	}
-	memset(hugepage, 0, nr_hugefiles * sizeof(struct hugepage_file));
+	memset(hugepage, 0, (nr_hugefiles + RTE_MAX_NUMA_NODES) *
+			sizeof(struct hugepage_file));
 
 	/*
 	 * unmap pages that we won't need (looks at used_hp).
 	 * also, sets final_va to NULL on pages that were unmapped.
 	 */
+	start = get_time_ns();
 	if (unmap_unneeded_hugepages(tmp_hp, used_hp,
 			internal_config.num_hugepage_sizes) < 0) {
 		RTE_LOG(ERR, EAL, "Unmapping and locking hugepages failed!\n");
 		goto fail;
 	}
+	times.remap += get_time_ns() - start;
 
 	/*
 	 * copy stuff from malloc'd hugepage* to the actual shared memory.
@@ -1401,6 +2328,15 @@ rte_eal_hugepage_init(void)
 		return -ENOMEM;
 	}
 
+	if (setup_heap_growth(mcfg, &hugepage[nr_hugefiles]) < 0)
+		return -1;
+
+done:
+	RTE_LOG(INFO, EAL, "Hugepage init took %" PRIu64 " ms (map %" PRIu64
+		" ms, fault %" PRIu64 " ms, sort %" PRIu64 " ms, remap %" PRIu64
+		" ms)\n", (get_time_ns() - init_start) / 1000000,
+		times.map / 1000000, times.fault / 1000000,
+		times.sort / 1000000, times.remap / 1000000);
 	return 0;
 
 fail:
@@ -1435,6 +2371,11 @@ rte_eal_hugepage_attach(void)
 	unsigned i, s = 0; /* s used to track the segment number */
 	off_t size;
 	int fd, fd_zero = -1, fd_hugepage = -1;
+	size_t seg_offset[RTE_MAX_MEMSEG];
+	unsigned nb_maps = 0;
+	uint64_t attach_start = get_time_ns();
+
+	memset(seg_offset, 0, sizeof(seg_offset));
 
 	if (aslr_enabled() > 0) {
 		RTE_LOG(WARNING, EAL, "WARNING: Address Space Layout Randomization "
@@ -1510,6 +2451,23 @@ rte_eal_hugepage_attach(void)
 		}
 	}
 
+	/* also reserve the areas the heaps can grow in */
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+		const struct rte_memseg *area = &mcfg->dyn_area[i];
+		void *base_addr;
+
+		if (area->len == 0)
+			continue;
+
+		base_addr = mmap(area->addr, area->len, PROT_READ,
+				MAP_PRIVATE, fd_zero, 0);
+		if (base_addr == MAP_FAILED || base_addr != area->addr) {
+			RTE_LOG(ERR, EAL, "Could not reserve growth area of "
+				"socket %u at [%p]\n", i, area->addr);
+			goto error;
+		}
+	}
+
 	size = getFileSize(fd_hugepage);
 	hp = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd_hugepage, 0);
 	if (hp == NULL) {
@@ -1520,65 +2478,106 @@ rte_eal_hugepage_attach(void)
 	num_hp = size / sizeof(struct hugepage_file);
 	RTE_LOG(DEBUG, EAL, "Analysing %u files\n", num_hp);
 
-	s = 0;
-	while (s < RTE_MAX_MEMSEG && mcfg->memseg[s].len > 0){
+	/*
+	 * Map the hugepages straight over the reserved areas, in a single pass
+	 * over the hugepage file: the primary sorted its entries, so the pages
+	 * of a segment come in address order. The entries are large, reading
+	 * the whole file once per segment was the bulk of the attach time.
+	 */
+	for (i = 0; i < num_hp; i++) {
+		int seg_id = hp[i].memseg_id;
 		void *addr, *base_addr;
-		uintptr_t offset = 0;
 		size_t mapping_size;
+
+		if (seg_id < 0 || seg_id >= RTE_MAX_MEMSEG ||
+				mcfg->memseg[seg_id].len == 0)
+			continue;
 #ifdef RTE_LIBRTE_IVSHMEM
 		/*
 		 * if segment has ioremap address set, it's an IVSHMEM segment and
 		 * doesn't need mapping as it was already mapped earlier
 		 */
-		if (mcfg->memseg[s].ioremap_addr != 0) {
-			s++;
+		if (mcfg->memseg[seg_id].ioremap_addr != 0)
 			continue;
-		}
 #endif
-		/*
-		 * free previously mapped memory so we can map the
-		 * hugepages into the space
-		 */
-		base_addr = mcfg->memseg[s].addr;
-		munmap(base_addr, mcfg->memseg[s].len);
-
-		/* find the hugepages for this segment and map them
-		 * we don't need to worry about order, as the server sorted the
-		 * entries before it did the second mmap of them */
-		for (i = 0; i < num_hp && offset < mcfg->memseg[s].len; i++){
-			if (hp[i].memseg_id == (int)s){
-				fd = open(hp[i].filepath, O_RDWR);
-				if (fd < 0) {
-					RTE_LOG(ERR, EAL, "Could not open %s\n",
-						hp[i].filepath);
-					goto error;
-				}
+		if (seg_offset[seg_id] >= mcfg->memseg[seg_id].len)
+			continue;
+
+		fd = open(hp[i].filepath, O_RDWR);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "Could not open %s\n",
+				hp[i].filepath);
+			goto error;
+		}
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
-				mapping_size = hp[i].size * hp[i].repeated;
+		mapping_size = hp[i].size * hp[i].repeated;
 #else
-				mapping_size = hp[i].size;
+		mapping_size = hp[i].size;
 #endif
-				addr = mmap(RTE_PTR_ADD(base_addr, offset),
-						mapping_size, PROT_READ | PROT_WRITE,
-						MAP_SHARED, fd, 0);
-				close(fd); /* close file both on success and on failure */
-				if (addr == MAP_FAILED ||
-						addr != RTE_PTR_ADD(base_addr, offset)) {
-					RTE_LOG(ERR, EAL, "Could not mmap %s\n",
-						hp[i].filepath);
-					goto error;
-				}
-				offset+=mapping_size;
-			}
+		/* replaces the /dev/zero reservation, the range is never free */
+		base_addr = RTE_PTR_ADD(mcfg->memseg[seg_id].addr,
+				seg_offset[seg_id]);
+		addr = mmap(base_addr, mapping_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_FIXED, fd, 0);
+		close(fd); /* close file both on success and on failure */
+		if (addr == MAP_FAILED || addr != base_addr) {
+			RTE_LOG(ERR, EAL, "Could not mmap %s\n",
+				hp[i].filepath);
+			goto error;
+		}
+		seg_offset[seg_id] += mapping_size;
+		nb_maps++;
+	}
+
+	for (s = 0; s < RTE_MAX_MEMSEG && mcfg->memseg[s].len > 0; s++) {
+#ifdef RTE_LIBRTE_IVSHMEM
+		if (mcfg->memseg[s].ioremap_addr != 0)
+			continue;
+#endif
+		if (seg_offset[s] != mcfg->memseg[s].len) {
+			RTE_LOG(ERR, EAL, "Could not find all pages of segment "
+				"%u\n", s);
+			goto error;
 		}
 		RTE_LOG(DEBUG, EAL, "Mapped segment %u of size 0x%llx\n", s,
 				(unsigned long long)mcfg->memseg[s].len);
-		s++;
 	}
+
+	/* map the files backing the growth areas, described at the end */
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+		const struct rte_memseg *area = &mcfg->dyn_area[i];
+		const struct hugepage_file *grow_hp;
+		void *addr;
+
+		if (area->len == 0)
+			continue;
+
+		munmap(area->addr, area->len);
+
+		grow_hp = &hp[num_hp - RTE_MAX_NUMA_NODES + i];
+		fd = open(grow_hp->filepath, O_RDWR);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "Could not open %s\n",
+				grow_hp->filepath);
+			goto error;
+		}
+		addr = mmap(area->addr, area->len, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_NORESERVE, fd, 0);
+		close(fd);
+		if (addr == MAP_FAILED || addr != area->addr) {
+			RTE_LOG(ERR, EAL, "Could not mmap %s\n",
+				grow_hp->filepath);
+			goto error;
+		}
+	}
+
 	/* unmap the hugepage config file, since we are done using it */
 	munmap((void *)(uintptr_t)hp, size);
 	close(fd_zero);
 	close(fd_hugepage);
+
+	RTE_LOG(INFO, EAL, "Hugepage attach took %" PRIu64 " ms (%u files "
+		"mapped)\n", (get_time_ns() - attach_start) / 1000000, nb_maps);
 	return 0;
 
 error:
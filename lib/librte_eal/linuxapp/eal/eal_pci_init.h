@@ -68,6 +68,7 @@ int pci_uio_ioport_unmap(struct rte_pci_ioport *p);
 
 int pci_vfio_enable(void);
 int pci_vfio_is_enabled(void);
+int pci_vfio_has_type1_iommu(void);
 int pci_vfio_mp_sync_setup(void);
 
 /* access config space */
@@ -89,6 +90,10 @@ int pci_vfio_map_resource(struct rte_pci_device *dev);
 int pci_vfio_get_group_fd(int iommu_group_fd);
 int pci_vfio_get_container_fd(void);
 
+/* DMA map/unmap of memory segments added at runtime */
+int pci_vfio_dma_map_memseg(const struct rte_memseg *ms);
+int pci_vfio_dma_unmap_memseg(const struct rte_memseg *ms);
+
 /*
  * Function prototypes for VFIO multiprocess sync functions
  */
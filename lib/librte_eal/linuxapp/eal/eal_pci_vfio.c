@@ -79,6 +79,9 @@ EAL_REGISTER_TAILQ(rte_vfio_tailq)
 /* per-process VFIO config */
 static struct vfio_config vfio_cfg;
 
+/* IOMMU type selected by the primary process, NULL until DMA is set up */
+static const struct vfio_iommu_type *vfio_dma_type;
+
 /* DMA mapping function prototype.
  * Takes VFIO container fd as a parameter.
  * Returns 0 on success, -1 on error.
@@ -102,33 +105,55 @@ static const struct vfio_iommu_type iommu_types[] = {
 	{ RTE_VFIO_NOIOMMU, "No-IOMMU", &vfio_noiommu_dma_map},
 };
 
+static int
+vfio_type1_dma_map_seg(int vfio_container_fd, const struct rte_memseg *ms)
+{
+	struct vfio_iommu_type1_dma_map dma_map;
+	int ret;
+
+	memset(&dma_map, 0, sizeof(dma_map));
+	dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
+	dma_map.vaddr = ms->addr_64;
+	dma_map.size = ms->len;
+	dma_map.iova = ms->phys_addr;
+	dma_map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+
+	ret = ioctl(vfio_container_fd, VFIO_IOMMU_MAP_DMA, &dma_map);
+
+	if (ret) {
+		RTE_LOG(ERR, EAL, "  cannot set up DMA remapping, "
+				"error %i (%s)\n", errno, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
 int
 vfio_type1_dma_map(int vfio_container_fd)
 {
+	const struct rte_mem_config *mcfg =
+		rte_eal_get_configuration()->mem_config;
 	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
-	int i, ret;
+	int i;
 
 	/* map all DPDK segments for DMA. use 1:1 PA to IOVA mapping */
 	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
-		struct vfio_iommu_type1_dma_map dma_map;
-
 		if (ms[i].addr == NULL)
 			break;
 
-		memset(&dma_map, 0, sizeof(dma_map));
-		dma_map.argsz = sizeof(struct vfio_iommu_type1_dma_map);
-		dma_map.vaddr = ms[i].addr_64;
-		dma_map.size = ms[i].len;
-		dma_map.iova = ms[i].phys_addr;
-		dma_map.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+		if (vfio_type1_dma_map_seg(vfio_container_fd, &ms[i]) < 0)
+			return -1;
+	}
 
-		ret = ioctl(vfio_container_fd, VFIO_IOMMU_MAP_DMA, &dma_map);
+	/* and the segments the heaps have grown with so far */
+	for (i = 0; i < RTE_MAX_MEMSEG; i++) {
+		if (mcfg->dyn_memseg[i].len == 0)
+			continue;
 
-		if (ret) {
-			RTE_LOG(ERR, EAL, "  cannot set up DMA remapping, "
-					"error %i (%s)\n", errno, strerror(errno));
+		if (vfio_type1_dma_map_seg(vfio_container_fd,
+				&mcfg->dyn_memseg[i]) < 0)
 			return -1;
-		}
 	}
 
 	return 0;
@@ -141,6 +166,42 @@ vfio_noiommu_dma_map(int __rte_unused vfio_container_fd)
 	return 0;
 }
 
+/*
+ * Map a memory segment added after the DMA setup, so devices can access
+ * memory the heaps grow with at runtime.
+ */
+int
+pci_vfio_dma_map_memseg(const struct rte_memseg *ms)
+{
+	if (vfio_dma_type == NULL || vfio_dma_type->type_id != RTE_VFIO_TYPE1)
+		return 0;
+
+	return vfio_type1_dma_map_seg(vfio_cfg.vfio_container_fd, ms);
+}
+
+int
+pci_vfio_dma_unmap_memseg(const struct rte_memseg *ms)
+{
+	struct vfio_iommu_type1_dma_unmap dma_unmap;
+
+	if (vfio_dma_type == NULL || vfio_dma_type->type_id != RTE_VFIO_TYPE1)
+		return 0;
+
+	memset(&dma_unmap, 0, sizeof(dma_unmap));
+	dma_unmap.argsz = sizeof(struct vfio_iommu_type1_dma_unmap);
+	dma_unmap.size = ms->len;
+	dma_unmap.iova = ms->phys_addr;
+
+	if (ioctl(vfio_cfg.vfio_container_fd, VFIO_IOMMU_UNMAP_DMA,
+			&dma_unmap)) {
+		RTE_LOG(ERR, EAL, "  cannot remove DMA remapping, "
+				"error %i (%s)\n", errno, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
 int
 pci_vfio_read_config(const struct rte_intr_handle *intr_handle,
 		    void *buf, size_t len, off_t offs)
@@ -769,6 +830,7 @@ pci_vfio_map_resource(struct rte_pci_device *dev)
 			return -1;
 		}
 		vfio_cfg.vfio_container_has_dma = 1;
+		vfio_dma_type = t;
 	}
 
 	/* get a file descriptor for the device */
@@ -1093,4 +1155,18 @@ pci_vfio_is_enabled(void)
 {
 	return vfio_cfg.vfio_enabled;
 }
+
+/*
+ * Check that the devices will be mapped in a type 1 IOMMU, the first type
+ * tried when the first device is mapped, which translates DMA addresses.
+ */
+int
+pci_vfio_has_type1_iommu(void)
+{
+	if (!vfio_cfg.vfio_enabled)
+		return 0;
+
+	return ioctl(vfio_cfg.vfio_container_fd, VFIO_CHECK_EXTENSION,
+			RTE_VFIO_TYPE1) == 1;
+}
 #endif
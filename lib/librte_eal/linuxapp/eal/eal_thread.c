@@ -181,7 +181,9 @@ eal_thread_loop(__attribute__((unused)) void *arg)
 
 		/* call the function and store the return value */
 		fct_arg = lcore_config[lcore_id].arg;
+		eal_lcore_poll_reset(lcore_id);
 		ret = lcore_config[lcore_id].f(fct_arg);
+		eal_lcore_poll_reset(lcore_id);
 		lcore_config[lcore_id].ret = ret;
 		rte_wmb();
 		lcore_config[lcore_id].state = FINISHED;
@@ -558,12 +558,19 @@ add_mempool_to_metadata(const struct rte_mempool * mp,
 		return -1;
 	}
 
+	/* only a mempool storing its objects in a ring can be shared */
+	if (strncmp(rte_mempool_get_ops(mp->ops_index)->name, "ring_",
+			strlen("ring_")) != 0) {
+		RTE_LOG(ERR, EAL, "Mempool is not ring based!\n");
+		return -1;
+	}
+
 	/* mempool consists of memzone and ring */
 	ret = add_memzone_to_metadata(mz, config);
 	if (ret < 0)
 		return -1;
 
-	return add_ring_to_metadata(mp->ring, config);
+	return add_ring_to_metadata(mp->pool_data, config);
 }
 
 int
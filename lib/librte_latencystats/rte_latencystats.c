@@ -0,0 +1,310 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_cycles.h>
+#include <rte_memzone.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+
+#include "rte_latencystats.h"
+
+#define RTE_LOGTYPE_LATENCY_STATS RTE_LOGTYPE_USER1
+
+#define LATENCY_STATS_MZ_NAME "RTE_LATENCYSTATS"
+
+#define NS_PER_SEC 1E9
+
+/* jitter is kept multiplied by 16, the inverse of its gain */
+#define JITTER_SHIFT 4
+
+/** Statistics of a Tx queue, only updated by the lcore sending on it. */
+struct latency_queue {
+	uint64_t samples;
+	uint64_t sum_ns;
+	uint64_t min_ns;
+	uint64_t max_ns;
+	uint64_t jitter;
+	uint64_t prev_ns;
+	uint64_t hist[RTE_LATENCYSTATS_HIST_BUCKETS];
+} __rte_cache_aligned;
+
+/** Content of the memzone, shared with secondary processes. */
+struct latency_data {
+	struct latency_queue queues[RTE_MAX_ETHPORTS]
+		[RTE_LATENCYSTATS_MAX_QUEUES];
+};
+
+/** Sampling state of an Rx queue, only used by the lcore polling it. */
+struct rx_sampler {
+	uint32_t countdown;
+} __rte_cache_aligned;
+
+static struct latency_data *latency_data;
+static struct rx_sampler rx_samplers[RTE_MAX_ETHPORTS]
+	[RTE_LATENCYSTATS_MAX_QUEUES];
+static void *rx_cbs[RTE_MAX_ETHPORTS][RTE_LATENCYSTATS_MAX_QUEUES];
+static void *tx_cbs[RTE_MAX_ETHPORTS][RTE_LATENCYSTATS_MAX_QUEUES];
+static uint32_t sample_rate;
+static double ns_per_cycle;
+static int started;
+
+/* timestamp one packet out of sample_rate */
+static uint16_t
+add_timestamps(__rte_unused uint8_t port, __rte_unused uint16_t queue,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		__rte_unused uint16_t max_pkts, void *user_param)
+{
+	struct rx_sampler *sampler = user_param;
+	uint32_t countdown = sampler->countdown;
+	uint64_t now;
+	uint32_t i, last = 0;
+
+	/* skip the whole burst in the common case */
+	if (likely(countdown > nb_pkts)) {
+		sampler->countdown = countdown - nb_pkts;
+		return nb_pkts;
+	}
+
+	now = rte_rdtsc();
+	for (i = countdown - 1; i < nb_pkts; i += sample_rate) {
+		pkts[i]->timestamp = now;
+		pkts[i]->ol_flags |= PKT_RX_TIMESTAMP;
+		last = i;
+	}
+	sampler->countdown = sample_rate - (nb_pkts - 1 - last);
+	return nb_pkts;
+}
+
+static inline void
+latency_update(struct latency_queue *q, uint64_t ns)
+{
+	uint64_t diff;
+	unsigned bucket;
+
+	if (q->samples == 0 || ns < q->min_ns)
+		q->min_ns = ns;
+	if (ns > q->max_ns)
+		q->max_ns = ns;
+	if (q->samples != 0) {
+		diff = ns > q->prev_ns ? ns - q->prev_ns : q->prev_ns - ns;
+		q->jitter += diff - (q->jitter >> JITTER_SHIFT);
+	}
+	q->prev_ns = ns;
+	q->sum_ns += ns;
+	q->samples++;
+
+	bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+	if (bucket >= RTE_LATENCYSTATS_HIST_BUCKETS)
+		bucket = RTE_LATENCYSTATS_HIST_BUCKETS - 1;
+	q->hist[bucket]++;
+}
+
+/* account the latency of the timestamped packets */
+static uint16_t
+calc_latency(__rte_unused uint8_t port, __rte_unused uint16_t queue,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_param)
+{
+	struct latency_queue *q = user_param;
+	uint64_t now = 0;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (likely(!(pkts[i]->ol_flags & PKT_RX_TIMESTAMP)))
+			continue;
+		if (now == 0)
+			now = rte_rdtsc();
+		latency_update(q, (uint64_t)((now - pkts[i]->timestamp) *
+				ns_per_cycle));
+		/* a packet sent again is measured once */
+		pkts[i]->ol_flags &= ~PKT_RX_TIMESTAMP;
+	}
+	return nb_pkts;
+}
+
+/* get the memzone of the statistics, reserving it in the primary process */
+static int
+latency_data_get(int socket_id, int create)
+{
+	const struct rte_memzone *mz;
+
+	if (latency_data != NULL)
+		return 0;
+
+	mz = rte_memzone_lookup(LATENCY_STATS_MZ_NAME);
+	if (mz == NULL) {
+		if (!create || rte_eal_process_type() != RTE_PROC_PRIMARY)
+			return -ENOENT;
+		mz = rte_memzone_reserve(LATENCY_STATS_MZ_NAME,
+				sizeof(struct latency_data), socket_id, 0);
+		if (mz == NULL) {
+			RTE_LOG(ERR, LATENCY_STATS,
+				"Cannot reserve latency stats memzone\n");
+			return -ENOMEM;
+		}
+		memset(mz->addr, 0, sizeof(struct latency_data));
+	}
+	latency_data = mz->addr;
+	return 0;
+}
+
+int
+rte_latencystats_init(uint32_t rate, int socket_id)
+{
+	struct rte_eth_dev_data *dev_data;
+	uint16_t nb_rxq, nb_txq, q;
+	uint8_t port;
+	int ret;
+
+	if (rate == 0)
+		return -EINVAL;
+	if (started)
+		return -EEXIST;
+
+	ret = latency_data_get(socket_id, 1);
+	if (ret < 0)
+		return ret;
+
+	sample_rate = rate;
+	ns_per_cycle = NS_PER_SEC / rte_get_tsc_hz();
+
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		if (!rte_eth_dev_is_valid_port(port))
+			continue;
+
+		dev_data = rte_eth_devices[port].data;
+		nb_rxq = dev_data->nb_rx_queues;
+		nb_txq = dev_data->nb_tx_queues;
+		if (nb_rxq > RTE_LATENCYSTATS_MAX_QUEUES ||
+				nb_txq > RTE_LATENCYSTATS_MAX_QUEUES) {
+			RTE_LOG(WARNING, LATENCY_STATS,
+				"Only %d queues of port %u are measured\n",
+				RTE_LATENCYSTATS_MAX_QUEUES, port);
+			nb_rxq = RTE_MIN(nb_rxq, RTE_LATENCYSTATS_MAX_QUEUES);
+			nb_txq = RTE_MIN(nb_txq, RTE_LATENCYSTATS_MAX_QUEUES);
+		}
+
+		for (q = 0; q < nb_rxq; q++) {
+			rx_samplers[port][q].countdown = sample_rate;
+			rx_cbs[port][q] = rte_eth_add_rx_callback(port, q,
+					add_timestamps, &rx_samplers[port][q]);
+			if (rx_cbs[port][q] == NULL)
+				goto fail;
+		}
+		for (q = 0; q < nb_txq; q++) {
+			tx_cbs[port][q] = rte_eth_add_tx_callback(port, q,
+					calc_latency,
+					&latency_data->queues[port][q]);
+			if (tx_cbs[port][q] == NULL)
+				goto fail;
+		}
+	}
+
+	started = 1;
+	return 0;
+
+fail:
+	ret = -rte_errno;
+	RTE_LOG(ERR, LATENCY_STATS,
+		"Cannot register callback on port %u queue %u\n", port, q);
+	started = 1;
+	rte_latencystats_uninit();
+	return ret;
+}
+
+int
+rte_latencystats_uninit(void)
+{
+	uint8_t port;
+	uint16_t q;
+
+	if (!started)
+		return -EINVAL;
+
+	/* the callbacks are not freed as they may still be running */
+	for (port = 0; port < RTE_MAX_ETHPORTS; port++) {
+		for (q = 0; q < RTE_LATENCYSTATS_MAX_QUEUES; q++) {
+			if (rx_cbs[port][q] != NULL)
+				rte_eth_remove_rx_callback(port, q,
+						rx_cbs[port][q]);
+			if (tx_cbs[port][q] != NULL)
+				rte_eth_remove_tx_callback(port, q,
+						tx_cbs[port][q]);
+			rx_cbs[port][q] = NULL;
+			tx_cbs[port][q] = NULL;
+		}
+	}
+
+	started = 0;
+	return 0;
+}
+
+int
+rte_latencystats_get(uint8_t port_id, uint16_t queue_id,
+		struct rte_latencystats *stats)
+{
+	const struct latency_queue *q;
+	uint64_t samples;
+
+	if (port_id >= RTE_MAX_ETHPORTS ||
+			queue_id >= RTE_LATENCYSTATS_MAX_QUEUES)
+		return -EINVAL;
+	if (latency_data_get(SOCKET_ID_ANY, 0) < 0)
+		return -ENOENT;
+
+	q = &latency_data->queues[port_id][queue_id];
+	samples = q->samples;
+	stats->samples = samples;
+	stats->min_ns = q->min_ns;
+	stats->avg_ns = samples == 0 ? 0 : q->sum_ns / samples;
+	stats->max_ns = q->max_ns;
+	stats->jitter_ns = q->jitter >> JITTER_SHIFT;
+	memcpy(stats->hist, q->hist, sizeof(stats->hist));
+	return 0;
+}
+
+int
+rte_latencystats_reset(void)
+{
+	if (latency_data_get(SOCKET_ID_ANY, 0) < 0)
+		return -ENOENT;
+
+	memset(latency_data->queues, 0, sizeof(latency_data->queues));
+	return 0;
+}
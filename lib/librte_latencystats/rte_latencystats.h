@@ -0,0 +1,145 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LATENCYSTATS_H_
+#define _RTE_LATENCYSTATS_H_
+
+/**
+ * @file
+ * RTE Latency Statistics
+ *
+ * The latency statistics library measures the time packets spend in the
+ * application, from their reception by rte_eth_rx_burst() to their
+ * transmission by rte_eth_tx_burst(), using ethdev Rx and Tx callbacks.
+ *
+ * One packet out of a configurable number is timestamped at Rx, in the
+ * timestamp field of the mbuf with the PKT_RX_TIMESTAMP flag. When such
+ * a packet is sent, its latency is accounted in the statistics of the
+ * Tx port and queue, which are kept in a memzone so that they can be
+ * read by secondary processes. The application must keep the
+ * PKT_RX_TIMESTAMP flag of the forwarded mbufs for them to be measured.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of buckets of the latency histograms. */
+#define RTE_LATENCYSTATS_HIST_BUCKETS 32
+
+/** Latency statistics of a Tx queue, all latencies in nanoseconds. */
+struct rte_latencystats {
+	uint64_t samples;    /**< Number of measured packets. */
+	uint64_t min_ns;     /**< Minimum latency. */
+	uint64_t avg_ns;     /**< Average latency. */
+	uint64_t max_ns;     /**< Maximum latency. */
+	/** Mean deviation between consecutive latencies, as in RFC 3550. */
+	uint64_t jitter_ns;
+	/**
+	 * Histogram of latencies: bucket i counts the latencies from 2^i to
+	 * 2^(i+1) - 1 ns, the last bucket also counts longer latencies.
+	 */
+	uint64_t hist[RTE_LATENCYSTATS_HIST_BUCKETS];
+};
+
+/**
+ * Start measuring latencies on all the configured queues of all ports.
+ *
+ * It must be called by the primary process once the ports are
+ * configured, and each Rx and Tx queue should be polled by a single
+ * lcore. Only the first RTE_LATENCYSTATS_MAX_QUEUES queues of a port are
+ * measured.
+ *
+ * @param sample_rate
+ *   One packet out of sample_rate received on a queue is timestamped.
+ * @param socket_id
+ *   Socket on which the memzone is allocated, or SOCKET_ID_ANY.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if sample_rate is 0.
+ *   - (-EEXIST) if the measures are already started.
+ *   - (-ENOMEM) if the memzone cannot be allocated.
+ */
+int rte_latencystats_init(uint32_t sample_rate, int socket_id);
+
+/**
+ * Stop measuring latencies.
+ *
+ * The callbacks are removed from the queues, the statistics are kept.
+ * As an ethdev callback may still be running, the ports should be
+ * stopped before restarting the measures.
+ *
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the measures are not started.
+ */
+int rte_latencystats_uninit(void);
+
+/**
+ * Get the latency statistics of a Tx queue.
+ *
+ * It can be called from a secondary process.
+ *
+ * @param port_id
+ *   The port identifier.
+ * @param queue_id
+ *   The Tx queue identifier.
+ * @param stats
+ *   A pointer to a structure filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if the port or queue is out of range.
+ *   - (-ENOENT) if the primary process did not start the measures.
+ */
+int rte_latencystats_get(uint8_t port_id, uint16_t queue_id,
+		struct rte_latencystats *stats);
+
+/**
+ * Reset the latency statistics of all queues.
+ *
+ * The statistics of a queue may be partially reset if packets are sent
+ * on it at the same time.
+ *
+ * @return
+ *   - 0: Success.
+ *   - (-ENOENT) if the primary process did not start the measures.
+ */
+int rte_latencystats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LATENCYSTATS_H_ */
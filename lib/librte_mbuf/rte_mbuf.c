@@ -56,6 +56,7 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
+#include <rte_memcpy.h>
 #include <rte_string_fns.h>
 #include <rte_hexdump.h>
 #include <rte_errno.h>
@@ -167,10 +168,180 @@ rte_pktmbuf_pool_create(const char *name, unsigned n,
 	mbp_priv.mbuf_data_room_size = data_room_size;
 	mbp_priv.mbuf_priv_size = priv_size;
 
-	return rte_mempool_create(name, n, elt_size,
+	if (rte_xen_dom0_supported())
+		return rte_mempool_create(name, n, elt_size,
+			cache_size, sizeof(struct rte_pktmbuf_pool_private),
+			rte_pktmbuf_pool_init, &mbp_priv, rte_pktmbuf_init,
+			NULL, socket_id, 0);
+
+	return rte_mempool_create_with_ops(name, n, elt_size,
 		cache_size, sizeof(struct rte_pktmbuf_pool_private),
 		rte_pktmbuf_pool_init, &mbp_priv, rte_pktmbuf_init, NULL,
-		socket_id, 0);
+		socket_id, 0, RTE_MBUF_DEFAULT_MEMPOOL_OPS);
+}
+
+/* max number of segments returned to a mempool in one bulk put */
+#define RTE_PKTMBUF_FREE_PENDING_SZ 64
+
+/* free an array of mbufs, grouping the segments by mempool */
+void
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned count)
+{
+	struct rte_mempool *pending_mp = NULL;
+	void *pending[RTE_PKTMBUF_FREE_PENDING_SZ];
+	struct rte_mbuf *m, *m_next;
+	unsigned i, nb_pending = 0;
+
+	for (i = 0; i < count; i++) {
+		m = mbufs[i];
+		if (m == NULL)
+			continue;
+
+		__rte_mbuf_sanity_check(m, 1);
+
+		for (; m != NULL; m = m_next) {
+			m_next = m->next;
+			m = __rte_pktmbuf_prefree_seg(m);
+			if (unlikely(m == NULL))
+				continue;
+			m->next = NULL;
+
+			/* flush when the pool changes or the array is full */
+			if (unlikely(m->pool != pending_mp ||
+					nb_pending == RTE_PKTMBUF_FREE_PENDING_SZ)) {
+				if (nb_pending > 0)
+					rte_mempool_put_bulk(pending_mp,
+						pending, nb_pending);
+				pending_mp = m->pool;
+				nb_pending = 0;
+			}
+			pending[nb_pending++] = m;
+		}
+	}
+
+	if (nb_pending > 0)
+		rte_mempool_put_bulk(pending_mp, pending, nb_pending);
+}
+
+/*
+ * Return true if data can be appended in the tailroom of a segment without
+ * corrupting another mbuf: the data buffer must not be shared.
+ */
+static inline int
+pktmbuf_seg_is_writable(const struct rte_mbuf *m)
+{
+	if (RTE_MBUF_INDIRECT(m) || rte_mbuf_refcnt_read(m) != 1)
+		return 0;
+	if (RTE_MBUF_HAS_EXTBUF(m) && rte_mbuf_ext_refcnt_read(m->shinfo) != 1)
+		return 0;
+	return 1;
+}
+
+/* copy the packet metadata of m into a new single segment mbuf */
+static void
+pktmbuf_copy_metadata(struct rte_mbuf *mc, const struct rte_mbuf *m)
+{
+	mc->port = m->port;
+	mc->ol_flags = m->ol_flags & ~(IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF);
+	mc->packet_type = m->packet_type;
+	mc->vlan_tci = m->vlan_tci;
+	mc->hash = m->hash;
+	mc->seqn = m->seqn;
+	mc->vlan_tci_outer = m->vlan_tci_outer;
+	memcpy(mc->dynfield0, m->dynfield0, sizeof(mc->dynfield0));
+	mc->udata64 = m->udata64;
+	mc->tx_offload = m->tx_offload;
+	mc->timesync = m->timesync;
+	mc->dynfield1 = m->dynfield1;
+	mc->timestamp = m->timestamp;
+}
+
+/* gather the segments of a packet in a single one */
+struct rte_mbuf *
+rte_pktmbuf_linearize(struct rte_mbuf *m, struct rte_mempool *mp)
+{
+	struct rte_mbuf *mc, *seg, *seg_next;
+	char *dst;
+
+	__rte_mbuf_sanity_check(m, 1);
+
+	if (m->next == NULL)
+		return m;
+
+	/* in place, when the remaining segments fit in the first one */
+	if (pktmbuf_seg_is_writable(m) &&
+			rte_pktmbuf_tailroom(m) >= m->pkt_len - m->data_len) {
+		dst = rte_pktmbuf_mtod_offset(m, char *, m->data_len);
+		for (seg = m->next; seg != NULL; seg = seg_next) {
+			seg_next = seg->next;
+			rte_memcpy(dst, rte_pktmbuf_mtod(seg, char *),
+				   seg->data_len);
+			dst += seg->data_len;
+			rte_pktmbuf_free_seg(seg);
+		}
+		m->next = NULL;
+		m->nb_segs = 1;
+		m->data_len = (uint16_t)m->pkt_len;
+		return m;
+	}
+
+	/* otherwise, copy the whole packet in a new mbuf */
+	if (mp == NULL)
+		mp = m->pool;
+	mc = rte_pktmbuf_alloc(mp);
+	if (mc == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	if (rte_pktmbuf_tailroom(mc) < m->pkt_len) {
+		rte_pktmbuf_free(mc);
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+
+	dst = rte_pktmbuf_mtod(mc, char *);
+	for (seg = m; seg != NULL; seg = seg->next) {
+		rte_memcpy(dst, rte_pktmbuf_mtod(seg, char *), seg->data_len);
+		dst += seg->data_len;
+	}
+	mc->data_len = (uint16_t)m->pkt_len;
+	mc->pkt_len = m->pkt_len;
+	pktmbuf_copy_metadata(mc, m);
+
+	rte_pktmbuf_free(m);
+	return mc;
+}
+
+/* merge the small segments of a packet in the tailroom of the previous ones */
+int
+rte_pktmbuf_coalesce(struct rte_mbuf *m, uint16_t max_len)
+{
+	struct rte_mbuf *prev, *seg, *seg_next;
+
+	__rte_mbuf_sanity_check(m, 1);
+
+	prev = m;
+	for (seg = m->next; seg != NULL; seg = seg_next) {
+		seg_next = seg->next;
+
+		/* empty segments are always dropped */
+		if (seg->data_len != 0 && (seg->data_len > max_len ||
+				rte_pktmbuf_tailroom(prev) < seg->data_len ||
+				!pktmbuf_seg_is_writable(prev))) {
+			prev = seg;
+			continue;
+		}
+
+		rte_memcpy(rte_pktmbuf_mtod_offset(prev, char *,
+						   prev->data_len),
+			   rte_pktmbuf_mtod(seg, char *), seg->data_len);
+		prev->data_len = (uint16_t)(prev->data_len + seg->data_len);
+		prev->next = seg_next;
+		m->nb_segs--;
+		rte_pktmbuf_free_seg(seg);
+	}
+
+	return m->nb_segs;
 }
 
 /* do some sanity checks on a mbuf: panic if it fails */
@@ -260,6 +431,7 @@ const char *rte_get_rx_ol_flag_name(uint64_t mask)
 	/* case PKT_RX_MAC_ERR: return "PKT_RX_MAC_ERR"; */
 	case PKT_RX_IEEE1588_PTP: return "PKT_RX_IEEE1588_PTP";
 	case PKT_RX_IEEE1588_TMST: return "PKT_RX_IEEE1588_TMST";
+	case PKT_RX_TIMESTAMP: return "PKT_RX_TIMESTAMP";
 	default: return NULL;
 	}
 }
@@ -53,6 +53,7 @@
  * http://www.kohala.com/start/tcpipiv2.html
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <rte_common.h>
 #include <rte_mempool.h>
@@ -60,6 +61,9 @@
 #include <rte_atomic.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
+#if defined(RTE_ARCH_X86) && defined(__SSE2__)
+#include <rte_vect.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -79,6 +83,9 @@ extern "C" {
  * - TX flags therefore start at bit position 60 (i.e. 63-3), and new flags get
  *   added to the right of the previously defined flags i.e. they should count
  *   downwards, not upwards.
+ * - The bits between the last RX flag and the first TX flag are given to
+ *   dynamic flags, see rte_mbuf_dyn.h. Update the static flags mask in
+ *   rte_mbuf_dyn.c when adding a flag at either end.
  *
  * Keep these flags synchronized with rte_get_rx_ol_flag_name() and
  * rte_get_tx_ol_flag_name().
@@ -98,6 +105,7 @@ extern "C" {
 #define PKT_RX_FDIR_ID       (1ULL << 13) /**< FD id reported if FDIR match. */
 #define PKT_RX_FDIR_FLX      (1ULL << 14) /**< Flexible bytes reported if FDIR match. */
 #define PKT_RX_QINQ_PKT      (1ULL << 15)  /**< RX packet with double VLAN stripped. */
+#define PKT_RX_TIMESTAMP     (1ULL << 16) /**< Timestamp field is valid. */
 /* add new RX flags here */
 
 /* add new TX flags here */
@@ -192,7 +200,10 @@ extern "C" {
  */
 #define PKT_TX_OUTER_IPV6    (1ULL << 60)
 
-#define __RESERVED           (1ULL << 61) /**< reserved for future mbuf use */
+/**
+ * Mbuf having an external buffer attached. shinfo in mbuf must be filled.
+ */
+#define EXT_ATTACHED_MBUF    (1ULL << 61)
 
 #define IND_ATTACHED_MBUF    (1ULL << 62) /**< Indirect attached mbuf */
 
@@ -813,6 +824,9 @@ struct rte_mbuf {
 
 	uint16_t vlan_tci_outer;  /**< Outer VLAN Tag Control Identifier (CPU order) */
 
+	/** Reserved for dynamic fields, see rte_mbuf_dyn.h. */
+	uint16_t dynfield0[3];
+
 	/* second cache line - fields only used in slow path or on TX */
 	MARKER cacheline1 __rte_cache_min_aligned;
 
@@ -848,10 +862,34 @@ struct rte_mbuf {
 	/** Timesync flags for use with IEEE1588. */
 	uint16_t timesync;
 
+	/** Reserved for dynamic fields, see rte_mbuf_dyn.h. */
+	uint32_t dynfield1;
+
 	/* Chain of off-load operations to perform on mbuf */
 	struct rte_mbuf_offload *offload_ops;
+
+	/** Rx timestamp in TSC cycles, valid if PKT_RX_TIMESTAMP is set. */
+	uint64_t timestamp;
+
+	/** Shared data for external buffer attached to mbuf. See
+	 * rte_pktmbuf_attach_extbuf(). */
+	struct rte_mbuf_ext_shared_info *shinfo;
 } __rte_cache_aligned;
 
+/**
+ * Function typedef of callback to free externally attached buffer.
+ */
+typedef void (*rte_mbuf_extbuf_free_callback_t)(void *addr, void *opaque);
+
+/**
+ * Shared data at the end of an external buffer.
+ */
+struct rte_mbuf_ext_shared_info {
+	rte_mbuf_extbuf_free_callback_t free_cb; /**< Free callback function */
+	void *fcb_opaque;                        /**< Free callback argument */
+	rte_atomic16_t refcnt_atomic;        /**< Atomically accessed refcnt */
+};
+
 static inline uint16_t rte_pktmbuf_priv_size(struct rte_mempool *mp);
 
 /**
@@ -889,10 +927,21 @@ rte_mbuf_to_baddr(struct rte_mbuf *md)
  */
 #define RTE_MBUF_INDIRECT(mb)   ((mb)->ol_flags & IND_ATTACHED_MBUF)
 
+/**
+ * Returns TRUE if given mbuf has an external buffer, or FALSE otherwise.
+ *
+ * External buffer is a user-provided anonymous buffer.
+ */
+#define RTE_MBUF_HAS_EXTBUF(mb) ((mb)->ol_flags & EXT_ATTACHED_MBUF)
+
 /**
  * Returns TRUE if given mbuf is direct, or FALSE otherwise.
+ *
+ * A direct mbuf is neither indirect nor attached to an external buffer:
+ * its data is stored in the buffer embedded in the mbuf itself.
  */
-#define RTE_MBUF_DIRECT(mb)     (!RTE_MBUF_INDIRECT(mb))
+#define RTE_MBUF_DIRECT(mb) \
+	(!((mb)->ol_flags & (IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF)))
 
 /**
  * Private data in case of pktmbuf pool.
@@ -1022,6 +1071,64 @@ rte_mbuf_refcnt_set(struct rte_mbuf *m, uint16_t new_value)
 
 #endif /* RTE_MBUF_REFCNT_ATOMIC */
 
+/**
+ * Reads the refcnt of an external buffer.
+ *
+ * @param shinfo
+ *   Shared data of the external buffer.
+ * @return
+ *   Reference count number.
+ */
+static inline uint16_t
+rte_mbuf_ext_refcnt_read(const struct rte_mbuf_ext_shared_info *shinfo)
+{
+	return (uint16_t)(rte_atomic16_read(&shinfo->refcnt_atomic));
+}
+
+/**
+ * Set refcnt of an external buffer.
+ *
+ * @param shinfo
+ *   Shared data of the external buffer.
+ * @param new_value
+ *   Value set
+ */
+static inline void
+rte_mbuf_ext_refcnt_set(struct rte_mbuf_ext_shared_info *shinfo,
+	uint16_t new_value)
+{
+	rte_atomic16_set(&shinfo->refcnt_atomic, new_value);
+}
+
+/**
+ * Add given value to refcnt of an external buffer and return its new
+ * value.
+ *
+ * The external buffer can be shared by mbufs used on different lcores,
+ * so its reference counter is always updated atomically, whatever the
+ * CONFIG_RTE_MBUF_REFCNT_ATOMIC option.
+ *
+ * @param shinfo
+ *   Shared data of the external buffer.
+ * @param value
+ *   Value to add/subtract
+ * @return
+ *   Updated value
+ */
+static inline uint16_t
+rte_mbuf_ext_refcnt_update(struct rte_mbuf_ext_shared_info *shinfo,
+	int16_t value)
+{
+	/* same shortcut as rte_mbuf_refcnt_update() for a single holder */
+	if (likely(rte_mbuf_ext_refcnt_read(shinfo) == 1)) {
+		rte_mbuf_ext_refcnt_set(shinfo, 1 + value);
+		return 1 + value;
+	}
+
+	return (uint16_t)(rte_atomic16_add_return(&shinfo->refcnt_atomic,
+		value));
+}
+
 /** Mbuf prefetch */
 #define RTE_MBUF_PREFETCH_TO_FREE(m) do {       \
 	if ((m) != NULL)                        \
@@ -1210,8 +1317,9 @@ void rte_pktmbuf_pool_init(struct rte_mempool *mp, void *opaque_arg);
  * Create a mbuf pool.
  *
  * This function creates and initializes a packet mbuf pool. It is
- * a wrapper to rte_mempool_create() with the proper packet constructor
- * and mempool constructor.
+ * a wrapper to rte_mempool_create_with_ops() with the proper packet
+ * constructor and mempool constructor. The pool handler is
+ * RTE_MBUF_DEFAULT_MEMPOOL_OPS, set at compilation time.
  *
  * @param name
  *   The name of the mbuf pool.
@@ -1335,11 +1443,227 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
 	return m;
 }
 
+/**
+ * @internal Reset the fields of freshly allocated packet mbufs.
+ * The use of that function is reserved for RTE internal needs.
+ * Please use rte_pktmbuf_alloc_bulk().
+ *
+ * All the mbufs must come from the packet mbuf pool *mp* and have a
+ * reference counter of 0. The 6 bytes initialised on RX descriptor
+ * rearm are written with a single store of a template built once for
+ * the whole array, and on x86 the ol_flags, packet_type and pkt_len
+ * fields are cleared with a single 16-byte vector store.
+ *
+ * @param mp
+ *   The mempool from which the mbufs were allocated.
+ * @param mbufs
+ *   Array of mbufs to reset.
+ * @param count
+ *   Number of mbufs in the array.
+ */
+static inline void
+__rte_pktmbuf_reset_bulk(struct rte_mempool *mp, struct rte_mbuf **mbufs,
+	unsigned count)
+{
+	struct rte_mbuf mb_def = { .buf_addr = 0 }; /* zeroed mbuf */
+	uint16_t buf_len = rte_pktmbuf_data_room_size(mp);
+	uint64_t rearm;
+	unsigned i;
+#if defined(RTE_ARCH_X86) && defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+#endif
+
+	/* the stores below rely on these fields being contiguous */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+		offsetof(struct rte_mbuf, rearm_data) + 6);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, packet_type) !=
+		offsetof(struct rte_mbuf, ol_flags) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, pkt_len) !=
+		offsetof(struct rte_mbuf, ol_flags) + 12);
+
+	/* prepare the rearm template, its last 2 bytes overlap ol_flags */
+	mb_def.data_off = RTE_MIN(RTE_PKTMBUF_HEADROOM, buf_len);
+	rte_mbuf_refcnt_set(&mb_def, 1);
+	mb_def.nb_segs = 1;
+	mb_def.port = 0xff;
+	mb_def.ol_flags = 0;
+	rte_compiler_barrier();
+	rearm = *(uint64_t *)(uintptr_t)&mb_def.rearm_data;
+
+	for (i = 0; i < count; i++) {
+		struct rte_mbuf *m = mbufs[i];
+
+		RTE_MBUF_ASSERT(rte_mbuf_refcnt_read(m) == 0);
+		*(uint64_t *)(uintptr_t)&m->rearm_data = rearm;
+#if defined(RTE_ARCH_X86) && defined(__SSE2__)
+		_mm_storeu_si128((__m128i *)(uintptr_t)&m->ol_flags, zero);
+#else
+		m->ol_flags = 0;
+		m->packet_type = 0;
+		m->pkt_len = 0;
+#endif
+		m->data_len = 0;
+		m->vlan_tci = 0;
+		m->vlan_tci_outer = 0;
+		m->next = NULL;
+		m->tx_offload = 0;
+		__rte_mbuf_sanity_check(m, 1);
+	}
+}
+
+/**
+ * Allocate a bulk of mbufs from a mempool.
+ *
+ * The mbufs are retrieved from the mempool in a single call and are
+ * initialized as if they were allocated with rte_pktmbuf_alloc(): each
+ * one contains one segment of length 0 with some bytes of headroom.
+ * This is either a success for all the requested mbufs, or a failure
+ * in which case no mbuf is allocated.
+ *
+ * @param pool
+ *   The mempool from which the mbufs are allocated.
+ * @param mbufs
+ *   Array where the pointers to the allocated mbufs are stored.
+ * @param count
+ *   Number of mbufs to allocate.
+ * @return
+ *   - 0: Success; all mbufs are allocated.
+ *   - -ENOENT: Not enough entries in the mempool; no mbuf is allocated.
+ */
+static inline int
+rte_pktmbuf_alloc_bulk(struct rte_mempool *pool, struct rte_mbuf **mbufs,
+	unsigned count)
+{
+	if (unlikely(count == 0))
+		return 0;
+	if (rte_mempool_get_bulk(pool, (void **)mbufs, count) < 0)
+		return -ENOENT;
+	__rte_pktmbuf_reset_bulk(pool, mbufs, count);
+	return 0;
+}
+
+/**
+ * Initialize shared data at the end of an external buffer before
+ * attaching it to a mbuf with rte_pktmbuf_attach_extbuf().
+ *
+ * The shared data is stored at the end of the buffer, which is shrunk
+ * accordingly; its reference counter is set to 1. It is not mandatory
+ * to use this helper: the shared data can be allocated anywhere by the
+ * application, as long as it outlives all the mbufs attached to the
+ * buffer.
+ *
+ * @param buf_addr
+ *   The pointer to the external buffer.
+ * @param [in,out] buf_len
+ *   The pointer to the length of the external buffer. Input value must
+ *   be larger than the size of ``struct rte_mbuf_ext_shared_info`` and
+ *   padding for alignment. If not enough, this function will return NULL.
+ *   Adjusted buffer length will be returned through this pointer.
+ * @param free_cb
+ *   Free callback function to call when the external buffer needs to be
+ *   freed.
+ * @param fcb_opaque
+ *   Argument for the free callback function.
+ * @return
+ *   A pointer to the initialized shared data on success, NULL otherwise.
+ */
+static inline struct rte_mbuf_ext_shared_info *
+rte_pktmbuf_ext_shinfo_init_helper(void *buf_addr, uint16_t *buf_len,
+	rte_mbuf_extbuf_free_callback_t free_cb, void *fcb_opaque)
+{
+	struct rte_mbuf_ext_shared_info *shinfo;
+	void *buf_end = RTE_PTR_ADD(buf_addr, *buf_len);
+	void *addr;
+
+	addr = RTE_PTR_ALIGN_FLOOR(RTE_PTR_SUB(buf_end, sizeof(*shinfo)),
+		sizeof(uintptr_t));
+	if (addr <= buf_addr)
+		return NULL;
+
+	shinfo = (struct rte_mbuf_ext_shared_info *)addr;
+	shinfo->free_cb = free_cb;
+	shinfo->fcb_opaque = fcb_opaque;
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+
+	*buf_len = (uint16_t)RTE_PTR_DIFF(shinfo, buf_addr);
+	return shinfo;
+}
+
+/**
+ * Attach an external buffer to a mbuf.
+ *
+ * The mbuf is then marked with EXT_ATTACHED_MBUF and its buffer address,
+ * physical address and length are the ones of the external buffer. Its
+ * own embedded buffer is left untouched and is restored when the
+ * external buffer is detached. The data offset is reset to have some
+ * headroom if the buffer allows, and the data length to 0.
+ *
+ * The reference counter of the shared data is not incremented: the
+ * reference given by the caller is transferred to the mbuf. It is
+ * incremented by rte_pktmbuf_attach() and rte_pktmbuf_clone() when the
+ * mbuf is cloned, and decremented when a mbuf attached to the buffer is
+ * detached or freed. When it reaches 0, the free callback of the shared
+ * data is invoked with the buffer address.
+ *
+ * The buffer must stay valid until then, and it must be accessible by
+ * the devices the mbuf is given to: for instance a hugepage-backed
+ * buffer whose physical address is known.
+ *
+ * Right now, attaching an external buffer to an indirect mbuf or to a
+ * mbuf which already has one is not supported.
+ *
+ * @param m
+ *   The pointer to the mbuf.
+ * @param buf_addr
+ *   The pointer to the external buffer.
+ * @param buf_physaddr
+ *   Physical address of the external buffer.
+ * @param buf_len
+ *   The size of the external buffer.
+ * @param shinfo
+ *   User-provided memory for shared data of the external buffer.
+ */
+static inline void
+rte_pktmbuf_attach_extbuf(struct rte_mbuf *m, void *buf_addr,
+	phys_addr_t buf_physaddr, uint16_t buf_len,
+	struct rte_mbuf_ext_shared_info *shinfo)
+{
+	RTE_MBUF_ASSERT(RTE_MBUF_DIRECT(m) &&
+	    rte_mbuf_refcnt_read(m) == 1);
+	RTE_MBUF_ASSERT(shinfo->free_cb != NULL);
+
+	m->buf_addr = buf_addr;
+	m->buf_physaddr = buf_physaddr;
+	m->buf_len = buf_len;
+
+	m->data_len = 0;
+	m->data_off = RTE_MIN(RTE_PKTMBUF_HEADROOM, buf_len);
+
+	m->ol_flags |= EXT_ATTACHED_MBUF;
+	m->shinfo = shinfo;
+}
+
+/**
+ * Detach the external buffer attached to a mbuf, same as
+ * ``rte_pktmbuf_detach()``.
+ *
+ * @param m
+ *   The mbuf having external buffer.
+ */
+#define rte_pktmbuf_detach_extbuf(m) rte_pktmbuf_detach(m)
+
 /**
  * Attach packet mbuf to another packet mbuf.
  *
- * After attachment we refer the mbuf we attached as 'indirect',
- * while mbuf we attached to as 'direct'.
+ * If the mbuf we are attaching to isn't a direct buffer and is attached
+ * to an external buffer, the mbuf being attached will be attached to
+ * the external buffer instead of mbuf indirection, and the reference
+ * counter of the external buffer is incremented.
+ *
+ * Otherwise, the mbuf will be indirectly attached. After attachment we
+ * refer the mbuf we attached as 'indirect', while mbuf we attached to as
+ * 'direct'. The direct mbuf's reference counter is incremented.
+ *
  * Right now, not supported:
  *  - attachment for already indirect mbuf (e.g. - mi has to be direct).
  *  - mbuf we trying to attach (mi) is used by someone else
@@ -1352,19 +1676,20 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
  */
 static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 {
-	struct rte_mbuf *md;
-
 	RTE_MBUF_ASSERT(RTE_MBUF_DIRECT(mi) &&
 	    rte_mbuf_refcnt_read(mi) == 1);
 
-	/* if m is not direct, get the mbuf that embeds the data */
-	if (RTE_MBUF_DIRECT(m))
-		md = m;
-	else
-		md = rte_mbuf_from_indirect(m);
+	if (RTE_MBUF_HAS_EXTBUF(m)) {
+		rte_mbuf_ext_refcnt_update(m->shinfo, 1);
+		mi->ol_flags = m->ol_flags;
+		mi->shinfo = m->shinfo;
+	} else {
+		/* reference the mbuf that embeds the data, m or its direct one */
+		rte_mbuf_refcnt_update(rte_mbuf_from_indirect(m), 1);
+		mi->priv_size = m->priv_size;
+		mi->ol_flags = m->ol_flags | IND_ATTACHED_MBUF;
+	}
 
-	rte_mbuf_refcnt_update(md, 1);
-	mi->priv_size = m->priv_size;
 	mi->buf_physaddr = m->buf_physaddr;
 	mi->buf_addr = m->buf_addr;
 	mi->buf_len = m->buf_len;
@@ -1377,11 +1702,16 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 	mi->vlan_tci_outer = m->vlan_tci_outer;
 	mi->tx_offload = m->tx_offload;
 	mi->hash = m->hash;
+	/* the dynamic flags are copied with ol_flags, copy their fields */
+	mi->dynfield0[0] = m->dynfield0[0];
+	mi->dynfield0[1] = m->dynfield0[1];
+	mi->dynfield0[2] = m->dynfield0[2];
+	mi->dynfield1 = m->dynfield1;
+	mi->timestamp = m->timestamp;
 
 	mi->next = NULL;
 	mi->pkt_len = mi->data_len;
 	mi->nb_segs = 1;
-	mi->ol_flags = m->ol_flags | IND_ATTACHED_MBUF;
 	mi->packet_type = m->packet_type;
 
 	__rte_mbuf_sanity_check(mi, 1);
@@ -1389,20 +1719,61 @@ static inline void rte_pktmbuf_attach(struct rte_mbuf *mi, struct rte_mbuf *m)
 }
 
 /**
- * Detach an indirect packet mbuf.
+ * @internal Drop the reference of a mbuf to its external buffer, and
+ * free the buffer if it was the last one.
+ */
+static inline void
+__rte_pktmbuf_free_extbuf(struct rte_mbuf *m)
+{
+	RTE_MBUF_ASSERT(RTE_MBUF_HAS_EXTBUF(m));
+	RTE_MBUF_ASSERT(m->shinfo != NULL);
+
+	if (rte_mbuf_ext_refcnt_update(m->shinfo, -1) == 0)
+		m->shinfo->free_cb(m->buf_addr, m->shinfo->fcb_opaque);
+}
+
+/**
+ * @internal Drop the reference of an indirect mbuf to the direct mbuf
+ * holding its data, and free the direct mbuf if it was the last one.
+ */
+static inline void
+__rte_pktmbuf_free_direct(struct rte_mbuf *m)
+{
+	struct rte_mbuf *md;
+
+	RTE_MBUF_ASSERT(RTE_MBUF_INDIRECT(m));
+
+	md = rte_mbuf_from_indirect(m);
+	if (rte_mbuf_refcnt_update(md, -1) == 0) {
+		md->next = NULL;
+		md->nb_segs = 1;
+		__rte_mbuf_raw_free(md);
+	}
+}
+
+/**
+ * Detach a packet mbuf from external buffer or direct buffer.
  *
+ *  - decrement refcnt and free the external/direct buffer if refcnt
+ *    becomes zero.
  *  - restore original mbuf address and length values.
  *  - reset pktmbuf data and data_len to their default values.
  *  All other fields of the given packet mbuf will be left intact.
  *
  * @param m
- *   The indirect attached packet mbuf.
+ *   The indirect attached packet mbuf, or the mbuf having an external
+ *   buffer attached.
  */
 static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 {
 	struct rte_mempool *mp = m->pool;
 	uint32_t mbuf_size, buf_len, priv_size;
 
+	if (RTE_MBUF_HAS_EXTBUF(m))
+		__rte_pktmbuf_free_extbuf(m);
+	else
+		__rte_pktmbuf_free_direct(m);
+
 	priv_size = rte_pktmbuf_priv_size(mp);
 	mbuf_size = sizeof(struct rte_mbuf) + priv_size;
 	buf_len = rte_pktmbuf_data_room_size(mp);
@@ -1423,16 +1794,12 @@ __rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 
 	if (likely(rte_mbuf_refcnt_update(m, -1) == 0)) {
 
-		/* if this is an indirect mbuf, then
+		/* if this is an indirect mbuf or has an external buffer,
 		 *  - detach mbuf
-		 *  - free attached mbuf segment
+		 *  - free attached mbuf segment or external buffer
 		 */
-		if (RTE_MBUF_INDIRECT(m)) {
-			struct rte_mbuf *md = rte_mbuf_from_indirect(m);
+		if (!RTE_MBUF_DIRECT(m))
 			rte_pktmbuf_detach(m);
-			if (rte_mbuf_refcnt_update(md, -1) == 0)
-				__rte_mbuf_raw_free(md);
-		}
 		return m;
 	}
 	return NULL;
@@ -1478,6 +1845,21 @@ static inline void rte_pktmbuf_free(struct rte_mbuf *m)
 	}
 }
 
+/**
+ * Free an array of packet mbufs back into their original mempools.
+ *
+ * Free each mbuf of the array, and all its segments in case of chained
+ * buffers, as rte_pktmbuf_free() would do. The segments released back
+ * to the same mempool are grouped and returned with a single bulk put,
+ * so the cost is amortized when most of them come from the same pool.
+ *
+ * @param mbufs
+ *   Array of packet mbufs to be freed. NULL entries are ignored.
+ * @param count
+ *   Number of entries in the array.
+ */
+void rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned count);
+
 /**
  * Creates a "clone" of the given packet mbuf.
  *
@@ -1842,6 +2224,51 @@ static inline int rte_pktmbuf_chain(struct rte_mbuf *head, struct rte_mbuf *tail
 	return 0;
 }
 
+/**
+ * Gather the data of a multi-segment packet in a single segment.
+ *
+ * When the first segment has a private data buffer with enough tailroom,
+ * the data of the next segments is copied at its end and these segments
+ * are freed: the packet is linearized in place and m is returned.
+ * Otherwise, the packet is copied in a new mbuf allocated from mp, with
+ * its metadata, and m is freed. A packet with a single segment is
+ * returned as is.
+ *
+ * The data is copied with rte_memcpy(), which uses the widest vector
+ * instructions available.
+ *
+ * @param m
+ *   The packet mbuf to linearize.
+ * @param mp
+ *   The mempool from which the new mbuf is allocated if the packet cannot
+ *   be linearized in place. If NULL, the pool of m is used.
+ * @return
+ *   - The linearized packet, m or a new mbuf.
+ *   - NULL on error, with rte_errno set and m left unchanged:
+ *     - ENOMEM: No mbuf available in mp.
+ *     - ENOSPC: The packet does not fit in a mbuf of mp.
+ */
+struct rte_mbuf *rte_pktmbuf_linearize(struct rte_mbuf *m,
+	struct rte_mempool *mp);
+
+/**
+ * Merge the small segments of a packet into the previous ones.
+ *
+ * Each segment whose data length is at most max_len is copied in the
+ * tailroom of the previous segment, if the data buffer of this segment is
+ * not shared and has enough room, and is then freed. Empty segments are
+ * always removed. The data of the packet is unchanged, the first segment
+ * is kept, so m remains the head of the packet.
+ *
+ * @param m
+ *   The packet mbuf to coalesce.
+ * @param max_len
+ *   The maximum data length of the segments to merge.
+ * @return
+ *   The number of segments of the packet after coalescing.
+ */
+int rte_pktmbuf_coalesce(struct rte_mbuf *m, uint16_t max_len);
+
 /**
  * Dump an mbuf structure to the console.
  *
@@ -0,0 +1,355 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_log.h>
+#include <rte_memzone.h>
+#include <rte_rwlock.h>
+#include <rte_mbuf.h>
+
+#include "rte_mbuf_dyn.h"
+
+#define RTE_MBUF_DYN_MZNAME "RTE_MBUF_DYN"
+
+/*
+ * The ol_flags bits used by the static flags of rte_mbuf.h: the RX flags
+ * up to PKT_RX_TIMESTAMP, and the TX flags from PKT_TX_QINQ_PKT up to the
+ * generic mbuf flags. The bits in between are given to dynamic flags.
+ */
+#define MBUF_STATIC_FLAGS \
+	(((PKT_RX_TIMESTAMP << 1) - 1) | ~(PKT_TX_QINQ_PKT - 1))
+
+#define MBUF_DYNFLAG_MAX 64
+
+struct mbuf_dynfield_elt {
+	struct rte_mbuf_dynfield params;
+	size_t offset;
+};
+
+struct mbuf_dynflag_elt {
+	struct rte_mbuf_dynflag params;
+	unsigned bitnum;
+};
+
+/** Content of the dynamic mbuf memzone, shared by all processes. */
+struct mbuf_dyn_shm {
+	/** Non-zero for the bytes of the mbuf free for dynamic fields. */
+	uint8_t free_space[sizeof(struct rte_mbuf)];
+	uint64_t free_flags; /**< Bits of ol_flags free for dynamic flags. */
+	unsigned nb_fields;  /**< Number of registered fields. */
+	unsigned nb_flags;   /**< Number of registered flags. */
+	struct mbuf_dynfield_elt fields[RTE_MBUF_DYNFIELD_MAX];
+	struct mbuf_dynflag_elt flags[MBUF_DYNFLAG_MAX];
+};
+
+static struct mbuf_dyn_shm *shm;
+
+/*
+ * Attach to the registry of the primary process, creating it if it does
+ * not exist yet and create is set. Called with the tailq lock held.
+ */
+static int
+mbuf_dyn_shm_init(int create)
+{
+	const struct rte_memzone *mz;
+	struct mbuf_dyn_shm *s;
+
+	if (shm != NULL)
+		return 0;
+
+	mz = rte_memzone_lookup(RTE_MBUF_DYN_MZNAME);
+	if (mz == NULL) {
+		if (!create)
+			return -ENOENT;
+		mz = rte_memzone_reserve(RTE_MBUF_DYN_MZNAME,
+			sizeof(struct mbuf_dyn_shm), SOCKET_ID_ANY, 0);
+		if (mz == NULL) {
+			RTE_LOG(ERR, MBUF,
+				"Cannot reserve dynamic mbuf memzone\n");
+			return -ENOMEM;
+		}
+		s = mz->addr;
+		memset(s, 0, sizeof(*s));
+		memset(&s->free_space[offsetof(struct rte_mbuf, dynfield0)], 1,
+			sizeof(((struct rte_mbuf *)0)->dynfield0));
+		memset(&s->free_space[offsetof(struct rte_mbuf, dynfield1)], 1,
+			sizeof(((struct rte_mbuf *)0)->dynfield1));
+		s->free_flags = ~MBUF_STATIC_FLAGS;
+	}
+
+	shm = mz->addr;
+	return 0;
+}
+
+static int
+mbuf_dyn_check_name(const char *name)
+{
+	size_t len = strnlen(name, RTE_MBUF_DYN_NAMESIZE);
+
+	return (len == 0 || len == RTE_MBUF_DYN_NAMESIZE) ? -EINVAL : 0;
+}
+
+static struct mbuf_dynfield_elt *
+mbuf_dynfield_find(const char *name)
+{
+	unsigned i;
+
+	for (i = 0; i < shm->nb_fields; i++) {
+		if (strcmp(shm->fields[i].params.name, name) == 0)
+			return &shm->fields[i];
+	}
+	return NULL;
+}
+
+static struct mbuf_dynflag_elt *
+mbuf_dynflag_find(const char *name)
+{
+	unsigned i;
+
+	for (i = 0; i < shm->nb_flags; i++) {
+		if (strcmp(shm->flags[i].params.name, name) == 0)
+			return &shm->flags[i];
+	}
+	return NULL;
+}
+
+/* return the first offset aligned as requested with enough free bytes */
+static int
+mbuf_dynfield_find_space(size_t size, size_t align)
+{
+	size_t off, i;
+
+	for (off = 0; off + size <= sizeof(struct rte_mbuf); off += align) {
+		for (i = 0; i < size; i++) {
+			if (shm->free_space[off + i] == 0)
+				break;
+		}
+		if (i == size)
+			return (int)off;
+	}
+	return -ENOSPC;
+}
+
+int
+rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params)
+{
+	struct mbuf_dynfield_elt *elt;
+	int ret;
+
+	if (params == NULL || mbuf_dyn_check_name(params->name) < 0 ||
+			params->size == 0 ||
+			params->size > sizeof(struct rte_mbuf) ||
+			params->align == 0 ||
+			params->align > sizeof(struct rte_mbuf) ||
+			!rte_is_power_of_2(params->align) ||
+			params->flags != 0)
+		return -EINVAL;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	ret = mbuf_dyn_shm_init(1);
+	if (ret < 0)
+		goto out;
+
+	/* the same field registered again keeps its offset */
+	elt = mbuf_dynfield_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.size != params->size ||
+				elt->params.align != params->align ||
+				elt->params.flags != params->flags) {
+			RTE_LOG(ERR, MBUF, "Dynamic mbuf field %s is "
+				"already registered with other parameters\n",
+				params->name);
+			ret = -EEXIST;
+		} else
+			ret = (int)elt->offset;
+		goto out;
+	}
+
+	if (shm->nb_fields == RTE_MBUF_DYNFIELD_MAX)
+		ret = -ENOSPC;
+	else
+		ret = mbuf_dynfield_find_space(params->size, params->align);
+	if (ret < 0) {
+		RTE_LOG(ERR, MBUF, "No space left in mbuf for dynamic "
+			"field %s (size %zu, align %zu)\n",
+			params->name, params->size, params->align);
+		goto out;
+	}
+
+	memset(&shm->free_space[ret], 0, params->size);
+	elt = &shm->fields[shm->nb_fields];
+	elt->params = *params;
+	elt->offset = ret;
+	shm->nb_fields++;
+
+	RTE_LOG(DEBUG, MBUF, "Registered dynamic mbuf field %s at offset %d\n",
+		params->name, ret);
+out:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return ret;
+}
+
+int
+rte_mbuf_dynfield_lookup(const char *name, struct rte_mbuf_dynfield *params)
+{
+	struct mbuf_dynfield_elt *elt = NULL;
+	int ret;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (mbuf_dyn_shm_init(0) == 0)
+		elt = mbuf_dynfield_find(name);
+	if (elt == NULL) {
+		ret = -ENOENT;
+	} else {
+		if (params != NULL)
+			*params = elt->params;
+		ret = (int)elt->offset;
+	}
+
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return ret;
+}
+
+int
+rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params)
+{
+	struct mbuf_dynflag_elt *elt;
+	int ret;
+
+	if (params == NULL || mbuf_dyn_check_name(params->name) < 0 ||
+			params->flags != 0)
+		return -EINVAL;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	ret = mbuf_dyn_shm_init(1);
+	if (ret < 0)
+		goto out;
+
+	/* the same flag registered again keeps its bit */
+	elt = mbuf_dynflag_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.flags != params->flags) {
+			RTE_LOG(ERR, MBUF, "Dynamic mbuf flag %s is "
+				"already registered with other parameters\n",
+				params->name);
+			ret = -EEXIST;
+		} else
+			ret = (int)elt->bitnum;
+		goto out;
+	}
+
+	if (shm->free_flags == 0) {
+		RTE_LOG(ERR, MBUF, "No bit left in mbuf ol_flags for "
+			"dynamic flag %s\n", params->name);
+		ret = -ENOSPC;
+		goto out;
+	}
+
+	ret = __builtin_ctzll(shm->free_flags);
+	shm->free_flags &= ~(1ULL << ret);
+	elt = &shm->flags[shm->nb_flags];
+	elt->params = *params;
+	elt->bitnum = ret;
+	shm->nb_flags++;
+
+	RTE_LOG(DEBUG, MBUF, "Registered dynamic mbuf flag %s at bit %d\n",
+		params->name, ret);
+out:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return ret;
+}
+
+int
+rte_mbuf_dynflag_lookup(const char *name, struct rte_mbuf_dynflag *params)
+{
+	struct mbuf_dynflag_elt *elt = NULL;
+	int ret;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (mbuf_dyn_shm_init(0) == 0)
+		elt = mbuf_dynflag_find(name);
+	if (elt == NULL) {
+		ret = -ENOENT;
+	} else {
+		if (params != NULL)
+			*params = elt->params;
+		ret = (int)elt->bitnum;
+	}
+
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return ret;
+}
+
+void
+rte_mbuf_dyn_dump(FILE *f)
+{
+	unsigned i, nb_free = 0;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (mbuf_dyn_shm_init(0) < 0) {
+		fprintf(f, "no dynamic mbuf field or flag registered\n");
+		goto out;
+	}
+
+	fprintf(f, "dynamic mbuf fields:\n");
+	for (i = 0; i < shm->nb_fields; i++)
+		fprintf(f, "  %s: offset=%zu size=%zu align=%zu\n",
+			shm->fields[i].params.name, shm->fields[i].offset,
+			shm->fields[i].params.size,
+			shm->fields[i].params.align);
+	for (i = 0; i < sizeof(shm->free_space); i++)
+		nb_free += (shm->free_space[i] != 0);
+	fprintf(f, "  free_bytes=%u\n", nb_free);
+
+	fprintf(f, "dynamic mbuf flags:\n");
+	for (i = 0; i < shm->nb_flags; i++)
+		fprintf(f, "  %s: bit=%u\n", shm->flags[i].params.name,
+			shm->flags[i].bitnum);
+	fprintf(f, "  free_flags=0x%"PRIx64"\n", shm->free_flags);
+out:
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+}
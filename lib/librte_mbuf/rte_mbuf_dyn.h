@@ -0,0 +1,191 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MBUF_DYN_H_
+#define _RTE_MBUF_DYN_H_
+
+/**
+ * @file
+ * RTE Mbuf dynamic fields and flags
+ *
+ * Many libraries and applications need to store per-packet metadata in
+ * the mbuf. Instead of sharing a few generic fields like udata64 or hash,
+ * they can register named fields and flags at init time:
+ *
+ * - A dynamic field is placed in the bytes of struct rte_mbuf reserved
+ *   for this purpose (dynfield0 and dynfield1). Registering it returns
+ *   its offset in the mbuf, to be saved in a global variable and used
+ *   with RTE_MBUF_DYNFIELD() in the data path.
+ *
+ * - A dynamic flag is placed in a bit of ol_flags that is not used by
+ *   the static flags of rte_mbuf.h. Registering it returns its bit
+ *   number.
+ *
+ * The registrations are shared by all processes, and registering again a
+ * name with the same parameters returns the same offset or bit, so that
+ * several users can share a field or a flag. Registering a name with
+ * different parameters fails with -EEXIST, and registering more than the
+ * reserved space with -ENOSPC: these conflicts are reported when the
+ * libraries and applications are initialized, instead of corrupting data
+ * at run time.
+ *
+ * The content of the dynamic fields and flags is not reset when a mbuf
+ * is allocated: it is up to their users to initialize them.
+ *
+ * These functions are not designed for the data path: they take a lock
+ * shared by all processes.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of the name of a dynamic field or flag, with the '\0'. */
+#define RTE_MBUF_DYN_NAMESIZE 64
+
+/** Maximum number of dynamic fields. */
+#define RTE_MBUF_DYNFIELD_MAX 16
+
+/**
+ * Parameters of a dynamic field.
+ */
+struct rte_mbuf_dynfield {
+	char name[RTE_MBUF_DYN_NAMESIZE]; /**< Name of the field. */
+	size_t size;        /**< Size of the field, in bytes. */
+	size_t align;       /**< Alignment of the field, a power of 2. */
+	unsigned int flags; /**< Reserved for future use, must be 0. */
+};
+
+/**
+ * Parameters of a dynamic flag.
+ */
+struct rte_mbuf_dynflag {
+	char name[RTE_MBUF_DYN_NAMESIZE]; /**< Name of the flag. */
+	unsigned int flags; /**< Reserved for future use, must be 0. */
+};
+
+/**
+ * Register a dynamic field in the mbuf structure.
+ *
+ * The field is placed at the first offset aligned as requested where
+ * enough bytes are free. If a field with the same name is already
+ * registered with the same parameters, its offset is returned.
+ *
+ * @param params
+ *   The parameters of the field.
+ * @return
+ *   - The offset of the field in the mbuf structure on success.
+ *   - -EINVAL: Invalid parameters (name, size, alignment or flags).
+ *   - -EEXIST: A field with the same name and different parameters is
+ *     already registered.
+ *   - -ENOSPC: Not enough space left in the mbuf structure.
+ *   - -ENOMEM: Cannot allocate the shared registry.
+ */
+int rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params);
+
+/**
+ * Look up a registered dynamic field.
+ *
+ * @param name
+ *   The name of the field.
+ * @param params
+ *   If not NULL, filled with the parameters of the field.
+ * @return
+ *   - The offset of the field in the mbuf structure on success.
+ *   - -ENOENT: No field with this name is registered.
+ */
+int rte_mbuf_dynfield_lookup(const char *name,
+	struct rte_mbuf_dynfield *params);
+
+/**
+ * Register a dynamic flag in the ol_flags field of the mbuf structure.
+ *
+ * If a flag with the same name is already registered with the same
+ * parameters, its bit number is returned.
+ *
+ * @param params
+ *   The parameters of the flag.
+ * @return
+ *   - The bit number of the flag on success: the flag mask is
+ *     (1ULL << bit number).
+ *   - -EINVAL: Invalid parameters (name or flags).
+ *   - -EEXIST: A flag with the same name and different parameters is
+ *     already registered.
+ *   - -ENOSPC: No free bit left in ol_flags.
+ *   - -ENOMEM: Cannot allocate the shared registry.
+ */
+int rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params);
+
+/**
+ * Look up a registered dynamic flag.
+ *
+ * @param name
+ *   The name of the flag.
+ * @param params
+ *   If not NULL, filled with the parameters of the flag.
+ * @return
+ *   - The bit number of the flag on success.
+ *   - -ENOENT: No flag with this name is registered.
+ */
+int rte_mbuf_dynflag_lookup(const char *name,
+	struct rte_mbuf_dynflag *params);
+
+/**
+ * Dump the registered dynamic fields and flags, and the free space.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ */
+void rte_mbuf_dyn_dump(FILE *f);
+
+/**
+ * Get a pointer to a dynamic field of a mbuf.
+ *
+ * @param m
+ *   The pointer to the mbuf.
+ * @param offset
+ *   The offset of the field, as returned by rte_mbuf_dynfield_register().
+ * @param type
+ *   The type of the pointer to return.
+ */
+#define RTE_MBUF_DYNFIELD(m, offset, type) \
+	((type)((uintptr_t)(m) + (offset)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MBUF_DYN_H_ */
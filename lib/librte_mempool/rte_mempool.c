@@ -67,9 +67,60 @@ static struct rte_tailq_elem rte_mempool_tailq = {
 };
 EAL_REGISTER_TAILQ(rte_mempool_tailq)
 
-#define CACHE_FLUSHTHRESH_MULTIPLIER 1.5
-#define CALC_CACHE_FLUSHTHRESH(c)	\
-	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
+#define CALC_CACHE_FLUSHTHRESH(c) RTE_MEMPOOL_CALC_CACHE_FLUSHTHRESH(c)
+
+/* caches attached to mempools by the calling non-EAL thread */
+RTE_DEFINE_PER_LCORE(struct rte_mempool_thread_cache,
+		     mempool_thread_cache[RTE_MEMPOOL_THREAD_CACHE_MAX]);
+
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+/* init a cache of the given size */
+static void
+mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
+{
+	cache->size = size;
+	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
+	cache->len = 0;
+	cache->max_size = size;
+	cache->calls = 0;
+}
+#endif
+
+/*
+ * return the number of entries of the per-lcore arrays of a mempool:
+ * caches and statistics are indexed by lcore id, up to the highest
+ * lcore used by the creating process, including service lcores.
+ */
+static unsigned
+mempool_nb_lcores(void)
+{
+	unsigned lcore_id, nb_lcores = 0;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		if (rte_eal_lcore_role(lcore_id) != ROLE_OFF)
+			nb_lcores = lcore_id + 1;
+
+	return nb_lcores;
+}
+
+/* return the size of the per-lcore arrays of a mempool */
+static size_t
+mempool_lcore_size(unsigned cache_size, unsigned nb_lcores)
+{
+	size_t size = 0;
+
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	if (cache_size != 0)
+		size += sizeof(struct rte_mempool_cache) * nb_lcores;
+#else
+	RTE_SET_USED(cache_size);
+#endif
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
+	size += sizeof(struct rte_mempool_debug_stats) * nb_lcores;
+#endif
+
+	return size;
+}
 
 /*
  * return the greatest common divisor between a and b (fast algorithm)
@@ -148,8 +199,8 @@ mempool_add_elem(struct rte_mempool *mp, void *obj, uint32_t obj_idx,
 	if (obj_init)
 		obj_init(mp, obj_init_arg, obj, obj_idx);
 
-	/* enqueue in ring */
-	rte_ring_sp_enqueue(mp->ring, obj);
+	/* enqueue in the pool handler */
+	rte_mempool_ops_enqueue_bulk(mp, &obj, 1);
 }
 
 uint32_t
@@ -375,6 +426,15 @@ rte_mempool_xmem_usage(void *vaddr, uint32_t elt_num, size_t elt_sz,
 	return usz;
 }
 
+static struct rte_mempool *
+mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, void *vaddr,
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift,
+		int ops_index);
+
 #ifndef RTE_LIBRTE_XEN_DOM0
 /* stub if DOM0 support not configured */
 struct rte_mempool *
@@ -419,6 +479,37 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 					       MEMPOOL_PG_SHIFT_MAX);
 }
 
+/* create the mempool with a given pool handler */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name)
+{
+	int ops_index;
+
+	/* objects in dom0 memory are always stored in a ring */
+	if (rte_xen_dom0_supported()) {
+		rte_errno = ENOTSUP;
+		return NULL;
+	}
+
+	ops_index = rte_mempool_ops_lookup(ops_name);
+	if (ops_index < 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	return mempool_xmem_create(name, n, elt_size,
+				   cache_size, private_data_size,
+				   mp_init, mp_init_arg,
+				   obj_init, obj_init_arg,
+				   socket_id, flags,
+				   NULL, NULL, MEMPOOL_PG_NUM_DEFAULT,
+				   MEMPOOL_PG_SHIFT_MAX, ops_index);
+}
+
 /*
  * Create the mempool over already allocated chunk of memory.
  * That external memory buffer can consists of physically disjoint pages.
@@ -433,17 +524,51 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		int socket_id, unsigned flags, void *vaddr,
 		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+{
+	const char *ops_name;
+	int ops_index;
+
+	/* the default pool handler is a ring matching the sp/sc flags */
+	if ((flags & MEMPOOL_F_SP_PUT) && (flags & MEMPOOL_F_SC_GET))
+		ops_name = "ring_sp_sc";
+	else if (flags & MEMPOOL_F_SP_PUT)
+		ops_name = "ring_sp_mc";
+	else if (flags & MEMPOOL_F_SC_GET)
+		ops_name = "ring_mp_sc";
+	else
+		ops_name = "ring_mp_mc";
+
+	ops_index = rte_mempool_ops_lookup(ops_name);
+	if (ops_index < 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	return mempool_xmem_create(name, n, elt_size,
+				   cache_size, private_data_size,
+				   mp_init, mp_init_arg,
+				   obj_init, obj_init_arg,
+				   socket_id, flags,
+				   vaddr, paddr, pg_num, pg_shift, ops_index);
+}
+
+static struct rte_mempool *
+mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, void *vaddr,
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift,
+		int ops_index)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
-	char rg_name[RTE_RING_NAMESIZE];
 	struct rte_mempool_list *mempool_list;
 	struct rte_mempool *mp = NULL;
 	struct rte_tailq_entry *te = NULL;
-	struct rte_ring *r = NULL;
-	const struct rte_memzone *mz;
-	size_t mempool_size;
+	const struct rte_memzone *mz = NULL;
+	size_t mempool_size, lcore_size;
+	unsigned nb_lcores;
 	int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
-	int rg_flags = 0;
 	void *obj;
 	struct rte_mempool_objsz objsz;
 	void *startaddr;
@@ -455,14 +580,10 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool_cache) &
 			  RTE_CACHE_LINE_MASK) != 0);
-	RTE_BUILD_BUG_ON((offsetof(struct rte_mempool, local_cache) &
-			  RTE_CACHE_LINE_MASK) != 0);
 #endif
-#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool_debug_stats) &
 			  RTE_CACHE_LINE_MASK) != 0);
-	RTE_BUILD_BUG_ON((offsetof(struct rte_mempool, stats) &
-			  RTE_CACHE_LINE_MASK) != 0);
 #endif
 
 	mempool_list = RTE_TAILQ_CAST(rte_mempool_tailq.head, rte_mempool_list);
@@ -490,12 +611,6 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	if (flags & MEMPOOL_F_NO_CACHE_ALIGN)
 		flags |= MEMPOOL_F_NO_SPREAD;
 
-	/* ring flags */
-	if (flags & MEMPOOL_F_SP_PUT)
-		rg_flags |= RING_F_SP_ENQ;
-	if (flags & MEMPOOL_F_SC_GET)
-		rg_flags |= RING_F_SC_DEQ;
-
 	/* calculate mempool object sizes. */
 	if (!rte_mempool_calc_obj_size(elt_size, flags, &objsz)) {
 		rte_errno = EINVAL;
@@ -504,15 +619,6 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
 
-	/* allocate the ring that will be used to store objects */
-	/* Ring functions will return appropriate errors if we are
-	 * running as a secondary process etc., so no checks made
-	 * in this function for that condition */
-	snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT, name);
-	r = rte_ring_create(rg_name, rte_align32pow2(n+1), socket_id, rg_flags);
-	if (r == NULL)
-		goto exit_unlock;
-
 	/*
 	 * reserve a memory zone for this mempool: private data is
 	 * cache-aligned
@@ -520,12 +626,16 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	private_data_size = (private_data_size +
 			     RTE_MEMPOOL_ALIGN_MASK) & (~RTE_MEMPOOL_ALIGN_MASK);
 
+	/* per-lcore arrays, stored after the private data */
+	nb_lcores = mempool_nb_lcores();
+	lcore_size = mempool_lcore_size(cache_size, nb_lcores);
+
 	if (! rte_eal_has_hugepages()) {
 		/*
 		 * expand private data size to a whole page, so that the
 		 * first pool element will start on a new standard page
 		 */
-		int head = sizeof(struct rte_mempool);
+		int head = sizeof(struct rte_mempool) + lcore_size;
 		int new_size = (private_data_size + head) % page_size;
 		if (new_size) {
 			private_data_size += page_size - new_size;
@@ -546,6 +656,7 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	 */
 	mempool_size = MEMPOOL_HEADER_SIZE(mp, pg_num) + private_data_size;
 	mempool_size = RTE_ALIGN_CEIL(mempool_size, RTE_MEMPOOL_ALIGN);
+	mempool_size += lcore_size;
 	if (vaddr == NULL)
 		mempool_size += (size_t)objsz.total_size * n;
 
@@ -581,21 +692,42 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	memset(mp, 0, sizeof(*mp));
 	snprintf(mp->name, sizeof(mp->name), "%s", name);
 	mp->phys_addr = mz->phys_addr;
-	mp->ring = r;
 	mp->size = n;
 	mp->flags = flags;
+	mp->socket_id = socket_id;
+	mp->ops_index = ops_index;
 	mp->elt_size = objsz.elt_size;
 	mp->header_size = objsz.header_size;
 	mp->trailer_size = objsz.trailer_size;
 	mp->cache_size = cache_size;
 	mp->cache_flushthresh = CALC_CACHE_FLUSHTHRESH(cache_size);
 	mp->private_data_size = private_data_size;
+	mp->nb_lcores = nb_lcores;
 
-	/* calculate address of the first element for continuous mempool. */
+	/* the per-lcore arrays follow the private data */
 	obj = (char *)mp + MEMPOOL_HEADER_SIZE(mp, pg_num) +
 		private_data_size;
 	obj = RTE_PTR_ALIGN_CEIL(obj, RTE_MEMPOOL_ALIGN);
 
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	/* init the per-lcore caches */
+	if (cache_size != 0) {
+		unsigned lcore_id;
+
+		mp->local_cache = obj;
+		for (lcore_id = 0; lcore_id < nb_lcores; lcore_id++)
+			mempool_cache_init(&mp->local_cache[lcore_id],
+					   cache_size);
+		obj = &mp->local_cache[nb_lcores];
+	}
+#endif
+
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
+	mp->stats = obj;
+	memset(mp->stats, 0, sizeof(*mp->stats) * nb_lcores);
+	obj = &mp->stats[nb_lcores];
+#endif
+
 	/* populate address translation fields. */
 	mp->pg_num = pg_num;
 	mp->pg_shift = pg_shift;
@@ -615,6 +747,14 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	mp->elt_va_end = mp->elt_va_start;
 
+	/*
+	 * allocate the pool that will be used to store objects; the pool
+	 * handlers return appropriate errors if we are running as a
+	 * secondary process etc., so no checks made here for that condition
+	 */
+	if (rte_mempool_ops_alloc(mp) < 0)
+		goto exit_unlock;
+
 	/* call the initializer */
 	if (mp_init)
 		mp_init(mp, mp_init_arg);
@@ -632,19 +772,124 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 exit_unlock:
 	rte_rwlock_write_unlock(RTE_EAL_MEMPOOL_RWLOCK);
-	rte_ring_free(r);
+	rte_memzone_free(mz);
 	rte_free(te);
 
 	return NULL;
 }
 
+/* create a user-owned mempool cache */
+struct rte_mempool_cache *
+rte_mempool_cache_create(uint32_t size, int socket_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	struct rte_mempool_cache *cache;
+
+	if (size == 0 || size > RTE_MEMPOOL_CACHE_MAX_SIZE) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	cache = rte_zmalloc_socket("MEMPOOL_CACHE", sizeof(*cache),
+				   RTE_CACHE_LINE_SIZE, socket_id);
+	if (cache == NULL) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate mempool cache!\n");
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	mempool_cache_init(cache, size);
+
+	return cache;
+#else
+	RTE_SET_USED(size);
+	RTE_SET_USED(socket_id);
+	rte_errno = EINVAL;
+	return NULL;
+#endif
+}
+
+/* free a user-owned mempool cache */
+void
+rte_mempool_cache_free(struct rte_mempool_cache *cache)
+{
+	rte_free(cache);
+}
+
+/* put all the objects of a user-owned cache back in the mempool */
+void
+rte_mempool_cache_flush(struct rte_mempool_cache *cache,
+			struct rte_mempool *mp)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	if (cache == NULL || cache->len == 0)
+		return;
+
+	rte_mempool_ops_enqueue_bulk(mp, cache->objs, cache->len);
+	cache->len = 0;
+#else
+	RTE_SET_USED(cache);
+	RTE_SET_USED(mp);
+#endif
+}
+
+/* use a user-owned cache for the gets and puts of the calling thread */
+int
+rte_mempool_cache_attach(struct rte_mempool *mp,
+			 struct rte_mempool_cache *cache)
+{
+	struct rte_mempool_thread_cache *tc;
+	unsigned i;
+
+	if (rte_lcore_id() < RTE_MAX_LCORE)
+		return -EINVAL;
+
+	tc = RTE_PER_LCORE(mempool_thread_cache);
+	for (i = 0; i < RTE_MEMPOOL_THREAD_CACHE_MAX; i++) {
+		if (tc[i].mp == mp)
+			return -EEXIST;
+	}
+
+	for (i = 0; i < RTE_MEMPOOL_THREAD_CACHE_MAX; i++) {
+		if (tc[i].mp == NULL) {
+			tc[i].cache = cache;
+			tc[i].mp = mp;
+			return 0;
+		}
+	}
+
+	return -ENOSPC;
+}
+
+/* stop using the cache attached to a mempool by the calling thread */
+struct rte_mempool_cache *
+rte_mempool_cache_detach(struct rte_mempool *mp)
+{
+	struct rte_mempool_thread_cache *tc;
+	struct rte_mempool_cache *cache;
+	unsigned i;
+
+	tc = RTE_PER_LCORE(mempool_thread_cache);
+	for (i = 0; i < RTE_MEMPOOL_THREAD_CACHE_MAX; i++) {
+		if (tc[i].mp == mp) {
+			cache = tc[i].cache;
+			tc[i].mp = NULL;
+			tc[i].cache = NULL;
+			rte_mempool_cache_flush(cache, mp);
+			return cache;
+		}
+	}
+
+	return NULL;
+}
+
 /* Return the number of entries in the mempool */
 unsigned
 rte_mempool_count(const struct rte_mempool *mp)
 {
 	unsigned count;
 
-	count = rte_ring_count(mp->ring);
+	count = rte_mempool_ops_get_count(mp);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	{
@@ -652,7 +897,7 @@ rte_mempool_count(const struct rte_mempool *mp)
 		if (mp->cache_size == 0)
 			return count;
 
-		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		for (lcore_id = 0; lcore_id < mp->nb_lcores; lcore_id++)
 			count += mp->local_cache[lcore_id].len;
 	}
 #endif
@@ -677,9 +922,15 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 
 	fprintf(f, "  cache infos:\n");
 	fprintf(f, "    cache_size=%"PRIu32"\n", mp->cache_size);
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+	if (mp->cache_size == 0)
+		return 0;
+
+	for (lcore_id = 0; lcore_id < mp->nb_lcores; lcore_id++) {
 		cache_count = mp->local_cache[lcore_id].len;
 		fprintf(f, "    cache_count[%u]=%u\n", lcore_id, cache_count);
+		if (mp->flags & MEMPOOL_F_CACHE_ADAPTIVE)
+			fprintf(f, "    cache_size[%u]=%"PRIu32"\n", lcore_id,
+				mp->local_cache[lcore_id].size);
 		count += cache_count;
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
@@ -760,8 +1011,16 @@ mempool_audit_cache(const struct rte_mempool *mp)
 {
 	/* check cache size consistency */
 	unsigned lcore_id;
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		if (mp->local_cache[lcore_id].len > mp->cache_flushthresh) {
+
+	if (mp->cache_size == 0)
+		return;
+
+	for (lcore_id = 0; lcore_id < mp->nb_lcores; lcore_id++) {
+		const struct rte_mempool_cache *cache =
+			&mp->local_cache[lcore_id];
+
+		/* an adaptive cache may be above its current threshold */
+		if (cache->len > CALC_CACHE_FLUSHTHRESH(cache->max_size)) {
 			RTE_LOG(CRIT, MEMPOOL, "badness on cache[%u]\n",
 				lcore_id);
 			rte_panic("MEMPOOL: invalid cache len\n");
@@ -784,13 +1043,65 @@ rte_mempool_audit(const struct rte_mempool *mp)
 	RTE_SET_USED(mp);
 }
 
+/* get the statistics of a mempool, or their sum for all lcores */
+int
+rte_mempool_stats_get(const struct rte_mempool *mp, unsigned lcore_id,
+	struct rte_mempool_debug_stats *stats)
+{
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
+	const struct rte_mempool_debug_stats *s;
+	unsigned i;
+
+	if (mp == NULL || stats == NULL)
+		return -EINVAL;
+
+	if (lcore_id != LCORE_ID_ANY) {
+		if (lcore_id >= mp->nb_lcores)
+			return -EINVAL;
+		*stats = mp->stats[lcore_id];
+		return 0;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < mp->nb_lcores; i++) {
+		s = &mp->stats[i];
+		stats->put_bulk += s->put_bulk;
+		stats->put_objs += s->put_objs;
+		stats->put_common_pool_bulk += s->put_common_pool_bulk;
+		stats->put_common_pool_objs += s->put_common_pool_objs;
+		stats->get_success_bulk += s->get_success_bulk;
+		stats->get_success_objs += s->get_success_objs;
+		stats->get_common_pool_bulk += s->get_common_pool_bulk;
+		stats->get_common_pool_objs += s->get_common_pool_objs;
+		stats->get_fail_bulk += s->get_fail_bulk;
+		stats->get_fail_objs += s->get_fail_objs;
+	}
+	return 0;
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(lcore_id);
+	RTE_SET_USED(stats);
+	return -ENOTSUP;
+#endif
+}
+
+/* reset the statistics of a mempool */
+void
+rte_mempool_stats_reset(struct rte_mempool *mp)
+{
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
+	memset(mp->stats, 0, sizeof(*mp->stats) * mp->nb_lcores);
+#else
+	RTE_SET_USED(mp);
+#endif
+}
+
 /* dump the status of the mempool on the console */
 void
 rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 {
-#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
 	struct rte_mempool_debug_stats sum;
-	unsigned lcore_id;
 #endif
 	unsigned common_count;
 	unsigned cache_count;
@@ -800,7 +1111,8 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 
 	fprintf(f, "mempool <%s>@%p\n", mp->name, mp);
 	fprintf(f, "  flags=%x\n", mp->flags);
-	fprintf(f, "  ring=<%s>@%p\n", mp->ring->name, mp->ring);
+	fprintf(f, "  ops=<%s>\n", rte_mempool_get_ops(mp->ops_index)->name);
+	fprintf(f, "  pool_data=%p\n", mp->pool_data);
 	fprintf(f, "  phys_addr=0x%" PRIx64 "\n", mp->phys_addr);
 	fprintf(f, "  size=%"PRIu32"\n", mp->size);
 	fprintf(f, "  header_size=%"PRIu32"\n", mp->header_size);
@@ -810,6 +1122,7 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 	       mp->header_size + mp->elt_size + mp->trailer_size);
 
 	fprintf(f, "  private_data_size=%"PRIu32"\n", mp->private_data_size);
+	fprintf(f, "  nb_lcores=%"PRIu32"\n", mp->nb_lcores);
 	fprintf(f, "  pg_num=%"PRIu32"\n", mp->pg_num);
 	fprintf(f, "  pg_shift=%"PRIu32"\n", mp->pg_shift);
 	fprintf(f, "  pg_mask=%#tx\n", mp->pg_mask);
@@ -823,29 +1136,34 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 			mp->size);
 
 	cache_count = rte_mempool_dump_cache(f, mp);
-	common_count = rte_ring_count(mp->ring);
+	common_count = rte_mempool_ops_get_count(mp);
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
 
 	/* sum and dump statistics */
-#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
-	memset(&sum, 0, sizeof(sum));
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		sum.put_bulk += mp->stats[lcore_id].put_bulk;
-		sum.put_objs += mp->stats[lcore_id].put_objs;
-		sum.get_success_bulk += mp->stats[lcore_id].get_success_bulk;
-		sum.get_success_objs += mp->stats[lcore_id].get_success_objs;
-		sum.get_fail_bulk += mp->stats[lcore_id].get_fail_bulk;
-		sum.get_fail_objs += mp->stats[lcore_id].get_fail_objs;
-	}
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
+	rte_mempool_stats_get(mp, LCORE_ID_ANY, &sum);
 	fprintf(f, "  stats:\n");
 	fprintf(f, "    put_bulk=%"PRIu64"\n", sum.put_bulk);
 	fprintf(f, "    put_objs=%"PRIu64"\n", sum.put_objs);
+	fprintf(f, "    put_common_pool_bulk=%"PRIu64"\n",
+		sum.put_common_pool_bulk);
+	fprintf(f, "    put_common_pool_objs=%"PRIu64"\n",
+		sum.put_common_pool_objs);
 	fprintf(f, "    get_success_bulk=%"PRIu64"\n", sum.get_success_bulk);
 	fprintf(f, "    get_success_objs=%"PRIu64"\n", sum.get_success_objs);
+	fprintf(f, "    get_common_pool_bulk=%"PRIu64"\n",
+		sum.get_common_pool_bulk);
+	fprintf(f, "    get_common_pool_objs=%"PRIu64"\n",
+		sum.get_common_pool_objs);
 	fprintf(f, "    get_fail_bulk=%"PRIu64"\n", sum.get_fail_bulk);
 	fprintf(f, "    get_fail_objs=%"PRIu64"\n", sum.get_fail_objs);
+	if (sum.get_success_bulk != 0 &&
+			sum.get_success_bulk >= sum.get_common_pool_bulk)
+		fprintf(f, "    cache_hit_rate=%.2f%%\n", 100. *
+			(sum.get_success_bulk - sum.get_common_pool_bulk) /
+			sum.get_success_bulk);
 #else
 	fprintf(f, "  no statistics available\n");
 #endif
@@ -39,10 +39,11 @@
  * RTE Mempool.
  *
  * A memory pool is an allocator of fixed-size object. It is
- * identified by its name, and uses a ring to store free objects. It
- * provides some other optional services, like a per-core object
- * cache, and an alignment helper to ensure that objects are padded
- * to spread them equally on all RAM channels, ranks, and so on.
+ * identified by its name, and uses a pool handler (a ring by default)
+ * to store free objects. It provides some other optional services,
+ * like a per-core object cache, and an alignment helper to ensure
+ * that objects are padded to spread them equally on all RAM channels,
+ * ranks, and so on.
  *
  * Objects owned by a mempool should never be added in another
  * mempool. When an object is freed using rte_mempool_put() or
@@ -52,11 +53,10 @@
  *
  * Note: the mempool implementation is not preemptable. A lcore must
  * not be interrupted by another task that uses the same mempool
- * (because it uses a ring which is not preemptable). Also, mempool
- * functions must not be used outside the DPDK environment: for
- * example, in linuxapp environment, a thread that is not created by
- * the EAL must not use mempools. This is due to the per-lcore cache
- * that won't work as rte_lcore_id() will not return a correct value.
+ * (because it uses a ring which is not preemptable). A thread that is
+ * not created by the EAL has no per-lcore cache, as rte_lcore_id() does
+ * not return a correct value: its gets and puts go to the common pool,
+ * unless it uses its own cache (see rte_mempool_cache_create()).
  */
 
 #include <stdio.h>
@@ -71,6 +71,7 @@
 #include <rte_lcore.h>
 #include <rte_memory.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
 #include <rte_ring.h>
 
 #ifdef __cplusplus
@@ -81,26 +82,47 @@ extern "C" {
 #define RTE_MEMPOOL_HEADER_COOKIE2  0xf2eef2eedadd2e55ULL /**< Header cookie. */
 #define RTE_MEMPOOL_TRAILER_COOKIE  0xadd2e55badbadbadULL /**< Trailer cookie.*/
 
-#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+/*
+ * The debug mode implies the statistics. The statistics alone
+ * (RTE_LIBRTE_MEMPOOL_STATS) do not change the object layout and only
+ * add a few per-lcore counter updates in the fast path.
+ */
+#if defined(RTE_LIBRTE_MEMPOOL_DEBUG) && !defined(RTE_LIBRTE_MEMPOOL_STATS)
+#define RTE_LIBRTE_MEMPOOL_STATS
+#endif
+
 /**
  * A structure that stores the mempool statistics (per-lcore).
+ *
+ * The counters are only updated when RTE_LIBRTE_MEMPOOL_STATS (or
+ * RTE_LIBRTE_MEMPOOL_DEBUG) is enabled. A get that does not access the
+ * common pool is a cache hit: the number of cache hits is
+ * get_success_bulk - get_common_pool_bulk.
  */
 struct rte_mempool_debug_stats {
 	uint64_t put_bulk;         /**< Number of puts. */
 	uint64_t put_objs;         /**< Number of objects successfully put. */
+	uint64_t put_common_pool_bulk; /**< Number of bulks enqueued in pool. */
+	uint64_t put_common_pool_objs; /**< Number of objects enqueued in pool. */
 	uint64_t get_success_bulk; /**< Successful allocation number. */
 	uint64_t get_success_objs; /**< Objects successfully allocated. */
+	uint64_t get_common_pool_bulk; /**< Number of bulks dequeued from pool. */
+	uint64_t get_common_pool_objs; /**< Number of objects dequeued from pool. */
 	uint64_t get_fail_bulk;    /**< Failed allocation number. */
 	uint64_t get_fail_objs;    /**< Objects that failed to be allocated. */
 } __rte_cache_aligned;
-#endif
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 /**
- * A structure that stores a per-core object cache.
+ * A structure that stores an object cache, either the per-lcore cache of
+ * a mempool or a cache created by the application for a thread.
  */
 struct rte_mempool_cache {
-	unsigned len; /**< Cache len */
+	uint32_t size;        /**< Current size of the cache */
+	uint32_t flushthresh; /**< Threshold before we flush excess elements */
+	uint32_t len;         /**< Current cache count */
+	uint32_t max_size;    /**< Size given at creation, maximum size */
+	uint32_t calls;       /**< Gets and puts since last pool access */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -109,6 +131,30 @@ struct rte_mempool_cache {
 } __rte_cache_aligned;
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
+/**
+ * @internal Number of objects a cache can hold before flushing the excess
+ * objects to the pool.
+ */
+#define RTE_MEMPOOL_CALC_CACHE_FLUSHTHRESH(c) ((typeof(c))((c) * 3 / 2))
+
+/**
+ * With MEMPOOL_F_CACHE_ADAPTIVE, a cache which went to the pool within
+ * less than this number of gets and puts is grown.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_GROW_CALLS 4
+
+/**
+ * With MEMPOOL_F_CACHE_ADAPTIVE, a cache which did not go to the pool
+ * for more than this number of gets and puts is shrunk.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_SHRINK_CALLS 64
+
+/** Minimum size of an adaptive cache. */
+#define RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE 32
+
+/** Maximum number of caches attached to mempools by a non-EAL thread. */
+#define RTE_MEMPOOL_THREAD_CACHE_MAX 4
+
 /**
  * A structure that stores the size of mempool elements.
  */
@@ -180,9 +226,11 @@ struct rte_mempool_objtlr {
  */
 struct rte_mempool {
 	char name[RTE_MEMPOOL_NAMESIZE]; /**< Name of mempool. */
-	struct rte_ring *ring;           /**< Ring to store objects. */
+	void *pool_data;                 /**< Ring or pool to store objects. */
 	phys_addr_t phys_addr;           /**< Phys. addr. of mempool struct. */
 	int flags;                       /**< Flags of the mempool. */
+	int socket_id;                   /**< Socket id passed at mempool creation. */
+	int32_t ops_index;               /**< Index into rte_mempool_ops_table. */
 	uint32_t size;                   /**< Size of the mempool. */
 	uint32_t cache_size;             /**< Size of per-lcore local cache. */
 	uint32_t cache_flushthresh;
@@ -194,14 +242,21 @@ struct rte_mempool {
 
 	unsigned private_data_size;      /**< Size of private data. */
 
+	/**
+	 * Number of entries of the per-lcore arrays, stored after the
+	 * private data: the highest lcore id used, with any role, by the
+	 * creating process plus one.
+	 */
+	uint32_t nb_lcores;
+
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/** Per-lcore local cache. */
-	struct rte_mempool_cache local_cache[RTE_MAX_LCORE];
+	/** Per-lcore local cache, NULL if cache_size is 0. */
+	struct rte_mempool_cache *local_cache;
 #endif
 
-#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
 	/** Per-lcore statistics. */
-	struct rte_mempool_debug_stats stats[RTE_MAX_LCORE];
+	struct rte_mempool_debug_stats *stats;
 #endif
 
 	/* Address translation support, starts from next cache line. */
@@ -223,9 +278,209 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_CACHE_ALIGN 0x0002 /**< Do not align objs on cache lines.*/
 #define MEMPOOL_F_SP_PUT         0x0004 /**< Default put is "single-producer".*/
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
+#define MEMPOOL_F_CACHE_ADAPTIVE 0x0010 /**< Resize caches on pool accesses. */
+
+/**
+ * Prototype for implementation specific data provisioning function.
+ *
+ * The function should provide the implementation specific memory for
+ * use by the other mempool ops functions in a given mempool ops struct.
+ * E.g. the default ops provides an instance of the rte_ring for this
+ * purpose. It will most likely point to a different type of data
+ * structure, and will be transparent to the application programmer.
+ * This function should set mp->pool_data.
+ */
+typedef int (*rte_mempool_alloc_t)(struct rte_mempool *mp);
+
+/**
+ * Free the opaque private data pointed to by mp->pool_data pointer.
+ */
+typedef void (*rte_mempool_free_t)(struct rte_mempool *mp);
+
+/**
+ * Enqueue an object into the external pool.
+ */
+typedef int (*rte_mempool_enqueue_t)(struct rte_mempool *mp,
+		void * const *obj_table, unsigned int n);
+
+/**
+ * Dequeue an object from the external pool.
+ */
+typedef int (*rte_mempool_dequeue_t)(struct rte_mempool *mp,
+		void **obj_table, unsigned int n);
+
+/**
+ * Return the number of available objects in the external pool.
+ */
+typedef unsigned (*rte_mempool_get_count)(const struct rte_mempool *mp);
+
+#define RTE_MEMPOOL_OPS_NAMESIZE 32 /**< Max length of ops struct name. */
+
+/** Structure defining mempool operations structure */
+struct rte_mempool_ops {
+	char name[RTE_MEMPOOL_OPS_NAMESIZE]; /**< Name of mempool ops struct. */
+	rte_mempool_alloc_t alloc;       /**< Allocate private data. */
+	rte_mempool_free_t free;         /**< Free the external pool. */
+	rte_mempool_enqueue_t enqueue;   /**< Enqueue an object. */
+	rte_mempool_dequeue_t dequeue;   /**< Dequeue an object. */
+	rte_mempool_get_count get_count; /**< Get qty of available objs. */
+} __rte_cache_aligned;
+
+#define RTE_MEMPOOL_MAX_OPS_IDX 16  /**< Max registered ops structs */
+
+/**
+ * Structure storing the table of registered ops structs, each of which
+ * contain the function pointers for the mempool ops functions.
+ *
+ * Each process has its own storage for this ops struct array so that
+ * the mempools can be shared across primary and secondary processes.
+ * The indices used to access the array are valid across processes,
+ * provided the same handlers are registered in the same order, which
+ * is the case when both processes are built from the same libraries.
+ */
+struct rte_mempool_ops_table {
+	rte_spinlock_t sl;     /**< Spinlock for add/delete. */
+	uint32_t num_ops;      /**< Number of used ops structs in the table. */
+	/**
+	 * Storage for all possible ops structs.
+	 */
+	struct rte_mempool_ops ops[RTE_MEMPOOL_MAX_OPS_IDX];
+} __rte_cache_aligned;
+
+/** Array of registered ops structs. */
+extern struct rte_mempool_ops_table rte_mempool_ops_table;
+
+/**
+ * @internal Get the mempool ops struct from its index.
+ *
+ * @param ops_index
+ *   The index of the ops struct in the ops struct table. It must be a valid
+ *   index: (0 <= idx < num_ops).
+ * @return
+ *   The pointer to the ops struct in the table.
+ */
+static inline struct rte_mempool_ops *
+rte_mempool_get_ops(int ops_index)
+{
+	return &rte_mempool_ops_table.ops[ops_index];
+}
+
+/**
+ * @internal Wrapper for mempool_ops alloc callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @return
+ *   - 0: Success; successfully allocated mempool pool_data.
+ *   - <0: Error; code of alloc function.
+ */
+int
+rte_mempool_ops_alloc(struct rte_mempool *mp);
+
+/**
+ * @internal Wrapper for mempool_ops free callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ */
+void
+rte_mempool_ops_free(struct rte_mempool *mp);
+
+/**
+ * @internal Wrapper for mempool_ops dequeue callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param obj_table
+ *   Pointer to a table of void * pointers (objects).
+ * @param n
+ *   Number of objects to get.
+ * @return
+ *   - 0: Success; got n objects.
+ *   - <0: Error; code of dequeue function.
+ */
+static inline int
+rte_mempool_ops_dequeue_bulk(struct rte_mempool *mp,
+		void **obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	return ops->dequeue(mp, obj_table, n);
+}
+
+/**
+ * @internal Wrapper for mempool_ops enqueue callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param obj_table
+ *   Pointer to a table of void * pointers (objects).
+ * @param n
+ *   Number of objects to put.
+ * @return
+ *   - 0: Success; n objects supplied.
+ *   - <0: Error; code of enqueue function.
+ */
+static inline int
+rte_mempool_ops_enqueue_bulk(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n)
+{
+	struct rte_mempool_ops *ops;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	return ops->enqueue(mp, obj_table, n);
+}
 
 /**
- * @internal When debug is enabled, store some statistics.
+ * @internal Wrapper for mempool_ops get_count callback.
+ *
+ * @param mp
+ *   Pointer to the memory pool.
+ * @return
+ *   The number of available objects in the external pool.
+ */
+unsigned
+rte_mempool_ops_get_count(const struct rte_mempool *mp);
+
+/**
+ * Get the index of a registered mempool ops struct from its name.
+ *
+ * @param name
+ *   Name of the mempool ops struct, e.g. "ring_mp_mc" or "stack".
+ * @return
+ *   - >=0: Index of the ops struct in rte_mempool_ops_table.
+ *   - -EINVAL: No ops struct is registered under this name.
+ */
+int rte_mempool_ops_lookup(const char *name);
+
+/**
+ * Register mempool operations.
+ *
+ * @param ops
+ *   Pointer to an ops structure to register.
+ * @return
+ *   - >=0: Success; return the index of the ops struct in the table.
+ *   - -EINVAL - missing callbacks or name too long in the ops struct.
+ *   - -ENOSPC - the maximum number of ops structs has been reached.
+ *   - -EEXIST - an ops struct with the same name is already registered.
+ */
+int rte_mempool_register_ops(const struct rte_mempool_ops *ops);
+
+/**
+ * Macro to statically register the ops of a mempool handler.
+ * Note that the rte_mempool_register_ops fails silently here when
+ * more then RTE_MEMPOOL_MAX_OPS_IDX is registered.
+ */
+#define MEMPOOL_REGISTER_OPS(ops)					\
+	void mp_hdlr_init_##ops(void);					\
+	void __attribute__((constructor, used)) mp_hdlr_init_##ops(void)\
+	{								\
+		rte_mempool_register_ops(&ops);			\
+	}
+
+/**
+ * @internal When statistics are enabled, store some statistics.
  *
  * @param mp
  *   Pointer to the memory pool.
@@ -234,10 +489,10 @@ struct rte_mempool {
  * @param n
  *   Number to add to the object-oriented statistics.
  */
-#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+#ifdef RTE_LIBRTE_MEMPOOL_STATS
 #define __MEMPOOL_STAT_ADD(mp, name, n) do {                    \
 		unsigned __lcore_id = rte_lcore_id();           \
-		if (__lcore_id < RTE_MAX_LCORE) {               \
+		if (__lcore_id < mp->nb_lcores) {               \
 			mp->stats[__lcore_id].name##_objs += n;	\
 			mp->stats[__lcore_id].name##_bulk += 1;	\
 		}                                               \
@@ -477,9 +732,9 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *   never be used. The access to the per-lcore table is of course
  *   faster than the multi-producer/consumer pool. The cache can be
  *   disabled if the cache_size argument is set to 0; it can be useful to
- *   avoid losing objects in cache. Note that even if not used, the
- *   memory space for cache is always reserved in a mempool structure,
- *   except if CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE is set to 0.
+ *   avoid losing objects in cache. The memory space for the caches is
+ *   only reserved if cache_size is not 0, for the lcores enabled when
+ *   the mempool is created.
  * @param private_data_size
  *   The size of the private data appended after the mempool
  *   structure. This is useful for storing some private data after the
@@ -522,6 +777,13 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_CACHE_ADAPTIVE: If this flag is set, the size of the
+ *     caches used with the mempool is adjusted each time they access
+ *     the common pool: halved when they rarely do, doubled when they
+ *     often do, between RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE and the size
+ *     of the cache given at creation.
+ *   These two flags also select the ring used as common pool:
+ *   "ring_sp_sc", "ring_sp_mc", "ring_mp_sc" or "ring_mp_mc".
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -539,6 +801,62 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 		   rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		   int socket_id, unsigned flags);
 
+/**
+ * Create a new mempool named *name* in memory, using a given pool handler.
+ *
+ * This function is identical to rte_mempool_create(), except that the
+ * common pool storing the free objects is provided by the mempool ops
+ * registered under *ops_name* instead of being a ring chosen from the
+ * MEMPOOL_F_SP_PUT and MEMPOOL_F_SC_GET flags. Built-in handlers are:
+ *   - "ring_mp_mc", "ring_sp_mc", "ring_mp_sc", "ring_sp_sc": a ring with
+ *     multi or single producer and consumer synchronization.
+ *   - "stack": a LIFO protected by a spinlock, which gives back the most
+ *     recently freed (and likely cache hot) objects first.
+ *
+ * @param name
+ *   The name of the mempool.
+ * @param n
+ *   The number of elements in the mempool.
+ * @param elt_size
+ *   The size of each element.
+ * @param cache_size
+ *   Size of the per-lcore object cache, see rte_mempool_create().
+ * @param private_data_size
+ *   The size of the private data appended after the mempool structure.
+ * @param mp_init
+ *   A function pointer that is called for initialization of the pool,
+ *   before object initialization. This parameter can be NULL.
+ * @param mp_init_arg
+ *   An opaque pointer to data that can be used in the mempool
+ *   constructor function.
+ * @param obj_init
+ *   A function pointer that is called for each object at
+ *   initialization of the pool. This parameter can be NULL.
+ * @param obj_init_arg
+ *   An opaque pointer to data that can be used as an argument for
+ *   each call to the object constructor function.
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in the case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param flags
+ *   Flags of the mempool, see rte_mempool_create().
+ * @param ops_name
+ *   The name of the mempool ops (pool handler) to use.
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. Possible rte_errno values include
+ *   the ones of rte_mempool_create() and:
+ *    - EINVAL - no mempool ops is registered with this name
+ *    - ENOTSUP - Xen Dom0 memory is in use
+ */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name);
+
 /**
  * Create a new mempool named *name* in memory.
  *
@@ -567,9 +885,9 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
  *   never be used. The access to the per-lcore table is of course
  *   faster than the multi-producer/consumer pool. The cache can be
  *   disabled if the cache_size argument is set to 0; it can be useful to
- *   avoid losing objects in cache. Note that even if not used, the
- *   memory space for cache is always reserved in a mempool structure,
- *   except if CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE is set to 0.
+ *   avoid losing objects in cache. The memory space for the caches is
+ *   only reserved if cache_size is not 0, for the lcores enabled when
+ *   the mempool is created.
  * @param private_data_size
  *   The size of the private data appended after the mempool
  *   structure. This is useful for storing some private data after the
@@ -612,6 +930,11 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_CACHE_ADAPTIVE: If this flag is set, the size of the
+ *     caches used with the mempool is adjusted each time they access
+ *     the common pool: halved when they rarely do, doubled when they
+ *     often do, between RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE and the size
+ *     of the cache given at creation.
  * @param vaddr
  *   Virtual address of the externally allocated memory buffer.
  *   Will be used to store mempool objects.
@@ -666,9 +989,9 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
  *   never be used. The access to the per-lcore table is of course
  *   faster than the multi-producer/consumer pool. The cache can be
  *   disabled if the cache_size argument is set to 0; it can be useful to
- *   avoid losing objects in cache. Note that even if not used, the
- *   memory space for cache is always reserved in a mempool structure,
- *   except if CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE is set to 0.
+ *   avoid losing objects in cache. The memory space for the caches is
+ *   only reserved if cache_size is not 0, for the lcores enabled when
+ *   the mempool is created.
  * @param private_data_size
  *   The size of the private data appended after the mempool
  *   structure. This is useful for storing some private data after the
@@ -711,6 +1034,11 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
  *   - MEMPOOL_F_SC_GET: If this flag is set, the default behavior
  *     when using rte_mempool_get() or rte_mempool_get_bulk() is
  *     "single-consumer". Otherwise, it is "multi-consumers".
+ *   - MEMPOOL_F_CACHE_ADAPTIVE: If this flag is set, the size of the
+ *     caches used with the mempool is adjusted each time they access
+ *     the common pool: halved when they rarely do, doubled when they
+ *     often do, between RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE and the size
+ *     of the cache given at creation.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -739,6 +1067,199 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
  */
 void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
 
+/**
+ * Get the statistics of a mempool.
+ *
+ * The statistics are stored in the shared memory of the mempool, so this
+ * function can be called from a secondary process. The counters are
+ * updated without any atomic operation: a snapshot taken while other
+ * lcores use the mempool may be slightly inconsistent.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The lcore whose statistics are returned, or LCORE_ID_ANY to get
+ *   the sum of the statistics of all lcores.
+ * @param stats
+ *   A pointer to a structure filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameter.
+ *   - -ENOTSUP: Statistics are not enabled (RTE_LIBRTE_MEMPOOL_STATS).
+ */
+int rte_mempool_stats_get(const struct rte_mempool *mp, unsigned lcore_id,
+	struct rte_mempool_debug_stats *stats);
+
+/**
+ * Reset the statistics of a mempool for all lcores.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+void rte_mempool_stats_reset(struct rte_mempool *mp);
+
+/**
+ * Create a user-owned mempool cache.
+ *
+ * This can be used by non-EAL threads to enable caching when they
+ * interact with a mempool, either by passing the cache to
+ * rte_mempool_generic_get() and rte_mempool_generic_put(), or by
+ * attaching it to the mempool with rte_mempool_cache_attach(). A cache
+ * is not bound to a mempool, but it must be flushed before being used
+ * with another one.
+ *
+ * @param size
+ *   The size of the mempool cache. See rte_mempool_create()'s cache_size
+ *   parameter for more information.
+ * @param socket_id
+ *   The socket identifier in the case of NUMA. The value can be
+ *   SOCKET_ID_ANY if there is no NUMA constraint for the reserved zone.
+ * @return
+ *   A pointer to the mempool cache on success, NULL on error with
+ *   rte_errno set appropriately:
+ *    - EINVAL - cache size is zero or too large
+ *    - ENOMEM - cache allocation failed
+ */
+struct rte_mempool_cache *
+rte_mempool_cache_create(uint32_t size, int socket_id);
+
+/**
+ * Free a user-owned mempool cache.
+ *
+ * The cache must have been flushed and detached from the mempools
+ * before.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ */
+void
+rte_mempool_cache_free(struct rte_mempool_cache *cache);
+
+/**
+ * Flush a user-owned mempool cache to the specified mempool.
+ *
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @param mp
+ *   A pointer to the mempool the objects of the cache come from.
+ */
+void
+rte_mempool_cache_flush(struct rte_mempool_cache *cache,
+			struct rte_mempool *mp);
+
+/**
+ * Attach a user-owned cache to a mempool for the calling thread.
+ *
+ * The cache is then used by the gets and puts of the calling thread on
+ * this mempool, as the per-lcore cache is for EAL lcores. Only non-EAL
+ * threads can attach caches, up to RTE_MEMPOOL_THREAD_CACHE_MAX, and a
+ * cache must not be attached by several threads.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the mempool cache.
+ * @return
+ *   - 0: Success; the cache is attached.
+ *   - -EINVAL: The calling thread is an EAL lcore.
+ *   - -EEXIST: The thread already attached a cache to this mempool.
+ *   - -ENOSPC: The thread already attached RTE_MEMPOOL_THREAD_CACHE_MAX
+ *     caches.
+ */
+int
+rte_mempool_cache_attach(struct rte_mempool *mp,
+			 struct rte_mempool_cache *cache);
+
+/**
+ * Detach the cache attached to a mempool by the calling thread.
+ *
+ * The objects of the cache are put back in the mempool. A thread must
+ * detach its caches before exiting.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   The detached cache, or NULL if the thread did not attach a cache to
+ *   this mempool.
+ */
+struct rte_mempool_cache *
+rte_mempool_cache_detach(struct rte_mempool *mp);
+
+/**
+ * @internal A cache attached to a mempool by a non-EAL thread.
+ */
+struct rte_mempool_thread_cache {
+	struct rte_mempool *mp;          /**< Mempool of the cache. */
+	struct rte_mempool_cache *cache; /**< Attached cache. */
+};
+
+RTE_DECLARE_PER_LCORE(struct rte_mempool_thread_cache,
+		      mempool_thread_cache[RTE_MEMPOOL_THREAD_CACHE_MAX]);
+
+/**
+ * Get a pointer to the default cache of a mempool for an lcore.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The logical core id, usually rte_lcore_id(). For a non-EAL thread
+ *   (LCORE_ID_ANY), the cache attached by the calling thread is returned.
+ *   An lcore which was not enabled when the mempool was created has no
+ *   cache.
+ * @return
+ *   A pointer to the mempool cache or NULL if disabled or non-EAL thread
+ *   without attached cache.
+ */
+static inline struct rte_mempool_cache * __attribute__((always_inline))
+rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	unsigned i;
+
+	if (likely(lcore_id < mp->nb_lcores)) {
+		if (mp->cache_size == 0)
+			return NULL;
+		return &mp->local_cache[lcore_id];
+	}
+
+	for (i = 0; i < RTE_MEMPOOL_THREAD_CACHE_MAX; i++) {
+		if (RTE_PER_LCORE(mempool_thread_cache)[i].mp == mp)
+			return RTE_PER_LCORE(mempool_thread_cache)[i].cache;
+	}
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(lcore_id);
+#endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
+
+	return NULL;
+}
+
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+/**
+ * @internal Resize a cache which just accessed the common pool, if the
+ * mempool has adaptive caches.
+ */
+static inline void
+__mempool_cache_adapt(const struct rte_mempool *mp,
+		      struct rte_mempool_cache *cache)
+{
+	uint32_t size = cache->size;
+
+	if (likely(!(mp->flags & MEMPOOL_F_CACHE_ADAPTIVE)))
+		return;
+
+	if (cache->calls < RTE_MEMPOOL_CACHE_ADAPT_GROW_CALLS)
+		size = RTE_MIN(size * 2, cache->max_size);
+	else if (cache->calls > RTE_MEMPOOL_CACHE_ADAPT_SHRINK_CALLS)
+		size = RTE_MAX(size / 2, RTE_MIN(cache->max_size,
+				(uint32_t)RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE));
+
+	cache->size = size;
+	cache->flushthresh = RTE_MEMPOOL_CALC_CACHE_FLUSHTHRESH(size);
+	cache->calls = 0;
+}
+#endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -748,43 +1269,34 @@ void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
  * @param n
  *   The number of objects to store back in the mempool, must be strictly
  *   positive.
- * @param is_mp
- *   Mono-producer (0) or multi-producers (1).
+ * @param cache
+ *   A pointer to a mempool cache structure. May be NULL if not needed,
+ *   the objects are then pushed in the common pool by the pool handler.
  */
 static inline void __attribute__((always_inline))
-__mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
-		    unsigned n, int is_mp)
+__mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+		      unsigned n, struct rte_mempool_cache *cache)
 {
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
-	uint32_t flushthresh = mp->cache_flushthresh;
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 	/* increment stat now, adding in mempool always success */
 	__MEMPOOL_STAT_ADD(mp, put, n);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/* cache is not enabled or single producer or non-EAL thread */
-	if (unlikely(cache_size == 0 || is_mp == 0 ||
-		     lcore_id >= RTE_MAX_LCORE))
-		goto ring_enqueue;
-
-	/* Go straight to ring if put would overflow mem allocated for cache */
-	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+	/* No cache provided or put would overflow mem allocated for cache */
+	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
 		goto ring_enqueue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = &cache->objs[cache->len];
 
 	/*
 	 * The cache follows the following algorithm
 	 *   1. Add the objects to the cache
 	 *   2. Anything greater than the cache min value (if it crosses the
-	 *   cache flush threshold) is flushed to the ring.
+	 *   cache flush threshold) is flushed to the pool handler.
 	 */
 
 	/* Add elements back into the cache */
@@ -792,36 +1304,55 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 		cache_objs[index] = *obj_table;
 
 	cache->len += n;
-
-	if (cache->len >= flushthresh) {
-		rte_ring_mp_enqueue_bulk(mp->ring, &cache->objs[cache_size],
-				cache->len - cache_size);
-		cache->len = cache_size;
+	cache->calls++;
+
+	if (cache->len >= cache->flushthresh) {
+		__MEMPOOL_STAT_ADD(mp, put_common_pool,
+				   cache->len - cache->size);
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
+				cache->len - cache->size);
+		cache->len = cache->size;
+		__mempool_cache_adapt(mp, cache);
 	}
 
 	return;
 
 ring_enqueue:
+#else
+	RTE_SET_USED(cache);
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* push remaining objects in ring */
+	/* push remaining objects in the pool handler */
+	__MEMPOOL_STAT_ADD(mp, put_common_pool, n);
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
-	if (is_mp) {
-		if (rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
-	else {
-		if (rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
+	if (rte_mempool_ops_enqueue_bulk(mp, obj_table, n) < 0)
+		rte_panic("cannot put objects in mempool\n");
 #else
-	if (is_mp)
-		rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
-	else
-		rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+	rte_mempool_ops_enqueue_bulk(mp, obj_table, n);
 #endif
 }
 
+/**
+ * Put several objects back in the mempool, using a given cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the mempool from the obj_table.
+ * @param cache
+ *   A pointer to a mempool cache structure, such as a cache created with
+ *   rte_mempool_cache_create(). May be NULL to put the objects directly
+ *   in the common pool.
+ */
+static inline void __attribute__((always_inline))
+rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+			unsigned n, struct rte_mempool_cache *cache)
+{
+	__mempool_check_cookies(mp, obj_table, n, 0);
+	__mempool_generic_put(mp, obj_table, n, cache);
+}
 
 /**
  * Put several objects back in the mempool (multi-producers safe).
@@ -837,8 +1368,8 @@ static inline void __attribute__((always_inline))
 rte_mempool_mp_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 			unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, 1);
+	rte_mempool_generic_put(mp, obj_table, n,
+				rte_mempool_default_cache(mp, rte_lcore_id()));
 }
 
 /**
@@ -855,8 +1386,7 @@ static inline void
 rte_mempool_sp_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 			unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, 0);
+	rte_mempool_generic_put(mp, obj_table, n, NULL);
 }
 
 /**
@@ -877,8 +1407,9 @@ static inline void __attribute__((always_inline))
 rte_mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 		     unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, !(mp->flags & MEMPOOL_F_SP_PUT));
+	rte_mempool_generic_put(mp, obj_table, n,
+		(mp->flags & MEMPOOL_F_SP_PUT) ? NULL :
+		rte_mempool_default_cache(mp, rte_lcore_id()));
 }
 
 /**
@@ -935,50 +1466,50 @@ rte_mempool_put(struct rte_mempool *mp, void *obj)
  *   A pointer to a table of void * pointers (objects).
  * @param n
  *   The number of objects to get, must be strictly positive.
- * @param is_mc
- *   Mono-consumer (0) or multi-consumers (1).
+ * @param cache
+ *   A pointer to a mempool cache structure. May be NULL if not needed,
+ *   the objects are then taken from the common pool by the pool handler.
  * @return
  *   - >=0: Success; number of objects supplied.
- *   - <0: Error; code of ring dequeue function.
+ *   - <0: Error; code of the pool handler dequeue function.
  */
 static inline int __attribute__((always_inline))
-__mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
-		   unsigned n, int is_mc)
+__mempool_generic_get(struct rte_mempool *mp, void **obj_table,
+		      unsigned n, struct rte_mempool_cache *cache)
 {
 	int ret;
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index, len;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
 
-	/* cache is not enabled or single consumer */
-	if (unlikely(cache_size == 0 || is_mc == 0 ||
-		     n >= cache_size || lcore_id >= RTE_MAX_LCORE))
+	/* No cache provided or cannot be satisfied from cache */
+	if (unlikely(cache == NULL || n >= cache->max_size))
 		goto ring_dequeue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = cache->objs;
+	cache->calls++;
 
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache_size - cache->len);
+		uint32_t req = n + (cache->size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, &cache->objs[cache->len], req);
+		ret = rte_mempool_ops_dequeue_bulk(mp,
+			&cache->objs[cache->len], req);
 		if (unlikely(ret < 0)) {
 			/*
 			 * In the offchance that we are buffer constrained,
 			 * where we are not able to allocate cache + n, go to
-			 * the ring directly. If that fails, we are truly out of
+			 * the pool directly. If that fails, we are truly out of
 			 * buffers.
 			 */
 			goto ring_dequeue;
 		}
 
+		__MEMPOOL_STAT_ADD(mp, get_common_pool, req);
 		cache->len += req;
+		__mempool_cache_adapt(mp, cache);
 	}
 
 	/* Now fill in the response ... */
@@ -992,22 +1523,56 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 	return 0;
 
 ring_dequeue:
+#else
+	RTE_SET_USED(cache);
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* get remaining objects from ring */
-	if (is_mc)
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
-	else
-		ret = rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+	/* get remaining objects from the pool handler */
+	ret = rte_mempool_ops_dequeue_bulk(mp, obj_table, n);
 
-	if (ret < 0)
+	if (ret < 0) {
 		__MEMPOOL_STAT_ADD(mp, get_fail, n);
-	else
+	} else {
+		__MEMPOOL_STAT_ADD(mp, get_common_pool, n);
 		__MEMPOOL_STAT_ADD(mp, get_success, n);
+	}
 
 	return ret;
 }
 
+/**
+ * Get several objects from the mempool, using a given cache.
+ *
+ * If a cache is given, objects will be retrieved first from it,
+ * subsequently from the common pool. Note that it can return -ENOENT
+ * when the cache and common pool are empty, even if other caches are
+ * full.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to get from mempool to obj_table.
+ * @param cache
+ *   A pointer to a mempool cache structure, such as a cache created with
+ *   rte_mempool_cache_create(). May be NULL to take the objects directly
+ *   from the common pool.
+ * @return
+ *   - 0: Success; objects taken.
+ *   - -ENOENT: Not enough entries in the mempool; no object is retrieved.
+ */
+static inline int __attribute__((always_inline))
+rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table,
+			unsigned n, struct rte_mempool_cache *cache)
+{
+	int ret;
+	ret = __mempool_generic_get(mp, obj_table, n, cache);
+	if (ret == 0)
+		__mempool_check_cookies(mp, obj_table, n, 1);
+	return ret;
+}
+
 /**
  * Get several objects from the mempool (multi-consumers safe).
  *
@@ -1029,11 +1594,8 @@ ring_dequeue:
 static inline int __attribute__((always_inline))
 rte_mempool_mc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n, 1);
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	return rte_mempool_generic_get(mp, obj_table, n,
+				rte_mempool_default_cache(mp, rte_lcore_id()));
 }
 
 /**
@@ -1058,11 +1620,7 @@ rte_mempool_mc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_mempool_sc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n, 0);
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	return rte_mempool_generic_get(mp, obj_table, n, NULL);
 }
 
 /**
@@ -1090,12 +1648,9 @@ rte_mempool_sc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_mempool_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n,
-				 !(mp->flags & MEMPOOL_F_SC_GET));
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	return rte_mempool_generic_get(mp, obj_table, n,
+		(mp->flags & MEMPOOL_F_SC_GET) ? NULL :
+		rte_mempool_default_cache(mp, rte_lcore_id()));
 }
 
 /**
@@ -0,0 +1,129 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+
+#include <rte_errno.h>
+#include <rte_stack.h>
+#include <rte_mempool.h>
+
+/*
+ * Pool handlers storing the objects in a stack. The last freed objects,
+ * which are likely to be still in the CPU caches, are the first ones
+ * given back. The "stack" handler is protected by a spinlock, while the
+ * "lf_stack" one is lock-free.
+ */
+
+static int
+__stack_alloc(struct rte_mempool *mp, uint32_t flags)
+{
+	char name[RTE_STACK_NAMESIZE];
+	struct rte_stack *s;
+
+	snprintf(name, sizeof(name), RTE_MEMPOOL_MZ_FORMAT, mp->name);
+
+	s = rte_stack_create(name, mp->size, mp->socket_id, flags);
+	if (s == NULL)
+		return -rte_errno;
+
+	mp->pool_data = s;
+
+	return 0;
+}
+
+static int
+stack_alloc(struct rte_mempool *mp)
+{
+	return __stack_alloc(mp, 0);
+}
+
+static int
+lf_stack_alloc(struct rte_mempool *mp)
+{
+	return __stack_alloc(mp, RTE_STACK_F_LF);
+}
+
+static int
+stack_enqueue(struct rte_mempool *mp, void * const *obj_table,
+	      unsigned n)
+{
+	struct rte_stack *s = mp->pool_data;
+
+	return rte_stack_push(s, obj_table, n) == 0 ? -ENOBUFS : 0;
+}
+
+static int
+stack_dequeue(struct rte_mempool *mp, void **obj_table,
+	      unsigned n)
+{
+	struct rte_stack *s = mp->pool_data;
+
+	return rte_stack_pop(s, obj_table, n) == 0 ? -ENOENT : 0;
+}
+
+static unsigned
+stack_get_count(const struct rte_mempool *mp)
+{
+	struct rte_stack *s = mp->pool_data;
+
+	return rte_stack_count(s);
+}
+
+static void
+stack_free(struct rte_mempool *mp)
+{
+	struct rte_stack *s = mp->pool_data;
+
+	rte_stack_free(s);
+}
+
+static const struct rte_mempool_ops ops_stack = {
+	.name = "stack",
+	.alloc = stack_alloc,
+	.free = stack_free,
+	.enqueue = stack_enqueue,
+	.dequeue = stack_dequeue,
+	.get_count = stack_get_count,
+};
+
+static const struct rte_mempool_ops ops_lf_stack = {
+	.name = "lf_stack",
+	.alloc = lf_stack_alloc,
+	.free = stack_free,
+	.enqueue = stack_enqueue,
+	.dequeue = stack_dequeue,
+	.get_count = stack_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(ops_stack);
+MEMPOOL_REGISTER_OPS(ops_lf_stack);
@@ -0,0 +1,194 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+#include <rte_log.h>
+
+#include "rte_metrics.h"
+
+#define RTE_LOGTYPE_METRICS RTE_LOGTYPE_USER1
+
+#define RTE_METRICS_MZ_NAME "RTE_METRICS"
+
+/** Content of the metrics memzone, shared by all processes. */
+struct rte_metrics_data {
+	rte_spinlock_t lock;  /**< Serializes registrations. */
+	uint16_t cnt_names;   /**< Number of registered metrics. */
+	struct rte_metric_name names[RTE_METRICS_MAX_METRICS];
+	/** One shard per lcore, and one for non-EAL threads. */
+	struct rte_metrics_shard shards[RTE_MAX_LCORE + 1];
+};
+
+static struct rte_metrics_data *metrics_data;
+
+struct rte_metrics_shard *rte_metrics_shards;
+
+int
+rte_metrics_init(int socket_id)
+{
+	const struct rte_memzone *mz;
+
+	if (metrics_data != NULL)
+		return 0;
+
+	mz = rte_memzone_lookup(RTE_METRICS_MZ_NAME);
+	if (mz == NULL) {
+		if (rte_eal_process_type() != RTE_PROC_PRIMARY) {
+			RTE_LOG(ERR, METRICS, "Metrics not initialized by primary process\n");
+			return -ENOENT;
+		}
+		mz = rte_memzone_reserve(RTE_METRICS_MZ_NAME,
+				sizeof(struct rte_metrics_data), socket_id, 0);
+		if (mz == NULL) {
+			RTE_LOG(ERR, METRICS, "Cannot reserve metrics memzone\n");
+			return -ENOMEM;
+		}
+		memset(mz->addr, 0, sizeof(struct rte_metrics_data));
+		rte_spinlock_init(&((struct rte_metrics_data *)mz->addr)->lock);
+	}
+
+	metrics_data = mz->addr;
+	rte_metrics_shards = metrics_data->shards;
+	return 0;
+}
+
+int
+rte_metrics_reg_names(const char * const *names, uint16_t cnt, int port_id)
+{
+	struct rte_metric_name *entry;
+	uint16_t i, first;
+
+	if (metrics_data == NULL || cnt == 0)
+		return -EINVAL;
+	for (i = 0; i < cnt; i++)
+		if (strlen(names[i]) >= RTE_METRICS_MAX_NAME_LEN)
+			return -EINVAL;
+
+	rte_spinlock_lock(&metrics_data->lock);
+
+	/* a single name registered again keeps its identifier */
+	if (cnt == 1) {
+		for (i = 0; i < metrics_data->cnt_names; i++) {
+			entry = &metrics_data->names[i];
+			if (entry->port_id == port_id &&
+					strcmp(entry->name, names[0]) == 0) {
+				rte_spinlock_unlock(&metrics_data->lock);
+				return i;
+			}
+		}
+	}
+
+	if (metrics_data->cnt_names + cnt > RTE_METRICS_MAX_METRICS) {
+		rte_spinlock_unlock(&metrics_data->lock);
+		return -ENOSPC;
+	}
+
+	first = metrics_data->cnt_names;
+	for (i = 0; i < cnt; i++) {
+		entry = &metrics_data->names[first + i];
+		snprintf(entry->name, sizeof(entry->name), "%s", names[i]);
+		entry->port_id = port_id;
+	}
+	/* readers see the names before the new count */
+	rte_smp_wmb();
+	metrics_data->cnt_names = first + cnt;
+
+	rte_spinlock_unlock(&metrics_data->lock);
+	return first;
+}
+
+int
+rte_metrics_reg_name(const char *name, int port_id)
+{
+	return rte_metrics_reg_names(&name, 1, port_id);
+}
+
+int
+rte_metrics_get_names(struct rte_metric_name *names, uint16_t capacity)
+{
+	uint16_t cnt;
+
+	if (metrics_data == NULL)
+		return -EINVAL;
+
+	cnt = metrics_data->cnt_names;
+	rte_smp_rmb();
+	if (names == NULL || capacity < cnt)
+		return cnt;
+
+	memcpy(names, metrics_data->names, cnt * sizeof(names[0]));
+	return cnt;
+}
+
+int
+rte_metrics_get_values(int port_id, struct rte_metric_value *values,
+		uint16_t capacity)
+{
+	const struct rte_metrics_shard *shard;
+	uint16_t key, cnt_names, cnt = 0;
+	unsigned i;
+	uint64_t sum;
+
+	if (metrics_data == NULL)
+		return -EINVAL;
+
+	cnt_names = metrics_data->cnt_names;
+	rte_smp_rmb();
+	for (key = 0; key < cnt_names; key++)
+		if (metrics_data->names[key].port_id == port_id)
+			cnt++;
+	if (values == NULL || capacity < cnt)
+		return cnt;
+
+	cnt = 0;
+	for (key = 0; key < cnt_names; key++) {
+		if (metrics_data->names[key].port_id != port_id)
+			continue;
+		sum = 0;
+		for (i = 0; i <= RTE_MAX_LCORE; i++) {
+			shard = &metrics_data->shards[i];
+			sum += shard->values[key];
+		}
+		values[cnt].key = key;
+		values[cnt].value = sum;
+		cnt++;
+	}
+	return cnt;
+}
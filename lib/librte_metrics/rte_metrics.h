@@ -0,0 +1,229 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_METRICS_H_
+#define _RTE_METRICS_H_
+
+/**
+ * @file
+ * RTE Metrics
+ *
+ * The metrics library is a registry of named 64-bit metrics, either
+ * global or attached to a port, kept in a memzone so that they can be
+ * read by secondary processes such as dpdk_proc_info.
+ *
+ * Each EAL lcore updates its own copy (shard) of the metrics with plain
+ * stores, and readers sum the shards of all lcores. Other threads
+ * update a shared shard with atomic operations.
+ */
+
+#include <stdint.h>
+
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of a metric name, including the terminating '\0'. */
+#define RTE_METRICS_MAX_NAME_LEN 64
+
+/** Owner of the metrics which are not related to a port. */
+#define RTE_METRICS_GLOBAL -1
+
+/** Name and owner of a metric. */
+struct rte_metric_name {
+	char name[RTE_METRICS_MAX_NAME_LEN]; /**< Name of the metric. */
+	int port_id; /**< Port of the metric, or RTE_METRICS_GLOBAL. */
+};
+
+/** Value of a metric. */
+struct rte_metric_value {
+	uint16_t key;   /**< Identifier of the metric. */
+	uint64_t value; /**< Sum of the values of all shards. */
+};
+
+/**
+ * @internal
+ * Values of all the metrics written by one lcore.
+ */
+struct rte_metrics_shard {
+	uint64_t values[RTE_METRICS_MAX_METRICS];
+} __rte_cache_aligned;
+
+/**
+ * @internal
+ * Shards of the metrics, one per lcore followed by the shard of non-EAL
+ * threads, set by rte_metrics_init().
+ */
+extern struct rte_metrics_shard *rte_metrics_shards;
+
+/**
+ * Initialize the metrics library.
+ *
+ * The primary process allocates the metrics memzone, secondary processes
+ * look it up. It must be called before any other function of the
+ * library.
+ *
+ * @param socket_id
+ *   Socket on which the memzone is allocated, or SOCKET_ID_ANY.
+ * @return
+ *   - 0: Success.
+ *   - (-ENOMEM) if the memzone cannot be allocated.
+ *   - (-ENOENT) if the primary process did not initialize the library.
+ */
+int rte_metrics_init(int socket_id);
+
+/**
+ * Register a metric.
+ *
+ * This function is multi-thread and multi-process safe. Registering a
+ * name twice for the same owner gives the same identifier.
+ *
+ * @param name
+ *   Name of the metric.
+ * @param port_id
+ *   Port of the metric, or RTE_METRICS_GLOBAL.
+ * @return
+ *   - The identifier of the metric on success.
+ *   - (-EINVAL) if the name is too long.
+ *   - (-ENOSPC) if RTE_METRICS_MAX_METRICS metrics are already registered.
+ */
+int rte_metrics_reg_name(const char *name, int port_id);
+
+/**
+ * Register a set of metrics with consecutive identifiers.
+ *
+ * @param names
+ *   Names of the metrics.
+ * @param cnt
+ *   Number of names.
+ * @param port_id
+ *   Port of the metrics, or RTE_METRICS_GLOBAL.
+ * @return
+ *   - The identifier of the first metric on success.
+ *   - (-EINVAL) if a name is too long or cnt is 0.
+ *   - (-ENOSPC) if there is not enough room left for cnt metrics.
+ */
+int rte_metrics_reg_names(const char * const *names, uint16_t cnt,
+		int port_id);
+
+/**
+ * Get the names of the registered metrics.
+ *
+ * @param names
+ *   Array filled with the names, indexed by metric identifier, or NULL.
+ * @param capacity
+ *   Number of entries in the array.
+ * @return
+ *   The number of registered metrics. The array is not filled if it is
+ *   NULL or smaller than this number.
+ */
+int rte_metrics_get_names(struct rte_metric_name *names, uint16_t capacity);
+
+/**
+ * Get the values of the metrics of an owner, summing the shards of all
+ * lcores.
+ *
+ * This function only reads the shards, it can be called at a high
+ * frequency from a secondary process without slowing down the lcores
+ * updating them.
+ *
+ * @param port_id
+ *   Port of the metrics, or RTE_METRICS_GLOBAL.
+ * @param values
+ *   Array filled with the values, or NULL.
+ * @param capacity
+ *   Number of entries in the array.
+ * @return
+ *   The number of metrics of the owner. The array is not filled if it is
+ *   NULL or smaller than this number.
+ */
+int rte_metrics_get_values(int port_id, struct rte_metric_value *values,
+		uint16_t capacity);
+
+/**
+ * Add a value to a metric.
+ *
+ * On an EAL lcore, only the shard of the lcore is written, without
+ * atomic operation.
+ *
+ * @param key
+ *   Identifier of the metric.
+ * @param delta
+ *   Value to add.
+ */
+static inline void
+rte_metrics_add(uint16_t key, uint64_t delta)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	if (likely(lcore_id < RTE_MAX_LCORE))
+		rte_metrics_shards[lcore_id].values[key] += delta;
+	else
+		rte_atomic64_add((rte_atomic64_t *)
+			&rte_metrics_shards[RTE_MAX_LCORE].values[key],
+			delta);
+}
+
+/**
+ * Set the value of a metric in the shard of the calling thread.
+ *
+ * As readers sum the shards, a metric set with this function, such as a
+ * gauge, should always be updated from the same thread.
+ *
+ * @param key
+ *   Identifier of the metric.
+ * @param value
+ *   New value.
+ */
+static inline void
+rte_metrics_set(uint16_t key, uint64_t value)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	if (likely(lcore_id < RTE_MAX_LCORE))
+		rte_metrics_shards[lcore_id].values[key] = value;
+	else
+		rte_atomic64_set((rte_atomic64_t *)
+			&rte_metrics_shards[RTE_MAX_LCORE].values[key],
+			value);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_METRICS_H_ */
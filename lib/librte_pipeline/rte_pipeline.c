@@ -1343,6 +1343,7 @@ int
 rte_pipeline_run(struct rte_pipeline *p)
 {
 	struct rte_port_in *port_in;
+	int n_pkts_total = 0;
 
 	for (port_in = p->port_in_first; port_in != NULL;
 		port_in = port_in->next) {
@@ -1354,6 +1355,7 @@ rte_pipeline_run(struct rte_pipeline *p)
 			port_in->burst_size);
 		if (n_pkts == 0)
 			continue;
+		n_pkts_total += n_pkts;
 
 		pkts_mask = RTE_LEN2MASK(n_pkts, uint64_t);
 		p->action_mask0[RTE_PIPELINE_ACTION_DROP] = 0;
@@ -1471,7 +1473,7 @@ rte_pipeline_run(struct rte_pipeline *p)
 				p->action_mask0[RTE_PIPELINE_ACTION_DROP]);
 	}
 
-	return 0;
+	return n_pkts_total;
 }
 
 int
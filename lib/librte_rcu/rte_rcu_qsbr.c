@@ -0,0 +1,329 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_spinlock.h>
+#include <rte_string_fns.h>
+
+#include "rte_rcu_qsbr.h"
+
+#define RTE_LOGTYPE_RCU RTE_LOGTYPE_USER1
+
+/* element of a defer queue, with the token of its grace period */
+struct rcu_dq_entry {
+	uint64_t token;
+	void *e;
+};
+
+struct rte_rcu_qsbr_dq {
+	char name[RTE_RCU_QSBR_DQ_NAMESIZE];
+	struct rte_rcu_qsbr *v;
+	rte_rcu_qsbr_free_resource_t free_fn;
+	void *p;
+	uint32_t size;
+	uint32_t trigger_reclaim_limit;
+	uint32_t max_reclaim_size;
+	rte_spinlock_t lock;
+	uint32_t head;  /* oldest entry */
+	uint32_t count; /* number of entries */
+	struct rcu_dq_entry entries[0];
+};
+
+static inline uint32_t
+rcu_qsbr_num_elems(uint32_t max_threads)
+{
+	return (max_threads + RTE_RCU_QSBR_THRID_WORD_BITS - 1) /
+		RTE_RCU_QSBR_THRID_WORD_BITS;
+}
+
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads)
+{
+	size_t sz;
+
+	if (max_threads == 0) {
+		RTE_LOG(ERR, RCU, "%s: invalid max_threads %u\n",
+			__func__, max_threads);
+		rte_errno = EINVAL;
+		return 1;
+	}
+
+	sz = sizeof(struct rte_rcu_qsbr);
+	sz += sizeof(struct rte_rcu_qsbr_cnt) * max_threads;
+	sz += sizeof(uint64_t) * rcu_qsbr_num_elems(max_threads);
+	return RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
+}
+
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads)
+{
+	size_t sz;
+
+	if (v == NULL || max_threads == 0)
+		return -EINVAL;
+
+	sz = rte_rcu_qsbr_get_memsize(max_threads);
+	memset(v, 0, sz);
+	v->max_threads = max_threads;
+	v->num_elems = rcu_qsbr_num_elems(max_threads);
+	v->token = RTE_RCU_QSBR_CNT_INIT;
+	v->acked_token = RTE_RCU_QSBR_CNT_INIT - 1;
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t *word, bit;
+
+	if (v == NULL || thread_id >= v->max_threads)
+		return -EINVAL;
+
+	word = &__rte_rcu_qsbr_thrid_bmap(v)[thread_id /
+		RTE_RCU_QSBR_THRID_WORD_BITS];
+	bit = UINT64_C(1) << (thread_id % RTE_RCU_QSBR_THRID_WORD_BITS);
+
+	/* the thread starts offline */
+	__atomic_store_n(&v->qsbr_cnt[thread_id].cnt,
+		RTE_RCU_QSBR_CNT_THR_OFFLINE, __ATOMIC_RELAXED);
+	if ((__atomic_fetch_or(word, bit, __ATOMIC_RELEASE) & bit) == 0)
+		__atomic_fetch_add(&v->num_threads, 1, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v,
+		unsigned int thread_id)
+{
+	uint64_t *word, bit;
+
+	if (v == NULL || thread_id >= v->max_threads)
+		return -EINVAL;
+
+	word = &__rte_rcu_qsbr_thrid_bmap(v)[thread_id /
+		RTE_RCU_QSBR_THRID_WORD_BITS];
+	bit = UINT64_C(1) << (thread_id % RTE_RCU_QSBR_THRID_WORD_BITS);
+
+	if ((__atomic_fetch_and(word, ~bit, __ATOMIC_RELEASE) & bit) != 0)
+		__atomic_fetch_sub(&v->num_threads, 1, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	t = rte_rcu_qsbr_start(v);
+
+	/* do not wait for ourselves */
+	if (thread_id != RTE_QSBR_THRID_INVALID)
+		rte_rcu_qsbr_quiescent(v, thread_id);
+
+	rte_rcu_qsbr_check(v, t, 1);
+}
+
+int
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v)
+{
+	uint64_t *bmap, bits;
+	unsigned int i, id;
+
+	if (f == NULL || v == NULL)
+		return -EINVAL;
+
+	fprintf(f, "QSBR variable:\n");
+	fprintf(f, "  QS variable memory size = %zu\n",
+		rte_rcu_qsbr_get_memsize(v->max_threads));
+	fprintf(f, "  Given # max threads = %u\n", v->max_threads);
+	fprintf(f, "  Current # threads = %u\n", v->num_threads);
+	fprintf(f, "  Token = %"PRIu64"\n",
+		__atomic_load_n(&v->token, __ATOMIC_ACQUIRE));
+	fprintf(f, "  Least Acknowledged Token = %"PRIu64"\n",
+		__atomic_load_n(&v->acked_token, __ATOMIC_ACQUIRE));
+
+	fprintf(f, "Quiescent State Counts for readers:\n");
+	bmap = __rte_rcu_qsbr_thrid_bmap(v);
+	for (i = 0; i < v->num_elems; i++) {
+		bits = __atomic_load_n(&bmap[i], __ATOMIC_ACQUIRE);
+		while (bits != 0) {
+			id = i * RTE_RCU_QSBR_THRID_WORD_BITS +
+				__builtin_ctzll(bits);
+			bits &= bits - 1;
+			fprintf(f, "  thread ID = %u, count = %"PRIu64"\n", id,
+				__atomic_load_n(&v->qsbr_cnt[id].cnt,
+					__ATOMIC_RELAXED));
+		}
+	}
+
+	return 0;
+}
+
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params)
+{
+	struct rte_rcu_qsbr_dq *dq;
+	size_t sz;
+
+	if (params == NULL || params->name == NULL || params->v == NULL ||
+			params->free_fn == NULL || params->size == 0 ||
+			params->trigger_reclaim_limit > params->size) {
+		RTE_LOG(ERR, RCU, "%s: invalid defer queue parameters\n",
+			__func__);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	sz = sizeof(*dq) + sizeof(struct rcu_dq_entry) * params->size;
+	dq = rte_zmalloc_socket(params->name, sz, RTE_CACHE_LINE_SIZE,
+		params->socket_id);
+	if (dq == NULL) {
+		RTE_LOG(ERR, RCU, "%s: cannot allocate defer queue %s\n",
+			__func__, params->name);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(dq->name, sizeof(dq->name), "%s", params->name);
+	dq->v = params->v;
+	dq->free_fn = params->free_fn;
+	dq->p = params->p;
+	dq->size = params->size;
+	dq->trigger_reclaim_limit = params->trigger_reclaim_limit;
+	dq->max_reclaim_size = params->max_reclaim_size != 0 ?
+		params->max_reclaim_size : params->size;
+	rte_spinlock_init(&dq->lock);
+
+	return dq;
+}
+
+/*
+ * Free up to n elements whose grace period is over, the queue being
+ * locked. The tokens are increasing along the queue, so it stops at the
+ * first element still in use.
+ */
+static unsigned int
+rcu_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n, int wait)
+{
+	struct rcu_dq_entry *entry;
+	unsigned int freed = 0;
+
+	while (freed < n && dq->count != 0) {
+		entry = &dq->entries[dq->head];
+		if (!rte_rcu_qsbr_check(dq->v, entry->token, wait))
+			break;
+		dq->free_fn(dq->p, entry->e);
+		dq->head = (dq->head + 1) % dq->size;
+		dq->count--;
+		freed++;
+	}
+
+	return freed;
+}
+
+int
+rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, void *e)
+{
+	struct rcu_dq_entry *entry;
+
+	if (dq == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dq->lock);
+
+	if (dq->count >= dq->trigger_reclaim_limit)
+		rcu_dq_reclaim(dq, dq->max_reclaim_size, 0);
+	if (dq->count == dq->size && rcu_dq_reclaim(dq, dq->size, 0) == 0) {
+		rte_spinlock_unlock(&dq->lock);
+		return -ENOSPC;
+	}
+
+	/* the token is taken under the lock to keep the queue ordered */
+	entry = &dq->entries[(dq->head + dq->count) % dq->size];
+	entry->token = rte_rcu_qsbr_start(dq->v);
+	entry->e = e;
+	dq->count++;
+
+	rte_spinlock_unlock(&dq->lock);
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n,
+		unsigned int *freed, unsigned int *pending)
+{
+	unsigned int count;
+
+	if (dq == NULL || n == 0)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dq->lock);
+	count = rcu_dq_reclaim(dq, n, 0);
+	if (pending != NULL)
+		*pending = dq->count;
+	rte_spinlock_unlock(&dq->lock);
+
+	if (freed != NULL)
+		*freed = count;
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq)
+{
+	if (dq == NULL)
+		return 0;
+
+	rte_spinlock_lock(&dq->lock);
+	rcu_dq_reclaim(dq, dq->count, 1);
+	rte_spinlock_unlock(&dq->lock);
+
+	rte_free(dq);
+
+	return 0;
+}
@@ -0,0 +1,430 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RCU_QSBR_H_
+#define _RTE_RCU_QSBR_H_
+
+/**
+ * @file
+ * RTE Quiescent State Based Reclamation (QSBR)
+ *
+ * Lock-free readers of a shared structure, such as a table or a list of
+ * callbacks, access its elements without taking any lock. A writer which
+ * removes an element cannot free its memory before all the readers which
+ * may still hold a reference to it are done.
+ *
+ * With QSBR, each reader thread reports a quiescent state, a point where
+ * it holds no reference to any element, typically once per iteration of
+ * its packet processing loop. After removing an element, the writer
+ * starts a grace period with rte_rcu_qsbr_start() and frees the element
+ * once every reader has reported a quiescent state since then, checked
+ * with rte_rcu_qsbr_check(). A reader reporting a quiescent state only
+ * writes its own cache line, so the cost on the data path is a few cycles.
+ *
+ * A reader which stops reporting quiescent states, for example while
+ * blocking, must go offline so that it does not delay the writers.
+ *
+ * Writers can wait for the readers with rte_rcu_qsbr_synchronize(), or
+ * hand the elements to a defer queue which frees them once it is safe.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Counter of a thread which is offline. */
+#define RTE_RCU_QSBR_CNT_THR_OFFLINE 0
+/** Initial value of the token. */
+#define RTE_RCU_QSBR_CNT_INIT 1
+
+/** Thread identifier of a writer which is not a reader. */
+#define RTE_QSBR_THRID_INVALID 0xffffffff
+
+/** Number of threads tracked by a word of the registered thread bitmap. */
+#define RTE_RCU_QSBR_THRID_WORD_BITS 64
+
+/** Quiescent state counter of a reader thread. */
+struct rte_rcu_qsbr_cnt {
+	/** Last token seen by the thread, 0 when it is offline. */
+	uint64_t cnt;
+} __rte_cache_aligned;
+
+/**
+ * QSBR variable, shared by the readers and the writers of a structure.
+ *
+ * It is followed in memory by the counters of the readers and by the
+ * bitmap of the registered readers; its size is given by
+ * rte_rcu_qsbr_get_memsize().
+ */
+struct rte_rcu_qsbr {
+	/** Token of the last grace period started by a writer. */
+	uint64_t token __rte_cache_aligned;
+	/** Token acknowledged by all the readers at the last check. */
+	uint64_t acked_token;
+	uint32_t num_elems;   /**< Number of words of the thread bitmap. */
+	uint32_t num_threads; /**< Number of registered threads. */
+	uint32_t max_threads; /**< Maximum number of threads. */
+
+	/** Counters of the readers, indexed by thread identifier. */
+	struct rte_rcu_qsbr_cnt qsbr_cnt[0] __rte_cache_aligned;
+} __rte_cache_aligned;
+
+/** @internal Bitmap of the registered threads, after the counters. */
+static inline uint64_t *
+__rte_rcu_qsbr_thrid_bmap(struct rte_rcu_qsbr *v)
+{
+	return (uint64_t *)&v->qsbr_cnt[v->max_threads];
+}
+
+/**
+ * Get the size of the memory to allocate for a QSBR variable.
+ *
+ * @param max_threads
+ *   Maximum number of reader threads.
+ * @return
+ *   The size in bytes, or 1 with rte_errno set to EINVAL if max_threads
+ *   is 0.
+ */
+size_t rte_rcu_qsbr_get_memsize(uint32_t max_threads);
+
+/**
+ * Initialize a QSBR variable.
+ *
+ * @param v
+ *   QSBR variable, in a cache-aligned memory area of the size given by
+ *   rte_rcu_qsbr_get_memsize().
+ * @param max_threads
+ *   Maximum number of reader threads, identified by 0 to max_threads - 1.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if a parameter is invalid.
+ */
+int rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads);
+
+/**
+ * Register a reader thread, which starts offline.
+ *
+ * Any identifier lower than max_threads can be used, such as the lcore
+ * identifier.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Identifier of the reader thread.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if a parameter is invalid.
+ */
+int rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v,
+		unsigned int thread_id);
+
+/**
+ * Unregister an offline reader thread.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Identifier of the reader thread.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if a parameter is invalid.
+ */
+int rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v,
+		unsigned int thread_id);
+
+/**
+ * Put a registered reader thread online: from now on, the writers wait
+ * for its quiescent states.
+ *
+ * It must be called before the thread accesses the shared structure.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Identifier of the reader thread.
+ */
+static inline void
+rte_rcu_qsbr_thread_online(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	t = __atomic_load_n(&v->token, __ATOMIC_RELAXED);
+	__atomic_store_n(&v->qsbr_cnt[thread_id].cnt, t, __ATOMIC_RELAXED);
+
+	/* the counter must be visible before the loads of the structure */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * Put a reader thread offline: the writers do not wait for it any more.
+ *
+ * It must be called when the thread holds no reference to the shared
+ * structure, before blocking or while it does not access the structure
+ * for a long time.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Identifier of the reader thread.
+ */
+static inline void
+rte_rcu_qsbr_thread_offline(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	__atomic_store_n(&v->qsbr_cnt[thread_id].cnt,
+		RTE_RCU_QSBR_CNT_THR_OFFLINE, __ATOMIC_RELEASE);
+}
+
+/**
+ * Report a quiescent state: the reader thread holds no reference to the
+ * elements of the shared structure it read before.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Identifier of the reader thread, which must be online.
+ */
+static inline void
+rte_rcu_qsbr_quiescent(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	t = __atomic_load_n(&v->token, __ATOMIC_ACQUIRE);
+
+	/* do not dirty the cache line when no grace period was started */
+	if (t != v->qsbr_cnt[thread_id].cnt)
+		__atomic_store_n(&v->qsbr_cnt[thread_id].cnt, t,
+			__ATOMIC_RELEASE);
+}
+
+/**
+ * Start a grace period, once an element was removed from the shared
+ * structure.
+ *
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   Token of the grace period, to give to rte_rcu_qsbr_check().
+ */
+static inline uint64_t
+rte_rcu_qsbr_start(struct rte_rcu_qsbr *v)
+{
+	/* the removal must be visible before the counters are read */
+	return __atomic_add_fetch(&v->token, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Check whether a grace period is over, that is whether all the online
+ * reader threads reported a quiescent state since it was started.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param t
+ *   Token returned by rte_rcu_qsbr_start().
+ * @param wait
+ *   If true, wait until the grace period is over.
+ * @return
+ *   1 if the grace period is over, 0 otherwise.
+ */
+static inline int
+rte_rcu_qsbr_check(struct rte_rcu_qsbr *v, uint64_t t, int wait)
+{
+	uint64_t *bmap, bits, c, acked = UINT64_MAX;
+	unsigned int i, id;
+
+	if (likely(t <= __atomic_load_n(&v->acked_token, __ATOMIC_ACQUIRE)))
+		return 1;
+
+	bmap = __rte_rcu_qsbr_thrid_bmap(v);
+	for (i = 0; i < v->num_elems; i++) {
+		bits = __atomic_load_n(&bmap[i], __ATOMIC_ACQUIRE);
+		while (bits != 0) {
+			id = i * RTE_RCU_QSBR_THRID_WORD_BITS +
+				__builtin_ctzll(bits);
+			bits &= bits - 1;
+
+			c = __atomic_load_n(&v->qsbr_cnt[id].cnt,
+				__ATOMIC_ACQUIRE);
+			while (c != RTE_RCU_QSBR_CNT_THR_OFFLINE && c < t) {
+				if (!wait)
+					return 0;
+				rte_pause();
+				c = __atomic_load_n(&v->qsbr_cnt[id].cnt,
+					__ATOMIC_ACQUIRE);
+			}
+			if (c != RTE_RCU_QSBR_CNT_THR_OFFLINE && c < acked)
+				acked = c;
+		}
+	}
+
+	/* all the readers are offline: the current token is acked */
+	if (acked == UINT64_MAX)
+		acked = t;
+	__atomic_store_n(&v->acked_token, acked, __ATOMIC_RELEASE);
+
+	return 1;
+}
+
+/**
+ * Start a grace period and wait for its end.
+ *
+ * If the caller is itself a registered reader thread, it reports a
+ * quiescent state first, so it must not hold references to the elements.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Identifier of the calling reader thread, or RTE_QSBR_THRID_INVALID
+ *   if the caller is not a reader.
+ */
+void rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Dump the state of a QSBR variable.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if a parameter is invalid.
+ */
+int rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v);
+
+/** Maximum length of the name of a defer queue. */
+#define RTE_RCU_QSBR_DQ_NAMESIZE 32
+
+/**
+ * Function freeing an element of a defer queue.
+ *
+ * @param p
+ *   The p parameter given at the creation of the defer queue.
+ * @param e
+ *   The element to free.
+ */
+typedef void (*rte_rcu_qsbr_free_resource_t)(void *p, void *e);
+
+/** Parameters of a defer queue. */
+struct rte_rcu_qsbr_dq_parameters {
+	const char *name;     /**< Name of the queue. */
+	int socket_id;        /**< Socket of the queue memory. */
+	uint32_t size;        /**< Maximum number of pending elements. */
+	/**
+	 * Number of pending elements from which an enqueue first frees the
+	 * elements whose grace period is over, 0 to do it on every enqueue.
+	 */
+	uint32_t trigger_reclaim_limit;
+	/** Maximum number of elements freed by an enqueue, 0 for all. */
+	uint32_t max_reclaim_size;
+	rte_rcu_qsbr_free_resource_t free_fn; /**< Function freeing. */
+	void *p;              /**< First parameter of free_fn. */
+	struct rte_rcu_qsbr *v; /**< QSBR variable of the readers. */
+};
+
+/** Defer queue, freeing elements once their grace period is over. */
+struct rte_rcu_qsbr_dq;
+
+/**
+ * Create a defer queue.
+ *
+ * @param params
+ *   Parameters of the queue.
+ * @return
+ *   The queue, or NULL on error with rte_errno set:
+ *   - EINVAL - invalid parameters
+ *   - ENOMEM - no memory
+ */
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params);
+
+/**
+ * Start a grace period for an element removed from the shared structure,
+ * and queue it until it can be freed.
+ *
+ * The elements of the queue whose grace period is over may be freed
+ * first, depending on trigger_reclaim_limit and max_reclaim_size. The
+ * function is thread-safe.
+ *
+ * @param dq
+ *   Defer queue.
+ * @param e
+ *   Element to free.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if a parameter is invalid.
+ *   - (-ENOSPC) if the queue is full of elements still in use.
+ */
+int rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, void *e);
+
+/**
+ * Free the queued elements whose grace period is over, without waiting.
+ *
+ * @param dq
+ *   Defer queue.
+ * @param n
+ *   Maximum number of elements to free.
+ * @param freed
+ *   Set to the number of elements freed, if not NULL.
+ * @param pending
+ *   Set to the number of elements still queued, if not NULL.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL) if a parameter is invalid.
+ */
+int rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n,
+		unsigned int *freed, unsigned int *pending);
+
+/**
+ * Wait for the grace periods of all the queued elements, free them and
+ * delete the queue.
+ *
+ * @param dq
+ *   Defer queue, NULL is ignored.
+ * @return
+ *   - 0: Success.
+ */
+int rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RCU_QSBR_H_ */
@@ -42,7 +42,7 @@
 
 static int rte_red_init_done = 0;     /**< Flag to indicate that global initialisation is done */
 uint32_t rte_red_rand_val = 0;        /**< Random value cache */
-uint32_t rte_red_rand_seed = 0;       /**< Seed for random number generation */
+uint32_t rte_red_rand_seed = 0;       /**< Unused, rte_fast_rand() relies on rte_rand() */
 
 /**
  * table[i] = log2(1-Wq) * Scale * -1
@@ -142,7 +142,6 @@ rte_red_config_init(struct rte_red_config *red_cfg,
 	 *  Initialize the RED module if not already done
 	 */
 	if (!rte_red_init_done) {
-		rte_red_rand_seed = rte_rand();
 		rte_red_rand_val = rte_fast_rand();
 		__rte_red_init_tables();
 		rte_red_init_done = 1;
@@ -50,6 +50,7 @@ extern "C" {
 #include <rte_common.h>
 #include <rte_debug.h>
 #include <rte_cycles.h>
+#include <rte_random.h>
 #include <rte_branch_prediction.h>
 
 #define RTE_RED_SCALING                     10         /**< Fraction size for fixed-point */
@@ -152,18 +153,15 @@ rte_red_config_init(struct rte_red_config *red_cfg,
 /**
  * @brief Generate random number for RED
  *
- * Implemenetation based on:
- * http://software.intel.com/en-us/articles/fast-random-number-generator-on-the-intel-pentiumr-4-processor/
- *
- * 10 bit shift has been found through empirical tests (was 16).
+ * Uses the per-lcore generator of rte_rand(), so that RED instances running
+ * on different lcores do not share a seed.
  *
  * @return Random number between 0 and (2^22 - 1)
  */
 static inline uint32_t
 rte_fast_rand(void)
 {
-	rte_red_rand_seed = (214013 * rte_red_rand_seed) + 2531011;
-	return rte_red_rand_seed >> 10;
+	return (uint32_t)(rte_rand() >> 42);
 }
 
 /**
@@ -0,0 +1,288 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_STACK_H_
+#define _RTE_STACK_H_
+
+/**
+ * @file
+ * RTE Stack
+ *
+ * A stack is a LIFO of pointers with bulk push and pop operations. The
+ * last pushed objects are the first popped ones, so that the objects
+ * given back are likely to be still in the CPU caches.
+ *
+ * Two implementations are provided, selected at creation time:
+ *  - the standard stack is an array protected by a spinlock;
+ *  - the lock-free stack (RTE_STACK_F_LF) is a linked list updated with
+ *    a 128-bit compare-and-swap of the top pointer and of a modification
+ *    counter, which prevents the ABA problem. A thread preempted while
+ *    using it cannot block the other ones. It is only available on
+ *    x86_64 platforms.
+ *
+ * Push and pop operations are "all or nothing": either all the requested
+ * objects are pushed or popped, or none of them.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_branch_prediction.h>
+
+#define RTE_TAILQ_STACK_NAME "RTE_STACK"
+#define RTE_STACK_MZ_PREFIX "STK_"
+/** The maximum length of a stack name. */
+#define RTE_STACK_NAMESIZE (RTE_MEMZONE_NAMESIZE - \
+			   sizeof(RTE_STACK_MZ_PREFIX) + 1)
+
+#define RTE_STACK_F_LF 0x0001 /**< The stack is lock-free. */
+
+/** Element of a lock-free stack list. */
+struct rte_stack_lf_elem {
+	void *data;                     /**< Stack data. */
+	struct rte_stack_lf_elem *next; /**< Next pointer. */
+};
+
+/** Top of a lock-free stack list, updated with a 128-bit CAS. */
+struct rte_stack_lf_head {
+	struct rte_stack_lf_elem *top; /**< Stack top. */
+	uint64_t cnt; /**< Modification counter for avoiding ABA problem. */
+};
+
+/** List of elements of a lock-free stack. */
+struct rte_stack_lf_list {
+	/** List head, 16-byte aligned for the 128-bit CAS. */
+	struct rte_stack_lf_head head __attribute__((aligned(16)));
+	/** List length. */
+	rte_atomic64_t len;
+};
+
+/**
+ * Structure containing two lock-free LIFO lists: the stack itself and a
+ * list of free linked-list elements.
+ */
+struct rte_stack_lf {
+	/** LIFO list of elements. */
+	struct rte_stack_lf_list used __rte_cache_aligned;
+	/** LIFO list of free elements. */
+	struct rte_stack_lf_list free __rte_cache_aligned;
+	/** LIFO elements. */
+	struct rte_stack_lf_elem elems[] __rte_cache_aligned;
+};
+
+/** Structure containing the LIFO, its current length, and a lock. */
+struct rte_stack_std {
+	rte_spinlock_t lock; /**< LIFO lock. */
+	uint32_t len; /**< LIFO len. */
+	void *objs[]; /**< LIFO pointer table. */
+};
+
+/**
+ * The RTE stack structure contains the LIFO structure itself, plus
+ * metadata such as its name and memzone pointer.
+ */
+struct rte_stack {
+	/** Name of the stack. */
+	char name[RTE_STACK_NAMESIZE] __rte_cache_aligned;
+	/** Memzone containing the rte_stack structure. */
+	const struct rte_memzone *memzone;
+	uint32_t capacity; /**< Usable size of the stack. */
+	uint32_t flags; /**< Flags supplied at creation. */
+	union {
+		struct rte_stack_lf stack_lf; /**< Lock-free LIFO structure. */
+		struct rte_stack_std stack_std; /**< LIFO structure. */
+	};
+} __rte_cache_aligned;
+
+#include "rte_stack_std.h"
+#include "rte_stack_lf.h"
+
+/**
+ * Push several objects on the stack (MT-safe).
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects). The last object of
+ *   the table is pushed last, so it is the first one to be popped.
+ * @param n
+ *   The number of objects to push on the stack from the obj_table.
+ * @return
+ *   Actual number of objects pushed (either 0 or *n*).
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_stack_push(struct rte_stack *s, void * const *obj_table, unsigned int n)
+{
+	if (s->flags & RTE_STACK_F_LF)
+		return __rte_stack_lf_push(s, obj_table, n);
+	else
+		return __rte_stack_std_push(s, obj_table, n);
+}
+
+/**
+ * Pop several objects from the stack (MT-safe).
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects), filled from the top
+ *   of the stack.
+ * @param n
+ *   The number of objects to pull from the stack.
+ * @return
+ *   Actual number of objects popped (either 0 or *n*).
+ */
+static inline unsigned int __attribute__((always_inline))
+rte_stack_pop(struct rte_stack *s, void **obj_table, unsigned int n)
+{
+	if (s->flags & RTE_STACK_F_LF)
+		return __rte_stack_lf_pop(s, obj_table, n);
+	else
+		return __rte_stack_std_pop(s, obj_table, n);
+}
+
+/**
+ * Return the number of used entries in a stack.
+ *
+ * With a lock-free stack, the result may be transiently lower than the
+ * actual number of entries while other threads are pushing objects.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @return
+ *   The number of used entries in the stack.
+ */
+static inline unsigned int
+rte_stack_count(struct rte_stack *s)
+{
+	if (s->flags & RTE_STACK_F_LF)
+		return __rte_stack_lf_count(s);
+	else
+		return __rte_stack_std_count(s);
+}
+
+/**
+ * Return the number of free entries in a stack.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @return
+ *   The number of free entries in the stack.
+ */
+static inline unsigned int
+rte_stack_free_count(struct rte_stack *s)
+{
+	return s->capacity - rte_stack_count(s);
+}
+
+/**
+ * Create a new stack named *name* in memory.
+ *
+ * This function uses ``memzone_reserve()`` to allocate memory for a stack of
+ * size *count*. The behavior of the stack is controlled by the *flags*.
+ *
+ * @param name
+ *   The name of the stack.
+ * @param count
+ *   The size of the stack.
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param flags
+ *   An OR of the following:
+ *    - RTE_STACK_F_LF: If this flag is set, the stack uses lock-free
+ *      variants of the push and pop functions. Otherwise, it achieves
+ *      thread-safety using a lock.
+ * @return
+ *   On success, the pointer to the new allocated stack. NULL on error with
+ *    rte_errno set appropriately. Possible errno values include:
+ *    - ENOSPC - the maximum number of memzones has already been allocated
+ *    - EEXIST - a stack with the same name already exists
+ *    - ENOMEM - insufficient memory to create the stack
+ *    - ENAMETOOLONG - name size exceeds RTE_STACK_NAMESIZE
+ *    - EINVAL - count is 0
+ *    - ENOTSUP - the lock-free stack is not supported on this platform
+ */
+struct rte_stack *
+rte_stack_create(const char *name, unsigned int count, int socket_id,
+		 uint32_t flags);
+
+/**
+ * Free all memory used by the stack.
+ *
+ * @param s
+ *   Stack to free
+ */
+void
+rte_stack_free(struct rte_stack *s);
+
+/**
+ * Lookup a stack by its name.
+ *
+ * @param name
+ *   The name of the stack.
+ * @return
+ *   The pointer to the stack matching the name, or NULL if not found,
+ *   with rte_errno set appropriately. Possible rte_errno values include:
+ *    - ENOENT - Stack with name *name* not found.
+ *    - EINVAL - *name* pointer is NULL.
+ */
+struct rte_stack *
+rte_stack_lookup(const char *name);
+
+/**
+ * Dump the status of the stack to a file.
+ *
+ * @param f
+ *   A pointer to a file for output
+ * @param s
+ *   A pointer to the stack structure.
+ */
+void
+rte_stack_dump(FILE *f, struct rte_stack *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_STACK_H_ */
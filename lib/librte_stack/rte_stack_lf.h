@@ -0,0 +1,267 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_STACK_LF_H_
+#define _RTE_STACK_LF_H_
+
+/**
+ * @file
+ * RTE Stack, lock-free implementation.
+ *
+ * This file is included by rte_stack.h; it must not be included directly.
+ *
+ * The stack is made of two linked lists sharing the same pool of elements:
+ * pushing objects takes elements from the free list, stores the objects in
+ * them and links them on top of the used list; popping does the opposite.
+ * Elements are never freed while the stack exists, so a thread can always
+ * dereference a next pointer read from an element, even if that element
+ * was popped meanwhile: the 128-bit CAS then fails, because the counter of
+ * the list head changed.
+ */
+
+#include <rte_prefetch.h>
+
+#ifdef RTE_ARCH_X86_64
+
+/**
+ * @internal Push a chain of elements, from *first* to *last*, on a list.
+ */
+static inline void __attribute__((always_inline))
+__rte_stack_lf_push_elems(struct rte_stack_lf_list *list,
+			  struct rte_stack_lf_elem *first,
+			  struct rte_stack_lf_elem *last,
+			  unsigned int num)
+{
+	struct rte_stack_lf_head old_head;
+	int success;
+
+	old_head = list->head;
+
+	do {
+		struct rte_stack_lf_head new_head;
+
+		/* Swing the top pointer to the first element in the list and
+		 * make the last element point to the old top.
+		 */
+		new_head.top = first;
+		new_head.cnt = old_head.cnt + 1;
+
+		last->next = old_head.top;
+
+		/* old_head is updated on failure */
+		success = rte_atomic128_cmp_exchange(
+				(rte_int128_t *)&list->head,
+				(rte_int128_t *)&old_head,
+				(rte_int128_t *)&new_head);
+	} while (success == 0);
+
+	rte_atomic64_add(&list->len, num);
+}
+
+/**
+ * @internal Pop a chain of *num* elements from a list, storing their data
+ * in *obj_table* if not NULL. Return the first element of the chain and
+ * its last one in *last*, or NULL if the list has less than *num* elements.
+ */
+static inline struct rte_stack_lf_elem * __attribute__((always_inline))
+__rte_stack_lf_pop_elems(struct rte_stack_lf_list *list,
+			 unsigned int num,
+			 void **obj_table,
+			 struct rte_stack_lf_elem **last)
+{
+	struct rte_stack_lf_head old_head;
+	int success;
+
+	/* Reserve num elements, if available */
+	while (1) {
+		uint64_t len = rte_atomic64_read(&list->len);
+
+		/* Does the list contain enough elements? */
+		if (unlikely(len < num))
+			return NULL;
+
+		if (rte_atomic64_cmpset((volatile uint64_t *)&list->len,
+					len, len - num))
+			break;
+	}
+
+	old_head = list->head;
+
+	/* Pop num elements */
+	do {
+		struct rte_stack_lf_head new_head;
+		struct rte_stack_lf_elem *tmp;
+		unsigned int i;
+
+		rte_smp_rmb();
+
+		tmp = old_head.top;
+
+		/* Traverse the list to find the new head. A next pointer will
+		 * either point to another element or NULL; if a thread
+		 * encounters a pointer that has already been popped, the CAS
+		 * will fail.
+		 */
+		for (i = 0; i < num && tmp != NULL; i++) {
+			rte_prefetch0(tmp->next);
+			if (obj_table)
+				obj_table[i] = tmp->data;
+			if (last)
+				*last = tmp;
+			tmp = tmp->next;
+		}
+
+		/* If NULL was encountered, the list was modified while
+		 * traversing it. Retry.
+		 */
+		if (i != num) {
+			old_head = list->head;
+			success = 0;
+			continue;
+		}
+
+		new_head.top = tmp;
+		new_head.cnt = old_head.cnt + 1;
+
+		/* old_head is updated on failure */
+		success = rte_atomic128_cmp_exchange(
+				(rte_int128_t *)&list->head,
+				(rte_int128_t *)&old_head,
+				(rte_int128_t *)&new_head);
+	} while (success == 0);
+
+	return old_head.top;
+}
+
+#else /* RTE_ARCH_X86_64 */
+
+/* a lock-free stack cannot be created without a 128-bit CAS */
+
+static inline void
+__rte_stack_lf_push_elems(struct rte_stack_lf_list *list __rte_unused,
+			  struct rte_stack_lf_elem *first __rte_unused,
+			  struct rte_stack_lf_elem *last __rte_unused,
+			  unsigned int num __rte_unused)
+{
+}
+
+static inline struct rte_stack_lf_elem *
+__rte_stack_lf_pop_elems(struct rte_stack_lf_list *list __rte_unused,
+			 unsigned int num __rte_unused,
+			 void **obj_table __rte_unused,
+			 struct rte_stack_lf_elem **last __rte_unused)
+{
+	return NULL;
+}
+
+#endif /* RTE_ARCH_X86_64 */
+
+/**
+ * @internal Push several objects on the lock-free stack (MT-safe).
+ */
+static inline unsigned int __attribute__((always_inline))
+__rte_stack_lf_push(struct rte_stack *s,
+		    void * const *obj_table,
+		    unsigned int n)
+{
+	struct rte_stack_lf_elem *tmp, *first, *last = NULL;
+	unsigned int i;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	/* Pop n free elements */
+	first = __rte_stack_lf_pop_elems(&s->stack_lf.free, n, NULL, &last);
+	if (unlikely(first == NULL))
+		return 0;
+
+	/* Construct the list elements, the last object ending on top */
+	for (tmp = first, i = 0; i < n; i++, tmp = tmp->next)
+		tmp->data = obj_table[n - i - 1];
+
+	/* Push them to the used list */
+	__rte_stack_lf_push_elems(&s->stack_lf.used, first, last, n);
+
+	return n;
+}
+
+/**
+ * @internal Pop several objects from the lock-free stack (MT-safe).
+ */
+static inline unsigned int __attribute__((always_inline))
+__rte_stack_lf_pop(struct rte_stack *s, void **obj_table, unsigned int n)
+{
+	struct rte_stack_lf_elem *first, *last = NULL;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	/* Pop n used elements */
+	first = __rte_stack_lf_pop_elems(&s->stack_lf.used,
+					 n, obj_table, &last);
+	if (unlikely(first == NULL))
+		return 0;
+
+	/* Push the list elements to the free list */
+	__rte_stack_lf_push_elems(&s->stack_lf.free, first, last, n);
+
+	return n;
+}
+
+/**
+ * @internal Return the number of used entries in the lock-free stack.
+ */
+static inline unsigned int
+__rte_stack_lf_count(struct rte_stack *s)
+{
+	/* stack_lf_push() and stack_lf_pop() do not update the list's
+	 * contents and stack_lf->len atomically, which can cause the list
+	 * to appear shorter than it actually is if this function is
+	 * called while other threads are modifying the list.
+	 */
+	return (unsigned int)rte_atomic64_read(&s->stack_lf.used.len);
+}
+
+/**
+ * @internal Initialize a lock-free stack.
+ */
+void
+rte_stack_lf_init(struct rte_stack *s, unsigned int count);
+
+/**
+ * @internal Return the memory required for a lock-free stack.
+ */
+ssize_t
+rte_stack_lf_get_memsize(unsigned int count);
+
+#endif /* _RTE_STACK_LF_H_ */
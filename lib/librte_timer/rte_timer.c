@@ -33,6 +33,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
 #include <stdint.h>
 #include <inttypes.h>
 #include <assert.h>
@@ -51,11 +52,69 @@
 #include <rte_branch_prediction.h>
 #include <rte_spinlock.h>
 #include <rte_random.h>
+#include <rte_malloc.h>
 
 #include "rte_timer.h"
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+#define TIMER_WHEEL_LEVELS 5                      /**< number of levels */
+#define TIMER_WHEEL_BITS   8                      /**< log2 of slots/level */
+#define TIMER_WHEEL_SLOTS  (1 << TIMER_WHEEL_BITS) /**< slots per level */
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SLOTS - 1)
+
+/** longest delay held by the wheel, later timers are cascaded again */
+#define TIMER_WHEEL_MAX_DELTA \
+	((1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/**
+ * Hierarchical timing wheel. Level 0 has one slot per tick, each slot of
+ * level n covers 256^n ticks. A timer is stored in the lowest level able
+ * to hold its delay, and timers of a level n slot are moved down
+ * (cascaded) when the wheel enters the range of ticks covered by the slot.
+ */
+struct timer_wheel {
+	/** next tick to expire; previous ticks are done and the slots
+	 *  starting at this tick are already cascaded */
+	uint64_t cur_tick;
+	unsigned nb_pending;                          /**< timers in wheel */
+	unsigned level_count[TIMER_WHEEL_LEVELS];     /**< timers per level */
+	struct rte_timer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+#define TIMER_MSG_RING_SIZE RTE_LIBRTE_TIMER_MSG_RING_SIZE
+#define TIMER_MSG_RING_MASK (TIMER_MSG_RING_SIZE - 1)
+
+/** operations posted to the lcore holding a timer in message mode */
+enum timer_msg_op {
+	TIMER_MSG_ADD,  /**< set and add a timer which is in no list */
+	TIMER_MSG_MOVE, /**< remove a pending timer, set and add it */
+	TIMER_MSG_DEL,  /**< remove a pending timer and stop it */
+};
+
+struct timer_msg {
+	volatile uint32_t seq;  /**< position of the message in the ring */
+	enum timer_msg_op op;
+	unsigned tim_lcore;     /**< lcore where to add the timer */
+	struct rte_timer *tim;
+	uint64_t expire;
+	uint64_t period;
+	rte_timer_cb_t f;
+	void *arg;
+};
+
+/**
+ * Bounded multi-producer/single-consumer ring of timer operations. The
+ * slot for position pos is free when its seq is pos, and holds a message
+ * when its seq is pos + 1; the consumer then releases it for the position
+ * pos + TIMER_MSG_RING_SIZE.
+ */
+struct timer_msg_ring {
+	volatile uint32_t head;                /**< next position to post */
+	uint32_t tail __rte_cache_aligned;     /**< next position to read */
+	struct timer_msg msgs[TIMER_MSG_RING_SIZE] __rte_cache_aligned;
+};
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
@@ -69,6 +128,12 @@ struct priv_timer {
 
 	unsigned prev_lcore;              /**< used for lcore round robin */
 
+	struct timer_wheel wheel;    /**< pending timers for wheel backend */
+
+	struct timer_msg_ring *msg_ring; /**< operations from other lcores */
+	/** moved timers that could not be posted to their new lcore yet */
+	struct rte_timer *msg_backlog;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
@@ -78,6 +143,21 @@ struct priv_timer {
 /** per-lcore private info for timers */
 static struct priv_timer priv_timer[RTE_MAX_LCORE];
 
+#ifdef RTE_LIBRTE_TIMER_WHEEL
+#define TIMER_DEFAULT_BACKEND RTE_TIMER_BACKEND_WHEEL
+#else
+#define TIMER_DEFAULT_BACKEND RTE_TIMER_BACKEND_SKIPLIST
+#endif
+
+/** data structure holding the pending timers */
+static enum rte_timer_backend timer_backend = TIMER_DEFAULT_BACKEND;
+
+/** a wheel tick lasts (1 << wheel_tick_shift) timer cycles */
+static unsigned wheel_tick_shift;
+
+/** how lcores update the pending timers of other lcores */
+static enum rte_timer_remote_mode timer_remote_mode = RTE_TIMER_REMOTE_LOCK;
+
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 #define __TIMER_STAT_ADD(name, n) do {					\
@@ -89,11 +169,23 @@ static struct priv_timer priv_timer[RTE_MAX_LCORE];
 #define __TIMER_STAT_ADD(name, n) do {} while(0)
 #endif
 
+/* start the wheels at current time, they must be empty */
+static void
+timer_wheel_reset_time(void)
+{
+	uint64_t cur_tick = rte_get_timer_cycles() >> wheel_tick_shift;
+	unsigned lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		priv_timer[lcore_id].wheel.cur_tick = cur_tick;
+}
+
 /* Init the timer library. */
 void
 rte_timer_subsystem_init(void)
 {
 	unsigned lcore_id;
+	uint64_t hz_per_us;
 
 	/* since priv_timer is static, it's zeroed by default, so only init some
 	 * fields.
@@ -102,6 +194,191 @@ rte_timer_subsystem_init(void)
 		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
 		priv_timer[lcore_id].prev_lcore = lcore_id;
 	}
+
+	/* use the largest power of 2 cycles not above 1us as wheel tick */
+	hz_per_us = rte_get_timer_hz() / 1000000;
+	wheel_tick_shift = 0;
+	while ((2ULL << wheel_tick_shift) <= hz_per_us)
+		wheel_tick_shift++;
+	timer_wheel_reset_time();
+}
+
+/* return 1 if no timer is pending and no operation is posted */
+static int
+timer_subsystem_is_idle(void)
+{
+	struct timer_msg_ring *ring;
+	unsigned lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		ring = priv_timer[lcore_id].msg_ring;
+		if (priv_timer[lcore_id].pending_head.sl_next[0] != NULL ||
+		    priv_timer[lcore_id].wheel.nb_pending != 0 ||
+		    priv_timer[lcore_id].msg_backlog != NULL ||
+		    (ring != NULL && ring->head != ring->tail))
+			return 0;
+	}
+	return 1;
+}
+
+/* Select the data structure holding pending timers */
+int
+rte_timer_subsystem_set_backend(enum rte_timer_backend backend)
+{
+	if (backend != RTE_TIMER_BACKEND_SKIPLIST &&
+	    backend != RTE_TIMER_BACKEND_WHEEL)
+		return -EINVAL;
+
+	if (!timer_subsystem_is_idle())
+		return -EBUSY;
+
+	if (backend == RTE_TIMER_BACKEND_WHEEL)
+		timer_wheel_reset_time();
+	timer_backend = backend;
+	return 0;
+}
+
+/* Get the data structure holding pending timers */
+enum rte_timer_backend
+rte_timer_subsystem_get_backend(void)
+{
+	return timer_backend;
+}
+
+/*
+ * check if timers can be pending on an lcore: any lcore used by the EAL,
+ * service lcores included, as their role can change at runtime
+ */
+static inline int
+timer_lcore_is_used(unsigned lcore_id)
+{
+	return lcore_id < RTE_MAX_LCORE &&
+		rte_eal_lcore_role(lcore_id) != ROLE_OFF;
+}
+
+/* allocate the message ring of an lcore */
+static int
+timer_msg_ring_create(unsigned lcore_id)
+{
+	struct timer_msg_ring *ring;
+	uint32_t i;
+
+	RTE_BUILD_BUG_ON((TIMER_MSG_RING_SIZE & TIMER_MSG_RING_MASK) != 0);
+
+	ring = rte_zmalloc_socket("timer_msg_ring", sizeof(*ring),
+			RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(lcore_id));
+	if (ring == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < TIMER_MSG_RING_SIZE; i++)
+		ring->msgs[i].seq = i;
+	priv_timer[lcore_id].msg_ring = ring;
+	return 0;
+}
+
+/* Select how lcores update the pending timers of other lcores */
+int
+rte_timer_subsystem_set_remote_mode(enum rte_timer_remote_mode mode)
+{
+	unsigned lcore_id;
+	int ret;
+
+	if (mode != RTE_TIMER_REMOTE_LOCK && mode != RTE_TIMER_REMOTE_MSG)
+		return -EINVAL;
+
+	if (!timer_subsystem_is_idle())
+		return -EBUSY;
+
+	/* rings are kept when going back to lock mode, they are empty */
+	if (mode == RTE_TIMER_REMOTE_MSG) {
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			if (!timer_lcore_is_used(lcore_id) ||
+			    priv_timer[lcore_id].msg_ring != NULL)
+				continue;
+			ret = timer_msg_ring_create(lcore_id);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
+	timer_remote_mode = mode;
+	return 0;
+}
+
+/* Get how lcores update the pending timers of other lcores */
+enum rte_timer_remote_mode
+rte_timer_subsystem_get_remote_mode(void)
+{
+	return timer_remote_mode;
+}
+
+/*
+ * Post an operation to the ring of lcore_id, return -ENOSPC if it is full,
+ * or -ENODEV if lcore_id has no ring. The timer must be in config state,
+ * it is owned by the message until lcore_id sets its new state.
+ */
+static int
+timer_msg_post(unsigned lcore_id, const struct timer_msg *msg)
+{
+	struct timer_msg_ring *ring = priv_timer[lcore_id].msg_ring;
+	struct timer_msg *slot;
+	uint32_t pos;
+	int32_t diff;
+
+	if (unlikely(ring == NULL))
+		return -ENODEV;
+
+	do {
+		pos = ring->head;
+		slot = &ring->msgs[pos & TIMER_MSG_RING_MASK];
+		diff = (int32_t)(slot->seq - pos);
+
+		/* slot still holds the message of the previous round */
+		if (diff < 0)
+			return -ENOSPC;
+
+		/* another producer took this position, reload head */
+		if (diff > 0)
+			continue;
+	} while (rte_atomic32_cmpset(&ring->head, pos, pos + 1) == 0);
+
+	slot->op = msg->op;
+	slot->tim_lcore = msg->tim_lcore;
+	slot->tim = msg->tim;
+	slot->expire = msg->expire;
+	slot->period = msg->period;
+	slot->f = msg->f;
+	slot->arg = msg->arg;
+
+	/* publish the message */
+	rte_smp_wmb();
+	slot->seq = pos + 1;
+	return 0;
+}
+
+/* Read the next operation of a ring, return -1 if it is empty */
+static int
+timer_msg_get(struct timer_msg_ring *ring, struct timer_msg *msg)
+{
+	struct timer_msg *slot = &ring->msgs[ring->tail & TIMER_MSG_RING_MASK];
+
+	if (slot->seq != ring->tail + 1)
+		return -1;
+	rte_smp_rmb();
+
+	msg->op = slot->op;
+	msg->tim_lcore = slot->tim_lcore;
+	msg->tim = slot->tim;
+	msg->expire = slot->expire;
+	msg->period = slot->period;
+	msg->f = slot->f;
+	msg->arg = slot->arg;
+
+	/* release the slot once it is read */
+	rte_smp_mb();
+	slot->seq = ring->tail + TIMER_MSG_RING_SIZE;
+	ring->tail++;
+	return 0;
 }
 
 /* Initialize the timer handle tim for use */
@@ -266,23 +543,14 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 }
 
 /*
- * add in list, lock if needed
- * timer must be in config state
- * timer must not be in a list
+ * add in skiplist of tim_lcore, list must be locked
  */
 static void
-timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+timer_skiplist_add(struct rte_timer *tim, unsigned tim_lcore)
 {
-	unsigned lcore_id = rte_lcore_id();
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs to be scheduled on another core, we need to
-	 * lock the list; if it is on local core, we need to lock if
-	 * we are not called from rte_timer_manage() */
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
-
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
 	timer_get_prev_entries(tim->expire, tim_lcore, prev);
@@ -306,31 +574,17 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	 * NOTE: this is not atomic on 32-bit*/
 	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
-
-	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
 
 /*
- * del from list, lock if needed
- * timer must be in config state
- * timer must be in a list
+ * del from skiplist of prev_owner, list must be locked
  */
 static void
-timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
-		int local_is_locked)
+timer_skiplist_del(struct rte_timer *tim, unsigned prev_owner)
 {
-	unsigned lcore_id = rte_lcore_id();
-	unsigned prev_owner = prev_status.owner;
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs is pending another core, we need to lock the
-	 * list; if it is on local core, we need to lock if we are not
-	 * called from rte_timer_manage() */
-	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
-
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -350,9 +604,215 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 			priv_timer[prev_owner].curr_skiplist_depth --;
 		else
 			break;
+}
+
+/* link a timer at the head of a wheel slot */
+static inline void
+timer_wheel_slot_insert(struct rte_timer **slot, struct rte_timer *tim)
+{
+	tim->wh.next = *slot;
+	if (*slot != NULL)
+		(*slot)->wh.pprev = &tim->wh.next;
+	tim->wh.pprev = slot;
+	*slot = tim;
+}
+
+/*
+ * Store a timer in the wheel according to its expire time. A timer
+ * whose expire tick is already past goes in the slot of the current
+ * tick, so it is expired by the next call to rte_timer_manage().
+ */
+static void
+timer_wheel_insert(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	uint64_t tick = tim->expire >> wheel_tick_shift;
+	uint64_t delta;
+	unsigned level = 0;
+
+	if (tick < wheel->cur_tick)
+		tick = wheel->cur_tick;
+	delta = tick - wheel->cur_tick;
+
+	/* too far in the future, park it in the last slot that the wheel
+	 * can address, it will be cascaded there again later */
+	if (delta > TIMER_WHEEL_MAX_DELTA) {
+		delta = TIMER_WHEEL_MAX_DELTA;
+		tick = wheel->cur_tick + delta;
+	}
+
+	while (delta >= ((uint64_t)TIMER_WHEEL_SLOTS <<
+			(level * TIMER_WHEEL_BITS)))
+		level++;
+
+	tim->wh.level = level;
+	wheel->level_count[level]++;
+	wheel->nb_pending++;
+	timer_wheel_slot_insert(&wheel->slots[level]
+			[(tick >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK],
+			tim);
+}
+
+/*
+ * add in wheel of tim_lcore, list must be locked
+ */
+static void
+timer_wheel_add(struct rte_timer *tim, unsigned tim_lcore)
+{
+	struct timer_wheel *wheel = &priv_timer[tim_lcore].wheel;
+	uint64_t cur_tick;
+
+	/* an empty wheel has nothing left to expire or cascade, move it
+	 * to the current time so that it does not have to catch up */
+	if (wheel->nb_pending == 0) {
+		cur_tick = rte_get_timer_cycles() >> wheel_tick_shift;
+		if (cur_tick > wheel->cur_tick)
+			wheel->cur_tick = cur_tick;
+	}
+
+	timer_wheel_insert(wheel, tim);
+}
+
+/*
+ * del from wheel of prev_owner, list must be locked
+ */
+static void
+timer_wheel_del(struct rte_timer *tim, unsigned prev_owner)
+{
+	struct timer_wheel *wheel = &priv_timer[prev_owner].wheel;
+
+	/* a periodic timer is reloaded while rte_timer_manage() holds it
+	 * in its run list, out of the wheel */
+	if (tim->wh.pprev == NULL)
+		return;
+
+	if (tim->wh.next != NULL)
+		tim->wh.next->wh.pprev = tim->wh.pprev;
+	*tim->wh.pprev = tim->wh.next;
+
+	wheel->level_count[tim->wh.level]--;
+	wheel->nb_pending--;
+}
+
+/* add in list of tim_lcore, list must be locked */
+static inline void
+timer_list_add(struct rte_timer *tim, unsigned tim_lcore)
+{
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL)
+		timer_wheel_add(tim, tim_lcore);
+	else
+		timer_skiplist_add(tim, tim_lcore);
+}
+
+/* del from list of prev_owner, list must be locked */
+static inline void
+timer_list_del(struct rte_timer *tim, unsigned prev_owner)
+{
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL)
+		timer_wheel_del(tim, prev_owner);
+	else
+		timer_skiplist_del(tim, prev_owner);
+}
+
+/* in message mode, only the lcore owning a list accesses it */
+static inline void
+timer_list_lock(unsigned lcore_id)
+{
+	if (timer_remote_mode == RTE_TIMER_REMOTE_LOCK)
+		rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+}
+
+static inline void
+timer_list_unlock(unsigned lcore_id)
+{
+	if (timer_remote_mode == RTE_TIMER_REMOTE_LOCK)
+		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+}
+
+/*
+ * add in list, lock if needed
+ * timer must be in config state
+ * timer must not be in a list
+ */
+static void
+timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	/* if timer needs to be scheduled on another core, we need to
+	 * lock the list; if it is on local core, we need to lock if
+	 * we are not called from rte_timer_manage() */
+	if (tim_lcore != lcore_id || !local_is_locked)
+		timer_list_lock(tim_lcore);
+
+	timer_list_add(tim, tim_lcore);
+
+	if (tim_lcore != lcore_id || !local_is_locked)
+		timer_list_unlock(tim_lcore);
+}
+
+/*
+ * del from list, lock if needed
+ * timer must be in config state
+ * timer must be in a list
+ */
+static void
+timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
+		int local_is_locked)
+{
+	unsigned lcore_id = rte_lcore_id();
+	unsigned prev_owner = prev_status.owner;
+
+	/* if timer needs is pending another core, we need to lock the
+	 * list; if it is on local core, we need to lock if we are not
+	 * called from rte_timer_manage() */
+	if (prev_owner != lcore_id || !local_is_locked)
+		timer_list_lock(prev_owner);
+
+	timer_list_del(tim, prev_owner);
 
 	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
+		timer_list_unlock(prev_owner);
+}
+
+/*
+ * Message mode: post the reset of a timer which is pending on another
+ * lcore, or which must be added on another lcore. The timer is in config
+ * state until the lcore handling the message sets it pending.
+ */
+static int
+timer_msg_reset(struct rte_timer *tim, union rte_timer_status prev_status,
+		uint64_t expire, uint64_t period, unsigned tim_lcore,
+		rte_timer_cb_t fct, void *arg)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct timer_msg msg;
+
+	msg.tim_lcore = tim_lcore;
+	msg.tim = tim;
+	msg.expire = expire;
+	msg.period = period;
+	msg.f = fct;
+	msg.arg = arg;
+
+	/* only the lcore where the timer is pending can remove it */
+	if (prev_status.state == RTE_TIMER_PENDING &&
+	    (unsigned)prev_status.owner != lcore_id) {
+		msg.op = TIMER_MSG_MOVE;
+		return timer_msg_post(prev_status.owner, &msg);
+	}
+
+	/* remove it from local list, put it back if post fails */
+	if (prev_status.state == RTE_TIMER_PENDING)
+		timer_list_del(tim, lcore_id);
+
+	msg.op = TIMER_MSG_ADD;
+	if (timer_msg_post(tim_lcore, &msg) < 0) {
+		if (prev_status.state == RTE_TIMER_PENDING)
+			timer_list_add(tim, lcore_id);
+		return -1;
+	}
+
+	return 0;
 }
 
 /* Reset and start the timer associated with the timer handle (private func) */
@@ -386,6 +846,29 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	if (ret < 0)
 		return -1;
 
+	/* in message mode, lists of other lcores are updated by them */
+	if (timer_remote_mode == RTE_TIMER_REMOTE_MSG &&
+	    (tim_lcore != lcore_id ||
+	     (prev_status.state == RTE_TIMER_PENDING &&
+	      (unsigned)prev_status.owner != lcore_id))) {
+		ret = timer_msg_reset(tim, prev_status, expire, period,
+				tim_lcore, fct, arg);
+		if (ret < 0) {
+			/* restore the timer, nobody else can modify it */
+			rte_wmb();
+			tim->status.u32 = prev_status.u32;
+			return -1;
+		}
+
+		__TIMER_STAT_ADD(reset, 1);
+		if (prev_status.state != RTE_TIMER_PENDING)
+			__TIMER_STAT_ADD(pending, 1);
+		if (prev_status.state == RTE_TIMER_RUNNING &&
+		    lcore_id < RTE_MAX_LCORE)
+			priv_timer[lcore_id].updated = 1;
+		return 0;
+	}
+
 	__TIMER_STAT_ADD(reset, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
@@ -426,7 +909,7 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 	uint64_t period;
 
 	if (unlikely((tim_lcore != (unsigned)LCORE_ID_ANY) &&
-			!rte_lcore_is_enabled(tim_lcore)))
+			!timer_lcore_is_used(tim_lcore)))
 		return -1;
 
 	if (type == PERIODICAL)
@@ -463,6 +946,26 @@ rte_timer_stop(struct rte_timer *tim)
 	if (ret < 0)
 		return -1;
 
+	/* in message mode, the lcore where the timer is pending removes
+	 * it; until then the timer is in config state and cannot be freed */
+	if (timer_remote_mode == RTE_TIMER_REMOTE_MSG &&
+	    prev_status.state == RTE_TIMER_PENDING &&
+	    (unsigned)prev_status.owner != lcore_id) {
+		struct timer_msg msg = {
+			.op = TIMER_MSG_DEL,
+			.tim = tim,
+		};
+
+		if (timer_msg_post(prev_status.owner, &msg) < 0) {
+			rte_wmb();
+			tim->status.u32 = prev_status.u32;
+			return -1;
+		}
+		__TIMER_STAT_ADD(stop, 1);
+		__TIMER_STAT_ADD(pending, -1);
+		return -EINPROGRESS;
+	}
+
 	__TIMER_STAT_ADD(stop, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
@@ -499,6 +1002,224 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
+/*
+ * Detach the timers of lcore_id skiplist that are expired at cur_time,
+ * list must be locked. Return them chained by sl_next[0].
+ */
+static struct rte_timer *
+timer_skiplist_get_expired(unsigned lcore_id, uint64_t cur_time)
+{
+	struct rte_timer *tim;
+	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
+	int i;
+
+	/* if nothing to do just return */
+	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
+	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time)
+		return NULL;
+
+	/* save start of list of expired timers */
+	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+
+	/* break the existing list at current time point */
+	timer_get_prev_entries(cur_time, lcore_id, prev);
+	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
+		priv_timer[lcore_id].pending_head.sl_next[i] =
+		    prev[i]->sl_next[i];
+		if (prev[i]->sl_next[i] == NULL)
+			priv_timer[lcore_id].curr_skiplist_depth--;
+		prev[i] ->sl_next[i] = NULL;
+	}
+
+	/* update the next to expire timer value */
+	priv_timer[lcore_id].pending_head.expire =
+	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
+		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
+
+	return tim;
+}
+
+/*
+ * The wheel has just entered cur_tick: move down the timers of the
+ * upper level slots whose range starts at this tick.
+ */
+static void
+timer_wheel_cascade(struct timer_wheel *wheel)
+{
+	struct rte_timer *tim, *next_tim;
+	unsigned level, idx;
+
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		/* a new slot of this level starts when the index in the
+		 * level below wraps to 0 */
+		if (((wheel->cur_tick >> ((level - 1) * TIMER_WHEEL_BITS)) &
+				TIMER_WHEEL_MASK) != 0)
+			break;
+
+		idx = (wheel->cur_tick >> (level * TIMER_WHEEL_BITS)) &
+			TIMER_WHEEL_MASK;
+		tim = wheel->slots[level][idx];
+		wheel->slots[level][idx] = NULL;
+		for ( ; tim != NULL; tim = next_tim) {
+			next_tim = tim->wh.next;
+			wheel->level_count[level]--;
+			wheel->nb_pending--;
+			timer_wheel_insert(wheel, tim);
+		}
+	}
+}
+
+/*
+ * Detach the timers of lcore_id wheel that are expired at cur_time,
+ * list must be locked. Return them chained by sl_next[0].
+ */
+static struct rte_timer *
+timer_wheel_get_expired(unsigned lcore_id, uint64_t cur_time)
+{
+	struct timer_wheel *wheel = &priv_timer[lcore_id].wheel;
+	uint64_t cur_tick = cur_time >> wheel_tick_shift;
+	uint64_t next_tick;
+	struct rte_timer *tim, *next_tim;
+	struct rte_timer *run_first_tim, **pprev;
+	unsigned level, shift;
+
+	run_first_tim = NULL;
+	pprev = &run_first_tim;
+
+	/* the slots of the ticks before cur_tick are expired as a whole */
+	while (wheel->cur_tick < cur_tick && wheel->nb_pending != 0) {
+		for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+			if (wheel->level_count[level] != 0)
+				break;
+
+		if (level == 0) {
+			tim = wheel->slots[0][wheel->cur_tick &
+				TIMER_WHEEL_MASK];
+			wheel->slots[0][wheel->cur_tick & TIMER_WHEEL_MASK] =
+				NULL;
+			for ( ; tim != NULL; tim = next_tim) {
+				next_tim = tim->wh.next;
+				wheel->level_count[0]--;
+				wheel->nb_pending--;
+				tim->wh.pprev = NULL;
+				*pprev = tim;
+				pprev = &tim->sl_next[0];
+			}
+			next_tick = wheel->cur_tick + 1;
+		} else {
+			/* lower levels are empty, skip the ticks up to the
+			 * next cascade of this level */
+			shift = level * TIMER_WHEEL_BITS;
+			next_tick = ((wheel->cur_tick >> shift) + 1) << shift;
+			if (next_tick > cur_tick)
+				next_tick = cur_tick;
+		}
+
+		wheel->cur_tick = next_tick;
+		timer_wheel_cascade(wheel);
+	}
+
+	/* nothing left to cascade, just move to the current time */
+	if (wheel->nb_pending == 0) {
+		if (wheel->cur_tick < cur_tick)
+			wheel->cur_tick = cur_tick;
+		*pprev = NULL;
+		return run_first_tim;
+	}
+
+	/* the slot of the current tick is partly elapsed */
+	tim = wheel->slots[0][wheel->cur_tick & TIMER_WHEEL_MASK];
+	for ( ; tim != NULL; tim = next_tim) {
+		next_tim = tim->wh.next;
+		if (tim->expire > cur_time)
+			continue;
+		timer_wheel_del(tim, lcore_id);
+		tim->wh.pprev = NULL;
+		*pprev = tim;
+		pprev = &tim->sl_next[0];
+	}
+
+	*pprev = NULL;
+	return run_first_tim;
+}
+
+/*
+ * Message mode: add a timer which is in no list on tim_lcore, locally or
+ * by posting it. If the ring of tim_lcore is full, the timer stays in the
+ * backlog of the local lcore, with tim_lcore saved as owner.
+ */
+static void
+timer_msg_forward(struct rte_timer *tim, unsigned tim_lcore)
+{
+	unsigned lcore_id = rte_lcore_id();
+	union rte_timer_status status;
+	struct timer_msg msg;
+
+	if (tim_lcore == lcore_id) {
+		timer_list_add(tim, lcore_id);
+		rte_wmb();
+		status.state = RTE_TIMER_PENDING;
+		status.owner = (int16_t)lcore_id;
+		tim->status.u32 = status.u32;
+		return;
+	}
+
+	msg.op = TIMER_MSG_ADD;
+	msg.tim_lcore = tim_lcore;
+	msg.tim = tim;
+	msg.expire = tim->expire;
+	msg.period = tim->period;
+	msg.f = tim->f;
+	msg.arg = tim->arg;
+	if (timer_msg_post(tim_lcore, &msg) == 0)
+		return;
+
+	status.state = RTE_TIMER_CONFIG;
+	status.owner = (int16_t)tim_lcore;
+	tim->status.u32 = status.u32;
+	tim->sl_next[0] = priv_timer[lcore_id].msg_backlog;
+	priv_timer[lcore_id].msg_backlog = tim;
+}
+
+/* Message mode: apply the operations posted by other lcores */
+static void
+timer_msg_process(unsigned lcore_id)
+{
+	union rte_timer_status status;
+	struct rte_timer *tim, *next_tim;
+	struct timer_msg msg;
+
+	/* first retry to move the timers of the backlog */
+	tim = priv_timer[lcore_id].msg_backlog;
+	priv_timer[lcore_id].msg_backlog = NULL;
+	for ( ; tim != NULL; tim = next_tim) {
+		next_tim = tim->sl_next[0];
+		timer_msg_forward(tim, tim->status.owner);
+	}
+
+	while (timer_msg_get(priv_timer[lcore_id].msg_ring, &msg) == 0) {
+		tim = msg.tim;
+
+		/* timer is pending here, unless it is added */
+		if (msg.op != TIMER_MSG_ADD)
+			timer_list_del(tim, lcore_id);
+
+		if (msg.op == TIMER_MSG_DEL) {
+			rte_wmb();
+			status.state = RTE_TIMER_STOP;
+			status.owner = RTE_TIMER_NO_OWNER;
+			tim->status.u32 = status.u32;
+			continue;
+		}
+
+		tim->expire = msg.expire;
+		tim->period = msg.period;
+		tim->f = msg.f;
+		tim->arg = msg.arg;
+		timer_msg_forward(tim, msg.tim_lcore);
+	}
+}
+
 /* must be called periodically, run all timer that expired */
 void rte_timer_manage(void)
 {
@@ -506,48 +1227,63 @@ void rte_timer_manage(void)
 	struct rte_timer *tim, *next_tim;
 	struct rte_timer *run_first_tim, **pprev;
 	unsigned lcore_id = rte_lcore_id();
-	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
-	int i, ret;
+	int ret;
 
 	/* timer manager only runs on EAL thread with valid lcore_id */
 	assert(lcore_id < RTE_MAX_LCORE);
 
 	__TIMER_STAT_ADD(manage, 1);
-	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
-		return;
-	cur_time = rte_get_timer_cycles();
+
+	/* apply the operations posted by other lcores before expiring */
+	if (timer_remote_mode == RTE_TIMER_REMOTE_MSG &&
+	    priv_timer[lcore_id].msg_ring != NULL)
+		timer_msg_process(lcore_id);
+
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL) {
+		/* optimize for the case where per-cpu wheel is empty */
+		if (priv_timer[lcore_id].wheel.nb_pending == 0)
+			return;
+		cur_time = rte_get_timer_cycles();
 
 #ifdef RTE_ARCH_X86_64
-	/* on 64-bit the value cached in the pending_head.expired will be
-	 * updated atomically, so we can consult that for a quick check here
-	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
-		return;
+		/* same quick check as below: nothing to do if the wheel
+		 * is still in the same tick and its slot is empty */
+		if (likely((cur_time >> wheel_tick_shift) ==
+				priv_timer[lcore_id].wheel.cur_tick &&
+			   priv_timer[lcore_id].wheel.slots[0]
+				[(cur_time >> wheel_tick_shift) &
+				 TIMER_WHEEL_MASK] == NULL))
+			return;
 #endif
+	} else {
+		/* optimize for the case where per-cpu list is empty */
+		if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
+			return;
+		cur_time = rte_get_timer_cycles();
 
-	/* browse ordered list, add expired timers in 'expired' list */
-	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
-
-	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
-		return;
+#ifdef RTE_ARCH_X86_64
+		/* on 64-bit the value cached in the pending_head.expired
+		 * will be updated atomically, so we can consult that for a
+		 * quick check here outside the lock */
+		if (likely(priv_timer[lcore_id].pending_head.expire >
+				cur_time))
+			return;
+#endif
 	}
 
-	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+	/* add expired timers in 'expired' list */
+	timer_list_lock(lcore_id);
 
-	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		priv_timer[lcore_id].pending_head.sl_next[i] =
-		    prev[i]->sl_next[i];
-		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
-		prev[i] ->sl_next[i] = NULL;
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL)
+		tim = timer_wheel_get_expired(lcore_id, cur_time);
+	else
+		tim = timer_skiplist_get_expired(lcore_id, cur_time);
+
+	/* if nothing to do just unlock and return */
+	if (tim == NULL) {
+		timer_list_unlock(lcore_id);
+		return;
 	}
 
 	/* transition run-list from PENDING to RUNNING */
@@ -563,18 +1299,13 @@ void rte_timer_manage(void)
 		} else {
 			/* another core is trying to re-config this one,
 			 * remove it from local expired list and put it
-			 * back on the priv_timer[] skip list */
+			 * back on the priv_timer[] pending timers */
 			*pprev = next_tim;
 			timer_add(tim, lcore_id, 1);
 		}
 	}
 
-	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
-
-	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	timer_list_unlock(lcore_id);
 
 	/* now scan expired list and call callbacks */
 	for (tim = run_first_tim; tim != NULL; tim = next_tim) {
@@ -599,7 +1330,7 @@ void rte_timer_manage(void)
 		}
 		else {
 			/* keep it in list and mark timer as pending */
-			rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+			timer_list_lock(lcore_id);
 			status.state = RTE_TIMER_PENDING;
 			__TIMER_STAT_ADD(pending, 1);
 			status.owner = (int16_t)lcore_id;
@@ -607,7 +1338,7 @@ void rte_timer_manage(void)
 			tim->status.u32 = status.u32;
 			__rte_timer_reset(tim, cur_time + tim->period,
 				tim->period, lcore_id, tim->f, tim->arg, 1);
-			rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+			timer_list_unlock(lcore_id);
 		}
 	}
 }
@@ -119,13 +119,38 @@ typedef void (*rte_timer_cb_t)(struct rte_timer *, void *);
 
 #define MAX_SKIPLIST_DEPTH 10
 
+/**
+ * Data structure used to keep the pending timers of each lcore.
+ */
+enum rte_timer_backend {
+	RTE_TIMER_BACKEND_SKIPLIST, /**< Skiplist ordered by expiry time. */
+	RTE_TIMER_BACKEND_WHEEL,    /**< Hierarchical timing wheel. */
+};
+
+/**
+ * How an lcore updates the pending timers of another lcore.
+ */
+enum rte_timer_remote_mode {
+	RTE_TIMER_REMOTE_LOCK, /**< Lock the timer list of the lcore. */
+	RTE_TIMER_REMOTE_MSG,  /**< Post to the message ring of the lcore. */
+};
+
 /**
  * A structure describing a timer in RTE.
  */
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	union {
+		/** Skiplist links, used by the skiplist backend. */
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/** Wheel slot links, used by the timer wheel backend. */
+		struct {
+			struct rte_timer *next;   /**< Next timer in slot. */
+			struct rte_timer **pprev; /**< Link to this timer. */
+			unsigned level;           /**< Wheel level of slot. */
+		} wh;
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t f;      /**< Callback function. */
@@ -139,7 +164,7 @@ struct rte_timer
  */
 #define RTE_TIMER_INITIALIZER {             \
 	0,                                      \
-	{NULL},                                 \
+	{{NULL}},                               \
 	{{RTE_TIMER_STOP, RTE_TIMER_NO_OWNER}}, \
 	0,                                      \
 	NULL,                                   \
@@ -165,6 +190,76 @@ struct rte_timer
  */
 void rte_timer_subsystem_init(void);
 
+/**
+ * Select the data structure used to keep pending timers.
+ *
+ * The default backend is the skiplist, unless the library is built with
+ * CONFIG_RTE_LIBRTE_TIMER_WHEEL. The skiplist keeps timers sorted by
+ * expiry time and costs O(log n) per reset or stop. The timer wheel
+ * hashes timers into per-lcore slots of about one microsecond, so that
+ * reset and stop are O(1) and rte_timer_manage() expires whole slots at
+ * once; timers expiring in the same slot are not run in expiry order.
+ *
+ * The backend can only be changed when no timer is pending, typically
+ * right after rte_timer_subsystem_init(), and must not be changed while
+ * other lcores use timers.
+ *
+ * @param backend
+ *   The backend to use for all lcores.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Unknown backend.
+ *   - (-EBUSY): Some timers are pending.
+ */
+int rte_timer_subsystem_set_backend(enum rte_timer_backend backend);
+
+/**
+ * Get the data structure used to keep pending timers.
+ *
+ * @return
+ *   The current timer backend.
+ */
+enum rte_timer_backend rte_timer_subsystem_get_backend(void);
+
+/**
+ * Select how timers are reset or stopped from another lcore.
+ *
+ * By default, an lcore resetting or stopping a timer pending on another
+ * lcore, or adding a timer on another lcore, takes the lock of the timer
+ * list of that lcore, which rte_timer_manage() also takes.
+ *
+ * In message mode, each lcore only accesses its own timer list and never
+ * takes a lock. Operations on other lcores are posted to their message
+ * ring of RTE_LIBRTE_TIMER_MSG_RING_SIZE entries, and applied by them at
+ * the beginning of rte_timer_manage(). Until then, the timer is in the
+ * CONFIG state: rte_timer_reset() and rte_timer_stop() fail on it and
+ * rte_timer_pending() returns 0. Also, stopping a timer pending on another
+ * lcore returns -EINPROGRESS once the stop is posted, as the timer cannot
+ * be freed before it is removed; rte_timer_stop_sync() returns once it is
+ * done. All lcores having timers must then call rte_timer_manage()
+ * regularly.
+ *
+ * The mode can only be changed when no timer is pending, and must not be
+ * changed while other lcores use timers.
+ *
+ * @param mode
+ *   The mode to use for all lcores.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Unknown mode.
+ *   - (-EBUSY): Some timers are pending.
+ *   - (-ENOMEM): Message rings cannot be allocated.
+ */
+int rte_timer_subsystem_set_remote_mode(enum rte_timer_remote_mode mode);
+
+/**
+ * Get how timers are reset or stopped from another lcore.
+ *
+ * @return
+ *   The current remote mode.
+ */
+enum rte_timer_remote_mode rte_timer_subsystem_get_remote_mode(void);
+
 /**
  * Initialize a timer handle.
  *
@@ -209,15 +304,17 @@ void rte_timer_init(struct rte_timer *tim);
  *     STOPPED state after execution.
  * @param tim_lcore
  *   The ID of the lcore where the timer callback function has to be
- *   executed. If tim_lcore is LCORE_ID_ANY, the timer library will
- *   launch it on a different core for each call (round-robin).
+ *   executed, possibly a service lcore. If tim_lcore is LCORE_ID_ANY,
+ *   the timer library will launch it on a different enabled core for
+ *   each call (round-robin).
  * @param fct
  *   The callback function of the timer.
  * @param arg
  *   The user argument of the callback function.
  * @return
  *   - 0: Success; the timer is scheduled.
- *   - (-1): Timer is in the RUNNING or CONFIG state.
+ *   - (-1): Timer is in the RUNNING or CONFIG state, or the message ring
+ *     of the lcore is full (see rte_timer_subsystem_set_remote_mode()).
  */
 int rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 		    enum rte_timer_type type, unsigned tim_lcore,
@@ -243,8 +340,9 @@ int rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
  *     STOPPED state after execution.
  * @param tim_lcore
  *   The ID of the lcore where the timer callback function has to be
- *   executed. If tim_lcore is LCORE_ID_ANY, the timer library will
- *   launch it on a different core for each call (round-robin).
+ *   executed, possibly a service lcore. If tim_lcore is LCORE_ID_ANY,
+ *   the timer library will launch it on a different enabled core for
+ *   each call (round-robin).
  * @param fct
  *   The callback function of the timer.
  * @param arg
@@ -276,7 +374,12 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
  *   The timer handle.
  * @return
  *   - 0: Success; the timer is stopped.
- *   - (-1): The timer is in the RUNNING or CONFIG state.
+ *   - (-EINPROGRESS): In message mode (see
+ *     rte_timer_subsystem_set_remote_mode()), the stop was posted to the
+ *     lcore where the timer is pending, which stops it in its next
+ *     rte_timer_manage() call. The timer can't be freed until then.
+ *   - (-1): The timer is in the RUNNING or CONFIG state, or the stop
+ *     could not be posted.
  */
 int rte_timer_stop(struct rte_timer *tim);
 